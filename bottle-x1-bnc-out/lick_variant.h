@@ -0,0 +1,41 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Lick sensor variant: one bottle, BNC output.
+ *
+ * The drinking bottle is connected to the first electrode (ELE0) in the
+ * touch sensor. Its touch status is written to one GPIO pin, connected
+ * to the BNC. See firmware/lick_config.h for all the settings available.
+ */
+
+#ifndef LICK_VARIANT_H
+#define LICK_VARIANT_H
+
+#define LICK_VARIANT_NAME "bottle-x1-bnc-out"
+
+// Board that the build targets unless PICO_BOARD is given (read by
+// firmware/CMakeLists.txt).
+#define LICK_BOARD pico
+
+#define LICK_N_SENSORS 1
+#define LICK_N_ELECTRODES 1
+
+// Touch (lick) data will be written to this Pico pin. Connect this pin
+// to the data acquisition system to record licking.
+#define LICK_SINK_GPIO 1
+#define LICK_GPIO_OUT_PINS {2}
+
+// Onsets and offsets of touch are also sent over USB, for a
+// timestamped log of the outputs (see firmware/lick_edges.h).
+#define LICK_SINK_EDGES 1
+
+#endif
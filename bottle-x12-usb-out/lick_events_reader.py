@@ -22,22 +22,49 @@ max output: 50 Hz = 50 lines in second of this kind
 = 16 * 50 = 800 chars/s
 thus, reading data every 2 seconds should be fine (size of serial buffer is 4095, I think)
 
+When the script starts, it asks the lick sensor how many columns it
+sends and how many electrodes it has (see host/python/lick_device.py);
+older firmware that does not answer is assumed to send 3 columns from
+12 electrodes.
+
+The text is decoded by the `lick` library in host/ (see
+host/python/lick_records.py); build it first with
+`cmake -S host -B host/build && cmake --build host/build`.
+
+The session is saved as a directory of csv segments, every read of the
+serial port as one checksummed block (see host/python/lick_segments.py),
+so that a crash loses at most the last read, and the session is
+recovered when the script next starts;
+`python3 host/python/lick_segments.py <directory> > session.csv` joins
+it into a single csv file. Counters of what is received are served on
+`METRICS` while the script runs (see host/python/lick_metrics.py).
+With `SQLITE` set, lick events are also inserted into a local SQLite
+database (see host/python/lick_sqlite.py), on a thread that the reader
+never waits for. The session, and `FSYNC`, `METRICS` and `SQLITE`, are
+shared by the readers of every variant (see
+host/python/lick_session.py); this script only parses the lick events
+of this variant.
+
 """
 
 import asyncio
-from datetime import datetime
 import os
 import sys
-import time
-
-import numpy as np
 
 from serial import Serial, SerialException
 from serial.tools import list_ports
 from serial_asyncio import create_serial_connection
 
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                             '..', 'host', 'python'))
+from lick_device import describe
+from lick_records import RecordDecoder
+from lick_session import ReaderSession, recover
+
 # Parameters
 BAUD = 115200
+N_COLUMNS = 3
+N_ELECTRODES = 12
 output_dir = "."  # os.path.expanduser("~")
 
 def get_pico_port():
@@ -51,47 +78,62 @@ def get_pico_port():
         raise SerialException("there is more than one Pico")
 
 
+def get_layout(port):
+    # Ask the lick sensor for the number of columns and electrodes.
+    try:
+        with Serial(port, BAUD) as serial:
+            device = describe(serial)
+    except SerialException:
+        device = None
+    if device is None or device.get('format') != 'events':
+        print("No description from the lick sensor; expecting",
+              N_COLUMNS, "columns")
+        return (N_COLUMNS, N_ELECTRODES)
+    print(f"Connected to {device['variant']}, "
+          f"firmware {device['version']}")
+    return (len(device['columns']), device['electrodes'])
+
+
 class InputProtocol(asyncio.Protocol):
     # ""
     #Based on an example in pySerial-asyncio documentation
     #https://pyserial-asyncio.readthedocs.io/en/latest/shortintro.html
     #""
-    def __init__(self):
-        self.t0 = -1
-        self.idx = -1
-        self.idx_col = 0
-        self.time_col = 1
-        now = datetime.now()
-        fname = f"lick_events_{now:%Y-%m-%d_%H_%M_%S}.csv"
-        fname = os.path.join(output_dir, fname)
-        self.fid = open(fname, mode="a")
+    def __init__(self, n_columns, n_electrodes, device):
+        self.n_electrodes = n_electrodes
+        self.sensor_col = 2
+        # With adaptive sampling the firmware adds a column with the
+        # sampling interval in effect, in us (see firmware/README.md).
+        self.interval_col = 3 if n_columns > 3 else None
+        # Lines are decoded as they arrive; an incomplete line is kept
+        # until the rest of it is received.
+        self.decoder = RecordDecoder(n_columns)
+        # One row is written per active electrode.
+        header = "idx,timestamp,electrode"
+        if self.interval_col is not None:
+            header += ",interval_us"
+        header += "\n"
+        self.session = ReaderSession(output_dir, device, header,
+                                     self.sensor_col, n_electrodes)
+        self.fid = self.session.fid
 
     def connection_made(self, transport):
         self.transport = transport
 
     def data_received(self, data):
-        self.data = np.fromstring(data, dtype = int, sep = ' ')
-        self.data = self.data.reshape(-1, 3)
-
-        # When the first lick event arrives, write to the output file the date and time; this is time 0.
-        if self.t0 == -1:
-            self.t0 = self.data[0, self.time_col]
-            # The index column might be removed in the future; I added
-            # this just to check that there is no data lost on the way
-            # between the Pico and the csv file.
-            self.idx = self.data[0, self.idx_col]
-
-            # The output file receives an automatic name based on the date and time. This avoids having to ask for a file name every time the programme is run.
-            start = datetime.now()
-            start = f'# {start:%Y-%m-%d %H:%M:%S}\n'
-            header = "idx,timestamp,electrode\n"
-            self.fid.write(start)
-            self.fid.write(header)
-        
-        # The timestamp and index of all lick events are relative to the
-        # first event.
-        self.data[:, self.time_col] -= self.t0
-        self.data[:, self.idx_col] -= self.idx
+        self.decoder.feed(data)
+        self.data = self.decoder.read()
+        # Lines starting with '#' (e.g. reports of sensor health) are
+        # not lick events; write them to the file as they are.
+        n_comments = self.session.write_comments(self.decoder)
+        # The timestamp and index of all lick events are made relative
+        # to the first event.
+        self.session.received(data, self.data, self.decoder.n_bad,
+                              n_comments)
+        if len(self.data) == 0:
+            self.session.write_block()
+            self.pause_reading()
+            return
 
         # Electrode data, as received from the Pico, codes on/off in a
         # binary form, as one single number. Thus if electrodes 0 and 4
@@ -113,17 +155,18 @@ class InputProtocol(asyncio.Protocol):
         # Option 2. Decode electrode status before saving. One line per
         # active electrode. (Thus more rows)
         for line in self.data:
-            # The sensor has 12 electrodes
-            for ele in range(12):
-                if (line[-1] >> ele) & 0x1:
-                    self.fid.write(f"{line[0]},{line[1]},{ele}\n")
-                    print(line[0], line[1], ele)
+            for ele in range(self.n_electrodes):
+                if (line[self.sensor_col] >> ele) & 0x1:
+                    row = f"{line[0]},{line[1]},{ele}"
+                    if self.interval_col is not None:
+                        row += f",{line[self.interval_col]}"
+                    self.fid.write(row + "\n")
+                    print(row.replace(',', ' '))
 
         # Stop callbacks again immediately
         self.pause_reading()
 
-        # Flush data to disk, to minimise data loss in case of a crash.
-        self.fid.flush()
+        self.session.write_block()
 
     def pause_reading(self):
         # Stop the callbacks to data_received
@@ -134,19 +177,23 @@ class InputProtocol(asyncio.Protocol):
         # has been received in the meantime.
         self.transport.resume_reading()
 
-input_protocol = InputProtocol()
-
 async def reader(port):
     transport, protocol = await create_serial_connection(
         # loop, InputProtocol, port.device, baudrate=BAUD)
-        loop, lambda: input_protocol, port.device, baudrate=BAUD)
+        loop, lambda: input_protocol, port, baudrate=BAUD)
 
     while True:
         # Read data from serial port every these seconds
         await asyncio.sleep(2)
         protocol.resume_reading()
 
-port = get_pico_port()
+# The serial port can be given on the command line, e.g. the device
+# made by host/tools/lick_emulate; otherwise the Pico is looked for.
+port = sys.argv[1] if len(sys.argv) > 1 else get_pico_port().device
+# Sessions that an earlier run left unfinished (a crash or a power cut)
+# are recovered before a new one is started.
+recover(output_dir)
+input_protocol = InputProtocol(*get_layout(port), port)
 loop = asyncio.new_event_loop()
 asyncio.set_event_loop(loop)
 
@@ -155,7 +202,7 @@ print("Acquiring lick event data. Press Ctrl+C to exit.")
 try:
     loop.run_until_complete(reader(port))
 except KeyboardInterrupt:
-    input_protocol.fid.close()
+    input_protocol.session.close()
     # pass
 
 loop.close()
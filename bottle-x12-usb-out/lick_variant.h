@@ -0,0 +1,34 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Lick sensor variant: up to 12 bottles, USB output.
+ *
+ * All 12 electrodes of one touch sensor are enabled. When a lick is
+ * detected, the event count, timestamp and electrode data are printed
+ * to serial. See firmware/lick_config.h for all the settings available.
+ */
+
+#ifndef LICK_VARIANT_H
+#define LICK_VARIANT_H
+
+#define LICK_VARIANT_NAME "bottle-x12-usb-out"
+
+// Board that the build targets unless PICO_BOARD is given (read by
+// firmware/CMakeLists.txt).
+#define LICK_BOARD pico2
+
+#define LICK_N_SENSORS 1
+#define LICK_N_ELECTRODES 12
+
+#define LICK_SINK_USB 1
+
+#endif
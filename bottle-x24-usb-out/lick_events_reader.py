@@ -17,15 +17,35 @@ file.
 Usage
 -----
 * Each line of data sent over serial is expected to consist of the
-  timestamp when a lick event was detected, followed by one or more
-  sensor values.
-* Define the header below, to match the number of columns of data to
-  expect from the lick sensor.
+  event count and the timestamp when a lick event was detected, followed
+  by one or more sensor values.
+* Lines that start with `#` (e.g. reports of sensor health) are not lick
+  events. They are printed and saved to the csv file as they are.
+* The text received is decoded by the `lick` library in host/ (see
+  host/python/lick_records.py), which must be built first with
+  `cmake -S host -B host/build && cmake --build host/build`.
+* The columns of data to expect are asked to the lick sensor when the
+  script starts (see host/python/lick_device.py). If the firmware does
+  not answer (older versions), the header below is used; it must then
+  match the number of columns sent by the lick sensor.
 * Connect the Pico to the computer before running this script.
 * This script will create a text file and then wait for data to be sent
   over serial.
-* Every few cycles, the data values received will be written to a csv
-  file.
+* Every read of the serial port is written to disk as one checksummed
+  block, in a directory of csv segments that are compressed once closed
+  (see host/python/lick_segments.py). After a crash, only the last
+  block can be lost, and the session is recovered when the script next
+  starts; `python3 host/python/lick_segments.py <directory>
+  > session.csv` joins a session into a single csv file.
+* Counters of what is received (bytes, lick events per electrode,
+  errors, lost events, write times) are served on `METRICS` while the
+  script runs (see host/python/lick_metrics.py).
+* With `SQLITE` set, lick events are also inserted into a local SQLite
+  database, one row per lick, on a thread that the reader never waits
+  for (see host/python/lick_sqlite.py).
+* The session, and `FSYNC`, `METRICS` and `SQLITE`, are shared by the
+  readers of every variant (see host/python/lick_session.py); this
+  script only parses the lick events of this variant.
 * The received sensor value is a binary representation of the electrodes
   in the sensor where a lick was detected. Here, those values are stored
   as such to the csv file.
@@ -60,10 +80,8 @@ experiments with the lick sensor for many hours.
 """
 
 import asyncio
-from datetime import datetime
 import os
 import sys
-import time
 
 import numpy as np
 
@@ -71,9 +89,15 @@ from serial import Serial, SerialException
 from serial.tools import list_ports
 from serial_asyncio import create_serial_connection
 
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                             '..', 'host', 'python'))
+from lick_device import describe
+from lick_records import RecordDecoder
+from lick_session import ReaderSession, recover
+
 # Parameters
 BAUD = 115200
-HEADER = "timestamp,sensorA,sensorB\n"
+HEADER = "idx,timestamp,sensorA,sensorB\n"
 output_dir = "."  # os.path.expanduser("~")
 
 
@@ -88,53 +112,59 @@ def get_pico_port():
         raise SerialException("there is more than one Pico")
 
 
+def get_header(port):
+    # Ask the lick sensor for the names of the columns that it sends.
+    try:
+        with Serial(port, BAUD) as serial:
+            device = describe(serial)
+    except SerialException:
+        device = None
+    if device is None or device.get('format') != 'events':
+        print("No description from the lick sensor; expecting",
+              HEADER.strip())
+        return HEADER
+    print(f"Connected to {device['variant']}, "
+          f"firmware {device['version']}")
+    return ','.join(device['columns']) + '\n'
+
+
 class InputProtocol(asyncio.Protocol):
     """
     Based on an example in pySerial-asyncio documentation
     https://pyserial-asyncio.readthedocs.io/en/latest/shortintro.html
     """
-    def __init__(self):
-        self.t0 = -1
-        self.ncols = len(HEADER.split(','))
-        self.counter = 0
-        # self.idx = -1
-        # self.idx_col = 0
-        self.time_col = 0
-        # The output file receives an automatic name based on the date
-        # and time. This avoids having to ask for a file name every time
-        # the programme is run.
-        now = datetime.now()
-        fname = f"lick_events_{now:%Y-%m-%d_%H_%M_%S}.csv"
-        fname = os.path.join(output_dir, fname)
-        self.fid = open(fname, mode="a")
+    def __init__(self, header, device):
+        self.ncols = len(header.split(','))
+        self.sensor_cols = [col for (col, name)
+                            in enumerate(header.strip().split(','))
+                            if name.startswith('sensor')]
+        # Lines are decoded as they arrive; an incomplete line is kept
+        # until the rest of it is received.
+        self.decoder = RecordDecoder(self.ncols)
+        self.n_bad = 0
+        self.session = ReaderSession(output_dir, device, header,
+                                     self.sensor_cols)
+        self.fid = self.session.fid
 
     def connection_made(self, transport):
         self.transport = transport
 
     def data_received(self, data):
-        # print(data)
-        self.data = np.fromstring(data, dtype=int, sep=' ')
-        try:
-            self.data = self.data.reshape(-1, self.ncols)
-        except ValueError as err:
-            print(err)
-            print("Ignoring values:", self.data)
-            self.data = np.zeros(self.ncols, dtype=int).reshape(
-                -1, self.ncols)
-
-        # When the first lick event arrives, write to the output file
-        # the date and time; this is time 0.
-        if self.t0 == -1:
-            self.t0 = self.data[0, self.time_col]
-            start = datetime.now()
-            start = f'# {start:%Y-%m-%d %H:%M:%S}\n'
-            self.fid.write(start)
-            self.fid.write(HEADER)
-        
-        # The timestamp and index of all lick events are relative to the
-        # first event.
-        self.data[:, self.time_col] -= self.t0
-        # self.data[:, self.idx_col] -= self.idx
+        self.decoder.feed(data)
+        self.data = self.decoder.read()
+        n_comments = self.session.write_comments(self.decoder)
+        if self.decoder.n_bad != self.n_bad:
+            print("Ignored", self.decoder.n_bad - self.n_bad,
+                  "lines that are not lick events")
+            self.n_bad = self.decoder.n_bad
+        # The timestamp and index of all lick events are made relative
+        # to the first event.
+        self.session.received(data, self.data, self.decoder.n_bad,
+                              n_comments)
+        if len(self.data) == 0:
+            self.session.write_block()
+            self.pause_reading()
+            return
 
         # Electrode data, as received from the Pico, codes on/off in a
         # binary form, as one single number. Thus if electrodes 0 and 4
@@ -165,12 +195,7 @@ class InputProtocol(asyncio.Protocol):
         # Stop callbacks again immediately
         self.pause_reading()
 
-        # Every few cycles flush data to disk, to minimise data loss in
-        # case of a crash.
-        self.counter += 1
-        if self.counter == 10:
-            self.fid.flush()
-            self.counter = 0
+        self.session.write_block()
 
     def pause_reading(self):
         # Stop the callbacks to data_received
@@ -181,12 +206,17 @@ class InputProtocol(asyncio.Protocol):
         # has been received in the meantime.
         self.transport.resume_reading()
 
-port = get_pico_port()
-input_protocol = InputProtocol()
+# The serial port can be given on the command line, e.g. the device
+# made by host/tools/lick_emulate; otherwise the Pico is looked for.
+port = sys.argv[1] if len(sys.argv) > 1 else get_pico_port().device
+# Sessions that an earlier run left unfinished (a crash or a power cut)
+# are recovered before a new one is started.
+recover(output_dir)
+input_protocol = InputProtocol(get_header(port), port)
 
 async def reader(port):
     transport, protocol = await create_serial_connection(
-        loop, lambda: input_protocol, port.device, baudrate=BAUD)
+        loop, lambda: input_protocol, port, baudrate=BAUD)
         # loop, InputProtocol, port.device, baudrate=BAUD)
 
     while True:
@@ -204,7 +234,7 @@ print("Acquiring lick event data. Press Ctrl+C to exit.")
 try:
     loop.run_until_complete(reader(port))
 except KeyboardInterrupt:
-    input_protocol.fid.close()
+    input_protocol.session.close()
     sys.exit()
 
 loop.close()
@@ -0,0 +1,41 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Lick sensor variant: up to 24 bottles, USB output.
+ *
+ * Two touch sensors (A, at I2C address 0x5A, and B, at 0x5B) share the
+ * same I2C pins. When a lick is detected, the event count, timestamp
+ * and electrode data are printed to serial. See firmware/lick_config.h
+ * for all the settings available.
+ */
+
+#ifndef LICK_VARIANT_H
+#define LICK_VARIANT_H
+
+#define LICK_VARIANT_NAME "bottle-x24-usb-out"
+
+// Board that the build targets unless PICO_BOARD is given (read by
+// firmware/CMakeLists.txt).
+#define LICK_BOARD pico2
+
+#define LICK_N_SENSORS 2
+#define LICK_SENSOR_ADDRESSES {0x5A, 0x5B}
+#define LICK_N_ELECTRODES 12
+
+// To send the filtered and baseline values of all electrodes instead of
+// lick events (e.g. for tuning the sensors), set LICK_SINK_USB to 0 and
+// LICK_SINK_RAW to 1. To send them on a separate USB interface, read
+// with host/tools/lick_usb_read, add `#define LICK_RAW_USB_VENDOR 1`.
+#define LICK_SINK_USB 1
+#define LICK_SINK_RAW 0
+
+#endif
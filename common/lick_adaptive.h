@@ -0,0 +1,108 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_adaptive.h
+
+   Activity-adaptive sampling: which sensors to read at each sample.
+
+   Samples are taken at a fixed, fast interval. A sensor is active, and
+   read at every sample, while any of its electrodes is touched (or
+   near the touch threshold, if the caller checks for that), and for
+   `hold` samples after that, so that it stays active between the
+   licks of a bout. Otherwise it is idle, and read only every
+   `idle_samples` samples; in between, it is taken to be untouched. The
+   idle sensors are read at different samples from each other, so that
+   their reads are spread over time.
+
+   The first onset of a bout is caught by an idle read, within
+   `idle_samples` samples of the touch, and those that follow within
+   one sample. The sensors that were active when a sample was taken
+   are in `fast`, so that the interval in effect can be sent with the
+   sample.
+
+   As in lick_detect.h, the functions here are `static inline`, take
+   the sizes as arguments and have no dependencies on the Pico SDK.
+ */
+
+#ifndef LICK_ADAPTIVE_H
+#define LICK_ADAPTIVE_H
+
+#include <stdint.h>
+
+#include "lick_detect.h"
+
+struct lick_adaptive {
+    uint32_t n_samples;
+    uint32_t hold_left[LICK_MAX_SENSORS];
+    uint8_t active;             // Sensors read at every sample
+    uint8_t fast;               // Those active at the last sample
+};
+
+/* All sensors start active. */
+static inline void lick_adaptive_init(struct lick_adaptive *a,
+        const uint8_t n_sensors, const uint32_t hold) {
+    a->n_samples = 0;
+    a->active = (uint8_t)((1u << n_sensors) - 1);
+    a->fast = a->active;
+    for (uint8_t i = 0; i < LICK_MAX_SENSORS; i++) {
+        a->hold_left[i] = hold;
+    }
+}
+
+/* Start a sample. Returns the mask of the sensors to read. */
+static inline uint8_t lick_adaptive_plan(struct lick_adaptive *a,
+        const uint8_t n_sensors, const uint32_t idle_samples) {
+    uint32_t now = a->n_samples++;
+    uint8_t mask = a->active;
+    for (uint8_t i = 0; i < n_sensors; i++) {
+        uint32_t phase = i * idle_samples / n_sensors;
+        if ((now + phase) % idle_samples == 0) {
+            mask |= (uint8_t)(1u << i);
+        }
+    }
+    a->fast = a->active;
+    return mask;
+}
+
+/* Update the state from the sensors read in this sample (`was_read`, as
+ * returned by lick_adaptive_plan): their touch status, and `near`, a
+ * mask of those with an electrode near the threshold. Sensors not read
+ * must have `touched` 0.
+ */
+static inline void lick_adaptive_update(struct lick_adaptive *a,
+        const uint16_t *touched, const uint8_t near, const uint8_t was_read,
+        const uint8_t n_sensors, const uint32_t hold) {
+    for (uint8_t i = 0; i < n_sensors; i++) {
+        uint8_t bit = (uint8_t)(1u << i);
+        if (!(was_read & bit)) {
+            continue;
+        }
+        if (touched[i] || (near & bit)) {
+            a->active |= bit;
+            a->hold_left[i] = hold;
+        } else if (a->hold_left[i]) {
+            a->hold_left[i]--;
+        } else {
+            a->active &= (uint8_t)~bit;
+        }
+    }
+}
+
+/* The interval in effect for sensor `i` at a sample whose `fast` mask
+ * is this, in samples.
+ */
+static inline uint32_t lick_adaptive_interval(const uint8_t fast,
+        const uint8_t i, const uint32_t idle_samples) {
+    return (fast >> i) & 1u ? 1 : idle_samples;
+}
+
+#endif
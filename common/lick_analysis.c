@@ -0,0 +1,542 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lick_analysis.h"
+
+#define MAX_COLUMNS 32
+
+enum format {
+    FORMAT_MASK,        // idx,timestamp,sensorA,sensorB,...
+    FORMAT_LABEL,       // timestamp,eleID (e.g. A5)
+    FORMAT_NUMBER       // idx,timestamp,electrode (e.g. 5)
+};
+
+struct columns {
+    enum format format;
+    int n;
+    int time;
+    int electrode;
+    int8_t sensor[MAX_COLUMNS];     // Sensor of each mask column, or -1
+};
+
+/* Find the columns from the header line. Returns -1 if the format is
+ * not known.
+ */
+static int parse_header(const char *p, const char *end,
+                        struct columns *c) {
+    memset(c, 0, sizeof(*c));
+    c->time = -1;
+    c->electrode = -1;
+    int n_sensors = 0;
+    while (p <= end && c->n < MAX_COLUMNS) {
+        const char *q = memchr(p, ',', (size_t)(end - p));
+        if (q == NULL) {
+            q = end;
+        }
+        size_t len = (size_t)(q - p);
+        while (len > 0 && (p[len - 1] == '\r' || p[len - 1] == ' ')) {
+            len--;
+        }
+        int col = c->n++;
+        c->sensor[col] = -1;
+        if (len == 9 && memcmp(p, "timestamp", 9) == 0) {
+            c->time = col;
+        } else if (len == 5 && memcmp(p, "eleID", 5) == 0) {
+            c->format = FORMAT_LABEL;
+            c->electrode = col;
+        } else if (len == 9 && memcmp(p, "electrode", 9) == 0) {
+            c->format = FORMAT_NUMBER;
+            c->electrode = col;
+        } else if (len >= 6 && memcmp(p, "sensor", 6) == 0) {
+            // sensorA, sensorB, ... or else in order of appearance.
+            int sensor = n_sensors;
+            if (len == 7 && p[6] >= 'A' && p[6] <= 'Z') {
+                sensor = p[6] - 'A';
+            }
+            if (sensor < LICK_ANALYSIS_MAX_SENSORS) {
+                c->sensor[col] = (int8_t)sensor;
+            }
+            n_sensors++;
+        }
+        p = q + 1;
+    }
+    if (c->time < 0) {
+        return -1;
+    }
+    if (c->electrode < 0) {
+        c->format = FORMAT_MASK;
+        return n_sensors > 0 ? 0 : -1;
+    }
+    return 0;
+}
+
+static int add_lick(struct lick_session *s, unsigned e, int64_t t) {
+    if (s->n[e] == s->cap[e]) {
+        size_t cap = s->cap[e] ? 2 * s->cap[e] : 256;
+        int64_t *t_ms = realloc(s->t_ms[e], cap * sizeof(*t_ms));
+        if (t_ms == NULL) {
+            return -1;
+        }
+        s->t_ms[e] = t_ms;
+        s->cap[e] = cap;
+    }
+    s->t_ms[e][s->n[e]++] = t;
+    return 0;
+}
+
+/* Electrode number from a label such as `B3`, or -1. */
+static int parse_label(const char *p, const char *end) {
+    if (p == end || *p < 'A' || *p >= 'A' + LICK_ANALYSIS_MAX_SENSORS) {
+        return -1;
+    }
+    int sensor = *p++ - 'A';
+    char *e;
+    long n = strtol(p, &e, 10);
+    if (e == p || e > end || n < 0 ||
+            n >= LICK_ANALYSIS_ELECTRODES_PER_SENSOR) {
+        return -1;
+    }
+    return sensor * LICK_ANALYSIS_ELECTRODES_PER_SENSOR + (int)n;
+}
+
+/* Read one data line into the session. Returns 1 if the line is not
+ * valid, 0 if it is, or -1 if out of memory.
+ */
+static int parse_line(struct lick_session *s, const struct columns *c,
+                      const char *p, const char *end) {
+    int64_t t = 0;
+    bool have_time = false;
+    long long values[MAX_COLUMNS];
+    int electrode = -1;
+    for (int col = 0; col < c->n; col++) {
+        if (p > end) {
+            return 1;
+        }
+        const char *q = memchr(p, ',', (size_t)(end - p));
+        if (q == NULL) {
+            q = end;
+        }
+        if (col == c->electrode && c->format == FORMAT_LABEL) {
+            electrode = parse_label(p, q);
+            if (electrode < 0) {
+                return 1;
+            }
+        } else if (col == c->time || col == c->electrode ||
+                   c->sensor[col] >= 0) {
+            char *e;
+            values[col] = strtoll(p, &e, 10);
+            if (e == p || e > q) {
+                return 1;
+            }
+            if (col == c->time) {
+                t = values[col];
+                have_time = true;
+            }
+        }
+        p = q + 1;
+    }
+    if (!have_time) {
+        return 1;
+    }
+    if (c->format == FORMAT_NUMBER) {
+        long long v = values[c->electrode];
+        if (v < 0 || v >= LICK_ANALYSIS_MAX_ELECTRODES) {
+            return 1;
+        }
+        electrode = (int)v;
+    }
+    if (c->format != FORMAT_MASK) {
+        return add_lick(s, (unsigned)electrode, t);
+    }
+    for (int col = 0; col < c->n; col++) {
+        if (c->sensor[col] < 0) {
+            continue;
+        }
+        unsigned long long mask = (unsigned long long)values[col];
+        unsigned base = (unsigned)c->sensor[col] *
+            LICK_ANALYSIS_ELECTRODES_PER_SENSOR;
+        for (unsigned i = 0; i < LICK_ANALYSIS_ELECTRODES_PER_SENSOR;
+             i++) {
+            if ((mask >> i) & 1 && add_lick(s, base + i, t)) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int compare_i64(const void *a, const void *b) {
+    int64_t x = *(const int64_t *)a;
+    int64_t y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static char *read_file(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    char *buf = NULL;
+    size_t cap = 0;
+    *len = 0;
+    while (1) {
+        if (*len == cap) {
+            cap = cap ? 2 * cap : 65536;
+            char *b = realloc(buf, cap);
+            if (b == NULL) {
+                free(buf);
+                fclose(f);
+                errno = ENOMEM;
+                return NULL;
+            }
+            buf = b;
+        }
+        size_t n = fread(buf + *len, 1, cap - *len, f);
+        *len += n;
+        if (n == 0) {
+            break;
+        }
+    }
+    int error = ferror(f) ? EIO : 0;
+    fclose(f);
+    if (error) {
+        free(buf);
+        errno = error;
+        return NULL;
+    }
+    // There is always room for this, so that strtoll stops at the end
+    // of a last line without '\n'.
+    buf[*len] = '\0';
+    return buf;
+}
+
+int lick_session_load(struct lick_session *s) {
+    size_t len;
+    char *buf = read_file(s->path, &len);
+    if (buf == NULL) {
+        s->error = errno;
+        return -1;
+    }
+    struct columns c;
+    bool have_header = false;
+    const char *p = buf;
+    const char *buf_end = buf + len;
+    while (p < buf_end) {
+        const char *end = memchr(p, '\n', (size_t)(buf_end - p));
+        if (end == NULL) {
+            end = buf_end;
+        }
+        if (p == end || *p == '#' || *p == '\r') {
+            // Comment or empty line.
+        } else if (!have_header) {
+            if (parse_header(p, end, &c)) {
+                free(buf);
+                s->error = EINVAL;
+                return -1;
+            }
+            have_header = true;
+        } else {
+            int ret = parse_line(s, &c, p, end);
+            if (ret < 0) {
+                free(buf);
+                s->error = ENOMEM;
+                return -1;
+            }
+            s->n_bad += (uint64_t)ret;
+        }
+        p = end + 1;
+    }
+    free(buf);
+    if (!have_header) {
+        s->error = EINVAL;
+        return -1;
+    }
+    // Licks are in time order in files written by the reader; sort
+    // those that are not (e.g. merged by hand).
+    for (unsigned e = 0; e < LICK_ANALYSIS_MAX_ELECTRODES; e++) {
+        for (size_t i = 1; i < s->n[e]; i++) {
+            if (s->t_ms[e][i] < s->t_ms[e][i - 1]) {
+                qsort(s->t_ms[e], s->n[e], sizeof(int64_t), compare_i64);
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+void lick_session_free(struct lick_session *s) {
+    for (unsigned e = 0; e < LICK_ANALYSIS_MAX_ELECTRODES; e++) {
+        free(s->t_ms[e]);
+        s->t_ms[e] = NULL;
+        s->n[e] = 0;
+        s->cap[e] = 0;
+    }
+}
+
+size_t lick_session_n_licks(const struct lick_session *s) {
+    size_t n = 0;
+    for (unsigned e = 0; e < LICK_ANALYSIS_MAX_ELECTRODES; e++) {
+        n += s->n[e];
+    }
+    return n;
+}
+
+/* Partially sort `x` so that x[k] is the value that would be there if
+ * it was sorted, with no larger values before it (Hoare's selection).
+ */
+static void select_k(int64_t *x, size_t n, size_t k) {
+    size_t lo = 0;
+    size_t hi = n - 1;
+    while (lo < hi) {
+        int64_t pivot = x[lo + (hi - lo) / 2];
+        size_t i = lo;
+        size_t j = hi;
+        while (i <= j) {
+            while (x[i] < pivot) {
+                i++;
+            }
+            while (x[j] > pivot) {
+                j--;
+            }
+            if (i <= j) {
+                int64_t tmp = x[i];
+                x[i] = x[j];
+                x[j] = tmp;
+                i++;
+                if (j == 0) {
+                    break;
+                }
+                j--;
+            }
+        }
+        if (k <= j) {
+            hi = j;
+        } else if (k >= i) {
+            lo = i;
+        } else {
+            return;
+        }
+    }
+}
+
+static double median(int64_t *x, size_t n) {
+    size_t k = n / 2;
+    select_k(x, n, k);
+    if (n % 2) {
+        return (double)x[k];
+    }
+    // The other middle value is the largest of those before x[k].
+    int64_t lower = x[0];
+    for (size_t i = 1; i < k; i++) {
+        if (x[i] > lower) {
+            lower = x[i];
+        }
+    }
+    return ((double)lower + (double)x[k]) / 2;
+}
+
+/* Count the runs of licks separated by at least `gap` ms that have at
+ * least `min_licks` licks, and their mean size and duration. If `ilis`
+ * is not NULL, the intervals within those runs are stored there too.
+ */
+static uint64_t find_runs(const int64_t *t, size_t n, uint32_t gap,
+                          uint32_t min_licks, double *mean_licks,
+                          double *mean_ms, int64_t *ilis,
+                          size_t *n_ilis) {
+    uint64_t n_runs = 0;
+    uint64_t sum_licks = 0;
+    int64_t sum_ms = 0;
+    size_t start = 0;
+    for (size_t i = 1; i <= n; i++) {
+        if (i < n && t[i] - t[i - 1] < (int64_t)gap) {
+            continue;
+        }
+        size_t len = i - start;
+        if (len >= min_licks) {
+            n_runs++;
+            sum_licks += len;
+            sum_ms += t[i - 1] - t[start];
+            if (ilis) {
+                for (size_t j = start + 1; j < i; j++) {
+                    ilis[(*n_ilis)++] = t[j] - t[j - 1];
+                }
+            }
+        }
+        start = i;
+    }
+    *mean_licks = n_runs ? (double)sum_licks / (double)n_runs : 0;
+    *mean_ms = n_runs ? (double)sum_ms / (double)n_runs : 0;
+    return n_runs;
+}
+
+int lick_analysis_electrode(const int64_t *t_ms, size_t n,
+                            const struct lick_analysis_params *p,
+                            struct lick_analysis_metrics *m) {
+    memset(m, 0, sizeof(*m));
+    m->n_licks = n;
+    if (n == 0) {
+        return 0;
+    }
+    m->first_ms = t_ms[0];
+    m->last_ms = t_ms[n - 1];
+    m->n_clusters = find_runs(t_ms, n, p->cluster_gap_ms, p->min_licks,
+                              &m->cluster_licks, &m->cluster_ms, NULL,
+                              NULL);
+    int64_t *ilis = NULL;
+    if (n > 1) {
+        ilis = malloc((n - 1) * sizeof(*ilis));
+        if (ilis == NULL) {
+            return -1;
+        }
+    }
+    size_t n_ilis = 0;
+    m->n_bouts = find_runs(t_ms, n, p->bout_gap_ms, p->min_licks,
+                           &m->bout_licks, &m->bout_ms, ilis, &n_ilis);
+    m->n_ilis = n_ilis;
+    if (n_ilis) {
+        int64_t sum = 0;
+        for (size_t i = 0; i < n_ilis; i++) {
+            sum += ilis[i];
+        }
+        m->ili_mean_ms = (double)sum / (double)n_ilis;
+        m->ili_median_ms = median(ilis, n_ilis);
+    }
+    free(ilis);
+    return 0;
+}
+
+/* Work shared by the threads of lick_analysis_run. Tasks are taken in
+ * order from `next`; each is a session (when loading) or a session and
+ * electrode (when analysing).
+ */
+struct pool {
+    struct lick_session *sessions;
+    const struct lick_analysis_params *p;
+    struct lick_analysis_metrics *metrics;
+    const size_t *totals;
+    const size_t *tasks;        // NULL when loading
+    size_t n_tasks;
+    atomic_size_t next;
+    atomic_int failed;
+};
+
+static void *worker(void *arg) {
+    struct pool *pool = arg;
+    size_t i;
+    while ((i = atomic_fetch_add(&pool->next, 1)) < pool->n_tasks) {
+        if (pool->tasks == NULL) {
+            if (lick_session_load(&pool->sessions[i])) {
+                lick_session_free(&pool->sessions[i]);
+            }
+            continue;
+        }
+        size_t task = pool->tasks[i];
+        size_t s = task / LICK_ANALYSIS_MAX_ELECTRODES;
+        size_t e = task % LICK_ANALYSIS_MAX_ELECTRODES;
+        const struct lick_session *session = &pool->sessions[s];
+        struct lick_analysis_metrics *m = &pool->metrics[task];
+        if (lick_analysis_electrode(session->t_ms[e], session->n[e],
+                                    pool->p, m)) {
+            atomic_store(&pool->failed, 1);
+            continue;
+        }
+        m->preference = (double)session->n[e] / (double)pool->totals[s];
+    }
+    return NULL;
+}
+
+/* Run all tasks in the pool with up to `n_threads` threads (including
+ * the calling one). If fewer threads can be started, the rest of the
+ * work is done by those that did.
+ */
+static void run_pool(struct pool *pool, unsigned n_threads) {
+    pthread_t *threads = NULL;
+    if (n_threads > 1) {
+        threads = malloc((n_threads - 1) * sizeof(*threads));
+        if (threads == NULL) {
+            n_threads = 1;
+        }
+    }
+    unsigned n_started = 0;
+    atomic_store(&pool->next, 0);
+    for (unsigned i = 0; i + 1 < n_threads; i++) {
+        if (pthread_create(&threads[n_started], NULL, worker, pool)) {
+            break;
+        }
+        n_started++;
+    }
+    worker(pool);
+    for (unsigned i = 0; i < n_started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+}
+
+int lick_analysis_run(struct lick_session *sessions, size_t n_sessions,
+                      const struct lick_analysis_params *p,
+                      unsigned n_threads,
+                      struct lick_analysis_metrics *metrics) {
+    memset(metrics, 0, n_sessions * LICK_ANALYSIS_MAX_ELECTRODES *
+           sizeof(*metrics));
+    if (n_threads == 0) {
+        n_threads = 1;
+    }
+    struct pool pool = {
+        .sessions = sessions,
+        .p = p,
+        .metrics = metrics,
+        .n_tasks = n_sessions
+    };
+    atomic_init(&pool.next, 0);
+    atomic_init(&pool.failed, 0);
+    run_pool(&pool, n_threads);
+
+    // One task per electrode with licks; the largest sessions are not
+    // split further, as even a long one takes well under a millisecond.
+    size_t *totals = calloc(n_sessions ? n_sessions : 1, sizeof(*totals));
+    size_t n_tasks = 0;
+    for (size_t s = 0; s < n_sessions; s++) {
+        for (unsigned e = 0; e < LICK_ANALYSIS_MAX_ELECTRODES; e++) {
+            n_tasks += sessions[s].n[e] > 0;
+        }
+    }
+    size_t *tasks = malloc((n_tasks ? n_tasks : 1) * sizeof(*tasks));
+    if (totals == NULL || tasks == NULL) {
+        free(totals);
+        free(tasks);
+        return -1;
+    }
+    n_tasks = 0;
+    for (size_t s = 0; s < n_sessions; s++) {
+        totals[s] = lick_session_n_licks(&sessions[s]);
+        for (unsigned e = 0; e < LICK_ANALYSIS_MAX_ELECTRODES; e++) {
+            if (sessions[s].n[e] > 0) {
+                tasks[n_tasks++] = s * LICK_ANALYSIS_MAX_ELECTRODES + e;
+            }
+        }
+    }
+    pool.totals = totals;
+    pool.tasks = tasks;
+    pool.n_tasks = n_tasks;
+    run_pool(&pool, n_threads);
+    free(totals);
+    free(tasks);
+    return atomic_load(&pool.failed) ? -1 : 0;
+}
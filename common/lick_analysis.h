@@ -0,0 +1,117 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_analysis.h
+
+   Lick microstructure of recorded sessions, electrode by electrode.
+
+   A session is a file of lick events as saved by lick_events_reader.py
+   (mask format: a timestamp and one number per sensor with a bit set
+   for every electrode with a lick onset) or as converted by
+   utils/events-to-long.py (long format: a timestamp and an electrode
+   label such as `A5` per line). Lines starting with `#` are ignored.
+   Electrode n of sensor A, B, ... is numbered n, 12 + n, ...
+
+   For every electrode (every bottle spout), the licks are grouped into
+   clusters, separated by pauses of at least `cluster_gap_ms`, and
+   bouts, separated by pauses of at least `bout_gap_ms`; runs with
+   fewer than `min_licks` licks are not counted as either. The
+   inter-lick intervals (ILIs) summarised are those within bouts, which
+   reflect the licking rhythm rather than the pauses.
+
+   Sessions are loaded, and then electrodes analysed, by a pool of
+   threads that take the next session or electrode as they become
+   free; no data is shared between tasks, so that the work scales with
+   the number of cores as long as there are more tasks than threads.
+ */
+
+#ifndef LICK_ANALYSIS_H
+#define LICK_ANALYSIS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LICK_ANALYSIS_ELECTRODES_PER_SENSOR 12
+#define LICK_ANALYSIS_MAX_SENSORS 8
+#define LICK_ANALYSIS_MAX_ELECTRODES \
+    (LICK_ANALYSIS_ELECTRODES_PER_SENSOR * LICK_ANALYSIS_MAX_SENSORS)
+
+struct lick_analysis_params {
+    uint32_t cluster_gap_ms;
+    uint32_t bout_gap_ms;
+    uint32_t min_licks;
+};
+
+#define LICK_ANALYSIS_DEFAULT_PARAMS {500, 1000, 1}
+
+/* The lick onset times (ms) of every electrode in a session. */
+struct lick_session {
+    const char *path;
+    int error;                  // errno of a failed load, or 0
+    uint64_t n_bad;             // Lines that could not be read
+    size_t n[LICK_ANALYSIS_MAX_ELECTRODES];
+    size_t cap[LICK_ANALYSIS_MAX_ELECTRODES];
+    int64_t *t_ms[LICK_ANALYSIS_MAX_ELECTRODES];
+};
+
+/* Metrics of one electrode. Means are 0 if there is nothing to
+ * average.
+ */
+struct lick_analysis_metrics {
+    uint64_t n_licks;
+    int64_t first_ms;
+    int64_t last_ms;
+    double preference;          // Fraction of the licks in the session
+    uint64_t n_ilis;            // Intervals within bouts
+    double ili_median_ms;
+    double ili_mean_ms;
+    uint64_t n_clusters;
+    double cluster_licks;       // Mean licks per cluster
+    double cluster_ms;          // Mean duration of a cluster
+    uint64_t n_bouts;
+    double bout_licks;
+    double bout_ms;
+};
+
+/* Load the session in `s->path` into `s`, which must be zeroed. Returns
+ * 0, or -1 (with the reason in `s->error`) if the file cannot be read
+ * or its format is unknown.
+ */
+int lick_session_load(struct lick_session *s);
+
+void lick_session_free(struct lick_session *s);
+
+/* Total number of licks in a session. */
+size_t lick_session_n_licks(const struct lick_session *s);
+
+/* Compute the metrics of `n` lick times, in increasing order. Returns
+ * 0, or -1 if out of memory. `preference` is left as 0.
+ */
+int lick_analysis_electrode(const int64_t *t_ms, size_t n,
+                            const struct lick_analysis_params *p,
+                            struct lick_analysis_metrics *m);
+
+/* Load `n_sessions` sessions (with `path` set and the rest zeroed) and
+ * compute the metrics of every electrode with `n_threads` threads.
+ * `metrics` has LICK_ANALYSIS_MAX_ELECTRODES entries per session; those
+ * of electrodes without licks, and of sessions that failed to load,
+ * are zeroed.
+ *
+ * Returns 0, or -1 if the threads could not be started or memory ran
+ * out.
+ */
+int lick_analysis_run(struct lick_session *sessions, size_t n_sessions,
+                      const struct lick_analysis_params *p,
+                      unsigned n_threads,
+                      struct lick_analysis_metrics *metrics);
+
+#endif
@@ -0,0 +1,261 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lick_codec.h"
+
+/* CRC-32, reflected polynomial 0xEDB88320, processed 4 bits at a time.
+ * A 16-entry table is small enough to keep in flash on the Pico and is
+ * still fast enough on the host.
+ */
+static const uint32_t crc32_nibble_table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint32_t lick_crc32(uint32_t crc, const uint8_t *data, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0xf];
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0xf];
+    }
+    return ~crc;
+}
+
+static inline void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = v & 0xff;
+    p[1] = v >> 8;
+}
+
+static inline void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+    p[2] = (v >> 16) & 0xff;
+    p[3] = v >> 24;
+}
+
+static inline uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+        ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Zig-zag encoding maps small signed differences to small unsigned
+// numbers: 0, -1, 1, -2, 2... become 0, 1, 2, 3, 4... The shift left
+// is done unsigned, as shifting a negative value left is undefined.
+static inline uint16_t zigzag(int16_t d) {
+    return (uint16_t)((uint16_t)((uint16_t)d << 1) ^ (uint16_t)(d >> 15));
+}
+
+static inline int16_t unzigzag(uint16_t z) {
+    return (int16_t)((z >> 1) ^ -(int16_t)(z & 1));
+}
+
+static inline uint8_t bit_width(uint16_t v) {
+    uint8_t w = 0;
+    while (v) {
+        w++;
+        v >>= 1;
+    }
+    return w;
+}
+
+size_t lick_codec_encode(const uint16_t *samples, uint8_t n_samples,
+        uint8_t n_channels, uint16_t seq, uint32_t t0_us,
+        uint16_t period_us, uint8_t flags, uint8_t *out,
+        size_t out_size) {
+    if (n_samples == 0 || n_channels == 0 ||
+            n_channels > LICK_CODEC_MAX_CHANNELS) {
+        return 0;
+    }
+    size_t max_size = LICK_CODEC_MAX_BLOCK_SIZE(n_channels, n_samples);
+    if (out_size < max_size) {
+        return 0;
+    }
+
+    uint8_t *p = out + LICK_CODEC_HEADER_SIZE;
+    for (uint8_t ch = 0; ch < n_channels; ch++) {
+        const uint16_t *s = samples + ch;
+
+        // One pass to find the width needed by the largest difference.
+        // OR-ing all zig-zag values together gives the same width as
+        // the largest of them.
+        uint16_t all = 0;
+        for (uint8_t i = 1; i < n_samples; i++) {
+            all |= zigzag((int16_t)(s[i * n_channels] -
+                                    s[(i - 1) * n_channels]));
+        }
+        uint8_t width = bit_width(all);
+
+        put_u16(p, s[0]);
+        p[2] = width;
+        p += 3;
+        if (width == 0) {
+            continue;
+        }
+
+        // Second pass to pack the differences.
+        uint32_t acc = 0;
+        uint8_t nbits = 0;
+        for (uint8_t i = 1; i < n_samples; i++) {
+            uint16_t z = zigzag((int16_t)(s[i * n_channels] -
+                                          s[(i - 1) * n_channels]));
+            acc |= (uint32_t)z << nbits;
+            nbits += width;
+            while (nbits >= 8) {
+                *p++ = acc & 0xff;
+                acc >>= 8;
+                nbits -= 8;
+            }
+        }
+        if (nbits) {
+            *p++ = acc & 0xff;
+        }
+    }
+
+    uint16_t payload_len = (uint16_t)(p - out - LICK_CODEC_HEADER_SIZE);
+    out[0] = LICK_CODEC_SYNC0;
+    out[1] = LICK_CODEC_SYNC1;
+    out[2] = LICK_CODEC_VERSION;
+    out[3] = n_channels;
+    out[4] = n_samples;
+    out[5] = flags;
+    put_u16(out + 6, seq);
+    put_u32(out + 8, t0_us);
+    put_u16(out + 12, period_us);
+    put_u16(out + 14, payload_len);
+
+    uint32_t crc = lick_crc32(0, out + 2, (size_t)(p - out - 2));
+    put_u32(p, crc);
+    p += LICK_CODEC_CRC_SIZE;
+
+    return (size_t)(p - out);
+}
+
+int lick_codec_decode(const uint8_t *buf, size_t len,
+        struct lick_block_info *info, uint16_t *samples,
+        size_t max_values, size_t *consumed) {
+    *consumed = 0;
+    if (len < 2) {
+        return LICK_CODEC_NEED_MORE;
+    }
+    if (buf[0] != LICK_CODEC_SYNC0 || buf[1] != LICK_CODEC_SYNC1) {
+        *consumed = 1;
+        return LICK_CODEC_BAD_SYNC;
+    }
+    if (len < LICK_CODEC_HEADER_SIZE) {
+        return LICK_CODEC_NEED_MORE;
+    }
+
+    info->version = buf[2];
+    info->n_channels = buf[3];
+    info->n_samples = buf[4];
+    info->flags = buf[5];
+    info->seq = get_u16(buf + 6);
+    info->t0_us = get_u32(buf + 8);
+    info->period_us = get_u16(buf + 12);
+    info->payload_len = get_u16(buf + 14);
+
+    // A header that cannot be right is most likely a false sync in the
+    // middle of other data. Skip the sync bytes and look again.
+    size_t max_payload = LICK_CODEC_MAX_BLOCK_SIZE(info->n_channels,
+            info->n_samples) - LICK_CODEC_HEADER_SIZE - LICK_CODEC_CRC_SIZE;
+    if (info->version != LICK_CODEC_VERSION || info->n_channels == 0 ||
+            info->n_channels > LICK_CODEC_MAX_CHANNELS ||
+            info->n_samples == 0 || info->payload_len > max_payload) {
+        *consumed = 2;
+        return LICK_CODEC_BAD_HEADER;
+    }
+
+    size_t block_size = LICK_CODEC_HEADER_SIZE + info->payload_len +
+        LICK_CODEC_CRC_SIZE;
+    if (len < block_size) {
+        return LICK_CODEC_NEED_MORE;
+    }
+
+    const uint8_t *crc_pos = buf + LICK_CODEC_HEADER_SIZE +
+        info->payload_len;
+    if (lick_crc32(0, buf + 2, (size_t)(crc_pos - buf - 2)) !=
+            get_u32(crc_pos)) {
+        *consumed = 2;
+        return LICK_CODEC_BAD_CRC;
+    }
+
+    uint8_t n_channels = info->n_channels;
+    uint8_t n_samples = info->n_samples;
+    if ((size_t)n_channels * n_samples > max_values) {
+        // The block is valid, it just does not fit; let the caller
+        // decide what to do with it.
+        *consumed = block_size;
+        return LICK_CODEC_NO_SPACE;
+    }
+
+    const uint8_t *p = buf + LICK_CODEC_HEADER_SIZE;
+    for (uint8_t ch = 0; ch < n_channels; ch++) {
+        if (p + 3 > crc_pos) {
+            *consumed = 2;
+            return LICK_CODEC_BAD_HEADER;
+        }
+        uint16_t *s = samples + ch;
+        uint16_t value = get_u16(p);
+        uint8_t width = p[2];
+        p += 3;
+        s[0] = value;
+
+        if (width == 0) {
+            for (uint8_t i = 1; i < n_samples; i++) {
+                s[i * n_channels] = value;
+            }
+            continue;
+        }
+
+        size_t packed_len = ((size_t)(n_samples - 1) * width + 7) / 8;
+        if (width > 16 || p + packed_len > crc_pos) {
+            *consumed = 2;
+            return LICK_CODEC_BAD_HEADER;
+        }
+
+        uint32_t acc = 0;
+        uint8_t nbits = 0;
+        uint32_t mask = (1u << width) - 1;
+        for (uint8_t i = 1; i < n_samples; i++) {
+            while (nbits < width) {
+                acc |= (uint32_t)(*p++) << nbits;
+                nbits += 8;
+            }
+            value += unzigzag((uint16_t)(acc & mask));
+            acc >>= width;
+            nbits -= width;
+            s[i * n_channels] = value;
+        }
+    }
+
+    *consumed = block_size;
+    return LICK_CODEC_OK;
+}
+
+size_t lick_codec_find_sync(const uint8_t *buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (buf[i] != LICK_CODEC_SYNC0) {
+            continue;
+        }
+        if (i + 1 == len || buf[i + 1] == LICK_CODEC_SYNC1) {
+            return i;
+        }
+    }
+    return len;
+}
@@ -0,0 +1,136 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_codec.h
+
+   Compressed block format for raw (filtered/baseline) sensor data.
+
+   Sending every filtered and baseline value from 24 electrodes as text
+   takes far more bandwidth than lick events do. Successive samples from
+   one electrode differ very little, so samples are collected into
+   blocks and, for each channel, only the first value is stored as is;
+   the rest are stored as the difference from the previous sample,
+   zig-zag encoded and bit-packed using as many bits as the largest
+   difference in that block needs.
+
+   Block layout (all multi-byte values are little-endian):
+
+     offset  size  field
+     0       2     sync bytes, 0xA5 0x5A
+     2       1     format version
+     3       1     number of channels
+     4       1     number of samples
+     5       1     flags (see below)
+     6       2     block sequence number
+     8       4     timestamp of the first sample, in us
+     12      2     sampling interval, in us
+     14      2     payload length, in bytes
+     16      ...   payload
+     ...     4     CRC-32 of bytes 2 to the end of the payload
+
+   Payload, for each channel in turn:
+
+     2 bytes   first value
+     1 byte    width in bits of the packed differences (0 to 16)
+     ...       (n_samples - 1) zig-zag differences, packed LSB first
+               and padded to a whole byte
+
+   Flags: bit n is set if sensor n failed at some point during the
+   block (see firmware/lick_sensor.h); its values in the block are not
+   valid. Bits 2 to 7 are reserved (0).
+
+   This file has no dependencies on the Pico SDK so that it can be
+   built both into the firmware and into the host tools.
+ */
+
+#ifndef LICK_CODEC_H
+#define LICK_CODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LICK_CODEC_SYNC0 0xA5
+#define LICK_CODEC_SYNC1 0x5A
+#define LICK_CODEC_VERSION 1
+
+#define LICK_CODEC_FLAG_SENSOR_FAULT(sensor) (1u << (sensor))
+
+#define LICK_CODEC_HEADER_SIZE 16
+#define LICK_CODEC_CRC_SIZE 4
+
+// Filtered and baseline values from two sensors of 12 electrodes each.
+#define LICK_CODEC_MAX_CHANNELS 48
+#define LICK_CODEC_MAX_SAMPLES 255
+
+/* Worst-case size of an encoded block, in bytes. */
+#define LICK_CODEC_MAX_BLOCK_SIZE(n_channels, n_samples) \
+    (LICK_CODEC_HEADER_SIZE + (n_channels) * (3 + 2 * ((n_samples) - 1)) \
+     + LICK_CODEC_CRC_SIZE)
+
+enum lick_codec_status {
+    LICK_CODEC_OK = 0,
+    LICK_CODEC_NEED_MORE = 1,  // Not enough bytes for a whole block
+    LICK_CODEC_BAD_SYNC = -1,  // Buffer does not start with a block
+    LICK_CODEC_BAD_HEADER = -2,
+    LICK_CODEC_BAD_CRC = -3,
+    LICK_CODEC_NO_SPACE = -4   // Output buffer too small
+};
+
+struct lick_block_info {
+    uint8_t version;
+    uint8_t n_channels;
+    uint8_t n_samples;
+    uint8_t flags;
+    uint16_t seq;
+    uint32_t t0_us;
+    uint16_t period_us;
+    uint16_t payload_len;
+};
+
+/* CRC-32 (IEEE 802.3) of `len` bytes, continuing from `crc` (use 0 to
+ * start a new checksum).
+ */
+uint32_t lick_crc32(uint32_t crc, const uint8_t *data, size_t len);
+
+/* Encode one block.
+ *
+ * `samples` holds `n_samples` rows of `n_channels` values each, i.e.
+ * samples[i * n_channels + ch]. Returns the number of bytes written to
+ * `out`, or 0 if the arguments are invalid or `out` is too small.
+ */
+size_t lick_codec_encode(const uint16_t *samples, uint8_t n_samples,
+        uint8_t n_channels, uint16_t seq, uint32_t t0_us,
+        uint16_t period_us, uint8_t flags, uint8_t *out,
+        size_t out_size);
+
+/* Decode one block from the start of `buf`.
+ *
+ * On success, `info` is filled in, `samples` receives the decoded values
+ * in the same layout given to the encoder, and `consumed` is set to the
+ * size of the block. `max_values` is the capacity of `samples`.
+ *
+ * On LICK_CODEC_NEED_MORE nothing is consumed; call again when more
+ * bytes have arrived. On any other error `consumed` is set to the
+ * number of bytes that can be safely skipped before looking for the
+ * next block (see lick_codec_find_sync).
+ */
+int lick_codec_decode(const uint8_t *buf, size_t len,
+        struct lick_block_info *info, uint16_t *samples,
+        size_t max_values, size_t *consumed);
+
+/* Index of the first possible start of a block in `buf`, or `len` if
+ * there is none. A trailing 0xA5 is reported as a possible start.
+ */
+size_t lick_codec_find_sync(const uint8_t *buf, size_t len);
+
+#endif
@@ -0,0 +1,210 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_detect.h
+
+   Lick detection shared by all variants of the lick sensor.
+
+   Each touch sensor reports the on/off status of its 12 electrodes as
+   one 16-bit number, bit n being electrode n. Lick onsets are the bits
+   that changed from 0 to 1 since the previous sample, and offsets those
+   that changed from 1 to 0.
+
+   The functions here are `static inline` and take the number of
+   sensors as an argument. The firmware always calls them with a
+   compile-time constant (LICK_N_SENSORS), so the compiler builds a
+   version of each function specific to that variant, with the loops
+   over sensors unrolled and no branches left in them.
+
+   This file has no dependencies on the Pico SDK so that it can be
+   built both into the firmware and into the host tools.
+ */
+
+#ifndef LICK_DETECT_H
+#define LICK_DETECT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LICK_MAX_SENSORS 2
+#define LICK_ELECTRODES_PER_SENSOR 12
+
+/* Status of all sensors at one sampling time. */
+struct lick_sample {
+    uint32_t timestamp_ms;
+    uint16_t touched[LICK_MAX_SENSORS];
+    uint16_t onset[LICK_MAX_SENSORS];
+    uint16_t offset[LICK_MAX_SENSORS];
+    uint8_t fast;       // Sensors read at the full rate (lick_adaptive.h)
+};
+
+/* Detection state carried from one sample to the next. */
+struct lick_detect {
+    uint16_t was_touched[LICK_MAX_SENSORS];
+    // Number of lick events sent so far. Sent with every event so that
+    // the host can tell if any were lost on the way.
+    uint32_t n_events;
+};
+
+static inline void lick_detect_init(struct lick_detect *d) {
+    for (uint8_t i = 0; i < LICK_MAX_SENSORS; i++) {
+        d->was_touched[i] = 0;
+    }
+    d->n_events = 0;
+}
+
+/* Compute onsets and offsets in `s` from its touch status, and update
+ * the detection state. Returns true if there was an onset in any
+ * electrode.
+ *
+ * E.g. at the onset of touch in electrode 1, was_touched is 0b00,
+ * touched is 0b10 and thus onset is 0b10. At the offset of touch in
+ * the same electrode was_touched is 0b10, touched is 0b00 and offset is
+ * 0b10.
+ */
+static inline bool lick_detect_step(struct lick_detect *d,
+        struct lick_sample *s, const uint8_t n_sensors) {
+    uint16_t any = 0;
+    for (uint8_t i = 0; i < n_sensors; i++) {
+        uint16_t changed = d->was_touched[i] ^ s->touched[i];
+        s->onset[i] = changed & s->touched[i];
+        s->offset[i] = changed & d->was_touched[i];
+        d->was_touched[i] = s->touched[i];
+        any |= s->onset[i];
+    }
+    return any != 0;
+}
+
+/* Lick event filter
+ *
+ * Rejects onsets that are unlikely to be licks, after they have been
+ * computed by lick_detect_step:
+ *
+ * - bursts: more than `max_simultaneous` onsets in the same sample
+ *   (e.g. the animal climbing on the cage or touching several spouts),
+ *   all of which are rejected;
+ * - refractory: onsets less than `min_ili` samples after the last
+ *   accepted lick on the same electrode;
+ * - short contacts: contacts that last fewer than `min_contact`
+ *   samples. The onsets of the others are passed on when the contact
+ *   has lasted that long, i.e. `min_contact - 1` samples late.
+ *
+ * Each criterion is off if its value is 0 (or 1 for min_contact).
+ * Rejected onsets are counted.
+ */
+struct lick_filter {
+    uint32_t n_samples;
+    uint32_t last_lick[LICK_MAX_SENSORS][LICK_ELECTRODES_PER_SENSOR];
+    uint8_t contact[LICK_MAX_SENSORS][LICK_ELECTRODES_PER_SENSOR];
+    uint16_t has_licked[LICK_MAX_SENSORS];
+    uint16_t pending[LICK_MAX_SENSORS];
+    uint32_t n_burst;
+    uint32_t n_refractory;
+    uint32_t n_short;
+};
+
+static inline void lick_filter_init(struct lick_filter *f) {
+    f->n_samples = 0;
+    for (uint8_t i = 0; i < LICK_MAX_SENSORS; i++) {
+        f->has_licked[i] = 0;
+        f->pending[i] = 0;
+    }
+    f->n_burst = 0;
+    f->n_refractory = 0;
+    f->n_short = 0;
+}
+
+/* Filter the onsets in `s`, which lick_detect_step has just computed.
+ * Returns true if any onset is left.
+ */
+static inline bool lick_filter_step(struct lick_filter *f,
+        struct lick_sample *s, const uint8_t n_sensors,
+        const uint32_t min_ili, const uint8_t max_simultaneous,
+        const uint8_t min_contact) {
+    uint32_t now = ++f->n_samples;
+
+    if (max_simultaneous) {
+        uint32_t n = 0;
+        for (uint8_t i = 0; i < n_sensors; i++) {
+            n += (uint32_t)__builtin_popcount(s->onset[i]);
+        }
+        if (n > max_simultaneous) {
+            f->n_burst += n;
+            for (uint8_t i = 0; i < n_sensors; i++) {
+                s->onset[i] = 0;
+            }
+        }
+    }
+
+    uint16_t any = 0;
+    for (uint8_t i = 0; i < n_sensors; i++) {
+        if (min_ili) {
+            uint16_t bits = s->onset[i] & f->has_licked[i];
+            while (bits) {
+                uint8_t e = (uint8_t)__builtin_ctz(bits);
+                bits &= (uint16_t)(bits - 1);
+                if (now - f->last_lick[i][e] < min_ili) {
+                    s->onset[i] &= (uint16_t)~(1u << e);
+                    f->n_refractory++;
+                }
+            }
+        }
+        if (min_contact > 1) {
+            // Contacts that ended before lasting long enough.
+            uint16_t ended = f->pending[i] & (uint16_t)~s->touched[i];
+            f->n_short += (uint32_t)__builtin_popcount(ended);
+            uint16_t pending = (f->pending[i] & s->touched[i]) |
+                s->onset[i];
+            uint16_t ready = 0;
+            uint16_t bits = pending;
+            while (bits) {
+                uint8_t e = (uint8_t)__builtin_ctz(bits);
+                bits &= (uint16_t)(bits - 1);
+                uint8_t c = (s->onset[i] >> e) & 1u ? 1 :
+                    (uint8_t)(f->contact[i][e] + 1);
+                f->contact[i][e] = c;
+                if (c >= min_contact) {
+                    ready |= (uint16_t)(1u << e);
+                }
+            }
+            f->pending[i] = pending & (uint16_t)~ready;
+            s->onset[i] = ready;
+        }
+        if (min_ili) {
+            uint16_t bits = s->onset[i];
+            while (bits) {
+                uint8_t e = (uint8_t)__builtin_ctz(bits);
+                bits &= (uint16_t)(bits - 1);
+                // The time of the lick is that of its onset.
+                f->last_lick[i][e] = min_contact > 1 ?
+                    now - (min_contact - 1u) : now;
+            }
+            f->has_licked[i] |= s->onset[i];
+        }
+        any |= s->onset[i];
+    }
+    return any != 0;
+}
+
+/* Map electrode status bits onto GPIO pins: bit n of `touched` is
+ * written to bit `pins[n]` of the returned mask.
+ */
+static inline uint32_t lick_gpio_value(uint16_t touched,
+        const uint8_t *pins, const uint8_t n_pins) {
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < n_pins; i++) {
+        value |= (uint32_t)((touched >> i) & 1u) << pins[i];
+    }
+    return value;
+}
+
+#endif
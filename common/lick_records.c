@@ -0,0 +1,366 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lick_records.h"
+
+#define INITIAL_SIZE 65536
+
+struct lick_records {
+    uint32_t n_cols;
+    uint64_t n_bad;
+    // Input not decoded yet is buf[start] to buf[len].
+    char *buf;
+    size_t start;
+    size_t len;
+    size_t cap;
+    size_t n_lines;
+    char *comments;
+    size_t comments_len;
+    size_t comments_cap;
+};
+
+static const double powers_of_10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool is_sep(char c) {
+    return c == ' ' || c == '\t' || c == ',' || c == '\r';
+}
+
+static inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+/* Each parser reads one value from `p` (which is not a separator) and
+ * returns a pointer to the character after it, or NULL if it is not a
+ * number followed by a separator or the end of the line.
+ */
+static const char *parse_i64(const char *p, const char *end,
+                             int64_t *v) {
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = *p == '-';
+        p++;
+    }
+    const char *digits = p;
+    uint64_t x = 0;
+    while (p < end && is_digit(*p)) {
+        if (x > (UINT64_MAX - 9) / 10) {
+            return NULL;
+        }
+        x = x * 10 + (uint64_t)(*p - '0');
+        p++;
+    }
+    if (p == digits || x > (uint64_t)INT64_MAX) {
+        return NULL;
+    }
+    // Truncate decimals.
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && is_digit(*p)) {
+            p++;
+        }
+    }
+    if (p < end && !is_sep(*p)) {
+        return NULL;
+    }
+    *v = neg ? -(int64_t)x : (int64_t)x;
+    return p;
+}
+
+static const char *parse_f64(const char *p, const char *end, double *v) {
+    const char *s = p;
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = *p == '-';
+        p++;
+    }
+    // Up to 19 significant digits fit in the mantissa; any more only
+    // scale it.
+    uint64_t mant = 0;
+    int n_digits = 0;
+    int scale = 0;
+    bool any = false;
+    while (p < end && is_digit(*p)) {
+        if (n_digits < 19) {
+            mant = mant * 10 + (uint64_t)(*p - '0');
+            n_digits += mant > 0;
+        } else {
+            scale++;
+        }
+        any = true;
+        p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && is_digit(*p)) {
+            if (n_digits < 19) {
+                mant = mant * 10 + (uint64_t)(*p - '0');
+                n_digits += mant > 0;
+                scale--;
+            }
+            any = true;
+            p++;
+        }
+    }
+    // Values that cannot be converted exactly here (exponents, too many
+    // digits, inf, nan) are left to strtod. Lines always end in '\n',
+    // so strtod cannot read past the end of the line.
+    bool exact = any && mant < (1ull << 53) && scale >= -22 &&
+        scale <= 22;
+    if (!exact || (p < end && !is_sep(*p))) {
+        char *e;
+        double x = strtod(s, &e);
+        if (e == s || e > end || (e < end && !is_sep(*e))) {
+            return NULL;
+        }
+        *v = x;
+        return e;
+    }
+    double x = (double)mant;
+    x = scale < 0 ? x / powers_of_10[-scale] : x * powers_of_10[scale];
+    *v = neg ? -x : x;
+    return p;
+}
+
+/* Count the values in a line, or return 0 if any is not a number. */
+static uint32_t count_values(const char *p, const char *end) {
+    uint32_t n = 0;
+    while (1) {
+        while (p < end && is_sep(*p)) {
+            p++;
+        }
+        if (p == end) {
+            return n;
+        }
+        double v;
+        p = parse_f64(p, end, &v);
+        if (p == NULL) {
+            return 0;
+        }
+        n++;
+    }
+}
+
+/* Set the number of columns from the first line that has values. */
+static void find_n_cols(struct lick_records *r) {
+    const char *p = r->buf + r->start;
+    const char *buf_end = r->buf + r->len;
+    while (p < buf_end) {
+        const char *end = memchr(p, '\n', (size_t)(buf_end - p));
+        if (end == NULL) {
+            return;
+        }
+        const char *q = p;
+        while (q < end && is_sep(*q)) {
+            q++;
+        }
+        if (q < end && *q != '#') {
+            uint32_t n = count_values(q, end);
+            if (n) {
+                r->n_cols = n;
+                return;
+            }
+        }
+        p = end + 1;
+    }
+}
+
+struct lick_records *lick_records_new(uint32_t n_cols) {
+    struct lick_records *r = calloc(1, sizeof(*r));
+    if (r == NULL) {
+        return NULL;
+    }
+    r->n_cols = n_cols;
+    r->cap = INITIAL_SIZE;
+    r->buf = malloc(r->cap);
+    if (r->buf == NULL) {
+        free(r);
+        return NULL;
+    }
+    return r;
+}
+
+void lick_records_free(struct lick_records *r) {
+    if (r) {
+        free(r->buf);
+        free(r->comments);
+        free(r);
+    }
+}
+
+int lick_records_feed(struct lick_records *r, const char *data,
+                      size_t len) {
+    if (r->start > 0) {
+        memmove(r->buf, r->buf + r->start, r->len - r->start);
+        r->len -= r->start;
+        r->start = 0;
+    }
+    if (r->len + len > r->cap) {
+        size_t cap = r->cap;
+        while (cap < r->len + len) {
+            cap *= 2;
+        }
+        char *buf = realloc(r->buf, cap);
+        if (buf == NULL) {
+            return -1;
+        }
+        r->buf = buf;
+        r->cap = cap;
+    }
+    memcpy(r->buf + r->len, data, len);
+    r->len += len;
+
+    const char *p = data;
+    const char *end = data + len;
+    while ((p = memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        r->n_lines++;
+        p++;
+    }
+    // Without a newline in sight this is not text, e.g. the wrong baud
+    // rate or binary data; do not keep it forever.
+    if (r->n_lines == 0 && r->len > LICK_RECORDS_MAX_LINE) {
+        r->len = 0;
+        r->n_bad++;
+    }
+    if (r->n_cols == 0) {
+        find_n_cols(r);
+    }
+    return 0;
+}
+
+size_t lick_records_n_lines(const struct lick_records *r) {
+    return r->n_lines;
+}
+
+uint32_t lick_records_n_cols(const struct lick_records *r) {
+    return r->n_cols;
+}
+
+uint64_t lick_records_n_bad(const struct lick_records *r) {
+    return r->n_bad;
+}
+
+static int add_comment(struct lick_records *r, const char *p,
+                       const char *end) {
+    size_t len = (size_t)(end - p);
+    while (len > 0 && p[len - 1] == '\r') {
+        len--;
+    }
+    if (r->comments_len + len + 1 > r->comments_cap) {
+        size_t cap = r->comments_cap ? r->comments_cap : 1024;
+        while (cap < r->comments_len + len + 1) {
+            cap *= 2;
+        }
+        char *c = realloc(r->comments, cap);
+        if (c == NULL) {
+            return -1;
+        }
+        r->comments = c;
+        r->comments_cap = cap;
+    }
+    memcpy(r->comments + r->comments_len, p, len);
+    r->comments_len += len;
+    r->comments[r->comments_len++] = '\n';
+    return 0;
+}
+
+/* Decode lines into rows of int64_t (as_double false) or double. */
+static size_t read_rows(struct lick_records *r, void *out,
+                        size_t max_rows, bool as_double) {
+    if (r->n_cols == 0) {
+        return 0;
+    }
+    int64_t *out_i = out;
+    double *out_f = out;
+    size_t n_rows = 0;
+    const char *p = r->buf + r->start;
+    const char *buf_end = r->buf + r->len;
+    while (n_rows < max_rows && r->n_lines > 0) {
+        const char *end = memchr(p, '\n', (size_t)(buf_end - p));
+        const char *next = end + 1;
+        r->n_lines--;
+        while (p < end && is_sep(*p)) {
+            p++;
+        }
+        if (p == end) {
+            p = next;
+            continue;
+        }
+        if (*p == '#') {
+            add_comment(r, p, end);
+            p = next;
+            continue;
+        }
+        if (end - p > LICK_RECORDS_MAX_LINE) {
+            r->n_bad++;
+            p = next;
+            continue;
+        }
+        uint32_t n = 0;
+        size_t row = n_rows * r->n_cols;
+        while (p != NULL) {
+            while (p < end && is_sep(*p)) {
+                p++;
+            }
+            if (p == end || n == r->n_cols) {
+                break;
+            }
+            if (as_double) {
+                p = parse_f64(p, end, &out_f[row + n]);
+            } else {
+                p = parse_i64(p, end, &out_i[row + n]);
+            }
+            n++;
+        }
+        if (p == end && n == r->n_cols) {
+            n_rows++;
+        } else {
+            r->n_bad++;
+        }
+        p = next;
+    }
+    r->start = (size_t)(p - r->buf);
+    return n_rows;
+}
+
+size_t lick_records_read_i64(struct lick_records *r, int64_t *out,
+                             size_t max_rows) {
+    return read_rows(r, out, max_rows, false);
+}
+
+size_t lick_records_read_f64(struct lick_records *r, double *out,
+                             size_t max_rows) {
+    return read_rows(r, out, max_rows, true);
+}
+
+size_t lick_records_comments_len(const struct lick_records *r) {
+    return r->comments_len;
+}
+
+size_t lick_records_comments(struct lick_records *r, char *out,
+                             size_t size) {
+    size_t n = r->comments_len < size ? r->comments_len : size;
+    // Whole lines only.
+    while (n > 0 && r->comments[n - 1] != '\n') {
+        n--;
+    }
+    memcpy(out, r->comments, n);
+    memmove(r->comments, r->comments + n, r->comments_len - n);
+    r->comments_len -= n;
+    return n;
+}
@@ -0,0 +1,86 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_records.h
+
+   Decoder for the text records printed by the lick sensor and the
+   sensor test programs: one record per line, with the same number of
+   numeric values in every line separated by spaces (or tabs or
+   commas). Lines that start with `#` are comments (e.g. health reports)
+   and are kept apart.
+
+   Bytes are fed as they arrive from the serial port, in chunks that
+   need not end at a line boundary; an incomplete line is kept until the
+   rest of it arrives. Complete lines are decoded into a contiguous
+   array of rows supplied by the caller, which can be e.g. the memory of
+   a numpy array. Lines with the wrong number of values, or with values
+   that are not numbers, are skipped and counted.
+
+   The functions use only an opaque handle and fixed-size types so that
+   they can be called from Python with ctypes (see
+   host/python/lick_records.py).
+ */
+
+#ifndef LICK_RECORDS_H
+#define LICK_RECORDS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Longest line accepted; longer ones are skipped as bad.
+#define LICK_RECORDS_MAX_LINE 4096
+
+struct lick_records;
+
+/* Create a decoder for records of `n_cols` values, or of as many values
+ * as the first valid line has if `n_cols` is 0. Returns NULL if out of
+ * memory.
+ */
+struct lick_records *lick_records_new(uint32_t n_cols);
+
+void lick_records_free(struct lick_records *r);
+
+/* Add `len` bytes of input. Returns 0, or -1 if out of memory. */
+int lick_records_feed(struct lick_records *r, const char *data,
+                      size_t len);
+
+/* Number of complete lines waiting to be decoded; no more than this
+ * many rows will be returned by the next read.
+ */
+size_t lick_records_n_lines(const struct lick_records *r);
+
+/* Decode up to `max_rows` complete lines into `out`, as rows of
+ * lick_records_n_cols() values. Returns the number of rows written.
+ * Values are truncated to integers by the first, and read as they are
+ * by the second.
+ */
+size_t lick_records_read_i64(struct lick_records *r, int64_t *out,
+                             size_t max_rows);
+size_t lick_records_read_f64(struct lick_records *r, double *out,
+                             size_t max_rows);
+
+/* Values per record; 0 until known. */
+uint32_t lick_records_n_cols(const struct lick_records *r);
+
+/* Number of lines skipped because they were not valid records. */
+uint64_t lick_records_n_bad(const struct lick_records *r);
+
+/* Comment lines found by the reads so far, each ending in '\n'. The
+ * first returns how many bytes there are; the second copies up to
+ * `size` of them to `out` (whole lines only) and removes them, and
+ * returns the number of bytes copied.
+ */
+size_t lick_records_comments_len(const struct lick_records *r);
+size_t lick_records_comments(struct lick_records *r, char *out,
+                             size_t size);
+
+#endif
@@ -0,0 +1,118 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_summary.h
+
+   Binned summaries of licking, for recordings that last weeks and do
+   not need the time of every lick.
+
+   For every electrode, the samples are counted in bins of a fixed
+   length: the licks (onsets, after the lick event filter if there is
+   one), the samples in contact, and the bouts started. A bout starts
+   with the first lick on an electrode, and with every lick at least
+   `bout_gap` samples after the previous one. Optionally, the intervals
+   between licks within bouts are counted in a histogram of `hist_len`
+   bins of `hist_width` samples each, the last bin also holding the
+   longer intervals.
+
+   As in lick_detect.h, the functions here are `static inline`, take the
+   sizes as arguments and have no dependencies on the Pico SDK, so that
+   the firmware builds a version specific to each variant and the host
+   tools can use them too.
+ */
+
+#ifndef LICK_SUMMARY_H
+#define LICK_SUMMARY_H
+
+#include <stdint.h>
+
+#include "lick_detect.h"
+
+#define LICK_SUMMARY_MAX_HIST 16
+
+/* Counts of one bin. */
+struct lick_summary_bin {
+    uint32_t count;             // Bins started so far
+    uint32_t start_ms;          // Timestamp of the first sample
+    uint32_t licks[LICK_MAX_SENSORS][LICK_ELECTRODES_PER_SENSOR];
+    uint32_t contact[LICK_MAX_SENSORS][LICK_ELECTRODES_PER_SENSOR];
+    uint32_t bouts[LICK_MAX_SENSORS][LICK_ELECTRODES_PER_SENSOR];
+    uint32_t hist[LICK_MAX_SENSORS][LICK_ELECTRODES_PER_SENSOR]
+        [LICK_SUMMARY_MAX_HIST];
+};
+
+/* State carried from one bin to the next. */
+struct lick_summary {
+    uint32_t n_samples;
+    uint32_t n_bins;
+    uint32_t last_lick[LICK_MAX_SENSORS][LICK_ELECTRODES_PER_SENSOR];
+    uint16_t has_licked[LICK_MAX_SENSORS];
+};
+
+static inline void lick_summary_init(struct lick_summary *m) {
+    m->n_samples = 0;
+    m->n_bins = 0;
+    for (uint8_t i = 0; i < LICK_MAX_SENSORS; i++) {
+        m->has_licked[i] = 0;
+    }
+}
+
+/* Clear `b` and number it as the next bin. */
+static inline void lick_summary_start(struct lick_summary *m,
+        struct lick_summary_bin *b, uint32_t start_ms,
+        const uint8_t n_sensors, const uint8_t hist_len) {
+    b->count = m->n_bins++;
+    b->start_ms = start_ms;
+    for (uint8_t i = 0; i < n_sensors; i++) {
+        for (uint8_t e = 0; e < LICK_ELECTRODES_PER_SENSOR; e++) {
+            b->licks[i][e] = 0;
+            b->contact[i][e] = 0;
+            b->bouts[i][e] = 0;
+            for (uint8_t k = 0; k < hist_len; k++) {
+                b->hist[i][e][k] = 0;
+            }
+        }
+    }
+}
+
+/* Add the sample `s`, whose onsets lick_detect_step (and the filter, if
+ * any) has computed, to the bin `b`.
+ */
+static inline void lick_summary_step(struct lick_summary *m,
+        struct lick_summary_bin *b, const struct lick_sample *s,
+        const uint8_t n_sensors, const uint8_t n_electrodes,
+        const uint32_t bout_gap, const uint8_t hist_len,
+        const uint32_t hist_width) {
+    uint32_t now = ++m->n_samples;
+    for (uint8_t i = 0; i < n_sensors; i++) {
+        for (uint8_t e = 0; e < n_electrodes; e++) {
+            b->contact[i][e] += (s->touched[i] >> e) & 1u;
+        }
+        uint16_t bits = s->onset[i];
+        while (bits) {
+            uint8_t e = (uint8_t)__builtin_ctz(bits);
+            bits &= (uint16_t)(bits - 1);
+            uint32_t ili = now - m->last_lick[i][e];
+            b->licks[i][e]++;
+            if (!((m->has_licked[i] >> e) & 1u) || ili >= bout_gap) {
+                b->bouts[i][e]++;
+            } else if (hist_len) {
+                uint32_t k = ili / hist_width;
+                b->hist[i][e][k < hist_len ? k : hist_len - 1u]++;
+            }
+            m->last_lick[i][e] = now;
+        }
+        m->has_licked[i] |= s->onset[i];
+    }
+}
+
+#endif
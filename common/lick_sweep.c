@@ -0,0 +1,621 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lick_sweep.h"
+
+#define LANES LICK_SWEEP_LANES
+#define MAX_VALUES (1 + 2 * LICK_SWEEP_MAX_ELECTRODES)
+
+/* Samples between which the per-lane counts are added to the results.
+ * At most one onset in two samples, each matched with a latency of at
+ * most LICK_SWEEP_MAX_WINDOW, fit in 16 bits.
+ */
+#define BLOCK 256
+
+/* Loading */
+
+static char *read_file(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    char *buf = NULL;
+    size_t cap = 0;
+    size_t n = 0;
+    for (;;) {
+        if (n == cap) {
+            cap = cap ? 2 * cap : 1 << 20;
+            char *b = realloc(buf, cap + 1);
+            if (b == NULL) {
+                free(buf);
+                fclose(f);
+                errno = ENOMEM;
+                return NULL;
+            }
+            buf = b;
+        }
+        size_t got = fread(buf + n, 1, cap - n, f);
+        n += got;
+        if (got == 0) {
+            break;
+        }
+    }
+    int failed = ferror(f);
+    fclose(f);
+    if (failed) {
+        free(buf);
+        errno = EIO;
+        return NULL;
+    }
+    buf[n] = '\0';
+    *len = n;
+    return buf;
+}
+
+/* Parse the unsigned numbers at the start of the line at `p` into
+ * `values`. Returns their number, and the start of the next line in
+ * `next`.
+ */
+static size_t parse_numbers(char *p, unsigned long *values, size_t max,
+                            char **next) {
+    size_t n = 0;
+    char *end;
+    while (n < max) {
+        while (*p == ' ' || *p == '\t' || *p == ',') {
+            p++;
+        }
+        if (*p < '0' || *p > '9') {
+            break;
+        }
+        values[n++] = strtoul(p, &end, 10);
+        p = end;
+    }
+    while (*p && *p != '\n') {
+        p++;
+    }
+    *next = *p ? p + 1 : p;
+    return n;
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Index of the sample nearest to time `t` in `t_us` (increasing). */
+static size_t nearest(const uint64_t *t_us, size_t n, uint64_t t) {
+    size_t lo = 0;
+    size_t hi = n;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (t_us[mid] < t) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == n || (lo > 0 && t - t_us[lo - 1] <= t_us[lo] - t)) {
+        return lo - 1;
+    }
+    return lo;
+}
+
+/* Read the reference onsets of `t`, whose sample times (us since its
+ * first sample) are `t_us`.
+ */
+static int load_labels(struct lick_sweep_trace *t, const uint64_t *t_us,
+                       uint32_t t_first, size_t per_sensor) {
+    size_t len;
+    char *buf = read_file(t->labels, &len);
+    if (buf == NULL) {
+        return -1;
+    }
+    size_t cap[LICK_SWEEP_MAX_ELECTRODES] = {0};
+    // Timestamps wrap around every ~71 min; labels are in time order,
+    // so a wrap shows as a step back.
+    uint64_t wraps = 0;
+    uint32_t last = 0;
+    bool have_last = false;
+    char *p = buf;
+    while (*p) {
+        char *line = p;
+        unsigned long ts;
+        size_t n = parse_numbers(line, &ts, 1, &p);
+        if (n == 0) {
+            continue;
+        }
+        // The electrode, as a number or a label.
+        char *s = line;
+        while (*s >= '0' && *s <= '9') {
+            s++;
+        }
+        while (*s == ' ' || *s == '\t' || *s == ',') {
+            s++;
+        }
+        size_t e;
+        char *end;
+        if (*s >= 'A' && *s <= 'Z') {
+            e = (size_t)(*s - 'A') * per_sensor;
+            unsigned long k = strtoul(s + 1, &end, 10);
+            if (end == s + 1 || k >= per_sensor) {
+                t->n_bad_labels++;
+                continue;
+            }
+            e += k;
+        } else {
+            e = strtoul(s, &end, 10);
+            if (end == s) {
+                t->n_bad_labels++;
+                continue;
+            }
+        }
+        uint32_t rel = (uint32_t)ts - t_first;
+        if (have_last && rel < last && last - rel > 0x80000000u) {
+            wraps++;
+        }
+        last = rel;
+        have_last = true;
+        uint64_t when = (wraps << 32) + rel;
+        if (e >= t->n_electrodes || when > t_us[t->n_samples - 1] +
+                (uint64_t)(t->period_ms * 1000)) {
+            t->n_bad_labels++;
+            continue;
+        }
+        if (t->n_ref[e] == cap[e]) {
+            cap[e] = cap[e] ? 2 * cap[e] : 1024;
+            uint32_t *r = realloc(t->ref[e], cap[e] * sizeof(*r));
+            if (r == NULL) {
+                free(buf);
+                errno = ENOMEM;
+                return -1;
+            }
+            t->ref[e] = r;
+        }
+        t->ref[e][t->n_ref[e]++] = (uint32_t)nearest(t_us, t->n_samples,
+                                                    when);
+    }
+    free(buf);
+    // In order, and once per sample.
+    for (size_t e = 0; e < t->n_electrodes; e++) {
+        if (t->n_ref[e] == 0) {
+            continue;
+        }
+        qsort(t->ref[e], t->n_ref[e], sizeof(uint32_t), compare_u32);
+        size_t k = 1;
+        for (size_t i = 1; i < t->n_ref[e]; i++) {
+            if (t->ref[e][i] != t->ref[e][k - 1]) {
+                t->ref[e][k++] = t->ref[e][i];
+            }
+        }
+        t->n_bad_labels += t->n_ref[e] - k;
+        t->n_ref[e] = k;
+    }
+    return 0;
+}
+
+int lick_sweep_load(struct lick_sweep_trace *t, size_t n_sensors) {
+    size_t len;
+    char *buf = read_file(t->path, &len);
+    if (buf == NULL) {
+        t->error = errno;
+        return -1;
+    }
+    size_t cap = 0;
+    uint64_t *t_us = NULL;
+    uint32_t t_first = 0;
+    uint32_t t_prev = 0;
+    char *p = buf;
+    while (*p) {
+        unsigned long values[MAX_VALUES];
+        if (*p == '#') {
+            parse_numbers(p, values, 0, &p);
+            continue;
+        }
+        size_t n = parse_numbers(p, values, MAX_VALUES, &p);
+        if (n < 3 || n % 2 == 0) {
+            continue;
+        }
+        size_t n_electrodes = (n - 1) / 2;
+        if (t->n_samples == 0) {
+            t->n_electrodes = n_electrodes;
+            t_first = t_prev = (uint32_t)values[0];
+        } else if (n_electrodes != t->n_electrodes) {
+            continue;
+        }
+        if (t->n_samples == cap) {
+            cap = cap ? 2 * cap : 65536;
+            uint64_t *u = realloc(t_us, cap * sizeof(*u));
+            if (u == NULL) {
+                goto out_of_memory;
+            }
+            t_us = u;
+            for (size_t e = 0; e < n_electrodes; e++) {
+                int16_t *d = realloc(t->delta[e], cap * sizeof(*d));
+                if (d == NULL) {
+                    goto out_of_memory;
+                }
+                t->delta[e] = d;
+            }
+        }
+        for (size_t e = 0; e < n_electrodes; e++) {
+            long filtered = (long)values[1 + e];
+            long baseline = (long)values[1 + n_electrodes + e];
+            t->delta[e][t->n_samples] = (int16_t)(baseline - filtered);
+        }
+        // Timestamps wrap around every ~71 min; unsigned arithmetic
+        // gives the interval from the previous sample.
+        uint32_t ts = (uint32_t)values[0];
+        t_us[t->n_samples] = t->n_samples ?
+            t_us[t->n_samples - 1] + (uint32_t)(ts - t_prev) : 0;
+        t_prev = ts;
+        t->n_samples++;
+    }
+    free(buf);
+    if (t->n_samples < 2) {
+        free(t_us);
+        t->error = EINVAL;
+        return -1;
+    }
+    t->period_ms = t_us[t->n_samples - 1] / 1000.0 / (t->n_samples - 1);
+    if (n_sensors == 0) {
+        n_sensors = t->n_electrodes > 12 ? 2 : 1;
+    }
+    if (t->labels && load_labels(t, t_us, t_first,
+                                 t->n_electrodes / n_sensors)) {
+        free(t_us);
+        t->error = errno;
+        return -1;
+    }
+    free(t_us);
+    return 0;
+
+out_of_memory:
+    free(buf);
+    free(t_us);
+    t->error = ENOMEM;
+    return -1;
+}
+
+void lick_sweep_free(struct lick_sweep_trace *t) {
+    for (size_t e = 0; e < LICK_SWEEP_MAX_ELECTRODES; e++) {
+        free(t->delta[e]);
+        free(t->ref[e]);
+        t->delta[e] = NULL;
+        t->ref[e] = NULL;
+        t->n_ref[e] = 0;
+    }
+}
+
+/* Replay */
+
+/* Settings and state of a chunk of settings, one lane each. Flags are
+ * 0 or -1 (all bits set), so that they can be used as masks.
+ */
+struct lanes {
+    int16_t tth[LANES];
+    int16_t rth[LANES];
+    int16_t tdbnc[LANES];
+    int16_t rdbnc[LANES];
+    int16_t min_ili[LANES];
+    int16_t min_contact[LANES];
+    int16_t touched[LANES];     // Flag
+    int16_t count[LANES];       // Samples past the threshold
+    int16_t pending[LANES];     // Flag: onset waiting for min_contact
+    int16_t contact[LANES];     // Samples since the pending onset
+    int16_t since[LANES];       // Samples since the last accepted onset
+    int16_t matched[LANES];     // Flag: this window has been matched
+    // Counts since the last BLOCK.
+    int16_t n_onsets[LANES];
+    int16_t n_matched[LANES];
+    int16_t latency[LANES];
+};
+
+static void add_counts(struct lanes *l, size_t n_lanes,
+                       const uint32_t *idx,
+                       struct lick_sweep_result *results, size_t stride) {
+    for (size_t j = 0; j < n_lanes; j++) {
+        struct lick_sweep_result *r = &results[idx[j] * stride];
+        r->n_onsets += (uint16_t)l->n_onsets[j];
+        r->n_matched += (uint16_t)l->n_matched[j];
+        r->latency_sum += l->latency[j];
+    }
+    memset(l->n_onsets, 0, sizeof(l->n_onsets));
+    memset(l->n_matched, 0, sizeof(l->n_matched));
+    memset(l->latency, 0, sizeof(l->latency));
+}
+
+/* Replay the `n_lanes` settings params[idx[j]], which share the same
+ * minimum contact, and add their counts to results[idx[j] * stride].
+ */
+static void replay_chunk(const int16_t *delta, size_t n,
+                         const uint32_t *ref, size_t n_ref,
+                         const struct lick_sweep_params *params,
+                         const uint32_t *idx, size_t n_lanes,
+                         uint32_t window,
+                         struct lick_sweep_result *results,
+                         size_t stride) {
+    struct lanes lanes;
+    struct lanes *l = &lanes;
+    memset(l, 0, sizeof(*l));
+    // Lanes past n_lanes are replayed too, but not counted; rounding up
+    // the number of lanes lets the loop be unrolled into whole SIMD
+    // registers.
+    const size_t n_loop = (n_lanes + 31) & ~(size_t)31;
+    for (size_t j = 0; j < n_lanes; j++) {
+        const struct lick_sweep_params *p = &params[idx[j]];
+        l->tth[j] = p->tth;
+        l->rth[j] = p->rth;
+        l->tdbnc[j] = p->tdbnc;
+        l->rdbnc[j] = p->rdbnc;
+        l->min_ili[j] = (int16_t)p->min_ili;
+        l->min_contact[j] = p->min_contact;
+        // No lick yet: out of every refractory period.
+        l->since[j] = LICK_SWEEP_MAX_ILI;
+        results[idx[j] * stride].n_reference = n_ref;
+    }
+    // Onsets are reported this many samples late, with the time of the
+    // start of their contact; the time after the last onset is set to
+    // this at every onset.
+    const int16_t delay = params[idx[0]].min_contact > 1 ?
+        (int16_t)(params[idx[0]].min_contact - 1) : 0;
+    // The reference onset whose window the current onset time is in.
+    size_t k = 0;
+    const int16_t ili_max = LICK_SWEEP_MAX_ILI;
+
+    for (size_t t = 0; t < n; t++) {
+        const int16_t d = delta[t];
+        int16_t in_window = 0;
+        int16_t lag = 0;
+        if (n_ref && t >= (size_t)delay) {
+            size_t u = t - (size_t)delay;
+            // Move to the next reference onset once it is nearer.
+            while (k + 1 < n_ref && u >= ref[k] &&
+                   u - ref[k] > (ref[k + 1] > u ? ref[k + 1] - u :
+                                 u - ref[k + 1])) {
+                k++;
+                memset(l->matched, 0, sizeof(l->matched));
+            }
+            int64_t dt = (int64_t)u - ref[k];
+            if (dt >= -(int64_t)window && dt <= (int64_t)window) {
+                in_window = -1;
+                lag = (int16_t)dt;
+            }
+        }
+
+        for (size_t j = 0; j < n_loop; j++) {
+            // The sensor's touch decision (see lick_tune.c).
+            int16_t touched = l->touched[j];
+            int16_t above = (int16_t)-(d > l->tth[j]);
+            int16_t below = (int16_t)-(d < l->rth[j]);
+            int16_t past = (touched & below) | (~touched & above);
+            int16_t count = (int16_t)((l->count[j] + 1) & past);
+            int16_t limit = (touched & l->rdbnc[j]) |
+                (~touched & l->tdbnc[j]);
+            int16_t change = (int16_t)-(count > limit);
+            int16_t onset = change & ~touched;
+            touched ^= change;
+            l->touched[j] = touched;
+            l->count[j] = count & ~change;
+
+            // The lick event filter (see lick_filter_step).
+            int16_t since = l->since[j];
+            since = (int16_t)(since < ili_max ? since + 1 : since);
+            onset &= (int16_t)-(since >= l->min_ili[j]);
+            int16_t pending = (l->pending[j] & touched) | onset;
+            int16_t contact = l->contact[j];
+            contact = (int16_t)(contact < ili_max ? contact + 1 : contact);
+            contact = (onset & 1) | (~onset & contact);
+            int16_t ready = pending &
+                (int16_t)-(contact >= l->min_contact[j]);
+            l->pending[j] = pending & ~ready;
+            l->contact[j] = contact;
+            l->since[j] = (ready & delay) | (~ready & since);
+
+            // Comparison with the reference.
+            int16_t hit = ready & in_window & ~l->matched[j];
+            l->matched[j] |= hit;
+            l->n_onsets[j] = (int16_t)(l->n_onsets[j] - ready);
+            l->n_matched[j] = (int16_t)(l->n_matched[j] - hit);
+            l->latency[j] = (int16_t)(l->latency[j] + (hit & lag));
+        }
+
+        if ((t + 1) % BLOCK == 0) {
+            add_counts(l, n_lanes, idx, results, stride);
+        }
+    }
+    add_counts(l, n_lanes, idx, results, stride);
+}
+
+static uint8_t min_contact(const struct lick_sweep_params *p) {
+    return p->min_contact > 1 ? p->min_contact : 1;
+}
+
+/* The settings in chunks: `order` is the index of every setting, sorted
+ * by minimum contact, and each chunk is a run of it of at most LANES
+ * with the same minimum contact. Returns the number of chunks, whose
+ * first entries in `order` are in `starts` (with one more at the end),
+ * or 0 if out of memory.
+ */
+static size_t make_chunks(const struct lick_sweep_params *params,
+                          size_t n_params, uint32_t **order,
+                          size_t **starts) {
+    *order = malloc((n_params ? n_params : 1) * sizeof(**order));
+    *starts = malloc((n_params + 1) * sizeof(**starts));
+    if (*order == NULL || *starts == NULL) {
+        free(*order);
+        free(*starts);
+        return 0;
+    }
+    // Counting sort, which keeps the order of the settings otherwise.
+    size_t first[257] = {0};
+    for (size_t i = 0; i < n_params; i++) {
+        first[min_contact(&params[i]) + 1]++;
+    }
+    for (size_t c = 1; c < 257; c++) {
+        first[c] += first[c - 1];
+    }
+    for (size_t i = 0; i < n_params; i++) {
+        (*order)[first[min_contact(&params[i])]++] = (uint32_t)i;
+    }
+    size_t n_chunks = 0;
+    for (size_t i = 0; i < n_params; i++) {
+        if (n_chunks == 0 || i - (*starts)[n_chunks - 1] == LANES ||
+            min_contact(&params[(*order)[i]]) !=
+            min_contact(&params[(*order)[i - 1]])) {
+            (*starts)[n_chunks++] = i;
+        }
+    }
+    (*starts)[n_chunks] = n_params;
+    return n_chunks;
+}
+
+void lick_sweep_electrode(const int16_t *delta, size_t n,
+                          const uint32_t *ref, size_t n_ref,
+                          const struct lick_sweep_params *params,
+                          size_t n_params, uint32_t window,
+                          struct lick_sweep_result *results) {
+    memset(results, 0, n_params * sizeof(*results));
+    uint32_t *order;
+    size_t *starts;
+    size_t n_chunks = make_chunks(params, n_params, &order, &starts);
+    for (size_t c = 0; c < n_chunks; c++) {
+        replay_chunk(delta, n, ref, n_ref, params, order + starts[c],
+                     starts[c + 1] - starts[c], window, results, 1);
+    }
+    free(order);
+    free(starts);
+}
+
+/* Work shared by the threads of lick_sweep_run. Tasks are taken in
+ * order from `next`; each is a trace (when loading) or a trace,
+ * electrode and chunk of settings (when replaying).
+ */
+struct pool {
+    struct lick_sweep_trace *traces;
+    size_t n_traces;
+    size_t n_sensors;
+    const struct lick_sweep_params *params;
+    size_t n_params;
+    uint32_t window;
+    const uint32_t *order;
+    const size_t *starts;
+    size_t n_chunks;
+    struct lick_sweep_result *results;
+    bool loading;
+    size_t n_tasks;
+    atomic_size_t next;
+};
+
+static void *worker(void *arg) {
+    struct pool *pool = arg;
+    size_t i;
+    while ((i = atomic_fetch_add(&pool->next, 1)) < pool->n_tasks) {
+        if (pool->loading) {
+            if (pool->traces[i].path && lick_sweep_load(&pool->traces[i], pool->n_sensors)) {
+                lick_sweep_free(&pool->traces[i]);
+            }
+            continue;
+        }
+        size_t c = i % pool->n_chunks;
+        size_t e = i / pool->n_chunks % LICK_SWEEP_MAX_ELECTRODES;
+        size_t s = i / pool->n_chunks / LICK_SWEEP_MAX_ELECTRODES;
+        const struct lick_sweep_trace *t = &pool->traces[s];
+        if (t->error || e >= t->n_electrodes) {
+            continue;
+        }
+        struct lick_sweep_result *r = &pool->results[
+            s * pool->n_params * LICK_SWEEP_MAX_ELECTRODES + e];
+        replay_chunk(t->delta[e], t->n_samples, t->ref[e], t->n_ref[e],
+                     pool->params, pool->order + pool->starts[c],
+                     pool->starts[c + 1] - pool->starts[c], pool->window,
+                     r, LICK_SWEEP_MAX_ELECTRODES);
+    }
+    return NULL;
+}
+
+/* Run all tasks in the pool with up to `n_threads` threads (including
+ * the calling one), as in lick_analysis.c.
+ */
+static void run_pool(struct pool *pool, unsigned n_threads) {
+    pthread_t *threads = NULL;
+    if (n_threads > 1) {
+        threads = malloc((n_threads - 1) * sizeof(*threads));
+        if (threads == NULL) {
+            n_threads = 1;
+        }
+    }
+    unsigned n_started = 0;
+    atomic_store(&pool->next, 0);
+    for (unsigned i = 0; i + 1 < n_threads; i++) {
+        if (pthread_create(&threads[n_started], NULL, worker, pool)) {
+            break;
+        }
+        n_started++;
+    }
+    worker(pool);
+    for (unsigned i = 0; i < n_started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+}
+
+int lick_sweep_run(struct lick_sweep_trace *traces, size_t n_traces,
+                   size_t n_sensors,
+                   const struct lick_sweep_params *params, size_t n_params,
+                   uint32_t window, unsigned n_threads,
+                   struct lick_sweep_result *results) {
+    memset(results, 0, n_traces * n_params * LICK_SWEEP_MAX_ELECTRODES *
+           sizeof(*results));
+    if (n_threads == 0) {
+        n_threads = 1;
+    }
+    uint32_t *order;
+    size_t *starts;
+    size_t n_chunks = make_chunks(params, n_params, &order, &starts);
+    if (n_chunks == 0 && n_params) {
+        return -1;
+    }
+    struct pool pool = {
+        .traces = traces,
+        .n_traces = n_traces,
+        .n_sensors = n_sensors,
+        .params = params,
+        .n_params = n_params,
+        .window = window,
+        .order = order,
+        .starts = starts,
+        .n_chunks = n_chunks,
+        .results = results,
+        .loading = true,
+        .n_tasks = n_traces
+    };
+    atomic_init(&pool.next, 0);
+    run_pool(&pool, n_threads);
+
+    // One task per chunk of settings on each electrode, so that even a
+    // single trace keeps every thread busy.
+    pool.loading = false;
+    pool.n_tasks = n_traces * LICK_SWEEP_MAX_ELECTRODES * n_chunks;
+    run_pool(&pool, n_threads);
+    free(order);
+    free(starts);
+    return 0;
+}
@@ -0,0 +1,133 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_sweep.h
+
+   Lick detection with many settings at once, replayed on recorded raw
+   data and compared with a reference labelling.
+
+   Each setting is a set of sensor thresholds and debounce values, whose
+   touch decision is replayed as in lick_tune.h, followed by the lick
+   event filter of the firmware (refractory period and minimum contact;
+   see common/lick_detect.h). The filter's burst criterion, which
+   couples the electrodes of a sample, is not part of this: every
+   electrode is replayed on its own.
+
+   The onsets of every setting are compared with reference onsets (e.g.
+   labelled by hand or from video): an onset within `window` samples of
+   a reference onset, and the first one to be, is matched to it, with a
+   latency of its time minus that of the reference; any other onset is a
+   false one, and the reference onsets left unmatched are missed. Each
+   sample belongs to the window of the nearest reference onset. Onsets
+   delayed by the minimum contact are compared at the time of their
+   contact, as the firmware timestamps them.
+
+   Settings are replayed in chunks of LICK_SWEEP_LANES that share the
+   minimum contact. All the state of a chunk is held in arrays of 16-bit
+   lanes updated without branches at every sample, which the compiler
+   turns into SIMD instructions. Traces are loaded, and then
+   electrodes and chunks replayed, by a pool of threads as in
+   lick_analysis.h.
+ */
+
+#ifndef LICK_SWEEP_H
+#define LICK_SWEEP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LICK_SWEEP_MAX_ELECTRODES 24
+#define LICK_SWEEP_LANES 256
+// Largest matching window, in samples.
+#define LICK_SWEEP_MAX_WINDOW 127
+// Largest refractory period, in samples.
+#define LICK_SWEEP_MAX_ILI 30000
+
+/* One setting. `min_ili` and `min_contact` are in samples, and are off
+ * if 0 (or 1 for min_contact).
+ */
+struct lick_sweep_params {
+    uint8_t tth;
+    uint8_t rth;
+    uint8_t tdbnc;
+    uint8_t rdbnc;
+    uint16_t min_ili;
+    uint8_t min_contact;
+};
+
+/* A recorded trace and its reference onsets. Set `path`, and `labels`
+ * to the file of reference onsets (or NULL), before loading.
+ */
+struct lick_sweep_trace {
+    const char *path;
+    const char *labels;
+    int error;                  // errno of a failed load, or 0
+    size_t n_samples;
+    size_t n_electrodes;
+    size_t n_bad_labels;        // Labels that could not be used
+    double period_ms;
+    int16_t *delta[LICK_SWEEP_MAX_ELECTRODES];
+    uint32_t *ref[LICK_SWEEP_MAX_ELECTRODES];
+    size_t n_ref[LICK_SWEEP_MAX_ELECTRODES];
+};
+
+/* How one setting did on one electrode. */
+struct lick_sweep_result {
+    uint64_t n_onsets;
+    uint64_t n_matched;
+    uint64_t n_reference;
+    int64_t latency_sum;        // Of the matched onsets, in samples
+};
+
+/* Load the trace in `t->path`, the output of lick_decode (timestamp in
+ * us, filtered values, then baseline values), and the reference onsets
+ * in `t->labels`, one per line as
+ *
+ *     <timestamp, us> <electrode>
+ *
+ * in time order, where the timestamp is on the clock of the trace and
+ * the electrode is its number or a label such as `B3` (electrode 3 of
+ * the second sensor, the electrodes being split evenly into `n_sensors`
+ * sensors; if 0, 1 for up to 12 electrodes, else 2). Each is placed at
+ * the nearest sample. `t` must be zeroed apart from `path` and
+ * `labels`. Returns 0, or -1 (with the reason in `t->error`).
+ */
+int lick_sweep_load(struct lick_sweep_trace *t, size_t n_sensors);
+
+void lick_sweep_free(struct lick_sweep_trace *t);
+
+/* Replay `n_params` settings on the delta of one electrode and compare
+ * them with its reference onsets (sample indices, in increasing
+ * order). `results` has one entry per setting.
+ */
+void lick_sweep_electrode(const int16_t *delta, size_t n,
+                          const uint32_t *ref, size_t n_ref,
+                          const struct lick_sweep_params *params,
+                          size_t n_params, uint32_t window,
+                          struct lick_sweep_result *results);
+
+/* Load `n_traces` traces and replay every setting on every electrode
+ * of each with `n_threads` threads. `results` has
+ * LICK_SWEEP_MAX_ELECTRODES entries per setting per trace:
+ * results[(trace * n_params + setting) * LICK_SWEEP_MAX_ELECTRODES +
+ * electrode]. Those of traces that failed to load are zeroed. Traces
+ * with `path` NULL are taken to be loaded already.
+ *
+ * Returns 0, or -1 if memory ran out.
+ */
+int lick_sweep_run(struct lick_sweep_trace *traces, size_t n_traces,
+                   size_t n_sensors,
+                   const struct lick_sweep_params *params, size_t n_params,
+                   uint32_t window, unsigned n_threads,
+                   struct lick_sweep_result *results);
+
+#endif
@@ -0,0 +1,335 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lick_tune.h"
+
+#define MS_PER_HOUR 3.6e6
+
+/* State of the touch decision of one electrode. */
+struct replay {
+    bool touched;
+    uint8_t count;  // Consecutive samples past the threshold
+};
+
+/* Advance the touch decision by one sample. Returns true at an onset. */
+static inline bool replay_step(struct replay *r, int16_t delta,
+                               const struct lick_tune_params *p) {
+    if (!r->touched) {
+        r->count = delta > p->tth ? r->count + 1 : 0;
+        if (r->count > p->tdbnc) {
+            r->touched = true;
+            r->count = 0;
+            return true;
+        }
+    } else {
+        r->count = delta < p->rth ? r->count + 1 : 0;
+        if (r->count > p->rdbnc) {
+            r->touched = false;
+            r->count = 0;
+        }
+    }
+    return false;
+}
+
+void lick_tune_noise_stats(const int16_t *delta, size_t n,
+                           struct lick_tune_noise *noise) {
+    double sum = 0;
+    double sum2 = 0;
+    int16_t max = INT16_MIN;
+    for (size_t i = 0; i < n; i++) {
+        sum += delta[i];
+        sum2 += (double)delta[i] * delta[i];
+        if (delta[i] > max) {
+            max = delta[i];
+        }
+    }
+    noise->mean = n ? sum / n : 0;
+    double var = n > 1 ? (sum2 - sum * noise->mean) / (n - 1) : 0;
+    noise->sd = var > 0 ? sqrt(var) : 0;
+    noise->max = max;
+}
+
+size_t lick_tune_find_touches(const int16_t *delta, size_t n,
+                              int16_t level_on, int16_t level_off,
+                              struct lick_tune_touches *touches) {
+    size_t n_touches = 0;
+    size_t start = 0;
+    bool above_off = false;
+    bool above_on = false;
+    // One step past the end closes a touch that lasts to the end.
+    for (size_t i = 0; i <= n; i++) {
+        if (i < n && delta[i] > level_off) {
+            if (!above_off) {
+                start = i;
+                above_off = true;
+            }
+            if (delta[i] > level_on) {
+                above_on = true;
+            }
+            continue;
+        }
+        if (above_on) {
+            if (n_touches < touches->max) {
+                touches->start[n_touches] = (uint32_t)start;
+                touches->end[n_touches] = (uint32_t)i;
+            }
+            n_touches++;
+        }
+        above_off = above_on = false;
+    }
+    touches->n = n_touches < touches->max ? n_touches : touches->max;
+    return n_touches;
+}
+
+size_t lick_tune_onsets(const int16_t *delta, size_t n,
+                        const struct lick_tune_params *p,
+                        uint32_t *onsets, size_t max_onsets) {
+    struct replay r = {0};
+    size_t n_onsets = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (replay_step(&r, delta[i], p)) {
+            if (n_onsets < max_onsets) {
+                onsets[n_onsets] = (uint32_t)i;
+            }
+            n_onsets++;
+        }
+    }
+    return n_onsets;
+}
+
+/* Rate of false onsets per sample predicted for Gaussian noise: the
+ * probability that a run of tdbnc + 1 samples above the threshold
+ * starts at any given sample. Deltas are integers, so "above tth"
+ * means at least tth + 1.
+ */
+static double model_false_rate(const struct lick_tune_noise *stats,
+                               const struct lick_tune_params *p) {
+    double q;
+    if (stats->sd > 0) {
+        q = 0.5 * erfc((p->tth + 0.5 - stats->mean) /
+                       (stats->sd * sqrt(2.0)));
+    } else {
+        q = stats->mean > p->tth ? 1 : 0;
+    }
+    return (1 - q) * pow(q, p->tdbnc + 1);
+}
+
+void lick_tune_score(const int16_t *noise, size_t n_noise,
+                     const int16_t *touch, size_t n_touch,
+                     const struct lick_tune_touches *touches,
+                     const struct lick_tune_noise *stats,
+                     double period_ms, const struct lick_tune_params *p,
+                     struct lick_tune_score *score) {
+    memset(score, 0, sizeof(*score));
+    score->n_touches = touches->n;
+
+    // There can be no onsets if the threshold is above the noise.
+    size_t n_false = 0;
+    if (stats->max > p->tth) {
+        n_false = lick_tune_onsets(noise, n_noise, p, NULL, 0);
+    }
+
+    // In the recording with touches, the first onset during a touch
+    // detects it. The time that the debounce takes is allowed for at
+    // both ends, as the touch may have started a little earlier than
+    // found (with a low threshold) and the onset comes that much later
+    // than the threshold is crossed. Any other onset is a false one.
+    struct replay r = {0};
+    size_t k = 0;
+    bool detected = false;
+    double latency_sum = 0;
+    for (size_t i = 0; i < n_touch; i++) {
+        while (k < touches->n && i >= touches->end[k] + p->tdbnc + 1u) {
+            k++;
+            detected = false;
+        }
+        if (!replay_step(&r, touch[i], p)) {
+            continue;
+        }
+        if (k < touches->n && !detected &&
+            i + p->tdbnc + 1 >= touches->start[k]) {
+            detected = true;
+            score->n_detected++;
+            if (i > touches->start[k]) {
+                latency_sum += (double)(i - touches->start[k]);
+            }
+        } else {
+            n_false++;
+        }
+    }
+
+    score->n_false = n_false;
+    if (score->n_detected) {
+        score->latency_ms = latency_sum / score->n_detected * period_ms;
+    }
+    double hours = (double)(n_noise + n_touch) * period_ms / MS_PER_HOUR;
+    double seen = hours > 0 ? n_false / hours : 0;
+    double model = model_false_rate(stats, p) * MS_PER_HOUR / period_ms;
+    score->false_per_hour = seen > model ? seen : model;
+}
+
+static int compare_int16(const void *a, const void *b) {
+    return *(const int16_t *)a - *(const int16_t *)b;
+}
+
+/* Is setting `a` (with score `sa`) better than `b`? See
+ * lick_tune_electrode for the order.
+ */
+static bool is_better(const struct lick_tune_params *a,
+                      const struct lick_tune_score *sa,
+                      const struct lick_tune_params *b,
+                      const struct lick_tune_score *sb, double mid) {
+    if (sa->latency_ms != sb->latency_ms) {
+        return sa->latency_ms < sb->latency_ms;
+    }
+    if (a->tth != b->tth) {
+        return fabs(a->tth - mid) < fabs(b->tth - mid);
+    }
+    return a->rth < b->rth;
+}
+
+/* When no setting is acceptable: is `a` better than `b`? Settings with
+ * few enough false onsets come first, and among them those that detect
+ * the most touches; otherwise, those with the fewest false onsets.
+ */
+static bool is_better_fallback(const struct lick_tune_params *a,
+                               const struct lick_tune_score *sa,
+                               const struct lick_tune_params *b,
+                               const struct lick_tune_score *sb,
+                               const struct lick_tune_criteria *criteria,
+                               double mid) {
+    bool a_ok = sa->false_per_hour <= criteria->max_false_per_hour;
+    bool b_ok = sb->false_per_hour <= criteria->max_false_per_hour;
+    if (a_ok != b_ok) {
+        return a_ok;
+    }
+    if (!a_ok && sa->false_per_hour != sb->false_per_hour) {
+        return sa->false_per_hour < sb->false_per_hour;
+    }
+    if (sa->n_detected != sb->n_detected) {
+        return sa->n_detected > sb->n_detected;
+    }
+    return is_better(a, sa, b, sb, mid);
+}
+
+int lick_tune_electrode(const int16_t *noise, size_t n_noise,
+                        const int16_t *touch, size_t n_touch,
+                        double period_ms, uint8_t tdbnc, uint8_t rdbnc,
+                        const struct lick_tune_criteria *criteria,
+                        struct lick_tune_params *best,
+                        struct lick_tune_score *score) {
+    struct lick_tune_noise stats;
+    lick_tune_noise_stats(noise, n_noise, &stats);
+
+    // Range of the delta during touches.
+    int16_t *sorted = malloc(n_touch * sizeof(*sorted));
+    if (sorted == NULL || n_touch == 0) {
+        free(sorted);
+        return -1;
+    }
+    memcpy(sorted, touch, n_touch * sizeof(*sorted));
+    qsort(sorted, n_touch, sizeof(*sorted), compare_int16);
+    double peak = sorted[n_touch * 99 / 100];
+    free(sorted);
+    double range = peak - stats.mean;
+    if (range < 4 * stats.sd || range < 2) {
+        return -1;
+    }
+
+    struct lick_tune_touches touches;
+    touches.max = n_touch / 2 + 1;
+    touches.start = malloc(touches.max * sizeof(uint32_t));
+    touches.end = malloc(touches.max * sizeof(uint32_t));
+    if (touches.start == NULL || touches.end == NULL) {
+        free(touches.start);
+        free(touches.end);
+        return -1;
+    }
+    lick_tune_find_touches(touch, n_touch,
+                           (int16_t)lround(stats.mean + range / 2),
+                           (int16_t)lround(stats.mean + range / 4),
+                           &touches);
+    if (touches.n == 0) {
+        free(touches.start);
+        free(touches.end);
+        return -1;
+    }
+
+    // Touch thresholds from just above the mean noise to the peak, and
+    // for each a few release thresholds between 1/4 and 7/8 of it.
+    int tth_min = stats.mean > 0 ? (int)stats.mean + 1 : 1;
+    int tth_max = peak < 255 ? (int)peak : 255;
+    double mid = stats.mean + range / 2;
+    int found = 0;
+    bool have_fallback = false;
+    struct lick_tune_params fallback = {0};
+    struct lick_tune_score fallback_score = {0};
+
+    for (int tth = tth_min; tth <= tth_max; tth++) {
+        int last_rth = -1;
+        for (int eighths = 2; eighths <= 7; eighths++) {
+            int rth = tth * eighths / 8;
+            if (rth >= tth) {
+                rth = tth - 1;
+            }
+            if (rth == last_rth) {
+                continue;
+            }
+            last_rth = rth;
+
+            struct lick_tune_params p = {(uint8_t)tth, (uint8_t)rth,
+                                         tdbnc, rdbnc};
+            // Many settings have too many false onsets from the noise
+            // statistics alone. Only the highest threshold, which has
+            // the fewest, is still needed in case nothing is
+            // acceptable.
+            double model = model_false_rate(&stats, &p) * MS_PER_HOUR /
+                period_ms;
+            if (model > criteria->max_false_per_hour && tth != tth_max) {
+                continue;
+            }
+            struct lick_tune_score s;
+            lick_tune_score(noise, n_noise, touch, n_touch, &touches,
+                            &stats, period_ms, &p, &s);
+
+            bool ok = s.false_per_hour <= criteria->max_false_per_hour &&
+                s.n_detected >= criteria->min_detected * s.n_touches;
+            if (ok) {
+                if (!found || is_better(&p, &s, best, score, mid)) {
+                    *best = p;
+                    *score = s;
+                    found = 1;
+                }
+            } else if (!found) {
+                if (!have_fallback || is_better_fallback(&p, &s,
+                        &fallback, &fallback_score, criteria, mid)) {
+                    fallback = p;
+                    fallback_score = s;
+                    have_fallback = true;
+                }
+            }
+        }
+    }
+    free(touches.start);
+    free(touches.end);
+
+    if (!found) {
+        *best = fallback;
+        *score = fallback_score;
+    }
+    return found;
+}
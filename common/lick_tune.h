@@ -0,0 +1,147 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_tune.h
+
+   Choice of touch thresholds and debounce from recorded traces.
+
+   The MPR121 decides that an electrode is touched when its delta (the
+   baseline minus the filtered value) is greater than the touch
+   threshold (TTH) for TDBNC + 1 samples in a row, and released when it
+   is lower than the release threshold (RTH) for RDBNC + 1 samples in a
+   row. Given the delta of an electrode recorded with the raw data
+   output of the firmware, this decision can be replayed with any
+   thresholds and debounce values, so that they can be chosen on the
+   host and the choice repeated exactly on the same recordings.
+
+   Two recordings are used for each electrode: one in which it is not
+   touched, from which the rate of false onsets is estimated, and one
+   with touches, from which the detection latency is measured. The
+   touches in the second recording are found from the delta itself,
+   without any thresholds from the sensor (see lick_tune_find_touches).
+
+   The baseline tracking settings (MHD, NHD, NCL, FDL) are not part of
+   this: they change the baseline, which is recorded as it was computed
+   by the sensor and cannot be recomputed on the host.
+ */
+
+#ifndef LICK_TUNE_H
+#define LICK_TUNE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Largest debounce value accepted by the MPR121.
+#define LICK_TUNE_MAX_DEBOUNCE 7
+
+struct lick_tune_params {
+    uint8_t tth;
+    uint8_t rth;
+    uint8_t tdbnc;
+    uint8_t rdbnc;
+};
+
+/* Delta statistics of an untouched electrode. */
+struct lick_tune_noise {
+    double mean;
+    double sd;
+    int16_t max;
+};
+
+/* Touches in a recording, as [start, end) sample indices. */
+struct lick_tune_touches {
+    size_t n;
+    size_t max;
+    uint32_t *start;
+    uint32_t *end;
+};
+
+/* Selection criteria. A setting is acceptable if its expected rate of
+ * false onsets is not above `max_false_per_hour` and it detects at
+ * least `min_detected` (0 to 1) of the touches.
+ */
+struct lick_tune_criteria {
+    double max_false_per_hour;
+    double min_detected;
+};
+
+/* How a setting performed on the recordings. */
+struct lick_tune_score {
+    double false_per_hour;   // Expected rate of false onsets
+    double latency_ms;       // Mean delay from touch to onset
+    size_t n_false;          // False onsets seen in both recordings
+    size_t n_detected;
+    size_t n_touches;
+};
+
+/* Mean, standard deviation and maximum of `delta`. */
+void lick_tune_noise_stats(const int16_t *delta, size_t n,
+                           struct lick_tune_noise *noise);
+
+/* Find the touches in `delta`. A touch is a stretch of samples in which
+ * delta is above `level_off` and, at some point, above `level_on`.
+ * Returns the number of touches found (only the first touches->max are
+ * stored).
+ */
+size_t lick_tune_find_touches(const int16_t *delta, size_t n,
+                              int16_t level_on, int16_t level_off,
+                              struct lick_tune_touches *touches);
+
+/* Replay the sensor's touch decision on `delta` with the given settings
+ * and store the sample index of each onset in `onsets`. Returns the
+ * number of onsets (only the first `max_onsets` are stored).
+ */
+size_t lick_tune_onsets(const int16_t *delta, size_t n,
+                        const struct lick_tune_params *p,
+                        uint32_t *onsets, size_t max_onsets);
+
+/* Score a setting on a recording without touches (`noise`) and one with
+ * the given touches (`touch`), both sampled every `period_ms`.
+ *
+ * The expected false onset rate is the larger of the rate seen in the
+ * recordings and the rate predicted from the noise statistics assuming
+ * that the noise is Gaussian and independent from sample to sample;
+ * the latter is what tells apart settings that no recording of a
+ * reasonable length would show any false onsets with.
+ */
+void lick_tune_score(const int16_t *noise, size_t n_noise,
+                     const int16_t *touch, size_t n_touch,
+                     const struct lick_tune_touches *touches,
+                     const struct lick_tune_noise *stats,
+                     double period_ms, const struct lick_tune_params *p,
+                     struct lick_tune_score *score);
+
+/* Search for the touch and release thresholds of one electrode with
+ * the given debounce values.
+ *
+ * Touches are those parts of `touch` where the delta rises above half
+ * of its range (from the mean of `noise` to its 99th percentile), from
+ * where it rises above a quarter of that range. Among the
+ * acceptable settings, the one with the lowest latency is chosen, then
+ * the one with the touch threshold closest to half the range, which
+ * leaves the largest margin both over the noise and under the touches,
+ * and then the one with the lowest release threshold, which is the
+ * least likely to release in mid-touch.
+ *
+ * Returns 1 if an acceptable setting was found, 0 if not (in which case
+ * the setting that detects the most touches with few enough false
+ * onsets, or else the one with the fewest false onsets, is returned),
+ * or -1 if there are no touches in `touch`.
+ */
+int lick_tune_electrode(const int16_t *noise, size_t n_noise,
+                        const int16_t *touch, size_t n_touch,
+                        double period_ms, uint8_t tdbnc, uint8_t rdbnc,
+                        const struct lick_tune_criteria *criteria,
+                        struct lick_tune_params *best,
+                        struct lick_tune_score *score);
+
+#endif
@@ -0,0 +1,188 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_bench.h
+
+   Cycle counts of code running on the Pico, and the jitter of the
+   sampling times.
+
+   The SysTick timer is set to count down at the CPU clock rate, which
+   works on both the RP2040 (Cortex-M0+, which has no cycle counter) and
+   the RP2350. Being 24-bit, it wraps every ~134 ms at 125 MHz, which is
+   much longer than anything measured here. Each core has its own
+   SysTick, so it is started on the core that runs the code measured.
+   The statistics may be updated on one core and reported from the
+   other, so both take a lock (a few cycles when not contended) to copy
+   them.
+ */
+
+#ifndef LICK_BENCH_H
+#define LICK_BENCH_H
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "pico/critical_section.h"
+#include "hardware/structs/systick.h"
+
+#define LICK_BENCH_MASK 0x00ffffff
+
+struct lick_bench {
+    const char *name;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t n;
+    critical_section_t lock;
+};
+
+static inline void lick_bench_init(struct lick_bench *b,
+        const char *name) {
+    b->name = name;
+    b->min = UINT32_MAX;
+    b->max = 0;
+    b->sum = 0;
+    b->n = 0;
+    critical_section_init(&b->lock);
+}
+
+/* Start the SysTick of the calling core. */
+static inline void lick_bench_clock_init(void) {
+    // Processor clock, no interrupt, enabled.
+    systick_hw->rvr = LICK_BENCH_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5;
+}
+
+static inline uint32_t lick_bench_start(void) {
+    return systick_hw->cvr;
+}
+
+/* Add the cycles elapsed since `start` to the statistics. */
+static inline void lick_bench_stop(struct lick_bench *b, uint32_t start) {
+    // SysTick counts down.
+    uint32_t cycles = (start - systick_hw->cvr) & LICK_BENCH_MASK;
+    critical_section_enter_blocking(&b->lock);
+    if (cycles < b->min) b->min = cycles;
+    if (cycles > b->max) b->max = cycles;
+    b->sum += cycles;
+    b->n++;
+    critical_section_exit(&b->lock);
+}
+
+/* Print and reset the statistics. Lines start with `#` so that host
+ * tools can tell them apart from data.
+ */
+static inline void lick_bench_report(struct lick_bench *b) {
+    critical_section_enter_blocking(&b->lock);
+    struct lick_bench copy = *b;
+    b->min = UINT32_MAX;
+    b->max = 0;
+    b->sum = 0;
+    b->n = 0;
+    critical_section_exit(&b->lock);
+
+    if (copy.n == 0) {
+        return;
+    }
+    printf("# bench %s cycles min %lu mean %lu max %lu n %lu\n",
+           copy.name, (unsigned long)copy.min,
+           (unsigned long)(copy.sum / copy.n), (unsigned long)copy.max,
+           (unsigned long)copy.n);
+}
+
+/* Jitter of the sampling times
+ *
+ * Every sample has a deadline on a fixed grid (see lick_sampler.h; with
+ * the repeating timer, the grid starts at the first sample). Its
+ * lateness is the time from the deadline until the sample starts, and
+ * its period error is the change in lateness from the previous sample:
+ * how far the time between their starts was from the time between
+ * their deadlines. A deadline is missed if it was skipped, or if its
+ * sample started after the next deadline had passed (the repeating
+ * timer then takes the late samples back to back).
+ *
+ * Period errors are counted in bins of powers of 2 of us: bin 0 is
+ * under 1 us, bin k from 2^(k-1) to 2^k us, and the last bin anything
+ * longer (from 16 ms on). Unlike the cycle counts, these statistics are
+ * kept from the start, so the last report gives the whole recording.
+ */
+#define LICK_JITTER_BINS 16
+
+struct lick_jitter {
+    const char *name;
+    uint32_t interval_us;       // Nominal interval between deadlines
+    uint64_t last_deadline_us;
+    int32_t last_late_us;
+    int32_t late_max_us;
+    uint32_t error_max_us;
+    uint32_t n;                 // Samples
+    uint32_t missed;            // Deadlines missed
+    uint32_t hist[LICK_JITTER_BINS];
+    critical_section_t lock;
+};
+
+static inline void lick_jitter_init(struct lick_jitter *j,
+        const char *name, uint32_t interval_us) {
+    *j = (struct lick_jitter){.name = name, .interval_us = interval_us};
+    critical_section_init(&j->lock);
+}
+
+/* Add a sample that started at `start_us`, whose deadline was
+ * `deadline_us`. Call first thing in the sample.
+ */
+static inline void lick_jitter_step(struct lick_jitter *j,
+        uint64_t deadline_us, uint64_t start_us) {
+    int32_t late = (int32_t)(start_us - deadline_us);
+    critical_section_enter_blocking(&j->lock);
+    if (j->n > 0) {
+        // Deadlines skipped since the last sample (with the sync lock,
+        // intervals are within 10% of the nominal one).
+        uint32_t gap = (uint32_t)(deadline_us - j->last_deadline_us);
+        j->missed += (gap + j->interval_us / 2) / j->interval_us - 1;
+        int32_t diff = late - j->last_late_us;
+        uint32_t error = (uint32_t)(diff < 0 ? -diff : diff);
+        uint8_t k = 0;
+        while (k < LICK_JITTER_BINS - 1 && error >= (1u << k)) {
+            k++;
+        }
+        j->hist[k]++;
+        if (error > j->error_max_us) j->error_max_us = error;
+    }
+    if (late >= (int32_t)j->interval_us) j->missed++;
+    if (late > j->late_max_us) j->late_max_us = late;
+    j->last_deadline_us = deadline_us;
+    j->last_late_us = late;
+    j->n++;
+    critical_section_exit(&j->lock);
+}
+
+/* Print the statistics, as a line starting with `#`. */
+static inline void lick_jitter_report(struct lick_jitter *j) {
+    critical_section_enter_blocking(&j->lock);
+    struct lick_jitter copy = *j;
+    critical_section_exit(&j->lock);
+
+    if (copy.n == 0) {
+        return;
+    }
+    printf("# jitter %s interval_us %lu n %lu missed %lu late_max_us %ld "
+           "error_max_us %lu hist", copy.name,
+           (unsigned long)copy.interval_us, (unsigned long)copy.n,
+           (unsigned long)copy.missed, (long)copy.late_max_us,
+           (unsigned long)copy.error_max_us);
+    for (uint8_t k = 0; k < LICK_JITTER_BINS; k++) {
+        printf(" %lu", (unsigned long)copy.hist[k]);
+    }
+    printf("\n");
+}
+
+#endif
@@ -0,0 +1,113 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+
+#include "lick_command.h"
+
+#if LICK_PRINT_FROM_SAMPLE
+static volatile bool describe_pending = false;
+#endif
+
+/* With adaptive sampling, lines end with the interval of each sensor. */
+static inline void interval_columns(void) {
+#if LICK_ADAPTIVE
+    for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+        printf(",interval%c", 'A' + i);
+    }
+#endif
+}
+
+static void describe(void) {
+    printf("# device lick-sensor variant %s version %s sensors %u "
+           "electrodes %u interval_us %lu", LICK_VARIANT_NAME,
+           LICK_FIRMWARE_VERSION, LICK_N_SENSORS, LICK_N_ELECTRODES,
+           (unsigned long)LICK_SAMPLING_INTERVAL_MS * 1000);
+#if LICK_SINK_USB
+    // The same names as in the header of the csv files saved by the
+    // lick events readers.
+    printf(" format events columns idx,timestamp");
+    for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+        printf(",sensor%c", 'A' + i);
+    }
+    interval_columns();
+#elif LICK_SINK_EDGES
+    printf(" format edges columns idx,timestamp");
+    for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+        printf(",onset%c,offset%c", 'A' + i, 'A' + i);
+    }
+    interval_columns();
+#elif LICK_SINK_SUMMARY
+    printf(" format summary bin_ms %lu bout_gap_ms %lu hist %u "
+           "hist_width_ms %lu", (unsigned long)LICK_SUMMARY_BIN_MS,
+           (unsigned long)LICK_SUMMARY_BOUT_GAP_MS, LICK_SUMMARY_HIST_LEN,
+           (unsigned long)LICK_SUMMARY_HIST_WIDTH_MS);
+#elif LICK_SINK_RAW
+    printf(" format raw channels %u block_len %u transport %s",
+           2 * LICK_N_SENSORS * LICK_N_ELECTRODES, LICK_RAW_BLOCK_LEN,
+           LICK_RAW_USB_VENDOR ? "usb-vendor" : "serial");
+#else
+    printf(" format none");
+#endif
+#if LICK_SNIPPET
+    printf(" snippet_pre %u snippet_post %u", LICK_SNIPPET_PRE,
+           LICK_SNIPPET_POST);
+#endif
+#if LICK_ACTION
+    printf(" action_pin %u", LICK_ACTION_PIN);
+#endif
+#if LICK_ADAPTIVE
+    printf(" idle_interval_us %lu", (unsigned long)LICK_SAMPLING_INTERVAL_MS
+           * LICK_ADAPTIVE_IDLE_SAMPLES * 1000);
+#endif
+    printf("\n");
+}
+
+void lick_command_init(void) {
+#if LICK_ACTION
+    gpio_init(LICK_ACTION_PIN);
+    gpio_set_dir(LICK_ACTION_PIN, GPIO_OUT);
+    gpio_put(LICK_ACTION_PIN, 0);
+#endif
+}
+
+void lick_command_poll(void) {
+    int c;
+    while ((c = getchar_timeout_us(0)) >= 0) {
+        switch (c) {
+            case LICK_CMD_DESCRIBE:
+#if LICK_PRINT_FROM_SAMPLE
+                describe_pending = true;
+#else
+                describe();
+#endif
+                break;
+#if LICK_ACTION
+            case LICK_CMD_TOGGLE:
+                gpio_xor_mask(1u << LICK_ACTION_PIN);
+                break;
+#endif
+            default:
+                break;
+        }
+    }
+}
+
+#if LICK_PRINT_FROM_SAMPLE
+void lick_command_report(void) {
+    if (describe_pending) {
+        describe_pending = false;
+        describe();
+    }
+}
+#endif
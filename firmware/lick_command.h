@@ -0,0 +1,79 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_command.h
+
+   Commands from the host computer.
+
+   Commands are single characters sent to the serial port, so that they
+   need no parsing and can be acted on as soon as they arrive:
+
+     ?   describe the device: reply with one line
+
+           # device lick-sensor variant <name> version <version>
+             sensors <n> electrodes <n> interval_us <us> format <format>
+             ...
+
+         (all in one line), where <format> is what is sent over USB:
+         - `events`, followed by `columns <names>`: one lick event per
+           line, with the values named in <names> (comma-separated);
+         - `raw`, followed by `channels <n> block_len <n> transport
+           <serial|usb-vendor>`: compressed raw data blocks (see
+           common/lick_codec.h);
+         - `edges`, followed by `columns <names>`: the onsets and
+           offsets of touch of variants with GPIO outputs (see
+           lick_edges.h);
+         - `summary`, followed by `bin_ms <ms> bout_gap_ms <ms> hist
+           <n> hist_width_ms <ms>`: a summary of licking every <bin_ms>
+           (see common/lick_summary.h and firmware/README.md);
+         - `none`: nothing (variants with GPIO outputs only).
+
+         With waveform snippets (see lick_snippet.h), `snippet_pre <n>
+         snippet_post <n>` follow, with LICK_ACTION_PIN, `action_pin
+         <pin>`, and with adaptive sampling (see lick_adaptive.h),
+         `idle_interval_us <us>` at the end; `interval_us` is then the
+         fast interval, and the events and edges have a column per
+         sensor with the interval in effect.
+
+     !   toggle LICK_ACTION_PIN (if set), with no reply. This is done
+         as soon as the command is read, so that the host can react to
+         lick events with as little delay as possible.
+
+   Other characters are ignored. The serial port is read from the main
+   loop. Replies are printed from the same place as the rest of the
+   text the variant sends, so that they are not mixed with it: with
+   lick events sampled on core 0, from the sample (see
+   lick_command_report); otherwise, from the main loop.
+ */
+
+#ifndef LICK_COMMAND_H
+#define LICK_COMMAND_H
+
+#include "lick_config.h"
+
+#define LICK_CMD_DESCRIBE '?'
+#define LICK_CMD_TOGGLE '!'
+
+/* Set up the pins driven by commands. */
+void lick_command_init(void);
+
+/* Read and act on the commands received. Call from the main loop. */
+void lick_command_poll(void);
+
+#if LICK_PRINT_FROM_SAMPLE
+/* Print the replies to the commands received since the last call. Call
+ * from the sample, after its lick events.
+ */
+void lick_command_report(void);
+#endif
+
+#endif
@@ -0,0 +1,505 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_config.h
+
+   Build-time configuration of the lick sensor firmware.
+
+   Each variant of the lick sensor has a `lick_variant.h` file in its own
+   directory (e.g. bottle-x1-bnc-out/lick_variant.h) that sets the number
+   of sensors and electrodes, and where lick data is sent to. The build
+   picks up that file for each variant; anything that a variant does not
+   set takes the default value defined here.
+ */
+
+#ifndef LICK_CONFIG_H
+#define LICK_CONFIG_H
+
+#include "lick_variant.h"
+
+#ifndef LICK_VARIANT_NAME
+#error "lick_variant.h must define LICK_VARIANT_NAME"
+#endif
+
+/* Firmware version, reported to the host (see lick_command.h). Set by
+ * the build from LICK_FIRMWARE_VERSION in CMakeLists.txt.
+ */
+#ifndef LICK_FIRMWARE_VERSION
+#define LICK_FIRMWARE_VERSION "unknown"
+#endif
+
+/* Touch sensors
+ * Number of MPR121 sensors (1 or 2), their I2C addresses, and the
+ * number of electrodes enabled in each (1 to 12).
+ */
+#ifndef LICK_N_SENSORS
+#define LICK_N_SENSORS 1
+#endif
+
+#ifndef LICK_SENSOR_ADDRESSES
+#if LICK_N_SENSORS == 1
+#define LICK_SENSOR_ADDRESSES {0x5A}
+#else
+#define LICK_SENSOR_ADDRESSES {0x5A, 0x5B}
+#endif
+#endif
+
+#ifndef LICK_N_ELECTRODES
+#define LICK_N_ELECTRODES 12
+#endif
+
+/* Touch sensor I2C definitions
+ * All sensors share the same I2C port and pins.
+ */
+#ifndef MPR121_I2C_PORT
+#define MPR121_I2C_PORT i2c0
+#endif
+#ifndef MPR121_I2C_PIN_SDA
+#define MPR121_I2C_PIN_SDA 20
+#endif
+#ifndef MPR121_I2C_PIN_SCL
+#define MPR121_I2C_PIN_SCL 21
+#endif
+#ifndef MPR121_I2C_FREQ
+#define MPR121_I2C_FREQ 400000
+#endif
+
+/* Sensor health
+ * LICK_I2C_TIMEOUT_US: time after which an I2C transaction with a
+ *   sensor is abandoned (reading the touch status takes ~150 us at
+ *   400 kHz).
+ * LICK_I2C_MAX_ERRORS: number of failed reads in a row after which a
+ *   sensor is considered to have failed and is reinitialised.
+ * LICK_REINIT_INTERVAL_MS: time between attempts to reinitialise a
+ *   failed sensor.
+ */
+#ifndef LICK_I2C_TIMEOUT_US
+#define LICK_I2C_TIMEOUT_US 1000
+#endif
+#ifndef LICK_I2C_MAX_ERRORS
+#define LICK_I2C_MAX_ERRORS 3
+#endif
+#ifndef LICK_REINIT_INTERVAL_MS
+#define LICK_REINIT_INTERVAL_MS 1000
+#endif
+
+/* Touch sensor settings
+ * Applied to every sensor. See the MPR121 datasheet and
+ * utils/test-sensor-settings for what these do.
+ */
+// Thresholds (touch, release). Default: 15, 10
+#ifndef LICK_SETTING_TTH
+#define LICK_SETTING_TTH 15
+#endif
+#ifndef LICK_SETTING_RTH
+#define LICK_SETTING_RTH 10
+#endif
+// Max half delta (rising, falling). Range 1~63. Default: 1, 1
+#ifndef LICK_SETTING_MHDR
+#define LICK_SETTING_MHDR 1
+#endif
+#ifndef LICK_SETTING_MHDF
+#define LICK_SETTING_MHDF 1
+#endif
+// Noise half delta (rising, falling, touched). Range 1~63.
+// Default: 1, 1, 1
+#ifndef LICK_SETTING_NHDR
+#define LICK_SETTING_NHDR 1
+#endif
+#ifndef LICK_SETTING_NHDF
+#define LICK_SETTING_NHDF 1
+#endif
+#ifndef LICK_SETTING_NHDT
+#define LICK_SETTING_NHDT 1
+#endif
+// Noise count limit (rising, falling, touched). Range 0~255.
+// Default: 0, 255, 0
+#ifndef LICK_SETTING_NCLR
+#define LICK_SETTING_NCLR 0
+#endif
+#ifndef LICK_SETTING_NCLF
+#define LICK_SETTING_NCLF 0
+#endif
+#ifndef LICK_SETTING_NCLT
+#define LICK_SETTING_NCLT 0
+#endif
+// Filter delay limit (rising, falling, touched). Range 0~255.
+// Default: 0, 2, 0
+#ifndef LICK_SETTING_FDLR
+#define LICK_SETTING_FDLR 0
+#endif
+#ifndef LICK_SETTING_FDLF
+#define LICK_SETTING_FDLF 0
+#endif
+#ifndef LICK_SETTING_FDLT
+#define LICK_SETTING_FDLT 0
+#endif
+// Debounce (touch, release). Range 0~7. Default: 0, 0
+#ifndef LICK_SETTING_TDBNC
+#define LICK_SETTING_TDBNC 0
+#endif
+#ifndef LICK_SETTING_RDBNC
+#define LICK_SETTING_RDBNC 0
+#endif
+
+/* Per-electrode thresholds
+ * Optional. If LICK_ELECTRODE_TTH and LICK_ELECTRODE_RTH are defined,
+ * they give the touch and release thresholds of each electrode of each
+ * sensor, e.g. {{12, 14}, {13, 12}} for two sensors of two electrodes,
+ * in place of LICK_SETTING_TTH and LICK_SETTING_RTH. host/tools/lick_tune
+ * chooses these (and the debounce) from recordings of the electrodes.
+ */
+
+/* Sampling interval
+ * Mice lick at up to ~10 Hz so 50 Hz is enough to detect every lick.
+ */
+#ifndef LICK_SAMPLING_INTERVAL_MS
+#define LICK_SAMPLING_INTERVAL_MS 20
+#endif
+
+/* Sampling core
+ * LICK_SAMPLING_CORE1: if 1, the sensors are sampled on core 1, from a
+ *   hardware alarm set to the deadline of every sample, and everything
+ *   is printed by the main loop on core 0 (see lick_sampler.h), so that
+ *   neither USB nor printing delays the samples; this works with every
+ *   output. If 0 (default), they are sampled from a repeating timer on
+ *   core 0.
+ * LICK_EVENTS_QUEUE_LEN: with LICK_SAMPLING_CORE1 and LICK_SINK_USB,
+ *   samples with lick events that can wait to be printed (a power of
+ *   2; see lick_events.h).
+ */
+#ifndef LICK_SAMPLING_CORE1
+#define LICK_SAMPLING_CORE1 0
+#endif
+#ifndef LICK_EVENTS_QUEUE_LEN
+#define LICK_EVENTS_QUEUE_LEN 64
+#endif
+
+/* Adaptive sampling
+ * Optional, to time onsets finely during bouts without reading idle
+ * sensors that often (see lick_adaptive.h and firmware/README.md).
+ * LICK_ADAPTIVE_IDLE_SAMPLES: if over 1, a sensor is read at every
+ *   sample only while it is active, and every this many samples while
+ *   it is idle. Set LICK_SAMPLING_INTERVAL_MS to the fast interval,
+ *   e.g. 2 ms with 10 idle samples for 500 Hz while licking and 50 Hz
+ *   otherwise. The sensors then sample their electrodes at the largest
+ *   power of 2 of ms up to the sampling interval, so that their touch
+ *   status keeps up (their debounce counts these samples).
+ * LICK_ADAPTIVE_HOLD_MS: a sensor stays active this long after any of
+ *   its electrodes was last touched, which should be longer than the
+ *   pauses between licks in a bout.
+ * LICK_ADAPTIVE_WAKE_DELTA: if not 0, idle reads also read the
+ *   filtered and baseline values of the sensor (~1 ms of the bus), and
+ *   the sensor becomes active when the delta of any electrode reaches
+ *   this, e.g. half the touch threshold.
+ */
+#ifndef LICK_ADAPTIVE_IDLE_SAMPLES
+#define LICK_ADAPTIVE_IDLE_SAMPLES 1
+#endif
+#ifndef LICK_ADAPTIVE_HOLD_MS
+#define LICK_ADAPTIVE_HOLD_MS 1000
+#endif
+#ifndef LICK_ADAPTIVE_WAKE_DELTA
+#define LICK_ADAPTIVE_WAKE_DELTA 0
+#endif
+#define LICK_ADAPTIVE (LICK_ADAPTIVE_IDLE_SAMPLES > 1)
+// The same in samples, rounded up.
+#define LICK_ADAPTIVE_HOLD ((LICK_ADAPTIVE_HOLD_MS + \
+    LICK_SAMPLING_INTERVAL_MS - 1) / LICK_SAMPLING_INTERVAL_MS)
+
+/* Lick event filtering
+ * Optional rejection of onsets that are unlikely to be licks, applied
+ * to the lick events sent over USB, or to the licks counted in the
+ * summaries (the GPIO outputs still show every contact). See
+ * common/lick_detect.h. Each is off if 0.
+ * LICK_FILTER_MIN_ILI_MS: onsets on an electrode less than this after
+ *   its last accepted lick are rejected. Mice lick at up to ~10 Hz, so
+ *   e.g. 60 ms rejects only bounces of the contact.
+ * LICK_FILTER_MAX_SIMULTANEOUS: if more onsets than this start in the
+ *   same sample (e.g. the animal climbed on the spouts), all of them are
+ *   rejected.
+ * LICK_FILTER_MIN_CONTACT_MS: contacts shorter than this are rejected.
+ *   Licks are then sent this much later, with the time of their onset.
+ * LICK_FILTER_REPORT_MS: how often the counts of rejected onsets are
+ *   printed, if they have changed.
+ */
+#ifndef LICK_FILTER_MIN_ILI_MS
+#define LICK_FILTER_MIN_ILI_MS 0
+#endif
+#ifndef LICK_FILTER_MAX_SIMULTANEOUS
+#define LICK_FILTER_MAX_SIMULTANEOUS 0
+#endif
+#ifndef LICK_FILTER_MIN_CONTACT_MS
+#define LICK_FILTER_MIN_CONTACT_MS 0
+#endif
+#ifndef LICK_FILTER_REPORT_MS
+#define LICK_FILTER_REPORT_MS 60000
+#endif
+#define LICK_FILTER (LICK_FILTER_MIN_ILI_MS || \
+                     LICK_FILTER_MAX_SIMULTANEOUS || \
+                     LICK_FILTER_MIN_CONTACT_MS)
+// The same in samples, rounded up.
+#define LICK_FILTER_MIN_ILI ((LICK_FILTER_MIN_ILI_MS + \
+    LICK_SAMPLING_INTERVAL_MS - 1) / LICK_SAMPLING_INTERVAL_MS)
+#define LICK_FILTER_MIN_CONTACT ((LICK_FILTER_MIN_CONTACT_MS + \
+    LICK_SAMPLING_INTERVAL_MS - 1) / LICK_SAMPLING_INTERVAL_MS)
+
+/* Lick waveform snippets
+ * LICK_SNIPPET_PRE, LICK_SNIPPET_POST: with lick events, print for every
+ *   onset the filtered values of its electrode from LICK_SNIPPET_PRE
+ *   samples before the onset to LICK_SNIPPET_POST samples after it (see
+ *   lick_snippet.h), so that real contacts can be told apart from
+ *   artifacts offline. Both 0 (default): off. The filtered and baseline
+ *   values of every electrode are then read at every sample, which
+ *   takes an extra I2C read per sensor.
+ */
+#ifndef LICK_SNIPPET_PRE
+#define LICK_SNIPPET_PRE 0
+#endif
+#ifndef LICK_SNIPPET_POST
+#define LICK_SNIPPET_POST 0
+#endif
+#define LICK_SNIPPET (LICK_SNIPPET_PRE || LICK_SNIPPET_POST)
+
+/* Synchronisation
+ * Optional, to align the samples with other recordings (e.g.
+ * electrophysiology or video). See firmware/README.md.
+ * LICK_SYNC_IN_PIN: GPIO with a TTL sync input; its rising edges are
+ *   used as set by LICK_SYNC_IN_MODE:
+ *   - LICK_SYNC_STAMP (default): the time of every edge is printed to
+ *     serial (requires LICK_SINK_USB).
+ *   - LICK_SYNC_LOCK: the sampling clock follows the input, which must
+ *     have a period of LICK_SYNC_IN_SAMPLES sampling intervals (e.g. 50
+ *     for 1 Hz pulses when sampling at 50 Hz), so that a sample is taken
+ *     at every edge. Edges are printed as well with LICK_SINK_USB.
+ * LICK_SYNC_OUT_PIN: GPIO on which a pulse, one sampling interval long,
+ *   starts at every LICK_SYNC_OUT_SAMPLES-th sample (default 50, i.e.
+ *   every second at 50 Hz). Its time is printed to serial with
+ *   LICK_SINK_USB.
+ */
+#define LICK_SYNC_STAMP 0
+#define LICK_SYNC_LOCK 1
+
+#ifdef LICK_SYNC_IN_PIN
+#define LICK_SYNC_IN 1
+#else
+#define LICK_SYNC_IN 0
+#endif
+#ifndef LICK_SYNC_IN_MODE
+#define LICK_SYNC_IN_MODE LICK_SYNC_STAMP
+#endif
+#ifndef LICK_SYNC_IN_SAMPLES
+#define LICK_SYNC_IN_SAMPLES 50
+#endif
+#ifdef LICK_SYNC_OUT_PIN
+#define LICK_SYNC_OUT 1
+#else
+#define LICK_SYNC_OUT 0
+#endif
+#ifndef LICK_SYNC_OUT_SAMPLES
+#define LICK_SYNC_OUT_SAMPLES 50
+#endif
+#define LICK_SYNC (LICK_SYNC_IN || LICK_SYNC_OUT)
+#define LICK_SYNC_IN_LOCK (LICK_SYNC_IN && \
+                           LICK_SYNC_IN_MODE == LICK_SYNC_LOCK)
+
+/* Host actions
+ * LICK_ACTION_PIN: GPIO that the host computer toggles with the `!`
+ *   command (see lick_command.h), e.g. to open a reward valve or start
+ *   a stimulus when a given bottle is licked. It starts low. To measure
+ *   the latency from lick events to the action, connect it to
+ *   LICK_SYNC_IN_PIN (see firmware/README.md).
+ */
+#ifdef LICK_ACTION_PIN
+#define LICK_ACTION 1
+#else
+#define LICK_ACTION 0
+#endif
+
+/* Outputs
+ * LICK_SINK_GPIO: electrode status is written to the GPIO pins listed
+ *   in LICK_GPIO_OUT_PINS (electrode 0 of the first sensor to the first
+ *   pin, etc.), e.g. to BNC connectors.
+ * LICK_SINK_USB: lick events are printed to serial (USB) as the event
+ *   count, the timestamp in ms, and one number per sensor with the
+ *   electrodes where a lick started.
+ * LICK_SINK_EDGES: with LICK_SINK_GPIO, the onsets and offsets of touch
+ *   are also printed to serial (USB), for a timestamped log of the GPIO
+ *   outputs (see lick_edges.h). They are printed by the main loop, so
+ *   the timing of the GPIO outputs does not change.
+ * LICK_EDGES_QUEUE_LEN: with LICK_SINK_EDGES, samples with edges that
+ *   can wait to be printed (a power of 2). At 50 Hz, 64 is over a
+ *   second of touch changing at every sample.
+ * LICK_SINK_SUMMARY: instead of lick events, a summary of every
+ *   electrode is printed to serial (USB) every LICK_SUMMARY_BIN_MS: its
+ *   licks, time in contact and bouts started (see lick_summary.h and
+ *   firmware/README.md), for recordings that last weeks.
+ * LICK_SUMMARY_BOUT_GAP_MS: with LICK_SINK_SUMMARY, a lick at least
+ *   this long after the previous one on the same electrode starts a
+ *   bout.
+ * LICK_SUMMARY_HIST_LEN, LICK_SUMMARY_HIST_WIDTH_MS: with
+ *   LICK_SINK_SUMMARY, the intervals between licks within bouts are
+ *   also counted, for every electrode, in a histogram of this many bins
+ *   (up to 16; 0, the default, for none) this wide each.
+ * LICK_SINK_RAW: instead of lick events, the filtered and baseline
+ *   values of every electrode are sent to serial as compressed binary
+ *   blocks of LICK_RAW_BLOCK_LEN samples (see common/lick_codec.h).
+ *   The block header has 16 bits for the sampling interval in us, so
+ *   the interval can be no longer than 65 ms.
+ * LICK_RAW_USB_VENDOR: with LICK_SINK_RAW, send the blocks on a bulk
+ *   endpoint of a vendor-class USB interface instead (see lick_usb.h).
+ *   The serial port is kept for text. The build looks for this setting
+ *   in lick_variant.h, so it must be set there as a plain
+ *   `#define LICK_RAW_USB_VENDOR 1`.
+ * LICK_USB_VID, LICK_USB_PID: USB vendor and product IDs of the device
+ *   with LICK_RAW_USB_VENDOR. The product ID is not an allocated one;
+ *   change it if it clashes with another device in the lab.
+ */
+#ifndef LICK_SINK_GPIO
+#define LICK_SINK_GPIO 0
+#endif
+#ifndef LICK_SINK_USB
+#define LICK_SINK_USB 0
+#endif
+#ifndef LICK_SINK_EDGES
+#define LICK_SINK_EDGES 0
+#endif
+#ifndef LICK_EDGES_QUEUE_LEN
+#define LICK_EDGES_QUEUE_LEN 64
+#endif
+#ifndef LICK_SINK_SUMMARY
+#define LICK_SINK_SUMMARY 0
+#endif
+#ifndef LICK_SUMMARY_BIN_MS
+#define LICK_SUMMARY_BIN_MS 60000
+#endif
+#ifndef LICK_SUMMARY_BOUT_GAP_MS
+#define LICK_SUMMARY_BOUT_GAP_MS 1000
+#endif
+#ifndef LICK_SUMMARY_HIST_LEN
+#define LICK_SUMMARY_HIST_LEN 0
+#endif
+#ifndef LICK_SUMMARY_HIST_WIDTH_MS
+#define LICK_SUMMARY_HIST_WIDTH_MS (2 * LICK_SAMPLING_INTERVAL_MS)
+#endif
+// The same in samples.
+#define LICK_SUMMARY_BIN (LICK_SUMMARY_BIN_MS / LICK_SAMPLING_INTERVAL_MS)
+#define LICK_SUMMARY_BOUT_GAP ((LICK_SUMMARY_BOUT_GAP_MS + \
+    LICK_SAMPLING_INTERVAL_MS - 1) / LICK_SAMPLING_INTERVAL_MS)
+#define LICK_SUMMARY_HIST_WIDTH (LICK_SUMMARY_HIST_WIDTH_MS / \
+    LICK_SAMPLING_INTERVAL_MS)
+#ifndef LICK_SINK_RAW
+#define LICK_SINK_RAW 0
+#endif
+#ifndef LICK_RAW_BLOCK_LEN
+#define LICK_RAW_BLOCK_LEN 50
+#endif
+#ifndef LICK_RAW_USB_VENDOR
+#define LICK_RAW_USB_VENDOR 0
+#endif
+#ifndef LICK_USB_VID
+#define LICK_USB_VID 0x2E8A
+#endif
+#ifndef LICK_USB_PID
+#define LICK_USB_PID 0x4C4B
+#endif
+// Lick events, and what is printed with them, are printed by the sample
+// itself rather than by the main loop.
+#define LICK_PRINT_FROM_SAMPLE (LICK_SINK_USB && !LICK_SAMPLING_CORE1)
+
+/* Benchmark
+ * When set (cmake -DLICK_BENCHMARK=ON), the duration of every sample is
+ * measured in CPU cycles, and a summary of it and of the jitter of the
+ * sampling times is printed to serial once per second (see
+ * lick_bench.h).
+ */
+#ifndef LICK_BENCHMARK
+#define LICK_BENCHMARK 0
+#endif
+
+/* Sanity checks */
+#if LICK_N_SENSORS < 1 || LICK_N_SENSORS > 2
+#error "LICK_N_SENSORS must be 1 or 2"
+#endif
+#if LICK_N_ELECTRODES < 1 || LICK_N_ELECTRODES > 12
+#error "LICK_N_ELECTRODES must be between 1 and 12"
+#endif
+#if LICK_SINK_GPIO && !defined(LICK_GPIO_OUT_PINS)
+#error "LICK_SINK_GPIO requires LICK_GPIO_OUT_PINS"
+#endif
+#if defined(LICK_ELECTRODE_TTH) != defined(LICK_ELECTRODE_RTH)
+#error "LICK_ELECTRODE_TTH and LICK_ELECTRODE_RTH must be set together"
+#endif
+#if LICK_SINK_USB && LICK_SINK_RAW
+#error "LICK_SINK_USB and LICK_SINK_RAW both use serial; choose one"
+#endif
+#if LICK_SINK_EDGES && (!LICK_SINK_GPIO || LICK_SINK_USB || LICK_SINK_RAW)
+#error "LICK_SINK_EDGES requires LICK_SINK_GPIO, without USB or raw output"
+#endif
+#if LICK_SINK_SUMMARY && (LICK_SINK_USB || LICK_SINK_RAW || LICK_SINK_EDGES)
+#error "LICK_SINK_SUMMARY cannot be used with USB, raw or edges output"
+#endif
+#if LICK_SUMMARY_BIN < 1 || \
+    LICK_SUMMARY_BIN_MS % LICK_SAMPLING_INTERVAL_MS
+#error "LICK_SUMMARY_BIN_MS must be a multiple of the sampling interval"
+#endif
+#if LICK_SUMMARY_HIST_LEN > 16
+#error "LICK_SUMMARY_HIST_LEN must be 16 or less"
+#endif
+#if LICK_SUMMARY_HIST_WIDTH < 1 || \
+    LICK_SUMMARY_HIST_WIDTH_MS % LICK_SAMPLING_INTERVAL_MS
+#error "LICK_SUMMARY_HIST_WIDTH_MS must be a multiple of the interval"
+#endif
+#if LICK_SUMMARY_BOUT_GAP < 1
+#error "LICK_SUMMARY_BOUT_GAP_MS must be at least one sampling interval"
+#endif
+#if LICK_EDGES_QUEUE_LEN & (LICK_EDGES_QUEUE_LEN - 1)
+#error "LICK_EDGES_QUEUE_LEN must be a power of 2"
+#endif
+#if LICK_SINK_RAW && LICK_SAMPLING_INTERVAL_MS > 65
+#error "LICK_SINK_RAW requires LICK_SAMPLING_INTERVAL_MS of 65 or less"
+#endif
+#if LICK_RAW_USB_VENDOR && !LICK_SINK_RAW
+#error "LICK_RAW_USB_VENDOR sends raw data and requires LICK_SINK_RAW"
+#endif
+#if LICK_FILTER && !(LICK_SINK_USB || LICK_SINK_SUMMARY)
+#error "LICK_FILTER_* require LICK_SINK_USB or LICK_SINK_SUMMARY"
+#endif
+#if LICK_FILTER_MIN_CONTACT > 255
+#error "LICK_FILTER_MIN_CONTACT_MS is too long"
+#endif
+#if LICK_SYNC_IN && LICK_SYNC_IN_MODE == LICK_SYNC_STAMP && !LICK_SINK_USB
+#error "LICK_SYNC_STAMP prints the sync edges and requires LICK_SINK_USB"
+#endif
+#if LICK_SNIPPET && !LICK_SINK_USB
+#error "LICK_SNIPPET_* print lick events and require LICK_SINK_USB"
+#endif
+#if LICK_SNIPPET_PRE + LICK_SNIPPET_POST + LICK_FILTER_MIN_CONTACT > 63
+#error "LICK_SNIPPET_PRE + LICK_SNIPPET_POST is too long"
+#endif
+#if LICK_ADAPTIVE && (LICK_SINK_RAW || LICK_SNIPPET)
+#error "LICK_ADAPTIVE_* cannot be used with raw data or snippets"
+#endif
+#if LICK_ADAPTIVE_WAKE_DELTA && !LICK_ADAPTIVE
+#error "LICK_ADAPTIVE_WAKE_DELTA requires LICK_ADAPTIVE_IDLE_SAMPLES > 1"
+#endif
+#if LICK_ACTION && LICK_SYNC_IN && LICK_ACTION_PIN == LICK_SYNC_IN_PIN
+#error "LICK_ACTION_PIN and LICK_SYNC_IN_PIN must be different pins"
+#endif
+#if LICK_EVENTS_QUEUE_LEN & (LICK_EVENTS_QUEUE_LEN - 1)
+#error "LICK_EVENTS_QUEUE_LEN must be a power of 2"
+#endif
+#if LICK_SYNC_IN_SAMPLES < 1 || LICK_SYNC_OUT_SAMPLES < 2
+#error "LICK_SYNC_IN_SAMPLES must be >= 1 and LICK_SYNC_OUT_SAMPLES >= 2"
+#endif
+
+#endif
@@ -0,0 +1,102 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include "hardware/sync.h"
+
+#include "lick_edges.h"
+#if LICK_ADAPTIVE
+#include "lick_adaptive.h"
+#endif
+
+#if LICK_SINK_EDGES
+
+struct edges {
+    uint32_t count;
+    uint32_t timestamp_ms;
+    uint16_t onset[LICK_N_SENSORS];
+    uint16_t offset[LICK_N_SENSORS];
+#if LICK_ADAPTIVE
+    uint8_t fast;
+#endif
+};
+
+volatile uint32_t lick_edges_dropped = 0;
+static uint32_t dropped_reported = 0;
+
+/* The sample is the only writer of `head` and the main loop the only
+ * writer of `tail`, so an entry is complete once `head` has moved past
+ * it. The fences keep this so when they run on different cores
+ * (LICK_SAMPLING_CORE1, see lick_sampler.h).
+ */
+static struct edges queue[LICK_EDGES_QUEUE_LEN];
+static volatile uint32_t head = 0;
+static volatile uint32_t tail = 0;
+static uint32_t n_edges = 0;
+
+void lick_edges_push(const struct lick_sample *s) {
+    uint16_t any = 0;
+    for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+        any |= s->onset[i] | s->offset[i];
+    }
+    if (!any) {
+        return;
+    }
+    if (head - tail == LICK_EDGES_QUEUE_LEN) {
+        lick_edges_dropped++;
+        n_edges++;
+        return;
+    }
+    __mem_fence_acquire();
+    struct edges *e = &queue[head % LICK_EDGES_QUEUE_LEN];
+    e->count = n_edges++;
+    e->timestamp_ms = s->timestamp_ms;
+    for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+        e->onset[i] = s->onset[i];
+        e->offset[i] = s->offset[i];
+    }
+#if LICK_ADAPTIVE
+    e->fast = s->fast;
+#endif
+    __mem_fence_release();
+    head = head + 1;
+}
+
+void lick_edges_task(void) {
+    while (tail != head) {
+        __mem_fence_acquire();
+        const struct edges *e = &queue[tail % LICK_EDGES_QUEUE_LEN];
+        printf("%lu %lu", (unsigned long)e->count,
+               (unsigned long)e->timestamp_ms);
+        for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+            printf(" %u %u", e->onset[i], e->offset[i]);
+        }
+#if LICK_ADAPTIVE
+        for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+            printf(" %lu", (unsigned long)lick_adaptive_interval(e->fast,
+                i, LICK_ADAPTIVE_IDLE_SAMPLES) * LICK_SAMPLING_INTERVAL_MS *
+                1000);
+        }
+#endif
+        printf("\n");
+        // Only now can the sample reuse the entry.
+        __mem_fence_release();
+        tail = tail + 1;
+    }
+    uint32_t dropped = lick_edges_dropped;
+    if (dropped != dropped_reported) {
+        printf("# edges dropped %lu\n", (unsigned long)dropped);
+        dropped_reported = dropped;
+    }
+}
+
+#endif
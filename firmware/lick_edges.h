@@ -0,0 +1,65 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_edges.h
+
+   Onsets and offsets of touch, sent over USB by the variants that write
+   the touch status to GPIO pins (LICK_SINK_EDGES), for a timestamped
+   log of what the GPIO outputs show.
+
+   The sample only copies its edges into a queue, after the GPIO outputs
+   have been written. The main loop formats and prints them. Sending
+   text over USB takes a variable time, and it is never done in the
+   sample, so it does not delay the GPIO outputs of this sample or of
+   later ones, whether the sensors are sampled on core 0 or core 1 (see
+   lick_sampler.h).
+
+   One line is printed for every sample in which touch started or ended
+   in any electrode:
+
+     <event count> <timestamp, ms> <onset A> <offset A> [<onset B>
+       <offset B>]
+
+   (all in one line), where each onset and offset is a mask of the
+   electrodes of one sensor, as in the lick events of the USB variants.
+   With adaptive sampling, the interval in us at which each sensor was
+   being read follows (see lick_adaptive.h).
+   The event count increases by one with every sample with edges. If
+   the queue is full (e.g. no host is reading), the samples are dropped,
+   which shows as a gap in the count, and the total dropped so far is
+   printed as `# edges dropped <count>`.
+ */
+
+#ifndef LICK_EDGES_H
+#define LICK_EDGES_H
+
+#include "pico/stdlib.h"
+
+#include "lick_config.h"
+#include "lick_detect.h"
+
+#if LICK_SINK_EDGES
+
+/* Samples that could not be queued because the queue was full */
+extern volatile uint32_t lick_edges_dropped;
+
+/* Queue the onsets and offsets of `s` if there are any. Call from the
+ * sample, after lick_detect_step.
+ */
+void lick_edges_push(const struct lick_sample *s);
+
+/* Print the queued edges. Call from the main loop. */
+void lick_edges_task(void);
+
+#endif
+
+#endif
@@ -0,0 +1,88 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include "hardware/sync.h"
+
+#include "lick_events.h"
+#if LICK_ADAPTIVE
+#include "lick_adaptive.h"
+#endif
+
+#if LICK_SINK_USB
+
+void lick_events_print(uint32_t count, const struct lick_sample *s) {
+    printf("%lu %lu", (unsigned long)count,
+           (unsigned long)s->timestamp_ms);
+    for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+        printf(" %u", s->onset[i]);
+    }
+#if LICK_ADAPTIVE
+    for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+        printf(" %lu", (unsigned long)lick_adaptive_interval(s->fast, i,
+            LICK_ADAPTIVE_IDLE_SAMPLES) * LICK_SAMPLING_INTERVAL_MS * 1000);
+    }
+#endif
+    printf("\n");
+}
+
+#if LICK_SAMPLING_CORE1
+
+struct event {
+    uint32_t count;
+    struct lick_sample sample;
+};
+
+volatile uint32_t lick_events_dropped = 0;
+static uint32_t dropped_reported = 0;
+
+/* The sample, on core 1, is the only writer of `head`, and the main
+ * loop, on core 0, the only writer of `tail`. The fences make an entry
+ * visible to the other core before `head` moves past it, and keep it
+ * from being reused until it has been printed.
+ */
+static struct event queue[LICK_EVENTS_QUEUE_LEN];
+static volatile uint32_t head = 0;
+static volatile uint32_t tail = 0;
+
+void lick_events_push(uint32_t count, const struct lick_sample *s) {
+    if (head - tail == LICK_EVENTS_QUEUE_LEN) {
+        lick_events_dropped++;
+        return;
+    }
+    __mem_fence_acquire();
+    struct event *e = &queue[head % LICK_EVENTS_QUEUE_LEN];
+    e->count = count;
+    e->sample = *s;
+    __mem_fence_release();
+    head = head + 1;
+}
+
+void lick_events_task(void) {
+    while (tail != head) {
+        __mem_fence_acquire();
+        const struct event *e = &queue[tail % LICK_EVENTS_QUEUE_LEN];
+        lick_events_print(e->count, &e->sample);
+        // Only now can the sample reuse the entry.
+        __mem_fence_release();
+        tail = tail + 1;
+    }
+    uint32_t dropped = lick_events_dropped;
+    if (dropped != dropped_reported) {
+        printf("# events dropped %lu\n", (unsigned long)dropped);
+        dropped_reported = dropped;
+    }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,63 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_events.h
+
+   Lick events of the variants with USB output (LICK_SINK_USB).
+
+   One line is printed for every sample in which a lick started in any
+   electrode (see firmware/README.md):
+
+     <event count> <timestamp, ms> <sensor A> [<sensor B>]
+
+   followed, with adaptive sampling, by the interval in us at which each
+   sensor was being read (see lick_adaptive.h).
+
+   Sampled on core 0, the lines are printed by the sample itself. When
+   the sensors are sampled on core 1 (LICK_SAMPLING_CORE1, see
+   lick_sampler.h), the sample only copies the event into a queue and
+   the main loop on core 0 prints it, as with lick_edges.h, so that
+   sending text over USB never delays a sample. If the queue is full
+   (e.g. no host is reading), the events are dropped, which shows as a
+   gap in the event count, and the total dropped so far is printed as
+   `# events dropped <count>`.
+ */
+
+#ifndef LICK_EVENTS_H
+#define LICK_EVENTS_H
+
+#include "pico/stdlib.h"
+
+#include "lick_config.h"
+#include "lick_detect.h"
+
+#if LICK_SINK_USB
+
+/* Print the lick event of `s`, with event count `count`. */
+void lick_events_print(uint32_t count, const struct lick_sample *s);
+
+#if LICK_SAMPLING_CORE1
+/* Events that could not be queued because the queue was full */
+extern volatile uint32_t lick_events_dropped;
+
+/* Queue the lick event of `s`, with event count `count`. Call from the
+ * sample, when it has onsets.
+ */
+void lick_events_push(uint32_t count, const struct lick_sample *s);
+
+/* Print the queued events. Call from the main loop. */
+void lick_events_task(void);
+#endif
+
+#endif
+
+#endif
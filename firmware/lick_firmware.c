@@ -0,0 +1,693 @@
+/* Copyright (c) 2024-2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_firmware.c
+
+   Firmware for all variants of the lick sensor.
+
+   The touch sensors are read at regular intervals. Depending on the
+   variant, the touch status of each electrode is written to GPIO pins
+   (e.g. to BNC connectors) and/or lick events are detected and printed
+   to serial (USB) for a host computer to log. Variants with GPIO
+   outputs can also log the onsets and offsets of touch over USB, from
+   the main loop (see lick_edges.h). For long recordings, summaries of
+   licking over bins of time can be sent instead of every lick event
+   (see lick_summary.h).
+
+   The health of the sensors is checked at every sample (see
+   lick_sensor.h). Changes are reported in-band: as lines starting with
+   `# health` among the lick events, or as flags in the headers of raw
+   data blocks.
+
+   Raw data can also be sent on a separate, vendor-class USB interface
+   instead of the serial port (see lick_usb.h).
+
+   Host tools ask the firmware what it sends, and can toggle an output
+   pin in reaction to lick events, through single-character commands on
+   the serial port (see lick_command.h).
+
+   Optionally, the samples are aligned with other recordings through a
+   sync input and output (see lick_sync.h), and the waveform of every
+   electrode around each lick onset is sent with the lick events (see
+   lick_snippet.h). Sensors can also be read at a fast rate only while
+   they are being licked, and at a slower one while idle (see
+   lick_adaptive.h).
+
+   The sensors are sampled from a repeating timer on core 0 or, with
+   LICK_SAMPLING_CORE1, from a hardware alarm on core 1, which does
+   nothing else (see lick_sampler.h); core 0 then prints everything
+   from its main loop.
+
+   What each variant does is set at build time in its `lick_variant.h`
+   file (see lick_config.h). Outputs that a variant does not use are
+   not compiled in, so the sample of each variant only has the code
+   that it needs.
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+
+#include "lick_config.h"
+#include "lick_sensor.h"
+#include "lick_detect.h"
+#include "lick_command.h"
+#if LICK_SYNC
+#include "lick_sync.h"
+#endif
+#if LICK_SNIPPET
+#include "lick_snippet.h"
+#endif
+#include "pico/critical_section.h"
+#include "hardware/sync.h"
+#if LICK_SAMPLING_CORE1
+#include "pico/multicore.h"
+#include "lick_sampler.h"
+#endif
+#if LICK_SINK_USB
+#include "lick_events.h"
+#endif
+#if LICK_SINK_EDGES
+#include "lick_edges.h"
+#endif
+#if LICK_SINK_SUMMARY
+#include "lick_summary.h"
+#endif
+#if LICK_ADAPTIVE
+#include "lick_adaptive.h"
+#endif
+#if LICK_SINK_RAW
+#include "lick_codec.h"
+#endif
+#if LICK_RAW_USB_VENDOR
+#include "lick_usb.h"
+#endif
+#if LICK_BENCHMARK
+#include "lick_bench.h"
+#endif
+
+#define LED_PIN PICO_DEFAULT_LED_PIN
+
+/* Detection state */
+struct lick_detect detect;
+
+/* Sensors read at every sample, with adaptive sampling */
+#if LICK_ADAPTIVE
+struct lick_adaptive adaptive;
+#endif
+
+/* Lick event filter
+ * Rejected onsets are counted, and the counts printed every
+ * LICK_FILTER_REPORT_MS if they have changed.
+ */
+#if LICK_FILTER
+struct lick_filter filter;
+uint32_t filter_reported = 0;
+absolute_time_t next_filter_report;
+// Accepted onsets are this much late when contacts must last
+// LICK_FILTER_MIN_CONTACT samples.
+#define FILTER_DELAY_MS (LICK_FILTER_MIN_CONTACT > 1 ? \
+    (LICK_FILTER_MIN_CONTACT - 1) * LICK_SAMPLING_INTERVAL_MS : 0)
+#else
+#define FILTER_DELAY_MS 0
+#endif
+
+/* GPIO outputs
+ * Touch (lick) data is written to these pins. Connect them to the data
+ * acquisition system to record licking.
+ */
+#if LICK_SINK_GPIO
+static const uint8_t gpio_out_pins[] = LICK_GPIO_OUT_PINS;
+#define N_GPIO_OUT (sizeof(gpio_out_pins) / sizeof(gpio_out_pins[0]))
+uint32_t gpio_out_mask;
+#endif
+
+/* Variants whose main loop prints everything else (edges and
+ * summaries, or all text when sampling on core 1) have their health
+ * events, and the counts of rejected onsets, reported from there too.
+ * The lock is needed when the sample runs on the other core.
+ */
+#define PRINT_FROM_LOOP ((LICK_SINK_EDGES || LICK_SINK_SUMMARY || \
+                          LICK_SAMPLING_CORE1) && !LICK_SINK_RAW)
+#if PRINT_FROM_LOOP
+volatile uint8_t health_pending = 0;
+critical_section_t health_lock;
+static void health_report(uint8_t mask);
+#if LICK_FILTER
+static void filter_report(void);
+#endif
+#endif
+
+/* Lick summaries
+ * As the raw data buffers, two bins are filled in turn: when the
+ * samples have filled one, the main loop prints it while they fill the
+ * other.
+ */
+#if LICK_SINK_SUMMARY
+struct lick_summary summary;
+struct lick_summary_bin summary_bins[2];
+uint8_t summary_buf = 0;
+uint32_t summary_count = 0;
+volatile int8_t summary_ready = -1;
+static void summary_print(const struct lick_summary_bin *b);
+#endif
+
+/* Raw data
+ * Two sample buffers are used in turn: while the samples fill one of
+ * them, the main loop compresses and sends the other. On the
+ * vendor USB interface, the compressed blocks are double-buffered too,
+ * so that one can be encoded while the other is still being sent.
+ */
+#if LICK_SINK_RAW
+#define RAW_N_CHANNELS (2 * LICK_N_SENSORS * LICK_N_ELECTRODES)
+uint16_t raw_frames[2][LICK_RAW_BLOCK_LEN][RAW_N_CHANNELS];
+uint32_t raw_t0_us[2];
+uint8_t raw_flags[2];
+uint8_t raw_buf = 0;
+uint8_t raw_count = 0;
+uint16_t raw_seq = 0;
+volatile int8_t raw_ready = -1;
+#define RAW_OUT_SIZE LICK_CODEC_MAX_BLOCK_SIZE(RAW_N_CHANNELS, \
+                                               LICK_RAW_BLOCK_LEN)
+uint8_t raw_out[LICK_RAW_USB_VENDOR ? 2 : 1][RAW_OUT_SIZE];
+uint8_t raw_out_buf = 0;
+#endif
+
+#if LICK_BENCHMARK
+struct lick_bench bench;
+#if LICK_SINK_GPIO
+// From the start of the sample until the GPIO outputs are written.
+struct lick_bench bench_gpio;
+#endif
+struct lick_jitter jitter;
+#endif
+
+/* Sampling
+ * Every sample has a deadline, on a grid of sampling intervals: from a
+ * repeating timer on core 0, or from a hardware alarm on core 1.
+ */
+const int32_t sampling_interval_ms = LICK_SAMPLING_INTERVAL_MS;
+static uint32_t take_sample(uint64_t deadline_us);
+#if LICK_SAMPLING_CORE1
+static void core1_main(void);
+#else
+bool timer_callback(repeating_timer_t *rt);
+#endif
+
+
+int main() {
+    stdio_init_all();
+
+    /* Setup the default, on-board LED */
+    gpio_init(LED_PIN);
+    gpio_set_dir(LED_PIN, GPIO_OUT);
+
+#if LICK_SINK_GPIO
+    /* Initialise the digital output pins */
+    gpio_out_mask = 0;
+    for (uint8_t i = 0; i < N_GPIO_OUT; i++) {
+        gpio_out_mask |= 1u << gpio_out_pins[i];
+    }
+    gpio_init_mask(gpio_out_mask);
+    gpio_set_dir_out_masked(gpio_out_mask);
+#endif
+
+    /* Initialise I2C and the touch sensors */
+    lick_sensors_init();
+    lick_detect_init(&detect);
+#if LICK_ADAPTIVE
+    lick_adaptive_init(&adaptive, LICK_N_SENSORS, LICK_ADAPTIVE_HOLD);
+#endif
+#if LICK_FILTER
+    lick_filter_init(&filter);
+    next_filter_report = make_timeout_time_ms(LICK_FILTER_REPORT_MS);
+#endif
+#if LICK_SINK_SUMMARY
+    lick_summary_init(&summary);
+#endif
+
+#if LICK_SYNC
+    lick_sync_init();
+#endif
+    lick_command_init();
+
+#if LICK_RAW_USB_VENDOR
+    lick_usb_init();
+#elif LICK_SINK_RAW
+    // Data is binary; do not let stdio turn \n bytes into \r\n.
+    stdio_set_translate_crlf(&stdio_usb, false);
+#endif
+
+#if PRINT_FROM_LOOP
+    critical_section_init(&health_lock);
+#endif
+
+#if LICK_BENCHMARK
+    lick_bench_init(&bench, LICK_VARIANT_NAME);
+#if LICK_SINK_GPIO
+    lick_bench_init(&bench_gpio, "gpio");
+#endif
+    lick_jitter_init(&jitter, LICK_SAMPLING_CORE1 ? "core1" : "timer",
+                     sampling_interval_ms * 1000);
+    absolute_time_t next_report = make_timeout_time_ms(1000);
+#endif
+
+#if LICK_SAMPLING_CORE1
+    /* Start sampling on core 1 */
+    multicore_launch_core1(core1_main);
+#else
+    /* Start repeating timer */
+#if LICK_BENCHMARK
+    lick_bench_clock_init();
+#endif
+    repeating_timer_t timer;
+    add_repeating_timer_ms(-sampling_interval_ms, timer_callback, NULL,
+                           &timer);
+#endif
+
+    while(1) {
+        lick_command_poll();
+#if LICK_SINK_USB && LICK_SAMPLING_CORE1
+        lick_events_task();
+#if LICK_SYNC
+        lick_sync_report();
+#endif
+#if LICK_SNIPPET
+        lick_snippet_task();
+#endif
+#endif
+#if LICK_SINK_EDGES
+        lick_edges_task();
+#endif
+#if LICK_SINK_SUMMARY
+        if (summary_ready >= 0) {
+            __mem_fence_acquire();
+            uint8_t buf = (uint8_t)summary_ready;
+            summary_ready = -1;
+            summary_print(&summary_bins[buf]);
+        }
+#endif
+#if PRINT_FROM_LOOP
+        if (health_pending) {
+            critical_section_enter_blocking(&health_lock);
+            uint8_t mask = health_pending;
+            health_pending = 0;
+            critical_section_exit(&health_lock);
+            health_report(mask);
+        }
+#if LICK_FILTER
+        if (time_reached(next_filter_report)) {
+            filter_report();
+            next_filter_report = make_timeout_time_ms(LICK_FILTER_REPORT_MS);
+        }
+#endif
+#endif
+#if LICK_SINK_RAW
+#if LICK_RAW_USB_VENDOR
+        lick_usb_task();
+        if (raw_ready >= 0 && !lick_usb_vendor_can_send()) {
+            // Both blocks still going out: drop this one, which the
+            // host sees as a gap in the block sequence numbers.
+            raw_ready = -1;
+            raw_seq++;
+        }
+#endif
+        if (raw_ready >= 0) {
+            __mem_fence_acquire();
+            uint8_t buf = (uint8_t)raw_ready;
+            uint8_t *out = raw_out[raw_out_buf];
+            size_t n = lick_codec_encode(&raw_frames[buf][0][0],
+                LICK_RAW_BLOCK_LEN, RAW_N_CHANNELS, raw_seq,
+                raw_t0_us[buf], (uint16_t)(sampling_interval_ms * 1000),
+                raw_flags[buf], out, RAW_OUT_SIZE);
+            raw_ready = -1;
+            raw_seq++;
+#if LICK_RAW_USB_VENDOR
+            lick_usb_vendor_send(out, n);
+            raw_out_buf ^= 1;
+#else
+            fwrite(out, 1, n, stdout);
+            fflush(stdout);
+#endif
+        }
+#endif
+#if LICK_BENCHMARK
+        if (time_reached(next_report)) {
+            lick_bench_report(&bench);
+#if LICK_SINK_GPIO
+            lick_bench_report(&bench_gpio);
+#endif
+            lick_jitter_report(&jitter);
+            next_report = make_timeout_time_ms(1000);
+        }
+#endif
+        tight_loop_contents();
+    }
+    return 0;
+}
+
+
+#if LICK_SINK_RAW
+/* Collect one sample of filtered and baseline values from every
+ * electrode. When the buffer is full, hand it over to the main loop and
+ * continue with the other one.
+ */
+static inline void raw_sample(void) {
+    uint16_t *frame = raw_frames[raw_buf][raw_count];
+    if (raw_count == 0) {
+        raw_t0_us[raw_buf] = time_us_32();
+    }
+    // Channels are all filtered values (sensor by sensor) followed by
+    // all baseline values.
+    for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+        lick_sensor_read_raw(i, frame + i * LICK_N_ELECTRODES,
+            frame + (LICK_N_SENSORS + i) * LICK_N_ELECTRODES);
+        // Health events are not printed, as the stream is binary;
+        // failed sensors are flagged in the block instead.
+        lick_health[i].events = 0;
+        if (lick_health[i].status != LICK_SENSOR_OK) {
+            raw_flags[raw_buf] |= LICK_CODEC_FLAG_SENSOR_FAULT(i);
+        }
+    }
+    raw_count++;
+    if (raw_count == LICK_RAW_BLOCK_LEN) {
+        // If the previous block has not been sent yet it is overwritten;
+        // the host sees this as a gap in the block sequence numbers.
+        __mem_fence_release();
+        raw_ready = raw_buf;
+        raw_buf ^= 1;
+        raw_count = 0;
+        raw_flags[raw_buf] = 0;
+    }
+}
+#endif
+
+
+#if LICK_ADAPTIVE
+/* Update which sensors are active from those read in this sample,
+ * `read`. With LICK_ADAPTIVE_WAKE_DELTA, the idle sensors read and not
+ * touched are checked for electrodes near the threshold too.
+ */
+static inline void adaptive_step(struct lick_sample *s, uint8_t read) {
+    uint8_t near = 0;
+#if LICK_ADAPTIVE_WAKE_DELTA
+    for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+        if (!(read & ~adaptive.fast & (1u << i)) || s->touched[i]) {
+            continue;
+        }
+        uint16_t filtered[LICK_N_ELECTRODES];
+        uint16_t baseline[LICK_N_ELECTRODES];
+        lick_sensor_read_raw(i, filtered, baseline);
+        for (uint8_t e = 0; e < LICK_N_ELECTRODES; e++) {
+            if ((int)baseline[e] - (int)filtered[e] >=
+                LICK_ADAPTIVE_WAKE_DELTA) {
+                near |= (uint8_t)(1u << i);
+            }
+        }
+    }
+#endif
+    s->fast = adaptive.fast;
+    lick_adaptive_update(&adaptive, s->touched, near, read, LICK_N_SENSORS,
+                         LICK_ADAPTIVE_HOLD);
+}
+#endif
+
+
+#if LICK_SINK_SUMMARY
+/* Add one sample to the current bin. When the bin is complete, hand it
+ * over to the main loop and continue with the other one.
+ */
+static inline void summary_sample(const struct lick_sample *s) {
+    struct lick_summary_bin *b = &summary_bins[summary_buf];
+    if (summary_count == 0) {
+        lick_summary_start(&summary, b, s->timestamp_ms, LICK_N_SENSORS,
+                           LICK_SUMMARY_HIST_LEN);
+    }
+    lick_summary_step(&summary, b, s, LICK_N_SENSORS, LICK_N_ELECTRODES,
+                      LICK_SUMMARY_BOUT_GAP, LICK_SUMMARY_HIST_LEN,
+                      LICK_SUMMARY_HIST_WIDTH);
+    summary_count++;
+    if (summary_count == LICK_SUMMARY_BIN) {
+        // If the previous bin has not been printed yet it is
+        // overwritten; the host sees this as a gap in the bin count.
+        __mem_fence_release();
+        summary_ready = summary_buf;
+        summary_buf ^= 1;
+        summary_count = 0;
+    }
+}
+
+/* Print one bin: its count and start time, then the counts of every
+ * electrode that was touched in it (see firmware/README.md).
+ */
+static void summary_print(const struct lick_summary_bin *b) {
+    printf("%lu %lu", (unsigned long)b->count,
+           (unsigned long)b->start_ms);
+    for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+        for (uint8_t e = 0; e < LICK_N_ELECTRODES; e++) {
+            if (b->contact[i][e] == 0 && b->licks[i][e] == 0) {
+                continue;
+            }
+            printf(" %c%u:%lu,%lu,%lu", 'A' + i, e,
+                   (unsigned long)b->licks[i][e],
+                   (unsigned long)b->contact[i][e] *
+                       LICK_SAMPLING_INTERVAL_MS,
+                   (unsigned long)b->bouts[i][e]);
+#if LICK_SUMMARY_HIST_LEN
+            for (uint8_t k = 0; k < LICK_SUMMARY_HIST_LEN; k++) {
+                printf(",%lu", (unsigned long)b->hist[i][e][k]);
+            }
+#endif
+        }
+    }
+    printf("\n");
+}
+#endif
+
+
+#if LICK_FILTER
+/* Print the number of onsets rejected so far for each reason. */
+static void filter_report(void) {
+    uint32_t total = filter.n_burst + filter.n_refractory +
+        filter.n_short;
+    if (total != filter_reported) {
+        printf("# rejected %lu burst %lu refractory %lu short %lu\n",
+               (unsigned long)to_ms_since_boot(get_absolute_time()),
+               (unsigned long)filter.n_burst,
+               (unsigned long)filter.n_refractory,
+               (unsigned long)filter.n_short);
+        filter_reported = total;
+    }
+}
+#endif
+
+
+#if !LICK_SINK_RAW
+/* Print a line for every sensor with health events, and clear them.
+ * Lines start with `#` so that host tools can tell them apart from
+ * data.
+ */
+static void health_report(uint8_t mask) {
+    uint32_t timestamp_ms = to_ms_since_boot(get_absolute_time());
+    for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+        if (!(mask & (1u << i))) {
+            continue;
+        }
+        // A copy, as the sensors may be read on the other core while
+        // this prints.
+        struct lick_sensor_health h;
+        lick_sensor_health_take(i, &h);
+        printf("# health %lu sensor %u %s errors %lu oor 0x%03x "
+               "reinits %lu recovery_us %lu max %lu bus_recoveries %lu\n",
+               (unsigned long)timestamp_ms, i,
+               h.status == LICK_SENSOR_OK ? "ok" : "failed",
+               (unsigned long)h.n_errors, h.oor,
+               (unsigned long)h.n_reinits,
+               (unsigned long)h.recovery_us,
+               (unsigned long)h.recovery_step_us_max,
+               (unsigned long)lick_bus_recoveries);
+    }
+}
+#endif
+
+
+/* Sample
+ *
+ * This function is called at every sampling time, whose deadline is
+ * `deadline_us`. The touch sensors are read and the data is sent to the
+ * outputs of this variant. Returns the interval to the next deadline,
+ * in us.
+ */
+static uint32_t take_sample(uint64_t deadline_us) {
+#if LICK_BENCHMARK
+    uint32_t bench_start = lick_bench_start();
+    lick_jitter_step(&jitter, deadline_us, time_us_64());
+#else
+    (void)deadline_us;
+#endif
+    struct lick_sample sample;
+
+#if LICK_SYNC
+    // Sync pulses mark the start of the sample, so they go first.
+    lick_sync_sample(time_us_64());
+#endif
+
+    // Read the sensors: all of them or, with adaptive sampling, the
+    // active ones and the idle ones whose turn it is.
+#if LICK_ADAPTIVE
+    uint8_t read = lick_adaptive_plan(&adaptive, LICK_N_SENSORS,
+                                      LICK_ADAPTIVE_IDLE_SAMPLES);
+#else
+    const uint8_t read = (1u << LICK_N_SENSORS) - 1;
+#endif
+    uint8_t health_events = lick_sensors_read(sample.touched, read);
+
+    // Write the data to the output pins first, so that their latency
+    // does not depend on anything else done here.
+#if LICK_SINK_GPIO
+    gpio_put_masked(gpio_out_mask,
+        lick_gpio_value(sample.touched[0], gpio_out_pins, N_GPIO_OUT));
+#if LICK_BENCHMARK
+    lick_bench_stop(&bench_gpio, bench_start);
+#endif
+#endif
+
+    // The on-board LED follows touch status of electrode 0.
+    gpio_put(LED_PIN, sample.touched[0] & 0x1);
+
+#if LICK_ADAPTIVE
+    adaptive_step(&sample, read);
+#endif
+
+#if LICK_SNIPPET
+    lick_snippet_sample();
+#endif
+
+    // Determine if there was a change in status from 0 to 1 in any
+    // electrode. This indicates the onset of a lick event.
+    bool any_onset = lick_detect_step(&detect, &sample, LICK_N_SENSORS);
+#if LICK_FILTER
+    any_onset = lick_filter_step(&filter, &sample, LICK_N_SENSORS,
+        LICK_FILTER_MIN_ILI, LICK_FILTER_MAX_SIMULTANEOUS,
+        LICK_FILTER_MIN_CONTACT);
+#endif
+
+#if LICK_SINK_USB
+    // If a lick was detected, print the event count, timestamp and
+    // sensor data to serial. One single number per sensor represents
+    // the onset status of its electrodes.
+    if (any_onset) {
+        sample.timestamp_ms = to_ms_since_boot(get_absolute_time());
+#if LICK_FILTER
+        sample.timestamp_ms -= FILTER_DELAY_MS;
+#endif
+#if LICK_SAMPLING_CORE1
+        // Only queued here; the main loop prints them.
+        lick_events_push(detect.n_events, &sample);
+#else
+        lick_events_print(detect.n_events, &sample);
+#endif
+#if LICK_SNIPPET
+        lick_snippet_onset(detect.n_events, sample.onset,
+                           FILTER_DELAY_MS / LICK_SAMPLING_INTERVAL_MS);
+#endif
+        detect.n_events++;
+    }
+#elif LICK_SINK_EDGES
+    // Only queued here; the main loop prints them.
+    (void)any_onset;
+    sample.timestamp_ms = to_ms_since_boot(get_absolute_time());
+    lick_edges_push(&sample);
+#elif LICK_SINK_SUMMARY
+    (void)any_onset;
+    sample.timestamp_ms = to_ms_since_boot(get_absolute_time());
+    summary_sample(&sample);
+#else
+    (void)any_onset;
+#endif
+#if LICK_FILTER && !PRINT_FROM_LOOP
+    if (time_reached(next_filter_report)) {
+        filter_report();
+        next_filter_report = make_timeout_time_ms(LICK_FILTER_REPORT_MS);
+    }
+#endif
+
+#if LICK_SINK_RAW
+    (void)health_events;
+    raw_sample();
+#elif PRINT_FROM_LOOP
+    if (health_events) {
+        critical_section_enter_blocking(&health_lock);
+        health_pending |= health_events;
+        critical_section_exit(&health_lock);
+    }
+#else
+    if (health_events) {
+        health_report(health_events);
+    }
+#endif
+
+#if LICK_SYNC && LICK_PRINT_FROM_SAMPLE
+    lick_sync_report();
+#endif
+#if LICK_SNIPPET
+    // Only queued when sampling on core 1.
+    lick_snippet_report();
+#endif
+#if LICK_PRINT_FROM_SAMPLE
+    lick_command_report();
+#endif
+
+    lick_sensors_recover();
+
+#if LICK_BENCHMARK
+    lick_bench_stop(&bench, bench_start);
+#endif
+#if LICK_SYNC_IN_LOCK
+    return (uint32_t)lick_sync_next_interval_us();
+#else
+    return sampling_interval_ms * 1000;
+#endif
+}
+
+
+#if LICK_SAMPLING_CORE1
+/* Core 1: sample, and nothing else (see lick_sampler.h). */
+static void core1_main(void) {
+#if LICK_BENCHMARK
+    // Cycles are counted by the SysTick of the core that samples.
+    lick_bench_clock_init();
+#endif
+    lick_sampler_run(take_sample, sampling_interval_ms * 1000);
+}
+#else
+/* Timer callback
+ *
+ * The timer was set with a negative interval, so it fires at fixed
+ * deadlines: each one is the previous one plus the interval, from the
+ * start of one sample to the start of the next, whatever the sample
+ * takes; samples that are late are taken back to back. The deadlines
+ * are counted here from the first sample.
+ */
+bool timer_callback(repeating_timer_t *rt) {
+    static uint64_t deadline_us = 0;
+    if (deadline_us == 0) {
+        deadline_us = time_us_64();
+    }
+    uint32_t interval_us = take_sample(deadline_us);
+    deadline_us += interval_us;
+#if LICK_SYNC_IN_LOCK
+    rt->delay_us = -(int64_t)interval_us;
+#endif
+    return true;
+}
+#endif
@@ -0,0 +1,51 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
+#include "lick_sampler.h"
+
+#if LICK_SAMPLING_CORE1
+
+static lick_sample_fn sample_fn;
+static uint64_t deadline_us;
+
+/* The alarm interrupt: take the sample, then set the alarm to the next
+ * deadline, or to the first one that has not passed yet.
+ */
+static void alarm_irq(uint alarm_num) {
+    uint32_t interval_us = sample_fn(deadline_us);
+    do {
+        deadline_us += interval_us;
+    } while (hardware_alarm_set_target(alarm_num,
+                                       from_us_since_boot(deadline_us)));
+}
+
+void lick_sampler_run(lick_sample_fn sample, uint32_t interval_us) {
+    sample_fn = sample;
+    // Not the alarm of the SDK's default alarm pool, which stays on
+    // core 0. Setting the callback enables the alarm's interrupt on
+    // this core.
+    uint alarm_num = (uint)hardware_alarm_claim_unused(true);
+    hardware_alarm_set_callback(alarm_num, alarm_irq);
+    deadline_us = time_us_64() + interval_us;
+    while (hardware_alarm_set_target(alarm_num,
+                                     from_us_since_boot(deadline_us))) {
+        deadline_us += interval_us;
+    }
+    while (true) {
+        __wfi();
+    }
+}
+
+#endif
@@ -0,0 +1,58 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_sampler.h
+
+   Sampling on a core of its own (LICK_SAMPLING_CORE1).
+
+   By default the sensors are read from a repeating timer of the SDK,
+   whose alarm interrupt is on core 0 together with the USB interrupts
+   and everything else the SDK runs there; a sample is delayed whenever
+   one of those is being handled, and the lick events are printed from
+   the sample itself. With LICK_SAMPLING_CORE1, core 1 does nothing but
+   sample: a hardware alarm of its own, the only interrupt enabled on
+   that core, is set to the absolute time of every sample, the deadline,
+   and the sample runs in its interrupt. Results are handed to core 0
+   through memory (queues and double buffers with one writer on each
+   side), and core 0 prints them from the main loop.
+
+   Deadlines are kept on a fixed grid: each one is the previous one plus
+   the interval returned by the sample. If a sample takes so long that
+   the next deadline has already passed, that deadline is skipped rather
+   than sampling late several times in a row, so that every sample stays
+   on the grid; the skipped deadlines show as missed in the jitter
+   report (see lick_bench.h).
+ */
+
+#ifndef LICK_SAMPLER_H
+#define LICK_SAMPLER_H
+
+#include "pico/stdlib.h"
+
+#include "lick_config.h"
+
+#if LICK_SAMPLING_CORE1
+
+/* Take one sample whose deadline was `deadline_us` (us since boot), and
+ * return the interval to the next deadline, in us.
+ */
+typedef uint32_t (*lick_sample_fn)(uint64_t deadline_us);
+
+/* Call `sample` at every deadline from `interval_us` from now on, from
+ * a hardware alarm on the calling core. Call it from core 1, last: it
+ * does not return.
+ */
+void lick_sampler_run(lick_sample_fn sample, uint32_t interval_us);
+
+#endif
+
+#endif
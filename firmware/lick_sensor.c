@@ -0,0 +1,448 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "hardware/i2c.h"
+#include "pico/critical_section.h"
+
+#include "lick_sensor.h"
+
+/* Touch status of electrodes 0-11 is in registers 0x00 and 0x01, and
+ * their out-of-range status in 0x02 and 0x03, so both are read in one
+ * transaction.
+ */
+#define TOUCH_STATUS_REG 0x00
+#define ELECTRODE_MASK ((1u << LICK_N_ELECTRODES) - 1)
+
+/* The MPR121 stores electrode filtered data as 13 pairs of bytes (low,
+ * high) from register 0x04, and the upper 8 bits of the 10-bit baseline
+ * values as 13 bytes from register 0x1E. Reading each of these in a
+ * single transaction is much quicker than reading electrode by
+ * electrode.
+ */
+#define RAW_FILTERED_REG 0x04
+#define RAW_BASELINE_REG 0x1E
+
+/* Touch and release thresholds of electrode 0 are in registers 0x41
+ * and 0x42, those of electrode 1 in 0x43 and 0x44, etc. They can only
+ * be written while the electrodes are disabled (ECR = 0).
+ */
+#define ELECTRODE_TTH_REG 0x41
+#define ELECTRODE_RTH_REG 0x42
+#define ECR_REG 0x5E
+
+/* The settings of a sensor are in registers 0x2B to 0x5D (baseline
+ * filters, thresholds, debounce, and AFE configuration 1 and 2), 0x7B
+ * to 0x7F (auto-configuration) and the ECR, which starts the sensor.
+ */
+#define SETTINGS_REG 0x2B
+#define N_SETTINGS_REGS (ECR_REG - SETTINGS_REG)
+#define AUTOCONFIG_REG 0x7B
+#define N_AUTOCONFIG_REGS 5
+
+/* The sensor samples its electrodes every 2^ESI ms, ESI being the low 3
+ * bits of the AFE configuration 2 register, which can also only be
+ * written while the electrodes are disabled. The upper bits are left
+ * as after reset: charge time 0.5 us, 4 samples for the second filter.
+ * With adaptive sampling, ESI is the largest that is not longer than
+ * the sampling interval.
+ */
+#define AFE_CONFIG2_REG 0x5D
+#define AFE_CONFIG2_DEFAULT 0x20
+#define SAMPLE_INTERVAL_ESI (LICK_SAMPLING_INTERVAL_MS >= 128 ? 7 : \
+    LICK_SAMPLING_INTERVAL_MS >= 64 ? 6 : \
+    LICK_SAMPLING_INTERVAL_MS >= 32 ? 5 : \
+    LICK_SAMPLING_INTERVAL_MS >= 16 ? 4 : \
+    LICK_SAMPLING_INTERVAL_MS >= 8 ? 3 : \
+    LICK_SAMPLING_INTERVAL_MS >= 4 ? 2 : \
+    LICK_SAMPLING_INTERVAL_MS >= 2 ? 1 : 0)
+
+/* Writing 0x63 to this register resets the sensor. */
+#define SOFT_RESET_REG 0x80
+#define SOFT_RESET_VALUE 0x63
+
+/* Bus recovery: SCL half-period (100 kHz), and the number of clock
+ * pulses that frees a sensor stuck in the middle of a byte.
+ */
+#define BUS_RECOVERY_HALF_PERIOD_US 5
+#define BUS_RECOVERY_PULSES 9
+
+struct mpr121_sensor lick_mpr121[LICK_N_SENSORS];
+const uint8_t lick_sensor_addresses[LICK_N_SENSORS] =
+    LICK_SENSOR_ADDRESSES;
+struct lick_sensor_health lick_health[LICK_N_SENSORS];
+uint32_t lick_bus_recoveries = 0;
+
+// Held while the health of a sensor is updated or taken, as these can
+// happen on different cores (LICK_SAMPLING_CORE1). No I2C is done
+// while it is held.
+static critical_section_t health_lock;
+
+/* A failed sensor is reinitialised by a reset followed by the writes
+ * of all its settings, the ECR last, one write per sample. The values
+ * are read back from the sensor once it has been configured at boot, so
+ * that a reinitialised sensor runs with the settings it had then,
+ * including those that the pico-mpr121 library chooses.
+ */
+struct reg_write {
+    uint8_t reg;
+    uint8_t value;
+};
+
+#define N_CONFIG_WRITES (1 + N_SETTINGS_REGS + N_AUTOCONFIG_REGS + 1)
+
+static struct reg_write config_writes[LICK_N_SENSORS][N_CONFIG_WRITES];
+
+// The sensor being reinitialised (-1 for none), its next write, and the
+// time of its reset.
+static int8_t reinit_sensor = -1;
+static uint8_t reinit_next;
+static uint32_t reinit_start_us;
+
+#ifdef LICK_ELECTRODE_TTH
+static const uint8_t electrode_tth[LICK_N_SENSORS][LICK_N_ELECTRODES] =
+    LICK_ELECTRODE_TTH;
+static const uint8_t electrode_rth[LICK_N_SENSORS][LICK_N_ELECTRODES] =
+    LICK_ELECTRODE_RTH;
+
+static void set_electrode_thresholds(uint8_t sensor) {
+    struct mpr121_sensor *s = &lick_mpr121[sensor];
+    uint8_t ecr;
+    mpr121_read(ECR_REG, &ecr, s);
+    mpr121_write(ECR_REG, 0, s);
+    for (uint8_t i = 0; i < LICK_N_ELECTRODES; i++) {
+        mpr121_write(ELECTRODE_TTH_REG + 2 * i, electrode_tth[sensor][i],
+                     s);
+        mpr121_write(ELECTRODE_RTH_REG + 2 * i, electrode_rth[sensor][i],
+                     s);
+    }
+    mpr121_write(ECR_REG, ecr, s);
+}
+#endif
+
+#if LICK_ADAPTIVE
+static void set_sample_interval(uint8_t sensor) {
+    struct mpr121_sensor *s = &lick_mpr121[sensor];
+    uint8_t ecr;
+    mpr121_read(ECR_REG, &ecr, s);
+    mpr121_write(ECR_REG, 0, s);
+    mpr121_write(AFE_CONFIG2_REG, AFE_CONFIG2_DEFAULT | SAMPLE_INTERVAL_ESI,
+                 s);
+    mpr121_write(ECR_REG, ecr, s);
+}
+#endif
+
+static void i2c_setup(void) {
+    i2c_init(MPR121_I2C_PORT, MPR121_I2C_FREQ);
+    gpio_set_function(MPR121_I2C_PIN_SDA, GPIO_FUNC_I2C);
+    gpio_set_function(MPR121_I2C_PIN_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(MPR121_I2C_PIN_SDA);
+    gpio_pull_up(MPR121_I2C_PIN_SCL);
+}
+
+/* Initialise one sensor and apply all settings. */
+static void sensor_configure(uint8_t sensor) {
+    struct mpr121_sensor *s = &lick_mpr121[sensor];
+    mpr121_init(MPR121_I2C_PORT, lick_sensor_addresses[sensor], s);
+
+    // The value of this function is the number of electrodes to
+    // enable: e.g. 3 enables electrodes 0 to 2.
+    mpr121_enable_electrodes(LICK_N_ELECTRODES, s);
+
+    mpr121_set_thresholds(LICK_SETTING_TTH, LICK_SETTING_RTH, s);
+    mpr121_set_max_half_delta(LICK_SETTING_MHDR, LICK_SETTING_MHDF, s);
+    mpr121_set_noise_half_delta(LICK_SETTING_NHDR, LICK_SETTING_NHDF,
+                                LICK_SETTING_NHDT, s);
+    mpr121_set_noise_count_limit(LICK_SETTING_NCLR, LICK_SETTING_NCLF,
+                                 LICK_SETTING_NCLT, s);
+    mpr121_set_filter_delay_limit(LICK_SETTING_FDLR, LICK_SETTING_FDLF,
+                                  LICK_SETTING_FDLT, s);
+    mpr121_set_debounce(LICK_SETTING_TDBNC, LICK_SETTING_RDBNC, s);
+#ifdef LICK_ELECTRODE_TTH
+    set_electrode_thresholds(sensor);
+#endif
+#if LICK_ADAPTIVE
+    set_sample_interval(sensor);
+#endif
+}
+
+/* Bus lines are open drain: a line is pulled low by driving it as an
+ * output (whose value is 0) and released by making it an input.
+ */
+static inline void line_low(uint pin) {
+    gpio_set_dir(pin, GPIO_OUT);
+}
+
+static inline void line_release(uint pin) {
+    gpio_set_dir(pin, GPIO_IN);
+}
+
+static inline void bus_delay(void) {
+    busy_wait_us_32(BUS_RECOVERY_HALF_PERIOD_US);
+}
+
+/* Free the bus when a sensor holds SDA low because the controller gave
+ * up in the middle of a byte: pulse SCL until the sensor has sent the
+ * rest of the byte and releases SDA, then send a stop condition and
+ * reset the I2C controller. This takes ~100 us.
+ */
+static void bus_recover(void) {
+    const uint sda = MPR121_I2C_PIN_SDA;
+    const uint scl = MPR121_I2C_PIN_SCL;
+    gpio_put(sda, 0);
+    gpio_put(scl, 0);
+    line_release(sda);
+    line_release(scl);
+    gpio_set_function(sda, GPIO_FUNC_SIO);
+    gpio_set_function(scl, GPIO_FUNC_SIO);
+    bus_delay();
+
+    for (uint8_t i = 0; i < BUS_RECOVERY_PULSES && !gpio_get(sda); i++) {
+        line_low(scl);
+        bus_delay();
+        line_release(scl);
+        bus_delay();
+    }
+    // Stop: SDA goes high while SCL is high.
+    line_low(scl);
+    bus_delay();
+    line_low(sda);
+    bus_delay();
+    line_release(scl);
+    bus_delay();
+    line_release(sda);
+    bus_delay();
+
+    i2c_deinit(MPR121_I2C_PORT);
+    i2c_setup();
+    lick_bus_recoveries++;
+}
+
+/* Recover the bus after a failed transaction if it is stuck. */
+static void check_bus(int ret) {
+    if (ret == PICO_ERROR_TIMEOUT || !gpio_get(MPR121_I2C_PIN_SDA) ||
+        !gpio_get(MPR121_I2C_PIN_SCL)) {
+        bus_recover();
+    }
+}
+
+/* Count a failed transaction with `sensor`, recover the bus if it is
+ * stuck, and mark the sensor as failed if this has happened too many
+ * times in a row.
+ */
+static void sensor_error(uint8_t sensor, int ret) {
+    struct lick_sensor_health *h = &lick_health[sensor];
+    check_bus(ret);
+    critical_section_enter_blocking(&health_lock);
+    h->n_errors++;
+    if (h->status == LICK_SENSOR_OK &&
+        ++h->n_consecutive_errors >= LICK_I2C_MAX_ERRORS) {
+        h->status = LICK_SENSOR_FAILED;
+        h->events |= LICK_HEALTH_FAILED;
+        h->next_attempt = get_absolute_time();
+    }
+    critical_section_exit(&health_lock);
+}
+
+/* Read `len` bytes from register `reg` of `sensor`. Returns the number
+ * of bytes read or a PICO_ERROR code.
+ */
+static int sensor_read_regs(uint8_t sensor, uint8_t reg, uint8_t *buf,
+                            size_t len) {
+    uint8_t addr = lick_sensor_addresses[sensor];
+    int ret = i2c_write_timeout_us(MPR121_I2C_PORT, addr, &reg, 1, true,
+                                   LICK_I2C_TIMEOUT_US);
+    if (ret < 0) {
+        return ret;
+    }
+    return i2c_read_timeout_us(MPR121_I2C_PORT, addr, buf, len, false,
+                               LICK_I2C_TIMEOUT_US);
+}
+
+/* Write `value` to register `reg` of `sensor`. Returns the number of
+ * bytes written or a PICO_ERROR code.
+ */
+static int sensor_write_reg(uint8_t sensor, uint8_t reg, uint8_t value) {
+    uint8_t buf[] = {reg, value};
+    return i2c_write_timeout_us(MPR121_I2C_PORT,
+        lick_sensor_addresses[sensor], buf, sizeof(buf), false,
+        LICK_I2C_TIMEOUT_US);
+}
+
+/* Read back the settings of one sensor, as configured, into the
+ * register writes that reinitialise it. Returns false if the sensor
+ * could not be read.
+ */
+static bool make_config_writes(uint8_t sensor) {
+    struct reg_write *w = config_writes[sensor];
+    uint8_t settings[N_SETTINGS_REGS];
+    uint8_t autoconfig[N_AUTOCONFIG_REGS];
+    uint8_t ecr;
+    if (sensor_read_regs(sensor, SETTINGS_REG, settings,
+                         N_SETTINGS_REGS) != N_SETTINGS_REGS ||
+        sensor_read_regs(sensor, AUTOCONFIG_REG, autoconfig,
+                         N_AUTOCONFIG_REGS) != N_AUTOCONFIG_REGS ||
+        sensor_read_regs(sensor, ECR_REG, &ecr, 1) != 1) {
+        return false;
+    }
+    *w++ = (struct reg_write){SOFT_RESET_REG, SOFT_RESET_VALUE};
+    for (uint8_t i = 0; i < N_SETTINGS_REGS; i++) {
+        *w++ = (struct reg_write){SETTINGS_REG + i, settings[i]};
+    }
+    for (uint8_t i = 0; i < N_AUTOCONFIG_REGS; i++) {
+        *w++ = (struct reg_write){AUTOCONFIG_REG + i, autoconfig[i]};
+    }
+    *w = (struct reg_write){ECR_REG, ecr};
+    return true;
+}
+
+void lick_sensors_init(void) {
+    /* Initialise I2C */
+    i2c_setup();
+
+    /* Initialise the touch sensors */
+    critical_section_init(&health_lock);
+    for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+        lick_health[i] = (struct lick_sensor_health){0};
+        sensor_configure(i);
+        // Without its settings a sensor cannot be reinitialised, so
+        // one that does not answer now is left failed.
+        if (!make_config_writes(i)) {
+            lick_health[i].status = LICK_SENSOR_FAILED;
+            lick_health[i].events = LICK_HEALTH_FAILED;
+            lick_health[i].next_attempt = at_the_end_of_time;
+        }
+    }
+}
+
+/* Do the next write of the sensor being reinitialised. If it fails the
+ * attempt is abandoned, and the sensor tried again from its reset after
+ * LICK_REINIT_INTERVAL_MS; after the last write the sensor is back.
+ */
+static void reinit_step(void) {
+    uint8_t sensor = (uint8_t)reinit_sensor;
+    struct lick_sensor_health *h = &lick_health[sensor];
+    const struct reg_write *w = &config_writes[sensor][reinit_next];
+    uint32_t start = time_us_32();
+    if (reinit_next == 0) {
+        reinit_start_us = start;
+    }
+    int ret = sensor_write_reg(sensor, w->reg, w->value);
+    if (ret != 2) {
+        check_bus(ret);
+    }
+    uint32_t end = time_us_32();
+    critical_section_enter_blocking(&health_lock);
+    if (ret != 2) {
+        h->n_errors++;
+        h->next_attempt = make_timeout_time_ms(LICK_REINIT_INTERVAL_MS);
+        reinit_sensor = -1;
+    } else if (++reinit_next == N_CONFIG_WRITES) {
+        h->status = LICK_SENSOR_OK;
+        h->n_consecutive_errors = 0;
+        h->n_reinits++;
+        h->events |= LICK_HEALTH_RECOVERED;
+        reinit_sensor = -1;
+    }
+    if (end - start > h->recovery_step_us_max) {
+        h->recovery_step_us_max = end - start;
+    }
+    if (reinit_sensor < 0) {
+        h->recovery_us = end - reinit_start_us;
+    }
+    critical_section_exit(&health_lock);
+}
+
+uint8_t lick_sensors_read(uint16_t *touched, uint8_t mask) {
+    uint8_t events = 0;
+    for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+        struct lick_sensor_health *h = &lick_health[i];
+        touched[i] = 0;
+        if (h->status != LICK_SENSOR_OK || !(mask & (1u << i))) {
+            continue;
+        }
+        uint8_t buf[4];
+        int ret = sensor_read_regs(i, TOUCH_STATUS_REG, buf, sizeof(buf));
+        if (ret != (int)sizeof(buf)) {
+            sensor_error(i, ret);
+        } else {
+            h->n_consecutive_errors = 0;
+            touched[i] = (buf[0] | (buf[1] << 8)) & ELECTRODE_MASK;
+            uint16_t oor = (buf[2] | (buf[3] << 8)) & ELECTRODE_MASK;
+            if (oor != h->oor) {
+                critical_section_enter_blocking(&health_lock);
+                h->oor = oor;
+                h->events |= LICK_HEALTH_OOR;
+                critical_section_exit(&health_lock);
+            }
+        }
+    }
+
+    for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+        if (lick_health[i].events) {
+            events |= 1u << i;
+        }
+    }
+    return events;
+}
+
+void lick_sensors_recover(void) {
+    // Only one failed sensor is reinitialised at a time, one write per
+    // sample, so that the time this adds to a sample is bounded.
+    for (uint8_t i = 0; reinit_sensor < 0 && i < LICK_N_SENSORS; i++) {
+        struct lick_sensor_health *h = &lick_health[i];
+        if (h->status != LICK_SENSOR_OK && time_reached(h->next_attempt)) {
+            reinit_sensor = (int8_t)i;
+            reinit_next = 0;
+        }
+    }
+    if (reinit_sensor >= 0) {
+        reinit_step();
+    }
+}
+
+void lick_sensor_health_take(uint8_t sensor,
+        struct lick_sensor_health *copy) {
+    critical_section_enter_blocking(&health_lock);
+    *copy = lick_health[sensor];
+    lick_health[sensor].events = 0;
+    critical_section_exit(&health_lock);
+}
+
+void lick_sensor_read_raw(uint8_t sensor, uint16_t *filtered,
+        uint16_t *baseline) {
+    uint8_t buf[2 * LICK_N_ELECTRODES];
+    for (uint8_t i = 0; i < LICK_N_ELECTRODES; i++) {
+        filtered[i] = baseline[i] = 0;
+    }
+    if (lick_health[sensor].status != LICK_SENSOR_OK) {
+        return;
+    }
+    int ret = sensor_read_regs(sensor, RAW_FILTERED_REG, buf,
+                               2 * LICK_N_ELECTRODES);
+    if (ret != 2 * LICK_N_ELECTRODES) {
+        sensor_error(sensor, ret);
+        return;
+    }
+    for (uint8_t i = 0; i < LICK_N_ELECTRODES; i++) {
+        filtered[i] = (buf[2 * i] | (buf[2 * i + 1] << 8)) & 0x3ff;
+    }
+    ret = sensor_read_regs(sensor, RAW_BASELINE_REG, buf,
+                           LICK_N_ELECTRODES);
+    if (ret != LICK_N_ELECTRODES) {
+        sensor_error(sensor, ret);
+        return;
+    }
+    for (uint8_t i = 0; i < LICK_N_ELECTRODES; i++) {
+        baseline[i] = buf[i] << 2;
+    }
+}
@@ -0,0 +1,108 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_sensor.h
+
+   Set up and read the MPR121 touch sensors, and keep them working.
+
+   Every read of a sensor is checked. A sensor whose reads fail
+   LICK_I2C_MAX_ERRORS times in a row (e.g. because it was disconnected
+   or lost power) is marked as failed, reads as not touched, and is
+   reinitialised every LICK_REINIT_INTERVAL_MS until it responds again,
+   with the register settings read back from it at boot; the other
+   sensors keep being read in the meantime. A sensor that does not
+   answer at boot is left failed. If a transaction times out or a line
+   of the bus is found stuck low, the bus is recovered by clocking out
+   whatever a sensor was sending, and the I2C controller is reset.
+ */
+
+#ifndef LICK_SENSOR_H
+#define LICK_SENSOR_H
+
+#include "pico/stdlib.h"
+
+/* Requires the pico-mpr121 libary which is available at
+ * https://github.com/antgon/pico-mpr121
+ */
+#include "mpr121.h"
+
+#include "lick_config.h"
+
+enum lick_sensor_status {
+    LICK_SENSOR_OK = 0,
+    LICK_SENSOR_FAILED
+};
+
+/* Health events, set in `events` by lick_sensors_read */
+#define LICK_HEALTH_FAILED (1u << 0)     // Sensor stopped responding
+#define LICK_HEALTH_RECOVERED (1u << 1)  // Sensor reinitialised
+#define LICK_HEALTH_OOR (1u << 2)        // Out-of-range status changed
+
+struct lick_sensor_health {
+    uint8_t status;
+    uint8_t events;
+    uint8_t n_consecutive_errors;
+    uint16_t oor;              // Electrodes that are out of range
+    uint32_t n_errors;         // Failed I2C transactions
+    uint32_t n_reinits;        // Successful reinitialisations
+    uint32_t recovery_us;      // Duration of the last attempt
+    uint32_t recovery_step_us_max;  // Longest time added to a sample
+    absolute_time_t next_attempt;
+};
+
+extern struct mpr121_sensor lick_mpr121[LICK_N_SENSORS];
+extern const uint8_t lick_sensor_addresses[LICK_N_SENSORS];
+extern struct lick_sensor_health lick_health[LICK_N_SENSORS];
+extern uint32_t lick_bus_recoveries;
+
+/* Initialise the I2C port and all touch sensors, and apply the sensor
+ * settings defined in lick_config.h.
+ */
+void lick_sensors_init(void);
+
+/* Read the touch status of the sensors in `mask` (bit n for sensor n).
+ * Failed sensors, and those not in `mask`, are not read, and read as
+ * not touched. Each read takes at most 2 * LICK_I2C_TIMEOUT_US, plus
+ * ~100 us if the bus has to be recovered.
+ *
+ * Returns a mask with bit n set if there are health events for sensor
+ * n in lick_health[n].events, which stay set until the caller clears
+ * them.
+ */
+uint8_t lick_sensors_read(uint16_t *touched, uint8_t mask);
+
+/* Go on reinitialising a failed sensor, if there is one and it is time
+ * to. Call this after all the outputs of every sample have been
+ * written. A sensor is reset and configured over a few tens of samples,
+ * with one register write per sample, so this adds at most
+ * LICK_I2C_TIMEOUT_US (plus ~100 us if the bus has to be recovered) to
+ * a sample; an attempt stops at the first write that fails. The time
+ * from the reset to the end of the attempt is kept in `recovery_us`,
+ * and the longest time added to a sample in `recovery_step_us_max`.
+ */
+void lick_sensors_recover(void);
+
+/* Copy the health of `sensor` to `copy` and clear its events, in one
+ * step with respect to the updates made while reading the sensors,
+ * which may be on the other core.
+ */
+void lick_sensor_health_take(uint8_t sensor,
+        struct lick_sensor_health *copy);
+
+/* Read the filtered and baseline values of all enabled electrodes in
+ * one sensor. The values of a failed sensor, or of a failed read, are
+ * 0.
+ */
+void lick_sensor_read_raw(uint8_t sensor, uint16_t *filtered,
+        uint16_t *baseline);
+
+#endif
@@ -0,0 +1,169 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include "hardware/sync.h"
+
+#include "lick_sensor.h"
+#include "lick_snippet.h"
+
+#if LICK_SNIPPET
+
+/* Samples kept: enough for the whole window of an onset reported late
+ * by the lick event filter. Must be a power of 2.
+ */
+#define RING_LEN 64
+
+/* Snippets waiting for their last sample: enough for every electrode
+ * starting a lick in the same sample, as in an artifact.
+ */
+#define MAX_PENDING (LICK_N_SENSORS * LICK_N_ELECTRODES)
+
+struct pending {
+    uint32_t event;
+    uint32_t onset;             // Sample number of the onset
+    uint16_t baseline;
+    uint8_t sensor;
+    uint8_t electrode;
+};
+
+/* A complete snippet, as printed. */
+struct snippet {
+    uint32_t event;
+    uint16_t baseline;
+    uint8_t sensor;
+    uint8_t electrode;
+    uint8_t pre;
+    uint8_t len;
+    int16_t delta[LICK_SNIPPET_PRE + LICK_SNIPPET_POST + 1];
+};
+
+volatile uint32_t lick_snippet_dropped = 0;
+static uint32_t dropped_reported = 0;
+
+#if LICK_SAMPLING_CORE1
+/* Complete snippets waiting for the main loop: enough for every
+ * electrode at once. The sample, on core 1, is the only writer of
+ * `head`, and the main loop, on core 0, the only writer of `tail`; the
+ * fences are as in lick_events.c. Must be a power of 2.
+ */
+#define QUEUE_LEN 32
+static struct snippet queue[QUEUE_LEN];
+static volatile uint32_t head = 0;
+static volatile uint32_t tail = 0;
+#endif
+
+static uint16_t filtered[RING_LEN][LICK_N_SENSORS][LICK_N_ELECTRODES];
+static uint16_t baseline[LICK_N_SENSORS][LICK_N_ELECTRODES];
+static uint32_t n_samples = 0;  // Number of the next sample
+static struct pending pending[MAX_PENDING];
+static uint8_t n_pending = 0;
+
+void lick_snippet_sample(void) {
+    uint16_t (*frame)[LICK_N_ELECTRODES] = filtered[n_samples % RING_LEN];
+    for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+        lick_sensor_read_raw(i, frame[i], baseline[i]);
+    }
+    n_samples++;
+}
+
+void lick_snippet_onset(uint32_t event, const uint16_t *onset,
+        uint8_t delay) {
+    uint32_t sample = n_samples - 1 - delay;
+    for (uint8_t i = 0; i < LICK_N_SENSORS; i++) {
+        for (uint8_t e = 0; e < LICK_N_ELECTRODES; e++) {
+            if (!((onset[i] >> e) & 1u)) {
+                continue;
+            }
+            if (n_pending == MAX_PENDING) {
+                lick_snippet_dropped++;
+                continue;
+            }
+            pending[n_pending++] = (struct pending){event, sample,
+                baseline[i][e], i, e};
+        }
+    }
+}
+
+static void snippet_print(const struct snippet *sn) {
+    printf("# snippet %lu %u %u %u %u", (unsigned long)sn->event,
+           sn->sensor, sn->electrode, sn->pre, sn->baseline);
+    for (uint8_t n = 0; n < sn->len; n++) {
+        printf(" %d", sn->delta[n]);
+    }
+    printf("\n");
+}
+
+static void dropped_report(void) {
+    uint32_t dropped = lick_snippet_dropped;
+    if (dropped != dropped_reported) {
+        printf("# snippet dropped %lu\n", (unsigned long)dropped);
+        dropped_reported = dropped;
+    }
+}
+
+void lick_snippet_report(void) {
+    uint8_t kept = 0;
+    for (uint8_t k = 0; k < n_pending; k++) {
+        struct pending *p = &pending[k];
+        // The first samples after start-up have no pre-onset values.
+        uint32_t first = p->onset >= LICK_SNIPPET_PRE ?
+            p->onset - LICK_SNIPPET_PRE : 0;
+        uint32_t last = p->onset + LICK_SNIPPET_POST;
+        if (last >= n_samples) {
+            pending[kept++] = *p;
+            continue;
+        }
+#if LICK_SAMPLING_CORE1
+        if (head - tail == QUEUE_LEN) {
+            lick_snippet_dropped++;
+            continue;
+        }
+        __mem_fence_acquire();
+        struct snippet *sn = &queue[head % QUEUE_LEN];
+#else
+        struct snippet snippet;
+        struct snippet *sn = &snippet;
+#endif
+        *sn = (struct snippet){p->event, p->baseline, p->sensor,
+            p->electrode, (uint8_t)(p->onset - first), 0, {0}};
+        for (uint32_t n = first; n <= last; n++) {
+            sn->delta[sn->len++] = (int16_t)((int)p->baseline -
+                (int)filtered[n % RING_LEN][p->sensor][p->electrode]);
+        }
+#if LICK_SAMPLING_CORE1
+        __mem_fence_release();
+        head = head + 1;
+#else
+        snippet_print(sn);
+#endif
+    }
+    n_pending = kept;
+#if !LICK_SAMPLING_CORE1
+    dropped_report();
+#endif
+}
+
+#if LICK_SAMPLING_CORE1
+void lick_snippet_task(void) {
+    while (tail != head) {
+        __mem_fence_acquire();
+        snippet_print(&queue[tail % QUEUE_LEN]);
+        // Only now can the sample reuse the entry.
+        __mem_fence_release();
+        tail = tail + 1;
+    }
+    dropped_report();
+}
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_snippet.h
+
+   Waveform snippets around lick onsets.
+
+   The filtered and baseline values of every electrode are kept for the
+   last few samples. For every electrode where a lick event starts, the
+   filtered values from LICK_SNIPPET_PRE samples before the onset to
+   LICK_SNIPPET_POST samples after it are printed, once the last of them
+   has been read, as one line
+
+     # snippet <event count> <sensor> <electrode> <pre> <baseline>
+       <delta> ...
+
+   (all in one line), where <event count> is that of the lick event,
+   <pre> is the number of samples before the onset, <baseline> is the
+   baseline value of the electrode at the onset, and each <delta> is
+   the baseline minus the filtered value of one sample, i.e. the
+   quantity that is compared with the touch and release thresholds.
+
+   Snippets are printed as comments so that the lick events readers
+   save them in the session file, next to the events. If more snippets
+   are waiting than there are electrodes (or, when sampling on core 1,
+   more than 32 complete ones are waiting for the main loop to print
+   them), the new ones are dropped, and the total dropped so far is
+   printed as `# snippet dropped <count>`.
+ */
+
+#ifndef LICK_SNIPPET_H
+#define LICK_SNIPPET_H
+
+#include "pico/stdlib.h"
+
+#include "lick_config.h"
+
+#if LICK_SNIPPET
+
+/* Snippets that could not be printed because too many were waiting */
+extern volatile uint32_t lick_snippet_dropped;
+
+/* Read the filtered and baseline values of this sample. Call at every
+ * sample, after the touch status has been read.
+ */
+void lick_snippet_sample(void);
+
+/* Start snippets for the electrodes with a lick onset in `onset` (one
+ * mask per sensor) in lick event `event`. Its onset was `delay` samples
+ * before the current one.
+ */
+void lick_snippet_onset(uint32_t event, const uint16_t *onset,
+        uint8_t delay);
+
+/* Print the snippets that are complete. Call from the sample, after
+ * its lick events. When sampling on core 1 (LICK_SAMPLING_CORE1), they
+ * are only queued, for lick_snippet_task.
+ */
+void lick_snippet_report(void);
+
+#if LICK_SAMPLING_CORE1
+/* Print the queued snippets. Call from the main loop. */
+void lick_snippet_task(void);
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,222 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+
+#include "lick_sync.h"
+
+#if LICK_SYNC
+
+#define SAMPLE_US (LICK_SAMPLING_INTERVAL_MS * 1000)
+
+/* Edges waiting for the next sample. In lock mode there is one edge
+ * every LICK_SYNC_IN_SAMPLES samples; in stamp mode, edges faster than
+ * this many per sample are counted as lost. Must be a power of 2.
+ */
+#define EDGE_QUEUE_LEN 8
+
+/* Lock mode: edge periods more than 10% away from the nominal one are
+ * taken as glitches or missed edges and not followed; the lock is good
+ * when the phase is within LOCK_TOLERANCE_US.
+ */
+#define SYNC_IN_PERIOD_US ((uint64_t)SAMPLE_US * LICK_SYNC_IN_SAMPLES)
+#define LOCK_TOLERANCE_US 50
+
+struct lick_sync_stats lick_sync;
+
+#if LICK_SYNC_IN
+static volatile uint64_t edge_us[EDGE_QUEUE_LEN];
+static volatile uint32_t edge_head = 0;
+static volatile uint32_t edge_tail = 0;
+static uint64_t last_sample_us = 0;
+static uint64_t last_edge_us = 0;
+
+static void sync_in_irq(uint gpio, uint32_t events) {
+    uint64_t t = time_us_64();
+    if (gpio != LICK_SYNC_IN_PIN || !(events & GPIO_IRQ_EDGE_RISE)) {
+        return;
+    }
+    if (edge_head - edge_tail < EDGE_QUEUE_LEN) {
+        edge_us[edge_head % EDGE_QUEUE_LEN] = t;
+        // The sample may run on the other core (lick_sampler.h).
+        __mem_fence_release();
+        edge_head++;
+    } else {
+        lick_sync.n_in_lost++;
+    }
+}
+#endif
+
+#if LICK_SINK_USB
+/* Edges and pulses waiting to be printed. The sample is the only writer
+ * of `report_head`, and lick_sync_report the only writer of
+ * `report_tail`, which may run on the other core (lick_sampler.h); the
+ * fences are as in lick_events.c. Must be a power of 2.
+ */
+#define REPORT_QUEUE_LEN 32
+
+struct sync_report {
+    bool out;                   // A pulse sent, or an edge received
+    uint32_t n;
+    uint64_t t_us;
+    int32_t phase_us;
+};
+
+static struct sync_report reports[REPORT_QUEUE_LEN];
+static volatile uint32_t report_head = 0;
+static volatile uint32_t report_tail = 0;
+static volatile uint32_t reports_dropped = 0;
+static uint32_t dropped_reported = 0;
+
+static void report_push(bool out, uint32_t n, uint64_t t_us,
+                        int32_t phase_us) {
+    if (report_head - report_tail == REPORT_QUEUE_LEN) {
+        reports_dropped++;
+        return;
+    }
+    __mem_fence_acquire();
+    reports[report_head % REPORT_QUEUE_LEN] = (struct sync_report){out, n,
+        t_us, phase_us};
+    __mem_fence_release();
+    report_head = report_head + 1;
+}
+#endif
+
+#if LICK_SYNC_IN_LOCK
+// Sampling interval in 1/256 us, and the fraction of a us carried over
+// from one sample to the next.
+static uint32_t interval_q8 = (uint32_t)SAMPLE_US << 8;
+static uint32_t interval_frac = 0;
+static int32_t correction_us = 0;
+
+static void lock_update(uint64_t t_edge, int32_t phase) {
+    if (last_edge_us) {
+        uint64_t period = t_edge - last_edge_us;
+        if (period > SYNC_IN_PERIOD_US - SYNC_IN_PERIOD_US / 10 &&
+                period < SYNC_IN_PERIOD_US + SYNC_IN_PERIOD_US / 10) {
+            int32_t measured = (int32_t)((period << 8) /
+                                         LICK_SYNC_IN_SAMPLES);
+            interval_q8 += (measured - (int32_t)interval_q8) / 4;
+        }
+    }
+    // A positive phase means that the samples are late: shorten the
+    // next interval by half of it.
+    correction_us = -phase / 2;
+    lick_sync.locked = abs(phase) <= LOCK_TOLERANCE_US;
+}
+
+int64_t lick_sync_next_interval_us(void) {
+    interval_frac += interval_q8 & 0xff;
+    int64_t us = (interval_q8 >> 8) + (interval_frac >> 8);
+    interval_frac &= 0xff;
+    us += correction_us;
+    correction_us = 0;
+    if (us < SAMPLE_US / 2) {
+        us = SAMPLE_US / 2;
+    } else if (us > 2 * SAMPLE_US) {
+        us = 2 * SAMPLE_US;
+    }
+    return us;
+}
+#endif
+
+#if LICK_SYNC_OUT
+static uint32_t out_count = 0;
+#endif
+
+void lick_sync_init(void) {
+#if LICK_SYNC_OUT
+    gpio_init(LICK_SYNC_OUT_PIN);
+    gpio_set_dir(LICK_SYNC_OUT_PIN, GPIO_OUT);
+    gpio_put(LICK_SYNC_OUT_PIN, 0);
+#endif
+#if LICK_SYNC_IN
+    // Pulled down so that an unconnected input gives no edges.
+    gpio_init(LICK_SYNC_IN_PIN);
+    gpio_set_dir(LICK_SYNC_IN_PIN, GPIO_IN);
+    gpio_pull_down(LICK_SYNC_IN_PIN);
+    gpio_set_irq_enabled_with_callback(LICK_SYNC_IN_PIN,
+        GPIO_IRQ_EDGE_RISE, true, sync_in_irq);
+#endif
+}
+
+void lick_sync_sample(uint64_t sample_us) {
+#if LICK_SYNC_OUT
+    if (out_count == 0) {
+        gpio_put(LICK_SYNC_OUT_PIN, 1);
+        lick_sync.n_out++;
+#if LICK_SINK_USB
+        report_push(true, lick_sync.n_out, sample_us, 0);
+#endif
+    } else if (out_count == 1) {
+        gpio_put(LICK_SYNC_OUT_PIN, 0);
+    }
+    if (++out_count == LICK_SYNC_OUT_SAMPLES) {
+        out_count = 0;
+    }
+#endif
+#if LICK_SYNC_IN
+    // The edge queue has one writer (the GPIO interrupt) and one reader
+    // (this), so it needs no lock.
+    while (edge_tail != edge_head) {
+        __mem_fence_acquire();
+        uint64_t t = edge_us[edge_tail % EDGE_QUEUE_LEN];
+        edge_tail++;
+        // Phase relative to the nearest sample: this one, or the last
+        // one if the edge was closer to it.
+        int64_t after = (int64_t)(sample_us - t);
+        int64_t before = (int64_t)(t - last_sample_us);
+        int32_t phase = (int32_t)(after <= before || !last_sample_us ?
+                                  after : -before);
+        lick_sync.n_in++;
+        lick_sync.phase_us = phase;
+#if LICK_SYNC_IN_LOCK
+        lock_update(t, phase);
+#endif
+        last_edge_us = t;
+#if LICK_SINK_USB
+        report_push(false, lick_sync.n_in, t, phase);
+#endif
+    }
+    last_sample_us = sample_us;
+#endif
+}
+
+#if LICK_SINK_USB
+void lick_sync_report(void) {
+    while (report_tail != report_head) {
+        __mem_fence_acquire();
+        const struct sync_report *r =
+            &reports[report_tail % REPORT_QUEUE_LEN];
+        if (r->out) {
+            printf("# sync out %lu %llu\n", (unsigned long)r->n,
+                   (unsigned long long)r->t_us);
+        } else {
+            printf("# sync in %lu %llu %ld\n", (unsigned long)r->n,
+                   (unsigned long long)r->t_us, (long)r->phase_us);
+        }
+        // Only now can the sample reuse the entry.
+        __mem_fence_release();
+        report_tail = report_tail + 1;
+    }
+    uint32_t dropped = reports_dropped;
+    if (dropped != dropped_reported) {
+        printf("# sync dropped %lu\n", (unsigned long)dropped);
+        dropped_reported = dropped;
+    }
+}
+#endif
+
+#endif
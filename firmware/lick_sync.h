@@ -0,0 +1,85 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_sync.h
+
+   Sync input and output, to align the samples with other recordings.
+
+   The time of every rising edge on the sync input is captured by a GPIO
+   interrupt, and handed to the next sample. There it is queued to be
+   printed (by the sample itself, or by the main loop when sampling on
+   core 1), together with its phase: how long after (or, if negative,
+   before) the edge the nearest sample was taken. In lock mode
+   the sampling interval is also adjusted so that the phase is kept
+   near 0 (see lick_sync_next_interval_us).
+
+   The sync output goes high at the start of every
+   LICK_SYNC_OUT_SAMPLES-th sample, before the sensors are read, and
+   low at the next sample; its edges are therefore sample times.
+
+   All times are in us from the same clock as the timestamps of lick
+   events (which are in ms).
+ */
+
+#ifndef LICK_SYNC_H
+#define LICK_SYNC_H
+
+#include "pico/stdlib.h"
+
+#include "lick_config.h"
+
+#if LICK_SYNC
+
+struct lick_sync_stats {
+    uint32_t n_in;              // Edges received
+    uint32_t n_in_lost;         // Edges not processed in time
+    uint32_t n_out;             // Pulses sent
+    int32_t phase_us;           // Phase of the last edge
+    bool locked;                // Lock mode: |phase| small enough
+};
+
+extern struct lick_sync_stats lick_sync;
+
+/* Set up the sync pins. */
+void lick_sync_init(void);
+
+/* Call first thing at every sample, with the time of the sample: sets
+ * the sync output, and takes in the edges received since the last
+ * sample.
+ */
+void lick_sync_sample(uint64_t sample_us);
+
+#if LICK_SYNC_IN_LOCK
+/* Interval, in us, until the next sample. It follows the period of the
+ * sync input (divided by LICK_SYNC_IN_SAMPLES), plus a correction of
+ * half of the phase of the last edge; it stays at the last value if the
+ * input stops.
+ */
+int64_t lick_sync_next_interval_us(void);
+#endif
+
+#if LICK_SINK_USB
+/* Print the sync edges and pulses taken in by the samples since the
+ * last call, as lines
+ *   # sync in <count> <time, us> <phase, us>
+ *   # sync out <count> <time, us>
+ * Call from the sample, after its outputs have been written, or, when
+ * sampling on core 1 (LICK_SAMPLING_CORE1), from the main loop. Up to
+ * 32 can wait; any more are dropped, and the total dropped so far is
+ * printed as `# sync dropped <count>`.
+ */
+void lick_sync_report(void);
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,221 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lick_usb.h"
+
+#if LICK_RAW_USB_VENDOR
+
+#include "pico/stdlib.h"
+#include "pico/stdio/driver.h"
+#include "pico/unique_id.h"
+#include "tusb.h"
+
+/* USB descriptors
+ * Interfaces 0 and 1 are the serial port (CDC), and interface 2 the
+ * vendor-class interface with the raw data. Endpoint numbers are those
+ * used by host/tools/lick_usb_read.
+ */
+enum {
+    ITF_CDC_COMM = 0,
+    ITF_CDC_DATA,
+    ITF_VENDOR,
+    ITF_TOTAL
+};
+
+#define EP_CDC_NOTIF 0x81
+#define EP_CDC_OUT 0x02
+#define EP_CDC_IN 0x82
+#define EP_VENDOR_OUT 0x03
+#define EP_VENDOR_IN 0x83
+
+// Full speed: 64-byte packets on bulk endpoints.
+#define EP_SIZE 64
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN + \
+                          TUD_VENDOR_DESC_LEN)
+
+enum {
+    STR_LANGID = 0,
+    STR_MANUFACTURER,
+    STR_PRODUCT,
+    STR_SERIAL,
+    STR_CDC,
+    STR_VENDOR,
+    STR_TOTAL
+};
+
+static const tusb_desc_device_t device_desc = {
+    .bLength = sizeof(tusb_desc_device_t),
+    .bDescriptorType = TUSB_DESC_DEVICE,
+    .bcdUSB = 0x0200,
+    // Interface association, required for CDC in a composite device.
+    .bDeviceClass = TUSB_CLASS_MISC,
+    .bDeviceSubClass = MISC_SUBCLASS_COMMON,
+    .bDeviceProtocol = MISC_PROTOCOL_IAD,
+    .bMaxPacketSize0 = CFG_TUD_ENDPOINT0_SIZE,
+    .idVendor = LICK_USB_VID,
+    .idProduct = LICK_USB_PID,
+    .bcdDevice = 0x0100,
+    .iManufacturer = STR_MANUFACTURER,
+    .iProduct = STR_PRODUCT,
+    .iSerialNumber = STR_SERIAL,
+    .bNumConfigurations = 1
+};
+
+static const uint8_t config_desc[] = {
+    TUD_CONFIG_DESCRIPTOR(1, ITF_TOTAL, 0, CONFIG_TOTAL_LEN, 0, 100),
+    TUD_CDC_DESCRIPTOR(ITF_CDC_COMM, STR_CDC, EP_CDC_NOTIF, 8,
+                       EP_CDC_OUT, EP_CDC_IN, EP_SIZE),
+    TUD_VENDOR_DESCRIPTOR(ITF_VENDOR, STR_VENDOR, EP_VENDOR_OUT,
+                          EP_VENDOR_IN, EP_SIZE)
+};
+
+static const char *const strings[STR_TOTAL] = {
+    [STR_MANUFACTURER] = "Lick sensor",
+    [STR_PRODUCT] = LICK_VARIANT_NAME,
+    [STR_CDC] = "Lick sensor serial",
+    [STR_VENDOR] = "Lick sensor raw data"
+};
+
+static char serial[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+
+const uint8_t *tud_descriptor_device_cb(void) {
+    return (const uint8_t *)&device_desc;
+}
+
+const uint8_t *tud_descriptor_configuration_cb(uint8_t index) {
+    (void)index;
+    return config_desc;
+}
+
+const uint16_t *tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+    // UTF-16 with a 2-byte header; strings here are ASCII.
+    static uint16_t desc[32];
+    (void)langid;
+    uint8_t len;
+    if (index == STR_LANGID) {
+        desc[1] = 0x0409;   // English
+        len = 1;
+    } else if (index < STR_TOTAL) {
+        const char *s = index == STR_SERIAL ? serial : strings[index];
+        for (len = 0; s[len] && len < 31; len++) {
+            desc[1 + len] = (uint8_t)s[len];
+        }
+    } else {
+        return NULL;
+    }
+    desc[0] = (uint16_t)((TUSB_DESC_STRING << 8) | (2 * len + 2));
+    return desc;
+}
+
+/* stdio over the serial port
+ * Text is written straight into the CDC buffer. If it is full, the USB
+ * stack is run until there is space, for at most CDC_TIMEOUT_US, so that
+ * a host that is not reading does not stop the firmware.
+ */
+#define CDC_TIMEOUT_US 10000
+
+static void cdc_out_chars(const char *buf, int len) {
+    if (!tud_cdc_connected()) {
+        return;
+    }
+    uint32_t start = time_us_32();
+    while (len > 0) {
+        uint32_t n = tud_cdc_write(buf, (uint32_t)len);
+        buf += n;
+        len -= (int)n;
+        if (len > 0) {
+            tud_task();
+            if (time_us_32() - start > CDC_TIMEOUT_US) {
+                break;
+            }
+        }
+    }
+    tud_cdc_write_flush();
+}
+
+static void cdc_out_flush(void) {
+    tud_cdc_write_flush();
+}
+
+static int cdc_in_chars(char *buf, int len) {
+    if (!tud_cdc_available()) {
+        return PICO_ERROR_NO_DATA;
+    }
+    return (int)tud_cdc_read(buf, (uint32_t)len);
+}
+
+static stdio_driver_t cdc_stdio = {
+    .out_chars = cdc_out_chars,
+    .out_flush = cdc_out_flush,
+    .in_chars = cdc_in_chars,
+    .crlf_enabled = PICO_STDIO_DEFAULT_CRLF
+};
+
+/* Raw data blocks waiting to be sent; the first is being sent. */
+struct vendor_block {
+    const uint8_t *data;
+    size_t len;
+};
+static struct vendor_block queue[2];
+static uint8_t n_queued = 0;
+static size_t sent = 0;
+
+void lick_usb_init(void) {
+    pico_get_unique_board_id_string(serial, sizeof(serial));
+    tusb_init();
+    stdio_set_driver_enabled(&cdc_stdio, true);
+}
+
+bool lick_usb_vendor_can_send(void) {
+    return n_queued < 2;
+}
+
+bool lick_usb_vendor_send(const uint8_t *data, size_t len) {
+    if (n_queued == 2) {
+        return false;
+    }
+    queue[n_queued++] = (struct vendor_block){data, len};
+    return true;
+}
+
+void lick_usb_task(void) {
+    tud_task();
+    if (n_queued == 0) {
+        return;
+    }
+    if (!tud_vendor_mounted()) {
+        // Nobody to send to: drop the blocks, as with a full queue.
+        n_queued = 0;
+        sent = 0;
+        return;
+    }
+    // Copy as much as fits into the endpoint buffer; TinyUSB sends it
+    // in the background while the next block is being collected.
+    uint32_t space = tud_vendor_write_available();
+    if (space == 0) {
+        return;
+    }
+    size_t n = queue[0].len - sent;
+    if (n > space) {
+        n = space;
+    }
+    sent += tud_vendor_write(queue[0].data + sent, (uint32_t)n);
+    tud_vendor_write_flush();
+    if (sent == queue[0].len) {
+        queue[0] = queue[1];
+        n_queued--;
+        sent = 0;
+    }
+}
+
+#endif
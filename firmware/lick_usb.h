@@ -0,0 +1,61 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_usb.h
+
+   Composite USB device for raw data streaming (LICK_RAW_USB_VENDOR).
+
+   The Pico shows up as a serial port (CDC), which stdio uses as usual
+   for text, and a vendor-class interface with a pair of bulk
+   endpoints. The compressed raw data blocks (see common/lick_codec.h)
+   are sent on the bulk IN endpoint, without going through stdio. They
+   are read on the host with host/tools/lick_usb_read.
+
+   The USB stack (TinyUSB) is run from the main loop by lick_usb_task,
+   and all output to USB, text or binary, must be written from the main
+   loop too. Blocks are queued by reference: up to two can be waiting
+   to be sent, so that one block can be encoded while the previous one
+   is still going out.
+ */
+
+#ifndef LICK_USB_H
+#define LICK_USB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lick_config.h"
+
+#if LICK_RAW_USB_VENDOR
+
+/* Start the USB device, and send stdio to its serial port. */
+void lick_usb_init(void);
+
+/* Run the USB stack and send whatever fits of the queued blocks. Call
+ * at every iteration of the main loop.
+ */
+void lick_usb_task(void);
+
+/* True if a block can be queued. */
+bool lick_usb_vendor_can_send(void);
+
+/* Queue `len` bytes for the bulk IN endpoint. `data` must not change
+ * until it has been sent: with two buffers used in turn, the one that
+ * was not queued last is free whenever lick_usb_vendor_can_send() is
+ * true. Returns false, and drops the block, if the queue is full.
+ */
+bool lick_usb_vendor_send(const uint8_t *data, size_t len);
+
+#endif
+
+#endif
@@ -0,0 +1,275 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* bench_adaptive.c
+
+   I2C bus use and onset timing error of adaptive sampling (see
+   common/lick_adaptive.h), compared with sampling at a fixed rate.
+
+   Usage:
+     bench_adaptive [-d days] [-b bouts_per_day]
+
+   Licking on the 24 electrodes of two sensors is simulated for `days`
+   (default 1): on each electrode, ~`bouts_per_day` (default 100) bouts
+   at random times, of 10 to 70 licks at ~7 Hz with contacts of 30 to
+   60 ms. Each schedule then reads the sensors as the firmware would,
+   with lick_adaptive.h deciding which sensors to read at each sample,
+   and every onset is timed from the start of its contact until the
+   first read that sees it; contacts that no read sees are missed.
+
+   Bus time counts the touch status reads only (63 bits at 400 kHz,
+   ~160 us each), not the sensor's own sampling and filtering. On the
+   Pico the reads are blocking, so the bus time is also time that the
+   CPU spends in the timer callback.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lick_adaptive.h"
+
+#define N_SENSORS 2
+#define N_ELECTRODES 12
+#define READ_US (63 * 1e6 / 400000)
+#define DAY_US (86400 * 1000000LL)
+
+struct event {
+    int64_t t_us;
+    uint8_t electrode;
+    uint8_t on;
+};
+
+/* Touch onsets and offsets of one sensor, in time order. */
+struct trace {
+    struct event *events;
+    size_t n_events;
+    size_t n_contacts;
+};
+
+struct schedule {
+    const char *name;
+    uint32_t interval_us;
+    uint32_t idle_samples;
+    uint32_t hold_ms;
+};
+
+/* Small deterministic PRNG so that runs are comparable. */
+static uint32_t rng_state = 12345;
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double uniform(void) {
+    return (rng() + 0.5) / 4294967296.0;
+}
+
+static int compare_events(const void *a, const void *b) {
+    const struct event *x = a;
+    const struct event *y = b;
+    return (x->t_us > y->t_us) - (x->t_us < y->t_us);
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static int make_trace(struct trace *tr, int64_t duration_us,
+                      double bouts_per_day) {
+    size_t cap = 1024;
+    tr->events = malloc(cap * sizeof(*tr->events));
+    tr->n_events = 0;
+    tr->n_contacts = 0;
+    if (tr->events == NULL) {
+        return -1;
+    }
+    double mean_gap_us = DAY_US / bouts_per_day;
+    for (uint8_t e = 0; e < N_ELECTRODES; e++) {
+        int64_t t = 0;
+        while (1) {
+            t += (int64_t)(-log(uniform()) * mean_gap_us);
+            if (t >= duration_us) {
+                break;
+            }
+            int n_licks = 10 + (int)(rng() % 61);
+            for (int k = 0; k < n_licks; k++) {
+                int64_t contact = 30000 + rng() % 30001;
+                if (tr->n_events + 2 > cap) {
+                    cap *= 2;
+                    struct event *p = realloc(tr->events,
+                                              cap * sizeof(*p));
+                    if (p == NULL) {
+                        return -1;
+                    }
+                    tr->events = p;
+                }
+                tr->events[tr->n_events++] = (struct event){t, e, 1};
+                tr->events[tr->n_events++] =
+                    (struct event){t + contact, e, 0};
+                tr->n_contacts++;
+                t += 125000 + rng() % 30001;
+            }
+        }
+    }
+    qsort(tr->events, tr->n_events, sizeof(*tr->events), compare_events);
+    return 0;
+}
+
+/* Touch state of one sensor as the reads see it. */
+struct reader {
+    size_t next;                // Next event to apply
+    uint16_t touched;
+    uint16_t unseen;            // Contacts not yet seen by a read
+    int64_t onset_us[N_ELECTRODES];
+};
+
+/* Apply the events up to `t_us`, and return the touch status read at
+ * that time. The delays of the onsets seen are appended to `delays`.
+ */
+static uint16_t read_at(struct reader *r, const struct trace *tr,
+                        int64_t t_us, double *delays, size_t *n_delays,
+                        size_t *n_missed) {
+    while (r->next < tr->n_events && tr->events[r->next].t_us <= t_us) {
+        const struct event *ev = &tr->events[r->next++];
+        uint16_t bit = (uint16_t)(1u << ev->electrode);
+        if (ev->on) {
+            r->touched |= bit;
+            r->unseen |= bit;
+            r->onset_us[ev->electrode] = ev->t_us;
+        } else {
+            r->touched &= (uint16_t)~bit;
+            if (r->unseen & bit) {
+                (*n_missed)++;
+                r->unseen &= (uint16_t)~bit;
+            }
+        }
+    }
+    uint16_t seen = r->touched & r->unseen;
+    while (seen) {
+        uint8_t e = (uint8_t)__builtin_ctz(seen);
+        seen &= (uint16_t)(seen - 1);
+        delays[(*n_delays)++] = (t_us - r->onset_us[e]) / 1000.0;
+    }
+    r->unseen &= (uint16_t)~r->touched;
+    return r->touched;
+}
+
+static void run(const struct schedule *s, const struct trace *traces,
+                int64_t duration_us, double *delays) {
+    struct lick_adaptive a;
+    struct reader readers[N_SENSORS] = {{0}};
+    uint32_t hold = (s->hold_ms * 1000 + s->interval_us - 1) /
+        s->interval_us;
+    lick_adaptive_init(&a, N_SENSORS, hold);
+    uint64_t n_reads = 0;
+    uint64_t n_fast = 0;
+    size_t n_delays = 0;
+    size_t n_missed = 0;
+    uint64_t n_samples = (uint64_t)(duration_us / s->interval_us);
+    for (uint64_t k = 0; k < n_samples; k++) {
+        int64_t t_us = (int64_t)k * s->interval_us;
+        uint8_t read = lick_adaptive_plan(&a, N_SENSORS, s->idle_samples);
+        uint16_t touched[N_SENSORS] = {0};
+        for (uint8_t i = 0; i < N_SENSORS; i++) {
+            if (read & (1u << i)) {
+                touched[i] = read_at(&readers[i], &traces[i], t_us,
+                                     delays, &n_delays, &n_missed);
+                n_reads++;
+            }
+        }
+        n_fast += (uint64_t)__builtin_popcount(a.fast);
+        lick_adaptive_update(&a, touched, 0, read, N_SENSORS, hold);
+    }
+    // Contacts still unseen at the end are not counted as missed.
+
+    qsort(delays, n_delays, sizeof(*delays), compare_doubles);
+    double sum = 0;
+    for (size_t i = 0; i < n_delays; i++) {
+        sum += delays[i];
+    }
+    double seconds = duration_us / 1e6;
+    printf("%-22s %9.0f %6.2f %9.0f %6.1f %7.2f %7.2f %7.2f %7zu\n",
+           s->name, n_reads / seconds,
+           100.0 * n_reads * READ_US / (seconds * 1e6),
+           n_samples / seconds,
+           s->idle_samples > 1 ?
+               100.0 * n_fast / ((double)n_samples * N_SENSORS) : 100.0,
+           n_delays ? sum / n_delays : 0,
+           n_delays ? delays[(size_t)(0.99 * (n_delays - 1))] : 0,
+           n_delays ? delays[n_delays - 1] : 0, n_missed);
+}
+
+int main(int argc, char *argv[]) {
+    double days = 1;
+    double bouts_per_day = 100;
+    int opt;
+    while ((opt = getopt(argc, argv, "d:b:")) != -1) {
+        switch (opt) {
+            case 'd':
+                days = atof(optarg);
+                break;
+            case 'b':
+                bouts_per_day = atof(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: bench_adaptive [-d days] "
+                        "[-b bouts_per_day]\n");
+                return 1;
+        }
+    }
+    int64_t duration_us = (int64_t)(days * DAY_US);
+    struct trace traces[N_SENSORS];
+    size_t n_contacts = 0;
+    for (uint8_t i = 0; i < N_SENSORS; i++) {
+        if (make_trace(&traces[i], duration_us, bouts_per_day)) {
+            fprintf(stderr, "bench_adaptive: out of memory\n");
+            return 1;
+        }
+        n_contacts += traces[i].n_contacts;
+    }
+    double *delays = malloc(n_contacts * sizeof(*delays));
+    if (delays == NULL) {
+        fprintf(stderr, "bench_adaptive: out of memory\n");
+        return 1;
+    }
+
+    static const struct schedule schedules[] = {
+        {"fixed 50 Hz", 20000, 1, 0},
+        {"fixed 500 Hz", 2000, 1, 0},
+        {"fixed 1 kHz", 1000, 1, 0},
+        {"adaptive 500/50 Hz", 2000, 10, 1000},
+        {"adaptive 1 kHz/50 Hz", 1000, 20, 1000},
+        {"adaptive 1 kHz/20 Hz", 1000, 50, 1000},
+    };
+    printf("%zu electrodes, %.1f days, %zu contacts\n",
+           (size_t)N_SENSORS * N_ELECTRODES, days, n_contacts);
+    printf("%-22s %9s %6s %9s %6s %7s %7s %7s %7s\n", "schedule",
+           "reads/s", "bus%", "samples/s", "fast%", "mean_ms", "p99_ms",
+           "max_ms", "missed");
+    for (size_t i = 0; i < sizeof(schedules) / sizeof(schedules[0]);
+         i++) {
+        run(&schedules[i], traces, duration_us, delays);
+    }
+
+    for (uint8_t i = 0; i < N_SENSORS; i++) {
+        free(traces[i].events);
+    }
+    free(delays);
+    return 0;
+}
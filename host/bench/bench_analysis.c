@@ -0,0 +1,214 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* bench_analysis.c
+
+   Scaling of the lick microstructure analysis with the number of
+   threads.
+
+   Usage:
+     bench_analysis [-n n_sessions] [-j max_threads] [dir]
+
+   A synthetic corpus of `n_sessions` (default 1000) one-hour sessions
+   with 24 bottles is written to `dir` (created if it does not exist;
+   default: a new directory in /tmp, removed at the end) in the csv
+   format of lick_events_reader.py, and then analysed with 1, 2, 4, ...
+   up to `max_threads` (default: the number of cores) threads. The
+   corpus is read once before timing, so that the times are of the
+   analysis rather than of the disk.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lick_analysis.h"
+
+#define SESSION_MS (60 * 60 * 1000)
+#define N_BOTTLES 24
+#define MIN_RUN_SECONDS 1.0
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Small deterministic PRNG so that runs are comparable. */
+static uint32_t rng_state = 12345;
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* Write one synthetic session. Every minute or so the animal visits a
+ * bottle, chosen with a preference that differs between sessions, and
+ * licks at ~7 Hz in clusters of ~20 licks separated by short pauses.
+ */
+static int write_session(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    uint32_t weight[N_BOTTLES];
+    uint32_t total = 0;
+    for (int b = 0; b < N_BOTTLES; b++) {
+        weight[b] = 1 + rng() % 10;
+        total += weight[b];
+    }
+    fprintf(f, "# 2026-10-18 10:00:00\nidx,timestamp,sensorA,sensorB\n");
+    uint32_t idx = 0;
+    int64_t t = 0;
+    while (1) {
+        t += 20000 + rng() % 80000;
+        uint32_t r = rng() % total;
+        int bottle = 0;
+        while (r >= weight[bottle]) {
+            r -= weight[bottle++];
+        }
+        uint32_t mask = 1u << (bottle % 12);
+        int n_clusters = 1 + (int)(rng() % 6);
+        for (int c = 0; c < n_clusters; c++) {
+            int n_licks = 5 + (int)(rng() % 30);
+            for (int i = 0; i < n_licks; i++) {
+                t += 120 + rng() % 50;
+                if (t >= SESSION_MS) {
+                    fclose(f);
+                    return 0;
+                }
+                fprintf(f, "%u,%lld,%u,%u\n", idx++, (long long)t,
+                        bottle < 12 ? mask : 0, bottle < 12 ? 0 : mask);
+            }
+            t += 500 + rng() % 400;
+        }
+    }
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: bench_analysis [-n n_sessions] "
+            "[-j max_threads] [dir]\n");
+}
+
+int main(int argc, char *argv[]) {
+    size_t n_sessions = 1000;
+    long max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+    while ((opt = getopt(argc, argv, "n:j:")) != -1) {
+        switch (opt) {
+            case 'n':
+                n_sessions = (size_t)atol(optarg);
+                break;
+            case 'j':
+                max_threads = atol(optarg);
+                break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+    char tmp_dir[] = "/tmp/bench_analysis_XXXXXX";
+    const char *dir = optind < argc ? argv[optind] : mkdtemp(tmp_dir);
+    if (dir == NULL || n_sessions == 0 || max_threads < 1) {
+        usage();
+        return 1;
+    }
+    if (mkdir(dir, 0777) && errno != EEXIST) {
+        perror(dir);
+        return 1;
+    }
+
+    char **paths = malloc(n_sessions * sizeof(*paths));
+    struct lick_session *sessions = malloc(n_sessions * sizeof(*sessions));
+    struct lick_analysis_metrics *metrics = malloc(n_sessions *
+        LICK_ANALYSIS_MAX_ELECTRODES * sizeof(*metrics));
+    if (paths == NULL || sessions == NULL || metrics == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (size_t s = 0; s < n_sessions; s++) {
+        paths[s] = malloc(strlen(dir) + 32);
+        sprintf(paths[s], "%s/session_%04zu.csv", dir, s);
+        if (write_session(paths[s])) {
+            return 1;
+        }
+    }
+
+    struct lick_analysis_params params = LICK_ANALYSIS_DEFAULT_PARAMS;
+    printf("%zu sessions in %s\n", n_sessions, dir);
+    printf("threads  time (s)  sessions/s  speedup\n");
+    double t_single = 0;
+    size_t n_licks = 0;
+    // The untimed first run (n_threads 0) brings the files into the
+    // page cache.
+    for (long n_threads = 0; n_threads <= max_threads;
+         n_threads = n_threads ? 2 * n_threads : 1) {
+        double best = 1e9;
+        double elapsed = 0;
+        int n_runs = 0;
+        while (elapsed < MIN_RUN_SECONDS || n_runs < 2) {
+            memset(sessions, 0, n_sessions * sizeof(*sessions));
+            for (size_t s = 0; s < n_sessions; s++) {
+                sessions[s].path = paths[s];
+            }
+            double start = now_s();
+            if (lick_analysis_run(sessions, n_sessions, &params,
+                                  (unsigned)n_threads, metrics)) {
+                fprintf(stderr, "out of memory\n");
+                return 1;
+            }
+            double t = now_s() - start;
+            elapsed += t;
+            n_runs++;
+            if (t < best) {
+                best = t;
+            }
+            n_licks = 0;
+            for (size_t s = 0; s < n_sessions; s++) {
+                n_licks += lick_session_n_licks(&sessions[s]);
+                lick_session_free(&sessions[s]);
+            }
+            if (n_threads == 0) {
+                break;
+            }
+        }
+        if (n_threads == 0) {
+            continue;
+        }
+        if (n_threads == 1) {
+            t_single = best;
+        }
+        printf("%7ld  %8.3f  %10.0f  %7.2f\n", n_threads, best,
+               n_sessions / best, t_single / best);
+    }
+    printf("%zu licks per run\n", n_licks);
+
+    if (optind >= argc) {
+        for (size_t s = 0; s < n_sessions; s++) {
+            remove(paths[s]);
+        }
+        rmdir(dir);
+    }
+    for (size_t s = 0; s < n_sessions; s++) {
+        free(paths[s]);
+    }
+    free(paths);
+    free(sessions);
+    free(metrics);
+    return 0;
+}
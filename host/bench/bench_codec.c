@@ -0,0 +1,268 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* bench_codec.c
+
+   Compression ratio and throughput of the raw data block codec.
+
+   Usage:
+     bench_codec [-b block_len] [trace.txt]
+
+   With no trace file, a synthetic 24-electrode trace (filtered and
+   baseline values, 48 channels) is generated. A trace file is a text
+   file with one sample per line and one value per channel, separated by
+   spaces, e.g. the output of `utils/test-sensor-settings` or of
+   `lick_decode`. Non-numeric lines are ignored.
+
+   The compressed size is compared with the same data sent as 16-bit
+   binary values and as text (space-separated decimal numbers, one line
+   per sample, as the firmware `printf`s them).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lick_codec.h"
+
+#define SYNTH_SAMPLES (50 * 60 * 10)  // 10 min at 50 Hz
+#define SYNTH_ELECTRODES 24
+#define MIN_RUN_SECONDS 1.0
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Small deterministic PRNG so that runs are comparable. */
+static uint32_t rng_state = 12345;
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* Synthetic trace: filtered values jitter by a count or two around a
+ * slowly drifting baseline, with bouts of licks (~7 Hz) on a few
+ * electrodes in which filtered drops by ~40-80 counts during contact.
+ * Channels 0-23 are filtered data, 24-47 baseline values.
+ */
+static uint16_t *make_synthetic(size_t *n_samples, uint8_t *n_channels) {
+    const uint8_t n_ele = SYNTH_ELECTRODES;
+    uint16_t *data = malloc(sizeof(uint16_t) * SYNTH_SAMPLES * n_ele * 2);
+    int baseline[SYNTH_ELECTRODES];
+    int bout_left[SYNTH_ELECTRODES];
+    for (int e = 0; e < n_ele; e++) {
+        baseline[e] = 550 + (int)(rng() % 150);
+        bout_left[e] = 0;
+    }
+    for (size_t i = 0; i < SYNTH_SAMPLES; i++) {
+        uint16_t *row = data + i * n_ele * 2;
+        for (int e = 0; e < n_ele; e++) {
+            if (rng() % 2000 == 0) {
+                baseline[e] += (rng() & 1) ? 1 : -1;
+            }
+            if (bout_left[e] == 0 && rng() % 3000 == 0) {
+                bout_left[e] = 50 + (int)(rng() % 500);
+            }
+            int filtered = baseline[e] + (int)(rng() % 5) - 2;
+            if (bout_left[e] > 0) {
+                bout_left[e]--;
+                // Contact for ~2 of every 7 samples at 50 Hz.
+                if ((bout_left[e] % 7) < 2) {
+                    filtered -= 40 + (int)(rng() % 40);
+                }
+            }
+            row[e] = (uint16_t)filtered;
+            row[n_ele + e] = (uint16_t)baseline[e];
+        }
+    }
+    *n_samples = SYNTH_SAMPLES;
+    *n_channels = n_ele * 2;
+    return data;
+}
+
+static uint16_t *read_trace(const char *fname, size_t *n_samples,
+        uint8_t *n_channels) {
+    FILE *fid = fopen(fname, "r");
+    if (fid == NULL) {
+        perror(fname);
+        return NULL;
+    }
+    size_t cap = 4096;
+    size_t n = 0;
+    uint8_t ncols = 0;
+    uint16_t *data = NULL;
+    char line[4096];
+    while (fgets(line, sizeof(line), fid)) {
+        uint16_t row[LICK_CODEC_MAX_CHANNELS];
+        uint8_t cols = 0;
+        char *p = line;
+        char *end;
+        while (cols < LICK_CODEC_MAX_CHANNELS) {
+            long v = strtol(p, &end, 10);
+            if (end == p) {
+                break;
+            }
+            row[cols++] = (uint16_t)v;
+            p = end;
+        }
+        if (cols == 0) {
+            continue;
+        }
+        if (ncols == 0) {
+            ncols = cols;
+            data = malloc(sizeof(uint16_t) * cap * ncols);
+        }
+        if (cols != ncols) {
+            continue;
+        }
+        if (n == cap) {
+            cap *= 2;
+            data = realloc(data, sizeof(uint16_t) * cap * ncols);
+        }
+        memcpy(data + n * ncols, row, sizeof(uint16_t) * ncols);
+        n++;
+    }
+    fclose(fid);
+    *n_samples = n;
+    *n_channels = ncols;
+    return data;
+}
+
+static size_t text_size(const uint16_t *data, size_t n_samples,
+        uint8_t n_channels) {
+    size_t size = 0;
+    char buf[8];
+    for (size_t i = 0; i < n_samples * n_channels; i++) {
+        // Value plus separator (space or newline).
+        size += (size_t)snprintf(buf, sizeof(buf), "%u", data[i]) + 1;
+    }
+    return size;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n_samples;
+    uint8_t n_channels;
+    uint16_t *data;
+    const char *source;
+    int block_len = 50;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:")) != -1) {
+        if (opt == 'b') {
+            block_len = atoi(optarg);
+        } else {
+            fprintf(stderr, "Usage: %s [-b block_len] [trace.txt]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (block_len < 2 || block_len > LICK_CODEC_MAX_SAMPLES) {
+        fprintf(stderr, "Block length must be between 2 and %d\n",
+                LICK_CODEC_MAX_SAMPLES);
+        return 1;
+    }
+
+    if (optind < argc) {
+        source = argv[optind];
+        data = read_trace(source, &n_samples, &n_channels);
+        if (data == NULL || n_samples < 2) {
+            fprintf(stderr, "No usable data in %s\n", source);
+            return 1;
+        }
+    } else {
+        source = "synthetic";
+        data = make_synthetic(&n_samples, &n_channels);
+    }
+
+    size_t n_blocks = (n_samples + block_len - 1) / block_len;
+    size_t max_block = LICK_CODEC_MAX_BLOCK_SIZE(n_channels, block_len);
+    uint8_t *encoded = malloc(n_blocks * max_block);
+    uint16_t *decoded = malloc(sizeof(uint16_t) * n_samples * n_channels);
+    size_t raw_bytes = n_samples * n_channels * sizeof(uint16_t);
+
+    // Encode.
+    size_t enc_bytes = 0;
+    int runs = 0;
+    double t0 = now_s();
+    double elapsed;
+    do {
+        enc_bytes = 0;
+        for (size_t i = 0; i < n_samples; i += block_len) {
+            size_t left = n_samples - i;
+            uint8_t n = (uint8_t)(left < (size_t)block_len ?
+                                  left : (size_t)block_len);
+            enc_bytes += lick_codec_encode(data + i * n_channels, n,
+                n_channels, (uint16_t)(i / block_len), 0, 20000, 0,
+                encoded + enc_bytes, max_block);
+        }
+        runs++;
+        elapsed = now_s() - t0;
+    } while (elapsed < MIN_RUN_SECONDS);
+    double enc_rate = runs * raw_bytes / elapsed;
+
+    // Decode.
+    size_t errors = 0;
+    runs = 0;
+    t0 = now_s();
+    do {
+        size_t pos = 0;
+        size_t out = 0;
+        while (pos < enc_bytes) {
+            struct lick_block_info info;
+            size_t consumed;
+            int ret = lick_codec_decode(encoded + pos, enc_bytes - pos,
+                &info, decoded + out, n_samples * n_channels - out,
+                &consumed);
+            if (ret != LICK_CODEC_OK) {
+                errors++;
+                break;
+            }
+            pos += consumed;
+            out += (size_t)info.n_samples * info.n_channels;
+        }
+        runs++;
+        elapsed = now_s() - t0;
+    } while (elapsed < MIN_RUN_SECONDS);
+    double dec_rate = runs * raw_bytes / elapsed;
+
+    if (errors || memcmp(data, decoded, raw_bytes) != 0) {
+        fprintf(stderr, "Round trip failed\n");
+        return 1;
+    }
+
+    size_t txt_bytes = text_size(data, n_samples, n_channels);
+    printf("source           %s\n", source);
+    printf("samples          %zu x %u channels\n", n_samples, n_channels);
+    printf("block length     %d samples\n", block_len);
+    printf("text             %zu bytes\n", txt_bytes);
+    printf("binary (16-bit)  %zu bytes\n", raw_bytes);
+    printf("encoded          %zu bytes\n", enc_bytes);
+    printf("ratio vs text    %.2f\n", (double)txt_bytes / enc_bytes);
+    printf("ratio vs binary  %.2f\n", (double)raw_bytes / enc_bytes);
+    printf("bits per value   %.2f\n",
+           8.0 * enc_bytes / (n_samples * n_channels));
+    printf("encode           %.1f MB/s, %.2f M samples/s\n",
+           enc_rate / 1e6, enc_rate / 2e6);
+    printf("decode           %.1f MB/s, %.2f M samples/s\n",
+           dec_rate / 1e6, dec_rate / 2e6);
+
+    free(data);
+    free(encoded);
+    free(decoded);
+    return 0;
+}
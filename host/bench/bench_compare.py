@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+# coding=utf-8
+#
+# Copyright (c) 2026 Antonio González
+
+""" bench_compare.py
+
+Compare two sets of results of bench_suite.py, e.g. those of a change
+with those of the commit it is based on, and flag the benchmarks that
+got worse by more than a threshold (default 15%) and by more than the
+variation between runs: the best new value has to be worse than every
+run of the baseline. A benchmark is flagged as better in the same way.
+Benchmarks marked as informational by bench_suite.py (those too short
+to be stable between runs) are flagged in lower case, and never make
+the comparison fail.
+
+For each benchmark, the change is given as a ratio, >1 when the new
+result is better whichever way is better for it (e.g. 1.20 is 20%
+faster). Benchmarks found in only one of the files are listed too. With
+-m, the table is printed in Markdown, to be pasted in a review.
+
+The exit status is 1 if any benchmark that is not informational got
+worse by more than the threshold, so that this can be used in scripts.
+Results from different computers are compared with a warning: they tell
+little.
+
+Example
+-------
+    git stash
+    cmake --build host/build --target bench
+    cp host/build/bench.json /tmp/before.json
+    git stash pop
+    cmake --build host/build --target bench
+    python3 host/bench/bench_compare.py /tmp/before.json \\
+        host/build/bench.json
+
+Usage: python3 bench_compare.py [-t threshold] [-m] baseline.json
+       results.json
+"""
+
+import argparse
+import json
+import sys
+
+THRESHOLD = 0.15
+
+
+def speedup(old, new):
+    """ Ratio of new to old, > 1 if new is better. """
+    if old['value'] <= 0 or new['value'] <= 0:
+        return float('nan')
+    if old.get('better', 'higher') == 'lower':
+        return old['value'] / new['value']
+    return new['value'] / old['value']
+
+
+def worst(result):
+    """ The worst of the runs of a result (see bench_suite.py -n). """
+    runs = result.get('runs', [result['value']])
+    return max(runs) if result.get('better') == 'lower' else min(runs)
+
+
+def compare(baseline, results, threshold):
+    """
+    Rows of (name, unit, old value, new value, ratio, flag), and the
+    number of regressions.
+    """
+    old = {r['name']: r for r in baseline['results']}
+    new = {r['name']: r for r in results['results']}
+    names = list(old) + [name for name in new if name not in old]
+    rows = []
+    n_worse = 0
+    for name in names:
+        if name not in new:
+            rows.append((name, old[name]['unit'], old[name]['value'],
+                         None, None, 'missing'))
+            continue
+        if name not in old:
+            rows.append((name, new[name]['unit'], None,
+                         new[name]['value'], None, 'new'))
+            continue
+        ratio = speedup(old[name], new[name])
+        # Best new value against the worst baseline run, and worst new
+        # run against the best baseline value.
+        beyond_old = speedup(dict(old[name], value=worst(old[name])),
+                             new[name])
+        beyond_new = speedup(old[name],
+                             dict(new[name], value=worst(new[name])))
+        if ratio < 1 / (1 + threshold) and beyond_old < 1:
+            if new[name].get('informational'):
+                flag = 'worse (info)'
+            else:
+                flag = 'WORSE'
+                n_worse += 1
+        elif ratio > 1 + threshold and beyond_new > 1:
+            flag = 'better'
+        else:
+            flag = ''
+        rows.append((name, new[name]['unit'], old[name]['value'],
+                     new[name]['value'], ratio, flag))
+    return (rows, n_worse)
+
+
+def value_text(value):
+    return '-' if value is None else f"{value:.4g}"
+
+
+def print_table(rows, markdown):
+    header = ("benchmark", "unit", "baseline", "new", "ratio", "")
+    cells = [(name, unit, value_text(old), value_text(new),
+              '-' if ratio is None else f"{ratio:.2f}", flag)
+             for (name, unit, old, new, ratio, flag) in rows]
+    if markdown:
+        print("| " + " | ".join(header) + " |")
+        print("|" + "|".join(("---", "---", "---:", "---:", "---:",
+                              "---")) + "|")
+        for row in cells:
+            print("| " + " | ".join(row) + " |")
+        return
+    widths = [max(len(row[i]) for row in cells + [header])
+              for i in range(len(header))]
+    for row in [header] + cells:
+        print(f"{row[0]:<{widths[0]}}  {row[1]:<{widths[1]}}  "
+              f"{row[2]:>{widths[2]}}  {row[3]:>{widths[3]}}  "
+              f"{row[4]:>{widths[4]}}  {row[5]}".rstrip())
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(
+        description="Compare two sets of results of bench_suite.py")
+    parser.add_argument('baseline')
+    parser.add_argument('results')
+    parser.add_argument('-t', type=float, default=THRESHOLD,
+                        help=f"threshold (default {THRESHOLD})")
+    parser.add_argument('-m', action='store_true', help="Markdown table")
+    args = parser.parse_args()
+    with open(args.baseline) as fid:
+        baseline = json.load(fid)
+    with open(args.results) as fid:
+        results = json.load(fid)
+
+    if baseline.get('host') != results.get('host'):
+        print("warning: the results are from different computers or "
+              "software versions", file=sys.stderr)
+    (rows, n_worse) = compare(baseline, results, args.t)
+    print_table(rows, args.m)
+    if n_worse:
+        print(f"{n_worse} benchmarks worse by more than "
+              f"{100 * args.t:.0f}%", file=sys.stderr)
+        sys.exit(1)
@@ -0,0 +1,283 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* bench_detect.c
+
+   Cost of the hardware-independent part of the firmware timer callback
+   (lick detection and GPIO mapping) for each variant of the lick
+   sensor, built the same way as in the firmware: with the number of
+   sensors and output pins as compile-time constants. The lick event
+   filter is measured on its own, with every criterion on, and so are
+   the summaries of LICK_SINK_SUMMARY, with a histogram.
+
+   This measures the logic only; on the Pico the callback is dominated
+   by the I2C transactions. Build the firmware with -DLICK_BENCHMARK=ON
+   to measure the whole callback on the device.
+
+   Usage:
+     bench_detect [-j]
+
+   With -j, the results are printed as a JSON list, as read by
+   bench_suite.py.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lick_detect.h"
+#include "lick_summary.h"
+
+#define N_SAMPLES (1 << 20)
+#define N_RUNS 20
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t rng_state = 12345;
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* Touch status of `n_electrodes` electrodes on each of `n_sensors`
+ * sensors, as sampled at 50 Hz. Every electrode has a lick train of its
+ * own: bouts of 10 to 70 licks at ~7 Hz (intervals of 6 to 8 samples)
+ * separated by pauses of 2 to 30 s. One interval in 16 is of 3 samples,
+ * shorter than the refractory period of the filter, and contacts last
+ * 2 or 3 samples but for one in 8, of 1 sample, shorter than its
+ * minimum. About once a
+ * minute every electrode of a sensor is touched at once for 2 samples,
+ * as when the cage is bumped.
+ */
+static uint16_t *make_touched(uint8_t n_sensors, uint8_t n_electrodes) {
+    uint16_t *touched = calloc(N_SAMPLES * n_sensors, sizeof(uint16_t));
+    const uint16_t all = (uint16_t)((1u << n_electrodes) - 1);
+    for (uint8_t s = 0; s < n_sensors; s++) {
+        for (uint8_t e = 0; e < n_electrodes; e++) {
+            size_t onset = rng() % 1500;
+            uint32_t left = 10 + rng() % 61;
+            while (onset < N_SAMPLES) {
+                uint32_t ili = rng() % 16 ? 6 + rng() % 3 : 3;
+                uint32_t contact = rng() % 8 ? 2 + rng() % 2 : 1;
+                if (contact >= ili) {
+                    contact = ili - 1;
+                }
+                for (size_t i = onset; i < onset + contact &&
+                     i < N_SAMPLES; i++) {
+                    touched[i * n_sensors + s] |= (uint16_t)(1u << e);
+                }
+                if (--left == 0) {
+                    ili = 100 + rng() % 1400;
+                    left = 10 + rng() % 61;
+                }
+                onset += ili;
+            }
+        }
+        for (size_t i = rng() % 3000; i + 1 < N_SAMPLES;
+             i += 2000 + rng() % 2000) {
+            touched[i * n_sensors + s] = all;
+            touched[(i + 1) * n_sensors + s] = all;
+        }
+    }
+    return touched;
+}
+
+/* Prevent the compiler from optimising the work away. */
+static volatile uint32_t sink;
+
+/* One benchmark function per variant. As in the firmware, the number
+ * of sensors and whether there are GPIO outputs are constants, so each
+ * function is compiled specifically for its variant.
+ */
+#define BENCH_VARIANT(fname, N_SENSORS, HAS_GPIO, PINS)                \
+    static double fname(const uint16_t *touched) {                     \
+        static const uint8_t pins[] = PINS;                            \
+        const uint8_t n_pins = sizeof(pins) / sizeof(pins[0]);         \
+        struct lick_detect d;                                          \
+        struct lick_sample s;                                          \
+        uint32_t acc = 0;                                              \
+        double best = 1e9;                                             \
+        for (int run = 0; run < N_RUNS; run++) {                       \
+            lick_detect_init(&d);                                      \
+            double t0 = now_s();                                       \
+            for (size_t i = 0; i < N_SAMPLES; i++) {                   \
+                for (uint8_t k = 0; k < N_SENSORS; k++) {              \
+                    s.touched[k] = touched[i * N_SENSORS + k];         \
+                }                                                      \
+                if (HAS_GPIO) {                                        \
+                    acc += lick_gpio_value(s.touched[0], pins, n_pins);\
+                }                                                      \
+                if (lick_detect_step(&d, &s, N_SENSORS)) {             \
+                    d.n_events++;                                      \
+                    acc += s.onset[N_SENSORS - 1];                     \
+                }                                                      \
+            }                                                          \
+            double dt = (now_s() - t0) / N_SAMPLES;                    \
+            if (dt < best) best = dt;                                  \
+        }                                                              \
+        sink = acc + d.n_events;                                       \
+        return best * 1e9;                                             \
+    }
+
+/* Filter settings, in samples: 80 ms refractory period, at most 3
+ * simultaneous onsets and 40 ms contacts at 50 Hz. With 2-sample
+ * contacts, licks are at least 3 samples apart, so a refractory period
+ * of 3 would never reject any.
+ */
+#define FILTER_MIN_ILI 4
+#define FILTER_MAX_SIMULTANEOUS 3
+#define FILTER_MIN_CONTACT 2
+
+/* Detection followed by the filter, for two sensors. */
+static double bench_filter(const uint16_t *touched,
+                           struct lick_filter *f) {
+    struct lick_detect d;
+    struct lick_sample s;
+    uint32_t acc = 0;
+    double best = 1e9;
+    for (int run = 0; run < N_RUNS; run++) {
+        lick_detect_init(&d);
+        lick_filter_init(f);
+        double t0 = now_s();
+        for (size_t i = 0; i < N_SAMPLES; i++) {
+            s.touched[0] = touched[i * 2];
+            s.touched[1] = touched[i * 2 + 1];
+            lick_detect_step(&d, &s, 2);
+            if (lick_filter_step(f, &s, 2, FILTER_MIN_ILI,
+                                 FILTER_MAX_SIMULTANEOUS,
+                                 FILTER_MIN_CONTACT)) {
+                d.n_events++;
+                acc += s.onset[1];
+            }
+        }
+        double dt = (now_s() - t0) / N_SAMPLES;
+        if (dt < best) best = dt;
+    }
+    sink = acc + d.n_events;
+    return best * 1e9;
+}
+
+/* Summary settings, in samples: 1 min bins, 1 s bout gap and a
+ * histogram of 8 bins of 40 ms at 50 Hz.
+ */
+#define SUMMARY_BIN 3000
+#define SUMMARY_BOUT_GAP 50
+#define SUMMARY_HIST_LEN 8
+#define SUMMARY_HIST_WIDTH 2
+
+/* Detection followed by the summary, for two sensors. */
+static double bench_summary(const uint16_t *touched) {
+    struct lick_detect d;
+    struct lick_sample s;
+    struct lick_summary m;
+    static struct lick_summary_bin b;
+    uint32_t acc = 0;
+    double best = 1e9;
+    for (int run = 0; run < N_RUNS; run++) {
+        lick_detect_init(&d);
+        lick_summary_init(&m);
+        double t0 = now_s();
+        for (size_t i = 0; i < N_SAMPLES; i++) {
+            s.touched[0] = touched[i * 2];
+            s.touched[1] = touched[i * 2 + 1];
+            lick_detect_step(&d, &s, 2);
+            if (i % SUMMARY_BIN == 0) {
+                acc += b.licks[1][0];
+                lick_summary_start(&m, &b, (uint32_t)i, 2,
+                                   SUMMARY_HIST_LEN);
+            }
+            lick_summary_step(&m, &b, &s, 2, 12, SUMMARY_BOUT_GAP,
+                              SUMMARY_HIST_LEN, SUMMARY_HIST_WIDTH);
+        }
+        double dt = (now_s() - t0) / N_SAMPLES;
+        if (dt < best) best = dt;
+    }
+    sink = acc + b.bouts[1][0];
+    return best * 1e9;
+}
+
+#define PINS_X1 {2}
+#define PINS_X6 {2, 4, 6, 8, 11, 13}
+#define PINS_NONE {0}
+
+BENCH_VARIANT(bench_x1, 1, 1, PINS_X1)
+BENCH_VARIANT(bench_x6, 1, 1, PINS_X6)
+BENCH_VARIANT(bench_x12, 1, 0, PINS_NONE)
+BENCH_VARIANT(bench_x24, 2, 0, PINS_NONE)
+
+struct result {
+    const char *name;
+    double ns;
+};
+
+int main(int argc, char *argv[]) {
+    bool json = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "j")) != -1) {
+        switch (opt) {
+            case 'j':
+                json = true;
+                break;
+            default:
+                fprintf(stderr, "usage: bench_detect [-j]\n");
+                return 1;
+        }
+    }
+    // The input of each variant has as many electrodes as it uses.
+    uint16_t *touched_x1 = make_touched(1, 1);
+    uint16_t *touched_x6 = make_touched(1, 6);
+    uint16_t *touched_x12 = make_touched(1, 12);
+    uint16_t *touched_x24 = make_touched(2, 12);
+
+    struct lick_filter f;
+    struct result results[] = {
+        {"bottle-x1-bnc-out", bench_x1(touched_x1)},
+        {"bottle-x6-bnc-out", bench_x6(touched_x6)},
+        {"bottle-x12-usb-out", bench_x12(touched_x12)},
+        {"bottle-x24-usb-out", bench_x24(touched_x24)},
+        {"bottle-x24-usb-out+filter", bench_filter(touched_x24, &f)},
+        {"bottle-x24-usb-out+summary", bench_summary(touched_x24)},
+    };
+    const size_t n = sizeof(results) / sizeof(results[0]);
+    if (json) {
+        printf("[\n");
+        for (size_t i = 0; i < n; i++) {
+            printf("  {\"name\": \"detect.%s\", \"value\": %.3f, "
+                   "\"unit\": \"ns/sample\", \"better\": \"lower\"}%s\n",
+                   results[i].name, results[i].ns, i + 1 < n ? "," : "");
+        }
+        printf("]\n");
+    } else {
+        printf("variant             ns/sample\n");
+        for (size_t i = 0; i < 4; i++) {
+            printf("%-19s %9.2f\n", results[i].name, results[i].ns);
+        }
+        printf("  + event filter    %9.2f\n", results[4].ns);
+        printf("  + summary         %9.2f\n", results[5].ns);
+        printf("(filter rejected per run: burst %u refractory %u "
+               "short %u)\n", f.n_burst, f.n_refractory, f.n_short);
+    }
+
+    free(touched_x1);
+    free(touched_x6);
+    free(touched_x12);
+    free(touched_x24);
+    return 0;
+}
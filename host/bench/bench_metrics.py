@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+# coding=utf-8
+#
+# Copyright (c) 2026 Antonio González
+
+""" bench_metrics.py
+
+Cost of the live metrics of the lick events readers
+(host/python/lick_metrics.py), as a fraction of the cost of ingesting
+the data: decoding each read of the serial port, saving it with
+np.savetxt and writing it as one block with host/python/lick_segments.py
+(fsync policy as in the readers, 'block', unless given).
+
+Reads of 1, 50 and 500 events (2 sensors) are ingested, and the time
+spent in the metrics is measured within the same run (comparing runs
+with and without metrics is swamped by the variation between runs):
+
+* reader: the calls made by the reader at every read and write;
+* scrape: rendering the metrics (on the server thread, in the
+  readers), which counts what the reader has handed over since the last
+  scrape. This is done once every 15 reads, as a Prometheus server
+  scraping every 15 s would do with a reader that reads once per
+  second.
+
+The overhead is given for the reader's calls alone, and with the
+scrapes added.
+
+Usage: python3 bench_metrics.py [n_reads] [fsync policy]
+"""
+
+import os
+import shutil
+import sys
+import tempfile
+import time
+
+import numpy as np
+
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                             '..', 'python'))
+from lick_metrics import ReaderMetrics
+from lick_records import RecordDecoder
+from lick_segments import SegmentWriter
+
+N_REPEATS = 5
+SCRAPE_EVERY = 15
+EVENTS_PER_READ = (1, 50, 500)
+
+
+def make_reads(n_reads, n_events):
+    rng = np.random.default_rng(1)
+    reads = []
+    count = 0
+    for _ in range(n_reads):
+        lines = []
+        for _ in range(n_events):
+            (a, b) = rng.integers(0, 4096, 2)
+            lines.append(f"{count} {20 * count} {a} {b}\r\n")
+            count += 1
+        reads.append(''.join(lines).encode())
+    return reads
+
+
+def ingest(reads, directory, fsync):
+    """
+    Ingest `reads` with metrics, and return the time taken in total, by
+    the metrics calls of the reader (including the extra clock reads),
+    and by rendering the metrics.
+    """
+    decoder = RecordDecoder(4)
+    writer = SegmentWriter(directory, fsync=fsync)
+    metrics = ReaderMetrics('bench', writer)
+    in_reader = 0
+    in_render = 0
+    start = time.perf_counter()
+    for (i, data) in enumerate(reads):
+        decoder.feed(data)
+        events = decoder.read()
+        comments = decoder.comments()
+        t0 = time.perf_counter()
+        metrics.received(data, events, decoder.n_bad, len(comments))
+        t1 = time.perf_counter()
+        np.savetxt(writer, events, delimiter=",", fmt="%d")
+        t2 = time.perf_counter()
+        writer.flush()
+        t3 = time.perf_counter()
+        metrics.wrote(t3 - t2)
+        t4 = time.perf_counter()
+        in_reader += (t1 - t0) + (t4 - t3)
+        if i % SCRAPE_EVERY == 0:
+            metrics.render()
+            in_render += time.perf_counter() - t4
+    elapsed = time.perf_counter() - start
+    writer.close()
+    shutil.rmtree(directory)
+    return (elapsed, in_reader, in_render)
+
+
+if __name__ == "__main__":
+    n_reads = int(sys.argv[1]) if len(sys.argv) > 1 else 3000
+    fsync = sys.argv[2] if len(sys.argv) > 2 else 'block'
+    n_scrapes = (n_reads + SCRAPE_EVERY - 1) // SCRAPE_EVERY
+    tmp = tempfile.mkdtemp()
+    try:
+        print(f"{'events/':<8}{'ingest,':>9}{'reader,':>9}{'scrape,':>9}"
+              f"{'overhead':>10}{'with scrapes':>14}")
+        print(f"{'read':<8}{'µs/read':>9}{'µs/read':>9}{'µs':>9}")
+        for n_events in EVENTS_PER_READ:
+            reads = make_reads(n_reads, n_events)
+            runs = [ingest(reads, os.path.join(tmp, str(k)), fsync)
+                    for k in range(N_REPEATS)]
+            # The run with the median share of time in the metrics.
+            runs.sort(key=lambda r: (r[1] + r[2]) / r[0])
+            (elapsed, in_reader, in_render) = runs[N_REPEATS // 2]
+            base = 1e6 * (elapsed - in_reader - in_render) / n_reads
+            reader = 1e6 * in_reader / n_reads
+            scrape = 1e6 * in_render / n_scrapes
+            total = reader + scrape / SCRAPE_EVERY
+            print(f"{n_events:<8}{base:9.1f}{reader:9.2f}{scrape:9.0f}"
+                  f"{100 * reader / base:9.2f}%{100 * total / base:13.2f}%")
+    finally:
+        shutil.rmtree(tmp)
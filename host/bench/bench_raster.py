@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+# coding=utf-8
+#
+# Copyright (c) 2026 Antonio González
+
+""" bench_raster.py
+
+Time per frame of the plotter's lick raster (utils/plotter/raster.py)
+with 96 electrodes (8 sensors of 12) licking at ~8 Hz each, all at
+once, over a 10-minute window.
+
+Lick events are made as the firmware sends them, one line per sample
+with any onsets, with samples every 20 ms (the default) or every 1 ms.
+They are fed to the raster in frames of 100 ms, as the plotter's timer
+does. Two ways of drawing are compared:
+
+* incremental: `LickRaster.add`, which draws only the new licks into
+  the image and clears the columns that time has reached;
+* redraw: the image is made again every frame from all the events in
+  the window, as a plot that is given all its data at every update
+  has to do.
+
+The mean time per frame is given for the 1st minute, the 10th (when
+the window fills up) and the last, with the longest frame. Times are
+of the numpy work only, not of showing the image, which
+costs the same for both (a fixed number of pixels) and needs a
+display.
+
+Usage: python3 bench_raster.py [minutes]
+"""
+
+import os
+import sys
+import time
+
+import numpy as np
+
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                             '..', '..', 'utils', 'plotter'))
+from raster import LickRaster, TICK
+
+N_SENSORS = 8
+N_ELECTRODES = 12
+FRAME_MS = 100
+WINDOW_MS = 600000
+N_COLUMNS = 1200
+REDRAW_EVERY = 100
+
+
+def make_events(minutes, interval_ms):
+    """
+    Lines of `timestamp mask...` of licks at ~8 Hz on every electrode.
+    """
+    rng = np.random.default_rng(1)
+    duration = minutes * 60000
+    times = []
+    rows = []
+    for row in range(N_SENSORS * N_ELECTRODES):
+        n = int(duration / 125) + 1
+        t = rng.uniform(0, 125) + np.cumsum(rng.uniform(110, 140, n))
+        t = t[t < duration]
+        times.append((t // interval_ms) * interval_ms)
+        rows.append(np.full(len(t), row))
+    times = np.concatenate(times).astype(np.int64)
+    rows = np.concatenate(rows)
+    (timestamps, line) = np.unique(times, return_inverse=True)
+    masks = np.zeros((len(timestamps), N_SENSORS), dtype=np.int64)
+    np.bitwise_or.at(masks, (line, rows // N_ELECTRODES),
+                     1 << (rows % N_ELECTRODES))
+    return (timestamps, masks)
+
+
+def redraw(timestamps, masks, now_ms, column_ms):
+    """ The image of the window ending at `now_ms`, from scratch. """
+    start = np.searchsorted(timestamps, now_ms - WINDOW_MS, side='right')
+    t = timestamps[start:]
+    bits = (masks[start:, :, np.newaxis] >>
+            np.arange(N_ELECTRODES)) & 1
+    (event, sensor, electrode) = np.nonzero(bits)
+    column = ((t[event] - (now_ms - WINDOW_MS)) //
+              column_ms).astype(np.int64)
+    column = np.clip(column, 0, N_COLUMNS - 1)
+    image = np.bincount((sensor * N_ELECTRODES + electrode) * N_COLUMNS +
+                        column,
+                        minlength=N_SENSORS * N_ELECTRODES * N_COLUMNS)
+    return np.minimum(image * TICK, 255).astype(np.uint8)
+
+
+def run(timestamps, masks, minutes, use_redraw):
+    """
+    Feed the events in frames, and return the time of every frame (s)
+    and the time at which it ended (ms). Redrawing is slow, so only
+    one frame in REDRAW_EVERY is done, and timed.
+    """
+    raster = LickRaster(N_SENSORS, N_ELECTRODES, WINDOW_MS, N_COLUMNS)
+    ends = np.arange(FRAME_MS, minutes * 60000 + 1, FRAME_MS)
+    bounds = np.searchsorted(timestamps, ends, side='right')
+    seconds = np.empty(len(ends))
+    first = 0
+    for (k, last) in enumerate(bounds):
+        if use_redraw and k % REDRAW_EVERY:
+            seconds[k] = np.nan
+            continue
+        start = time.perf_counter()
+        if use_redraw:
+            redraw(timestamps[:last], masks[:last], ends[k],
+                   raster.column_ms)
+        else:
+            raster.add(timestamps[first:last], masks[first:last])
+            raster.advance(ends[k])
+        seconds[k] = time.perf_counter() - start
+        first = last
+    return (seconds, ends)
+
+
+def report(name, seconds, ends, minutes):
+    cells = []
+    for m in (1, 10, minutes):
+        window = (ends > (m - 1) * 60000) & (ends <= m * 60000)
+        cells.append(f"{1000 * np.nanmean(seconds[window]):6.3f}")
+    print(f"  {name:<12}" + "  ".join(f"{c:>10}" for c in cells) +
+          f"  {1000 * np.nanmax(seconds):8.3f}")
+
+
+if __name__ == "__main__":
+    minutes = int(sys.argv[1]) if len(sys.argv) > 1 else 20
+    print(f"{N_SENSORS * N_ELECTRODES} electrodes, {minutes} min, "
+          f"frames of {FRAME_MS} ms, window {WINDOW_MS // 60000} min")
+    for interval_ms in (20, 1):
+        (timestamps, masks) = make_events(minutes, interval_ms)
+        n_licks = int(np.sum((masks[:, :, np.newaxis] >>
+                              np.arange(N_ELECTRODES)) & 1))
+        print(f"samples every {interval_ms} ms: {len(timestamps)} lines, "
+              f"{n_licks} licks ({n_licks / (minutes * 60):.0f}/s)")
+        print(f"  {'method':<12}" +
+              "  ".join(f"{f'min {m}, ms':>10}" for m in (1, 10, minutes)) +
+              f"  {'max ms':>8}")
+        for (name, use_redraw) in (("incremental", False),
+                                   ("redraw", True)):
+            (seconds, ends) = run(timestamps, masks, minutes, use_redraw)
+            report(name, seconds, ends, minutes)
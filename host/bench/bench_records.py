@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+# coding=utf-8
+#
+# Copyright (c) 2026 Antonio González
+
+""" bench_records.py
+
+Throughput of the ways the Python tools can turn the text sent by the
+lick sensor into numpy arrays:
+
+* numpy: `np.fromstring(..., sep=' ')` and reshape, as the event readers
+  used to do (this cannot tell comments or broken lines apart);
+* python: split lines and convert every value with int() or float(), as
+  the plotter used to do;
+* native: the `lick` library (host/python/lick_records.py), fed either
+  in 4 kB chunks, as data arrives from the serial port, or all at once.
+
+Two synthetic streams are used: lick events (4 integers per line, as
+sent by bottle-x24-usb-out) and sensor traces (6 values per line, as
+plotted by utils/plotter).
+
+Usage: python3 bench_records.py [n_lines]
+"""
+
+import os
+import sys
+import time
+
+import numpy as np
+
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                             '..', 'python'))
+from lick_records import RecordDecoder
+
+CHUNK_SIZE = 4096
+N_REPEATS = 5
+
+
+def make_events(n):
+    rng = np.random.default_rng(1)
+    t = np.cumsum(rng.integers(20, 400, n))
+    a = rng.integers(0, 4096, n)
+    b = rng.integers(0, 4096, n)
+    lines = [f"{i} {t[i]} {a[i]} {b[i]}\r\n" for i in range(n)]
+    return ''.join(lines).encode()
+
+
+def make_traces(n):
+    rng = np.random.default_rng(2)
+    base = 600 + rng.normal(0, 2, n)
+    filt = base - np.abs(rng.normal(0, 20, n))
+    lines = [f"{base[i]:.1f} {filt[i]:.1f} {base[i] - filt[i]:.2f} "
+             f"12.0 6.0 {int(base[i] - filt[i] > 12)}\r\n"
+             for i in range(n)]
+    return ''.join(lines).encode()
+
+
+def with_numpy(data, n_cols, dtype):
+    return np.fromstring(data, dtype=dtype, sep=' ').reshape(-1, n_cols)
+
+
+def with_python(data, n_cols, dtype):
+    convert = int if dtype == np.int64 else float
+    rows = [[convert(v) for v in line.split()]
+            for line in data.decode().splitlines()]
+    return np.array(rows, dtype=dtype)
+
+
+def with_native_chunks(data, n_cols, dtype):
+    decoder = RecordDecoder(n_cols, dtype)
+    out = []
+    for i in range(0, len(data), CHUNK_SIZE):
+        decoder.feed(data[i:i + CHUNK_SIZE])
+        out.append(decoder.read())
+    return np.concatenate(out)
+
+
+def with_native(data, n_cols, dtype):
+    decoder = RecordDecoder(n_cols, dtype)
+    decoder.feed(data)
+    return decoder.read()
+
+
+def bench(name, data, n_cols, dtype):
+    methods = [("numpy", with_numpy), ("python", with_python),
+               ("native (4 kB chunks)", with_native_chunks),
+               ("native", with_native)]
+    expected = with_python(data, n_cols, dtype)
+    print(f"{name}: {len(expected)} lines, {len(data) / 1e6:.1f} MB")
+    print(f"  {'method':<22}{'MB/s':>8}{'Mlines/s':>10}")
+    for (method, func) in methods:
+        best = float('inf')
+        for _ in range(N_REPEATS):
+            start = time.perf_counter()
+            result = func(data, n_cols, dtype)
+            best = min(best, time.perf_counter() - start)
+        assert np.array_equal(result, expected), method
+        print(f"  {method:<22}{len(data) / best / 1e6:8.1f}"
+              f"{len(expected) / best / 1e6:10.2f}")
+
+
+if __name__ == "__main__":
+    n = int(sys.argv[1]) if len(sys.argv) > 1 else 500000
+    # np.fromstring with sep is deprecated but is what was used.
+    import warnings
+    warnings.simplefilter('ignore', DeprecationWarning)
+    bench("events", make_events(n), 4, np.int64)
+    bench("traces", make_traces(n), 6, np.float64)
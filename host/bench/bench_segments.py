@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+# coding=utf-8
+#
+# Copyright (c) 2026 Antonio González
+
+""" bench_segments.py
+
+Lick events per second that host/python/lick_segments.py can write to
+disk with each fsync policy, in blocks of 1 event (one event per read
+of the serial port, as when reacting to licks) and of 50 events (one
+second of a busy bottle-x24-usb-out session), compared with a plain csv
+file flushed once per block, as the readers used to write.
+
+Also reported is the time taken to reopen (recover) a session whose last
+segment ends in a broken block.
+
+Usage: python3 bench_segments.py [directory] [seconds]
+
+The directory (default: a temporary one) should be on the disk that
+will hold the data, e.g. the SD card of a Raspberry Pi: fsync costs
+depend on it much more than on the processor.
+"""
+
+import os
+import shutil
+import sys
+import tempfile
+import time
+
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                             '..', 'python'))
+from lick_segments import FSYNC_POLICIES, SegmentWriter
+
+HEADER = "idx,timestamp,sensorA,sensorB\n"
+BLOCK_SIZES = (1, 50)
+
+
+def event_lines(n):
+    return [f"{i},{20 * i},{1 << (i % 12)},0\n" for i in range(n)]
+
+
+def bench_plain(directory, block, seconds):
+    lines = event_lines(block)
+    n = 0
+    with open(os.path.join(directory, 'plain.csv'), 'a') as fid:
+        fid.write(HEADER)
+        t_end = time.perf_counter() + seconds
+        start = time.perf_counter()
+        while time.perf_counter() < t_end:
+            fid.writelines(lines)
+            fid.flush()
+            n += block
+        elapsed = time.perf_counter() - start
+    return n / elapsed
+
+
+def bench_writer(directory, block, seconds, fsync):
+    lines = event_lines(block)
+    n = 0
+    # Segments of 1 MB, so that rotation and compression are included.
+    session = os.path.join(directory, f'lick_events_{fsync}_{block}')
+    writer = SegmentWriter(session, fsync=fsync, max_bytes=1 << 20)
+    writer.set_header(HEADER)
+    t_end = time.perf_counter() + seconds
+    start = time.perf_counter()
+    while time.perf_counter() < t_end:
+        for line in lines:
+            writer.write(line)
+        writer.flush()
+        n += block
+    writer.close()
+    elapsed = time.perf_counter() - start
+    return n / elapsed
+
+
+def bench_recover(directory):
+    session = os.path.join(directory, 'lick_events_recover')
+    writer = SegmentWriter(session, fsync='none')
+    writer.set_header(HEADER)
+    for (i, line) in enumerate(event_lines(100000)):
+        writer.write(line)
+        if i % 50 == 49:
+            writer.flush()
+    writer.flush()
+    # A crash in the middle of a block: the segment is left open, and
+    # the lock released as when the process dies.
+    writer._fid.write(b'# block 1 100 00000000\n1,2')
+    writer._fid.close()
+    writer._lock.close()
+    start = time.perf_counter()
+    writer = SegmentWriter(session, fsync='none')
+    elapsed = time.perf_counter() - start
+    writer.close()
+    return (elapsed, writer.n_recovered)
+
+
+if __name__ == "__main__":
+    seconds = float(sys.argv[2]) if len(sys.argv) > 2 else 2
+    if len(sys.argv) > 1:
+        directory = tempfile.mkdtemp(dir=sys.argv[1])
+    else:
+        directory = tempfile.mkdtemp()
+    try:
+        print(f"{'writer':<22}" +
+              ''.join(f"{f'{b} events/block':>18}" for b in BLOCK_SIZES))
+        rates = [bench_plain(directory, b, seconds) for b in BLOCK_SIZES]
+        print(f"{'plain csv, flush':<22}" +
+              ''.join(f"{r:18.0f}" for r in rates))
+        for fsync in FSYNC_POLICIES:
+            rates = [bench_writer(directory, b, seconds, fsync)
+                     for b in BLOCK_SIZES]
+            print(f"{'segments, ' + fsync:<22}" +
+                  ''.join(f"{r:18.0f}" for r in rates))
+        (elapsed, cut) = bench_recover(directory)
+        print(f"recovery: {1000 * elapsed:.1f} ms, {cut} bytes cut")
+    finally:
+        shutil.rmtree(directory)
@@ -0,0 +1,220 @@
+#!/usr/bin/env python3
+# coding=utf-8
+#
+# Copyright (c) 2026 Antonio González
+
+""" bench_sqlite.py
+
+Insert rate and query times of the SQLite sink of the lick events
+readers (host/python/lick_sqlite.py), on a multi-day dataset: `cages`
+bottle-x24-usb-out devices (default 8), each with one session per day
+for `days` days (default 7). On every electrode there are ~100 bouts a
+day, at random times, of 10 to 70 licks at ~7 Hz.
+
+Ingest: the events of every session are given to a `SqliteSink` in
+reads of 50 events (one second of a busy session), as fast as they can
+be, and the insert rate is the number of rows (licks) over the time
+until the sink has closed. During the last day, another connection
+runs a query over the whole database in a loop, as an analysis script
+would. The time taken by every call to `add` is reported next to the
+longest commit, to check that the reader never waits for the database.
+
+Queries, each run with random sessions and electrodes: the licks of one
+electrode in an hour and in a whole session, the licks of all
+electrodes in a minute, the licks per electrode of a session, and the
+licks per session of a device. For comparison, the licks of one
+electrode in a session are also found by parsing the csv file of the
+session, as the analysis scripts do now.
+
+Usage: python3 bench_sqlite.py [days] [cages] [dir]
+
+The directory (default: a temporary one) should be on the disk that
+will hold the database.
+"""
+
+import os
+import shutil
+import sqlite3
+import sys
+import tempfile
+import threading
+import time
+
+import numpy as np
+
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                             '..', 'python'))
+from lick_records import RecordDecoder
+from lick_sqlite import SqliteSink
+
+N_SENSORS = 2
+N_ELECTRODES = 12
+READ_EVENTS = 50
+DAY_MS = 86400 * 1000
+N_QUERIES = 50
+
+
+def make_session(rng):
+    """
+    Lick events of one day: (idx, t_ms, masks), in time order, at the
+    20 ms resolution of the firmware.
+    """
+    times = []
+    rows = []
+    for row in range(N_SENSORS * N_ELECTRODES):
+        starts = rng.uniform(0, DAY_MS, rng.poisson(100))
+        for start in starts:
+            n = rng.integers(10, 71)
+            t = start + np.cumsum(rng.uniform(125, 155, n))
+            times.append(t[t < DAY_MS])
+            rows.append(np.full(len(times[-1]), row))
+    times = (np.concatenate(times) // 20 * 20).astype(np.int64)
+    rows = np.concatenate(rows)
+    (t_ms, line) = np.unique(times, return_inverse=True)
+    masks = np.zeros((len(t_ms), N_SENSORS), dtype=np.int64)
+    np.bitwise_or.at(masks, (line, rows // N_ELECTRODES),
+                     1 << (rows % N_ELECTRODES))
+    return (np.arange(len(t_ms)), t_ms, masks)
+
+
+def session_csv(idx, t_ms, masks):
+    lines = [f"{i},{t},{a},{b}\n" for (i, t, (a, b))
+             in zip(idx, t_ms, masks.tolist())]
+    return "# 2026-10-18 00:00:00\nidx,timestamp,sensorA,sensorB\n" + \
+        ''.join(lines)
+
+
+def query_loop(path, stop, counts):
+    # Another connection reading the whole database, as an analysis.
+    conn = sqlite3.connect(path)
+    while not stop.is_set():
+        conn.execute("SELECT sensor, electrode, count(*) FROM licks "
+                     "GROUP BY session, sensor, electrode").fetchall()
+        counts.append(1)
+    conn.close()
+
+
+def ingest(path, sessions, n_cages):
+    add_seconds = []
+    n_rows = 0
+    max_commit = 0
+    n_dropped = 0
+    n_concurrent = []
+    stop = threading.Event()
+    start = time.perf_counter()
+    for (k, (idx, t_ms, masks)) in enumerate(sessions):
+        (day, cage) = divmod(k, n_cages)
+        if day == len(sessions) // n_cages - 1 and cage == 0:
+            reader = threading.Thread(target=query_loop,
+                                      args=(path, stop, n_concurrent))
+            reader.start()
+        sink = SqliteSink(path, f"cage{cage}_day{day}",
+                          device=f"cage{cage}")
+        sink.set_start(f"2026-10-{day + 1:02d} 00:00:00")
+        for i in range(0, len(idx), READ_EVENTS):
+            t0 = time.perf_counter()
+            sink.add(idx[i:i + READ_EVENTS], t_ms[i:i + READ_EVENTS],
+                     masks[i:i + READ_EVENTS])
+            add_seconds.append(time.perf_counter() - t0)
+        sink.close()
+        n_rows += sink.n_rows
+        n_dropped += sink.n_dropped
+        max_commit = max(max_commit, sink.max_commit_seconds)
+    elapsed = time.perf_counter() - start
+    stop.set()
+    reader.join()
+    add_us = 1e6 * np.array(add_seconds)
+    print(f"ingest: {n_rows} rows in {elapsed:.1f} s, "
+          f"{n_rows / elapsed:.0f} rows/s; {n_dropped} events dropped")
+    print(f"  add(): median {np.median(add_us):.1f} us, "
+          f"p99.9 {np.percentile(add_us, 99.9):.1f} us, "
+          f"max {np.max(add_us):.0f} us; longest commit "
+          f"{1000 * max_commit:.0f} ms; {len(n_concurrent)} whole-database "
+          f"queries during the last day")
+
+
+def time_query(conn, sql, make_args):
+    rng = np.random.default_rng(3)
+    ms = []
+    for _ in range(N_QUERIES):
+        args = make_args(rng)
+        start = time.perf_counter()
+        conn.execute(sql, args).fetchall()
+        ms.append(1000 * (time.perf_counter() - start))
+    return ms
+
+
+def queries(path, n_sessions, n_cages, csv_text):
+    conn = sqlite3.connect(path)
+
+    def session(rng):
+        return int(rng.integers(1, n_sessions + 1))
+
+    def electrode(rng):
+        return (session(rng), int(rng.integers(N_SENSORS)),
+                int(rng.integers(N_ELECTRODES)))
+
+    def hour(rng):
+        t = int(rng.integers(0, DAY_MS - 3600000))
+        return electrode(rng) + (t, t + 3600000)
+
+    def minute(rng):
+        t = int(rng.integers(0, DAY_MS - 60000))
+        return (session(rng), t, t + 60000)
+
+    cases = [
+        ("one electrode, 1 hour",
+         "SELECT t_ms FROM licks WHERE session = ? AND sensor = ? AND "
+         "electrode = ? AND t_ms BETWEEN ? AND ?", hour),
+        ("one electrode, session",
+         "SELECT t_ms FROM licks WHERE session = ? AND sensor = ? AND "
+         "electrode = ?", electrode),
+        ("all electrodes, 1 min",
+         "SELECT sensor, electrode, t_ms FROM licks WHERE session = ? "
+         "AND t_ms BETWEEN ? AND ?", minute),
+        ("per electrode, session",
+         "SELECT sensor, electrode, count(*) FROM licks WHERE session = ? "
+         "GROUP BY sensor, electrode", lambda rng: (session(rng),)),
+        ("per session, device",
+         "SELECT s.name, count(*) FROM sessions s JOIN licks l ON "
+         "l.session = s.id WHERE s.device = ? GROUP BY s.id",
+         lambda rng: (f"cage{rng.integers(n_cages)}",)),
+    ]
+    print(f"{'query (ms)':<26}{'median':>8}{'p95':>8}")
+    for (name, sql, make_args) in cases:
+        ms = time_query(conn, sql, make_args)
+        print(f"{name:<26}{np.median(ms):8.2f}"
+              f"{np.percentile(ms, 95):8.2f}")
+    conn.close()
+
+    # The same as "one electrode, session", from the csv file.
+    ms = []
+    for _ in range(5):
+        start = time.perf_counter()
+        decoder = RecordDecoder(4)
+        decoder.feed(csv_text.encode())
+        data = decoder.read()
+        data[(data[:, 2] >> 5) & 1 == 1, 1]
+        ms.append(1000 * (time.perf_counter() - start))
+    print(f"{'same, parsing the csv':<26}{np.median(ms):8.2f}"
+          f"{np.max(ms):8.2f}")
+
+
+if __name__ == "__main__":
+    days = int(sys.argv[1]) if len(sys.argv) > 1 else 7
+    n_cages = int(sys.argv[2]) if len(sys.argv) > 2 else 8
+    if len(sys.argv) > 3:
+        directory = tempfile.mkdtemp(dir=sys.argv[3])
+    else:
+        directory = tempfile.mkdtemp()
+    rng = np.random.default_rng(1)
+    sessions = [make_session(rng) for _ in range(days * n_cages)]
+    n_events = sum(len(s[0]) for s in sessions)
+    print(f"{n_cages} devices x {days} days, {n_events} lick events")
+    path = os.path.join(directory, 'licks.sqlite')
+    try:
+        ingest(path, sessions, n_cages)
+        print(f"database: {os.path.getsize(path) / 1e6:.0f} MB")
+        queries(path, len(sessions), n_cages, session_csv(*sessions[0]))
+    finally:
+        shutil.rmtree(directory)
@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+# coding=utf-8
+#
+# Copyright (c) 2026 Antonio González
+
+""" bench_suite.py
+
+Run the benchmarks of the code that the lick sensor's data goes
+through, from the firmware to the files on disk, and save the results
+as JSON, so that they can be compared between commits with
+bench_compare.py:
+
+* detect: the hardware-independent part of the firmware timer callback
+  for each variant, with the event filter and the summaries
+  (bench_detect), in ns per sample;
+* records: decoding the text sent by the firmware into numpy arrays
+  (host/python/lick_records.py), lick events and sensor traces, in
+  MB/s;
+* csv: writing decoded lick events as csv lines, as the readers do with
+  np.savetxt, and converting them to long format
+  (utils/events-to-long.py), in lines/s;
+* session: writing lick events in blocks of 50 to a session directory
+  (host/python/lick_segments.py, without fsync, which depends on the
+  disk rather than the code; see bench_segments.py for that), and
+  reading the session back, in events/s.
+
+The suite is run `-n` times (default 3), one whole pass after another
+so that the runs of each benchmark are spread over the time the suite
+takes; every run takes the best of several repeats, and the result is
+the best of the runs, to be less sensitive to other work on the
+computer. The value of every run is kept too, so that bench_compare.py
+can tell a change from the variation between runs. With `-a`, the runs
+of an earlier results file are added to those of this suite, so that a
+baseline can gather the runs of suites taken at different times. The
+results are only comparable between runs on the same computer; the
+output says which one it was.
+
+The detect benchmarks take a few nanoseconds per sample, and vary by
+up to 2x between suites on a busy or virtual computer, so they are
+marked as informational: bench_compare.py reports them but does not
+fail on them.
+
+The C benchmarks are taken from the build directory given (default
+host/build), and the lick library from it too. `cmake --build <build>
+--target bench` builds them and runs this with the results in
+`<build>/bench.json`.
+
+Usage: python3 bench_suite.py [-b build_dir] [-n runs] [-a earlier.json]
+       [-o results.json]
+"""
+
+import argparse
+from datetime import datetime, timezone
+import importlib.util
+import io
+import json
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.join(HERE, '..', '..')
+N_REPEATS = 5
+N_LINES = 200000
+SESSION_BLOCK = 50
+
+
+def best_time(func, *args):
+    """ Shortest time of N_REPEATS calls, and the last result. """
+    best = float('inf')
+    for _ in range(N_REPEATS):
+        start = time.perf_counter()
+        result = func(*args)
+        best = min(best, time.perf_counter() - start)
+    return (best, result)
+
+
+def result(name, value, unit, better='higher'):
+    return {'name': name, 'value': round(value, 3), 'unit': unit,
+            'better': better}
+
+
+def bench_detect(build_dir):
+    path = os.path.join(build_dir, 'bench_detect')
+    out = subprocess.run([path, '-j'], check=True, capture_output=True,
+                         text=True).stdout
+    results = json.loads(out)
+    for r in results:
+        r['informational'] = True
+    return results
+
+
+def bench_records():
+    from bench_records import (make_events, make_traces, with_native,
+                               with_native_chunks)
+    import numpy as np
+    results = []
+    streams = (("events", make_events(N_LINES), 4, np.int64),
+               ("traces", make_traces(N_LINES), 6, np.float64))
+    for (name, data, n_cols, dtype) in streams:
+        (dt, _) = best_time(with_native, data, n_cols, dtype)
+        results.append(result(f"records.{name}", len(data) / dt / 1e6,
+                              'MB/s'))
+        (dt, _) = best_time(with_native_chunks, data, n_cols, dtype)
+        results.append(result(f"records.{name}.chunks",
+                              len(data) / dt / 1e6, 'MB/s'))
+    return results
+
+
+def event_csv(events):
+    """ The csv file saved by the readers for these events. """
+    import numpy as np
+    out = io.StringIO()
+    out.write("idx,timestamp,sensorA,sensorB\n")
+    np.savetxt(out, events, delimiter=",", fmt="%d")
+    return out.getvalue()
+
+
+def bench_csv():
+    from bench_records import make_events, with_native
+    import numpy as np
+    events = with_native(make_events(N_LINES), 4, np.int64)
+    (dt, text) = best_time(event_csv, events)
+    results = [result("csv.savetxt", len(events) / dt, 'lines/s')]
+
+    spec = importlib.util.spec_from_file_location(
+        'events_to_long', os.path.join(ROOT, 'utils', 'events-to-long.py'))
+    events_to_long = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(events_to_long)
+    (dt, _) = best_time(lambda: events_to_long.to_long(
+        io.StringIO(text), io.StringIO()))
+    results.append(result("csv.to_long", len(events) / dt, 'lines/s'))
+    return results
+
+
+def event_csv_lines(n):
+    return [f"{i},{20 * i},{1 << (i % 12)},0\n" for i in range(n)]
+
+
+def write_session(directory, blocks):
+    from lick_segments import SegmentWriter
+    shutil.rmtree(directory, ignore_errors=True)
+    # Segments of 1 MB, so that rotation and compression are included.
+    writer = SegmentWriter(directory, fsync='none', max_bytes=1 << 20)
+    writer.set_header("idx,timestamp,sensorA,sensorB\n")
+    for block in blocks:
+        writer.write(block)
+        writer.flush()
+    writer.close()
+
+
+def read_session(directory):
+    from lick_segments import read_session
+    return sum(len(payload) for payload in read_session(directory))
+
+
+def bench_session():
+    lines = event_csv_lines(N_LINES)
+    blocks = [''.join(lines[i:i + SESSION_BLOCK])
+              for i in range(0, len(lines), SESSION_BLOCK)]
+    parent = tempfile.mkdtemp()
+    directory = os.path.join(parent, 'lick_events_bench')
+    try:
+        (dt, _) = best_time(write_session, directory, blocks)
+        results = [result("session.write", len(lines) / dt, 'events/s')]
+        (dt, _) = best_time(read_session, directory)
+        results.append(result("session.read", len(lines) / dt,
+                              'events/s'))
+    finally:
+        shutil.rmtree(parent)
+    return results
+
+
+def merge(runs):
+    """
+    One result per benchmark from the results of several runs: the best
+    value, and those of all runs. A result that has runs of its own (from
+    an earlier file) adds all of them.
+    """
+    merged = {}
+    for run in runs:
+        for r in run:
+            if r['name'] not in merged:
+                merged[r['name']] = dict(r, runs=[])
+            merged[r['name']]['runs'].extend(r.get('runs', [r['value']]))
+    for r in merged.values():
+        best = min if r['better'] == 'lower' else max
+        r['value'] = best(r['runs'])
+    return list(merged.values())
+
+
+def host_info():
+    cpu = platform.processor()
+    try:
+        with open('/proc/cpuinfo') as fid:
+            for line in fid:
+                if line.startswith('model name'):
+                    cpu = line.split(':', 1)[1].strip()
+                    break
+    except OSError:
+        pass
+    import numpy as np
+    return {'node': platform.node(), 'machine': platform.machine(),
+            'cpu': cpu, 'cpus': os.cpu_count(),
+            'python': platform.python_version(), 'numpy': np.__version__}
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(
+        description="Run the benchmarks and save the results as JSON")
+    parser.add_argument('-b', default=os.path.join(ROOT, 'host', 'build'),
+                        help="build directory (default host/build)")
+    parser.add_argument('-n', type=int, default=3,
+                        help="runs of the suite (default 3)")
+    parser.add_argument('-a', help="add the runs of this earlier results "
+                        "file, from the same computer")
+    parser.add_argument('-o', help="output file (default: stdout)")
+    args = parser.parse_args()
+
+    # The lick library of the same build as the C benchmarks.
+    library = os.path.join(args.b, 'liblick.so')
+    if 'LICK_LIBRARY' not in os.environ and os.path.exists(library):
+        os.environ['LICK_LIBRARY'] = library
+    sys.path.append(os.path.join(HERE, '..', 'python'))
+
+    runs = []
+    n_suites = 1
+    if args.a:
+        with open(args.a) as fid:
+            earlier = json.load(fid)
+        if earlier.get('host') != host_info():
+            sys.exit(f"{args.a} is from another computer")
+        runs.append(earlier['results'])
+        n_suites += earlier.get('suites', 1)
+    for k in range(args.n):
+        run = []
+        for (name, bench) in (("detect", lambda: bench_detect(args.b)),
+                              ("records", bench_records),
+                              ("csv", bench_csv),
+                              ("session", bench_session)):
+            print(f"{k + 1}/{args.n} {name}...", file=sys.stderr)
+            run.extend(bench())
+        runs.append(run)
+    report = {'date': datetime.now(timezone.utc).isoformat(
+                  timespec='seconds'),
+              'host': host_info(), 'suites': n_suites,
+              'results': merge(runs)}
+    text = json.dumps(report, indent=2) + '\n'
+    if args.o:
+        with open(args.o, 'w') as fid:
+            fid.write(text)
+    else:
+        sys.stdout.write(text)
@@ -0,0 +1,267 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* bench_sweep.c
+
+   Time taken by lick_sweep to replay 1000 settings on a 24-electrode
+   trace, with 1, 2, 4, ... threads.
+
+   Usage:
+     bench_sweep [-m minutes] [-j max_threads]
+
+   A synthetic trace of `minutes` (default 300, i.e. 5 hours) at 50 Hz
+   is made in memory: Gaussian noise on every electrode, with bouts of
+   licking at ~7 Hz on a few electrodes at a time. The reference onsets
+   are the starts of the simulated contacts. The settings are touch
+   thresholds from 4 to 28, four release thresholds, and ten
+   combinations of debounce, refractory period and minimum contact.
+
+   Before timing, the results of every setting on the first minutes of
+   one electrode are checked against a plain replay of one setting at a
+   time, with lick_tune_onsets and the firmware's lick_filter_step.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lick_detect.h"
+#include "lick_sweep.h"
+#include "lick_tune.h"
+
+#define N_ELECTRODES 24
+#define PERIOD_MS 20.0
+#define WINDOW 5
+#define CHECK_SAMPLES (10 * 60 * 50)
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Small deterministic PRNG so that runs are comparable. */
+static uint32_t rng_state = 12345;
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double gauss(void) {
+    double u = (rng() + 1.0) / 4294967297.0;
+    double v = (rng() + 1.0) / 4294967297.0;
+    return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+/* Fill `t` with a synthetic trace of `n` samples. */
+static int make_trace(struct lick_sweep_trace *t, size_t n) {
+    t->n_samples = n;
+    t->n_electrodes = N_ELECTRODES;
+    t->period_ms = PERIOD_MS;
+    for (size_t e = 0; e < N_ELECTRODES; e++) {
+        t->delta[e] = malloc(n * sizeof(int16_t));
+        t->ref[e] = malloc(n / 4 * sizeof(uint32_t));
+        if (t->delta[e] == NULL || t->ref[e] == NULL) {
+            return -1;
+        }
+        double sd = 1.5 + (e % 4) * 0.5;
+        size_t i = 0;
+        while (i < n) {
+            // A pause, then a bout of licks.
+            size_t pause = 500 + rng() % 20000;
+            for (size_t k = 0; k < pause && i < n; k++, i++) {
+                t->delta[e][i] = (int16_t)lround(gauss() * sd);
+            }
+            size_t n_licks = 10 + rng() % 100;
+            for (size_t k = 0; k < n_licks && i < n; k++) {
+                // ~7 Hz: 3 samples of contact, 4 without, with some
+                // jitter and a slow rise on the first sample.
+                size_t contact = 2 + rng() % 3;
+                int16_t peak = (int16_t)(30 + rng() % 30);
+                t->ref[e][t->n_ref[e]++] = (uint32_t)i;
+                for (size_t c = 0; c < contact && i < n; c++, i++) {
+                    double v = c == 0 ? peak / 2.0 : peak;
+                    t->delta[e][i] = (int16_t)lround(v + gauss() * sd);
+                }
+                size_t gap = 3 + rng() % 3;
+                for (size_t c = 0; c < gap && i < n; c++, i++) {
+                    t->delta[e][i] = (int16_t)lround(gauss() * sd);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static size_t make_settings(struct lick_sweep_params *p) {
+    // (tdbnc, rdbnc, min_ili, min_contact)
+    static const uint8_t extra[][4] = {
+        {0, 0, 0, 0}, {1, 0, 0, 0}, {0, 1, 0, 0}, {1, 1, 0, 0},
+        {2, 2, 0, 0}, {0, 0, 3, 0}, {0, 0, 0, 2}, {0, 0, 3, 2},
+        {1, 1, 3, 2}, {0, 0, 5, 3}
+    };
+    static const int eighths[] = {2, 4, 5, 7};
+    size_t n = 0;
+    for (int tth = 4; tth <= 28; tth++) {
+        for (size_t r = 0; r < 4; r++) {
+            for (size_t x = 0; x < sizeof(extra) / sizeof(extra[0]); x++) {
+                p[n++] = (struct lick_sweep_params){(uint8_t)tth,
+                    (uint8_t)(tth * eighths[r] / 8), extra[x][0],
+                    extra[x][1], extra[x][2], extra[x][3]};
+            }
+        }
+    }
+    return n;
+}
+
+/* One setting replayed plainly, sample by sample: the sensor's
+ * decision (as in lick_tune.c, whose onsets are checked too), the
+ * firmware's filter, and matching with the reference onsets. Returns
+ * false if the onsets differ from those of lick_tune_onsets.
+ */
+static bool replay_plain(const int16_t *delta, size_t n,
+                         const uint32_t *ref, size_t n_ref,
+                         const struct lick_sweep_params *p,
+                         struct lick_sweep_result *r) {
+    memset(r, 0, sizeof(*r));
+    r->n_reference = n_ref;
+    struct lick_tune_params tp = {p->tth, p->rth, p->tdbnc, p->rdbnc};
+    size_t n_tune = lick_tune_onsets(delta, n, &tp, NULL, 0);
+    size_t n_raw = 0;
+    uint8_t *matched = calloc(n_ref + 1, 1);
+    struct lick_filter f;
+    lick_filter_init(&f);
+    struct lick_sample s = {0};
+    uint8_t delay = p->min_contact > 1 ? p->min_contact - 1 : 0;
+    bool touched = false;
+    unsigned count = 0;
+    for (size_t i = 0; i < n; i++) {
+        bool onset = false;
+        if (!touched) {
+            count = delta[i] > p->tth ? count + 1 : 0;
+            if (count > p->tdbnc) {
+                touched = onset = true;
+                count = 0;
+                n_raw++;
+            }
+        } else {
+            count = delta[i] < p->rth ? count + 1 : 0;
+            if (count > p->rdbnc) {
+                touched = false;
+                count = 0;
+            }
+        }
+        s.touched[0] = touched;
+        s.onset[0] = onset;
+        if (!lick_filter_step(&f, &s, 1, p->min_ili, 0, p->min_contact)) {
+            continue;
+        }
+        r->n_onsets++;
+        // The nearest reference onset, the earlier one if two are.
+        size_t u = i - delay;
+        size_t k = 0;
+        for (size_t j = 1; j < n_ref; j++) {
+            size_t dk = u > ref[k] ? u - ref[k] : ref[k] - u;
+            size_t dj = u > ref[j] ? u - ref[j] : ref[j] - u;
+            if (dj < dk) {
+                k = j;
+            }
+        }
+        long dt = (long)u - (long)ref[k];
+        if (n_ref && labs(dt) <= WINDOW && !matched[k]) {
+            matched[k] = 1;
+            r->n_matched++;
+            r->latency_sum += dt;
+        }
+    }
+    free(matched);
+    return n_raw == n_tune;
+}
+
+int main(int argc, char *argv[]) {
+    double minutes = 300;
+    long max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+    while ((opt = getopt(argc, argv, "m:j:")) != -1) {
+        switch (opt) {
+            case 'm':
+                minutes = atof(optarg);
+                break;
+            case 'j':
+                max_threads = atol(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: bench_sweep [-m minutes] "
+                        "[-j max_threads]\n");
+                return 1;
+        }
+    }
+    size_t n = (size_t)(minutes * 60000 / PERIOD_MS);
+    static struct lick_sweep_trace trace;
+    static struct lick_sweep_params params[1000];
+    size_t n_params = make_settings(params);
+    struct lick_sweep_result *results = malloc(n_params *
+        LICK_SWEEP_MAX_ELECTRODES * sizeof(*results));
+    if (results == NULL || make_trace(&trace, n)) {
+        fprintf(stderr, "bench_sweep: out of memory\n");
+        return 1;
+    }
+
+    // Check against the plain replay, on the first minutes of an
+    // electrode with licks in them.
+    size_t e = 0;
+    size_t n_check = n < CHECK_SAMPLES ? n : CHECK_SAMPLES;
+    size_t n_ref = 0;
+    while (n_ref == 0 && e < N_ELECTRODES) {
+        while (n_ref < trace.n_ref[e] && trace.ref[e][n_ref] < n_check) {
+            n_ref++;
+        }
+        if (n_ref == 0) {
+            e++;
+        }
+    }
+    lick_sweep_electrode(trace.delta[e], n_check, trace.ref[e], n_ref,
+                         params, n_params, WINDOW, results);
+    size_t n_wrong = 0;
+    for (size_t i = 0; i < n_params; i++) {
+        struct lick_sweep_result plain;
+        if (!replay_plain(trace.delta[e], n_check, trace.ref[e], n_ref,
+                          &params[i], &plain) ||
+            memcmp(&plain, &results[i], sizeof(plain))) {
+            n_wrong++;
+        }
+    }
+    printf("check: %zu settings on %zu samples of electrode %zu, "
+           "%zu differ from the plain replay\n", n_params, n_check, e,
+           n_wrong);
+
+    printf("%zu settings, %zu electrodes, %.0f min at 50 Hz\n", n_params,
+           (size_t)N_ELECTRODES, minutes);
+    printf("threads  seconds  Msetting-samples/s\n");
+    double work = (double)n_params * N_ELECTRODES * n;
+    for (long j = 1; j <= max_threads; j *= 2) {
+        double t0 = now_s();
+        lick_sweep_run(&trace, 1, 0, params, n_params, WINDOW,
+                       (unsigned)j, results);
+        double dt = now_s() - t0;
+        printf("%7ld  %7.1f  %18.0f\n", j, dt, work / dt / 1e6);
+    }
+    lick_sweep_free(&trace);
+    free(results);
+    return n_wrong ? 1 : 0;
+}
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+# coding=utf-8
+#
+# Copyright (c) 2026 Antonio González
+
+""" lick_device.py
+
+Ask a lick sensor what it sends.
+
+The firmware answers the command `?` on its serial port with one line
+that describes it (see firmware/lick_command.h):
+
+    # device lick-sensor variant bottle-x24-usb-out version 0.2 sensors 2
+      electrodes 12 interval_us 20000 format events
+      columns idx,timestamp,sensorA,sensorB
+
+(all in one line). Host tools use it to set themselves up (number and
+names of the columns, sampling rate) instead of guessing from the data,
+which takes as long as it takes for data to arrive.
+
+Example
+-------
+    from serial import Serial
+    from lick_device import describe
+
+    with Serial('/dev/ttyACM0', 115200) as port:
+        device = describe(port)
+    if device is not None:
+        print(device['variant'], device['columns'])
+"""
+
+import time
+
+DESCRIBE = b'?'
+PREFIX = b'# device '
+
+
+def parse_descriptor(line):
+    """
+    Parse a `# device` line into a dict. Values are int when they are
+    numbers, and `columns` is a list of names. Returns None if the line
+    is not a description. The firmware version is kept as text.
+    """
+    if isinstance(line, bytes):
+        line = line.decode('ascii', errors='replace')
+    fields = line.split()
+    if len(fields) < 3 or fields[:2] != ['#', 'device']:
+        return None
+    device = {'name': fields[2]}
+    for (key, value) in zip(fields[3::2], fields[4::2]):
+        if key == 'columns':
+            device[key] = value.split(',')
+        elif key == 'version':
+            device[key] = value
+        else:
+            try:
+                device[key] = int(value)
+            except ValueError:
+                device[key] = value
+    return device
+
+
+def describe(port, timeout=0.5, attempts=2):
+    """
+    Send the describe command on an open pySerial port, and return the
+    reply parsed by `parse_descriptor`, or None if there is none (e.g.
+    firmware older than the command). The command is sent once and the
+    whole reply is waited for up to `timeout` seconds; only then is it
+    sent again, in case it was lost while the port was being opened, up
+    to `attempts` times in all.
+
+    Data received before the reply is dropped, and so is any received
+    with or after it (e.g. a late reply to an earlier attempt): the input
+    buffer is flushed before returning. The port's timeout is left as it
+    was.
+    """
+    old_timeout = port.timeout
+    port.timeout = 0
+    try:
+        for _ in range(attempts):
+            port.write(DESCRIBE)
+            device = _wait_reply(port, time.monotonic() + timeout)
+            if device is not None:
+                return device
+        return None
+    finally:
+        port.reset_input_buffer()
+        port.timeout = old_timeout
+
+
+def _wait_reply(port, t_end):
+    # Read until a whole `# device` line has arrived or until `t_end`.
+    buffer = b''
+    while time.monotonic() < t_end:
+        buffer += port.read(max(1, port.in_waiting))
+        start = buffer.find(PREFIX)
+        if start >= 0:
+            end = buffer.find(b'\n', start)
+            if end >= 0:
+                return parse_descriptor(buffer[start:end])
+            buffer = buffer[start:]
+        else:
+            # Keep only what could be the start of a reply.
+            buffer = buffer[-len(PREFIX):]
+        time.sleep(0.001)
+    return None
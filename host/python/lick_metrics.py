@@ -0,0 +1,308 @@
+#!/usr/bin/env python3
+# coding=utf-8
+#
+# Copyright (c) 2026 Antonio González
+
+""" lick_metrics.py
+
+Live counters of the lick events readers, served in the Prometheus text
+format, so that a backlog, a broken stream or a silent sensor can be
+seen while the experiment is running instead of after it.
+
+`ReaderMetrics` is updated by a reader once per read of the serial port
+and once per write to disk. `serve` answers HTTP requests for any path
+(e.g. /metrics) on a local TCP port or a Unix socket, on a thread of
+its own:
+
+    curl -s localhost:9180/metrics
+    curl -s --unix-socket /tmp/lick.sock http://localhost/metrics
+
+Metrics, all labelled with the device (serial port):
+
+    lick_bytes_total                      bytes received
+    lick_records_total                    lick events decoded
+    lick_comments_total                   lines starting with `#`
+    lick_parse_errors_total               lines that were not valid
+    lick_count_gaps_total                 jumps in the event count
+    lick_events_lost_total                events missing from the jumps
+    lick_electrode_events_total           events of each electrode
+                                          (label electrode="A0", ...)
+    lick_read_bytes                       histogram of the bytes waiting
+                                          at each read of the port
+    lick_write_seconds                    histogram of the time taken to
+                                          write one block to disk
+    lick_compress_queue                   closed segments waiting to be
+                                          compressed
+    lick_seconds_since_last_data          since anything was received
+    lick_seconds_since_last_record        since the last lick event
+
+The reader only keeps a reference to what it received; everything is
+counted, with numpy, when the metrics are requested (or every
+MAX_PENDING_READS reads). See host/bench/bench_metrics.py for what this
+costs.
+
+Example
+-------
+    metrics = ReaderMetrics('/dev/ttyACM0')
+    serve(metrics, 'localhost:9180')
+    ...
+    metrics.received(data, events, decoder.n_bad, n_comments)
+"""
+
+import bisect
+import collections
+from http.server import BaseHTTPRequestHandler, HTTPServer
+import itertools
+import os
+import socketserver
+import threading
+import time
+
+import numpy as np
+
+CONTENT_TYPE = 'text/plain; version=0.0.4; charset=utf-8'
+
+# Histogram buckets (upper bounds). The serial port is read every 1 or
+# 2 s; at 115200 baud up to ~11 kB can arrive per second.
+READ_BYTES_BUCKETS = (64, 256, 1024, 4096, 16384, 65536)
+WRITE_SECONDS_BUCKETS = (0.0001, 0.0003, 0.001, 0.003, 0.01, 0.03, 0.1,
+                         0.3, 1.0)
+
+# Reads of the serial port after which the metrics are updated even if
+# they have not been requested, to keep the memory bounded.
+MAX_PENDING_READS = 1000
+
+# Bits set in each value of a byte, least significant first.
+BYTE_BITS = np.unpackbits(np.arange(256, dtype=np.uint8)[:, None], axis=1,
+                          bitorder='little').astype(np.int64)
+
+
+class Histogram:
+    """Counts of observations under each bucket bound, sum and count."""
+    def __init__(self, buckets):
+        self.buckets = buckets
+        self.counts = [0] * (len(buckets) + 1)
+        self.sum = 0
+        self.count = 0
+
+    def add(self, values):
+        for value in values:
+            self.counts[bisect.bisect_left(self.buckets, value)] += 1
+        self.sum += sum(values)
+        self.count += len(values)
+
+    def lines(self, name, labels):
+        """Names and labels of the lines of the histogram."""
+        return ([f'{name}_bucket{{{labels},le="{bound}"}}'
+                 for bound in self.buckets + ('+Inf',)] +
+                [f'{name}_sum{{{labels}}}', f'{name}_count{{{labels}}}'])
+
+    def values(self):
+        """Values of the lines of the histogram."""
+        return (list(itertools.accumulate(self.counts)) +
+                [self.sum, self.count])
+
+
+class ReaderMetrics:
+    """
+    Metrics of one lick events reader, reading from `device`. `writer`,
+    if given, is the SegmentWriter of the session (for its compression
+    queue).
+    """
+    def __init__(self, device, writer=None):
+        self.labels = f'device="{device}"'
+        self.writer = writer
+        self.n_bytes = 0
+        self.n_records = 0
+        self.n_comments = 0
+        self.n_bad = 0
+        self.n_gaps = 0
+        self.n_lost = 0
+        self.last_count = None
+        self.last_data = None
+        self.last_record = None
+        self.read_bytes = Histogram(READ_BYTES_BUCKETS)
+        self.write_seconds = Histogram(WRITE_SECONDS_BUCKETS)
+        # Events of each electrode (up to 32) of each sensor.
+        self.electrodes = np.zeros((0, 32), dtype=np.int64)
+        # Reads and writes not yet counted. The reader only appends to
+        # these (which is thread-safe for a deque); all the counting is
+        # done in `update`.
+        self._reads = collections.deque()
+        self._writes = collections.deque()
+        self._lock = threading.Lock()
+        # The text of the metrics, with a {} for every value, made again
+        # when the lines change (e.g. a new electrode).
+        self._template = None
+        self._template_key = None
+
+    def received(self, data, events, n_bad, n_comments=0):
+        """
+        Count one read of the serial port: the bytes received, the
+        events decoded from them (array, one row per event, columns
+        count, timestamp and one per sensor), the total of bad lines so
+        far, and the comments. `events` must not be changed afterwards.
+        """
+        self.n_bad = n_bad
+        self.n_comments += n_comments
+        self._reads.append((time.monotonic(), len(data), events))
+        if len(self._reads) >= MAX_PENDING_READS:
+            self.update()
+
+    def wrote(self, seconds):
+        """Count one write of a block to disk, taking `seconds`."""
+        self._writes.append(seconds)
+
+    def update(self):
+        """Count the reads and writes received since the last update."""
+        # Called from the reader and from the server thread.
+        with self._lock:
+            reads = [self._reads.popleft() for _ in range(len(self._reads))]
+            writes = [self._writes.popleft()
+                      for _ in range(len(self._writes))]
+            self.write_seconds.add(writes)
+            sizes = []
+            batch = []
+            for (t, size, events) in reads:
+                sizes.append(size)
+                if size:
+                    self.last_data = t
+                if len(events):
+                    self.last_record = t
+                    batch.append(events)
+            self.n_bytes += sum(sizes)
+            self.read_bytes.add(sizes)
+            if len(batch) == 1:
+                self._count_events(batch[0])
+            elif batch:
+                self._count_events(np.concatenate(batch))
+
+    def _count_events(self, events):
+        n = len(events)
+        self.n_records += n
+        if self.last_count is None:
+            # Events sent before the reader started are not lost.
+            self.last_count = int(events[0, 0]) - 1
+        # Counts are consecutive unless events were lost (or the lick
+        # sensor restarted).
+        jumps = np.diff(events[:, 0], prepend=self.last_count)
+        n_gaps = int(np.count_nonzero(jumps != 1))
+        if n_gaps:
+            self.n_gaps += n_gaps
+            self.n_lost += int((jumps[jumps > 1] - 1).sum())
+        self.last_count = int(events[-1, 0])
+        # One bit per electrode in each sensor column. The values of the
+        # low 4 bytes (of the little-endian int64) of every sensor are
+        # counted in one histogram, and then the bits set in each value.
+        n_sensors = events.shape[1] - 2
+        if n_sensors > len(self.electrodes):
+            self.electrodes = np.vstack((self.electrodes, np.zeros(
+                (n_sensors - len(self.electrodes), 32), np.int64)))
+        masks = np.ascontiguousarray(events, dtype='<i8').view(np.uint8)
+        masks = masks.reshape(n, -1, 8)[:, 2:, :4]
+        offsets = 256 * np.arange(n_sensors * 4).reshape(n_sensors, 4)
+        hist = np.bincount((masks + offsets).ravel(),
+                           minlength=256 * 4 * n_sensors)
+        self.electrodes[:n_sensors] += (
+            hist.reshape(-1, 256) @ BYTE_BITS).reshape(n_sensors, 32)
+
+    def _make_template(self, n_electrodes):
+        lab = self.labels
+        out = []
+
+        def add(name, kind, text, lines):
+            out.append(f'# HELP {name} {text}')
+            out.append(f'# TYPE {name} {kind}')
+            for line in lines:
+                out.append(line.replace('{', '{{').replace('}', '}}') +
+                           ' {}')
+
+        for (name, text) in (
+                ('lick_bytes_total', 'Bytes received.'),
+                ('lick_records_total', 'Lick events decoded.'),
+                ('lick_comments_total', 'Comment lines received.'),
+                ('lick_parse_errors_total',
+                 'Lines that were not valid records.'),
+                ('lick_count_gaps_total', 'Jumps in the event count.'),
+                ('lick_events_lost_total',
+                 'Events missing from jumps in the event count.')):
+            add(name, 'counter', text, [f'{name}{{{lab}}}'])
+        add('lick_electrode_events_total', 'counter',
+            'Lick events of each electrode.',
+            [f'lick_electrode_events_total{{{lab},'
+             f'electrode="{chr(ord("A") + s)}{e}"}}'
+             for s in range(len(self.electrodes))
+             for e in range(n_electrodes)])
+        add('lick_read_bytes', 'histogram',
+            'Bytes waiting at each read of the serial port.',
+            self.read_bytes.lines('lick_read_bytes', lab))
+        add('lick_write_seconds', 'histogram',
+            'Time taken to write one block to disk.',
+            self.write_seconds.lines('lick_write_seconds', lab))
+        if self.writer is not None:
+            add('lick_compress_queue', 'gauge',
+                'Closed segments waiting to be compressed.',
+                [f'lick_compress_queue{{{lab}}}'])
+        for (name, text, t) in (
+                ('lick_seconds_since_last_data',
+                 'Seconds since anything was received.', self.last_data),
+                ('lick_seconds_since_last_record',
+                 'Seconds since the last lick event.', self.last_record)):
+            if t is not None:
+                add(name, 'gauge', text, [f'{name}{{{lab}}}'])
+        return '\n'.join(out) + '\n'
+
+    def render(self):
+        """Return all the metrics, in the Prometheus text format."""
+        self.update()
+        now = time.monotonic()
+        # Electrodes up to the highest one that has had an event.
+        n_electrodes = int(np.flatnonzero(
+            self.electrodes.any(axis=0)).max(initial=-1)) + 1
+        key = (self.electrodes.shape, n_electrodes,
+               self.last_data is None, self.last_record is None)
+        if key != self._template_key:
+            self._template = self._make_template(n_electrodes)
+            self._template_key = key
+        values = [self.n_bytes, self.n_records, self.n_comments,
+                  self.n_bad, self.n_gaps, self.n_lost]
+        values += self.electrodes[:, :n_electrodes].ravel().tolist()
+        values += self.read_bytes.values()
+        values += self.write_seconds.values()
+        if self.writer is not None:
+            values.append(self.writer.compress_queue)
+        for t in (self.last_data, self.last_record):
+            if t is not None:
+                values.append(f'{now - t:.3f}')
+        return self._template.format(*values)
+
+
+class _Handler(BaseHTTPRequestHandler):
+    def do_GET(self):
+        body = self.server.metrics.render().encode()
+        self.send_response(200)
+        self.send_header('Content-Type', CONTENT_TYPE)
+        self.send_header('Content-Length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def log_message(self, format, *args):
+        pass
+
+
+def serve(metrics, address):
+    """
+    Serve `metrics` on `address`, either 'host:port' (e.g.
+    'localhost:9180') or the path of a Unix socket, from a background
+    thread. Return the server (call `shutdown` to stop it).
+    """
+    if address.startswith('/') or address.startswith('.'):
+        if os.path.exists(address):
+            os.remove(address)
+        server = socketserver.UnixStreamServer(address, _Handler)
+    else:
+        (host, port) = address.rsplit(':', 1)
+        server = HTTPServer((host, int(port)), _Handler)
+    server.metrics = metrics
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    return server
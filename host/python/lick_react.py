@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+# coding=utf-8
+#
+# Copyright (c) 2026 Antonio González
+
+""" lick_react.py
+
+React to lick events on chosen electrodes, from Python, by toggling the
+action pin of the lick sensor (see the `!` command in
+firmware/lick_command.h).
+
+This is the Python counterpart of host/tools/lick_react, for
+experiment scripts that decide what to do in Python. The serial port is
+read as soon as anything arrives (not in batches, as the lick events
+readers do), and the command is sent before the events are handed to
+the script.
+
+With the action pin connected to the sync input, the latency from each
+lick event to the action is measured as by lick_react; run this file
+to print a summary:
+
+    python3 lick_react.py /dev/ttyACM0 1:0 -t 60
+
+Example
+-------
+    from serial import Serial
+    from lick_react import Reactor
+
+    with Serial('/dev/ttyACM0', 115200) as port:
+        reactor = Reactor(port, {(1, 0)})    # Electrode 0 of sensor B
+        while True:
+            events = reactor.poll()          # Reacts, then returns them
+"""
+
+import argparse
+import time
+
+import numpy as np
+
+from lick_device import describe
+from lick_records import RecordDecoder
+
+ACTION = b'!'
+N_COLUMNS = 4
+
+
+class Reactor:
+    """
+    Send the action command, on an open pySerial port, for every lick
+    event on an electrode in `electrodes`, a set of (sensor, electrode)
+    pairs.
+    """
+    def __init__(self, port, electrodes):
+        self.port = port
+        device = describe(port)
+        if device is not None and 'columns' in device:
+            n_cols = len(device['columns'])
+        else:
+            n_cols = N_COLUMNS
+        self.decoder = RecordDecoder(n_cols)
+        self.masks = np.zeros(n_cols - 2, dtype=np.int64)
+        for (sensor, electrode) in electrodes:
+            if sensor < len(self.masks):
+                self.masks[sensor] |= 1 << electrode
+        self.level = False
+        self.n_actions = 0
+        self.pending_ms = []        # Events that raised the pin
+        self.latency_ms = []
+        self.host_ms = []
+        self.comments = []
+        port.timeout = 0.1
+        port.reset_input_buffer()
+
+    def poll(self):
+        """
+        Wait (up to 0.1 s) for data, react to it, and return the lick
+        events received as an array (one row per event). Comments are
+        kept in `self.comments`.
+        """
+        data = self.port.read(max(1, self.port.in_waiting))
+        t_read = time.monotonic()
+        self.decoder.feed(data)
+        events = self.decoder.read()
+        if len(events) > 0:
+            hits = (events[:, 2:] & self.masks).any(axis=1)
+            hits = np.flatnonzero(hits)
+            for row in hits:
+                self.port.write(ACTION)
+                self.host_ms.append(1000 * (time.monotonic() - t_read))
+                self.n_actions += 1
+                self.level = not self.level
+                if self.level:
+                    self.pending_ms.append(events[row, 1])
+        for comment in self.decoder.comments():
+            self.comments.append(comment)
+            fields = comment.split()
+            if fields[1:3] == ['sync', 'in'] and self.pending_ms:
+                t_ms = self.pending_ms.pop(0)
+                self.latency_ms.append(int(fields[4]) / 1000 - t_ms)
+        return events
+
+
+def summary(name, times):
+    if len(times) == 0:
+        print(f"{name}: none")
+        return
+    (p50, p99) = np.percentile(times, [50, 99])
+    print(f"{name}: n {len(times)} p50 {p50:.2f} p99 {p99:.2f} "
+          f"max {max(times):.2f} ms")
+
+
+if __name__ == '__main__':
+    from serial import Serial
+
+    parser = argparse.ArgumentParser(
+        description="React to lick events and measure the latency")
+    parser.add_argument('port')
+    parser.add_argument('electrodes', nargs='*', default=[],
+                        help="sensor:electrode (default: all)")
+    parser.add_argument('-t', type=float, default=10,
+                        help="seconds (default 10)")
+    args = parser.parse_args()
+    if args.electrodes:
+        electrodes = {tuple(int(v) for v in e.split(':'))
+                      for e in args.electrodes}
+    else:
+        electrodes = {(s, e) for s in range(2) for e in range(12)}
+
+    with Serial(args.port, 115200) as port:
+        reactor = Reactor(port, electrodes)
+        t_end = time.monotonic() + args.t
+        try:
+            while time.monotonic() < t_end:
+                reactor.poll()
+        except KeyboardInterrupt:
+            pass
+    print(f"{reactor.n_actions} actions")
+    summary("lick to action", reactor.latency_ms)
+    summary("host (read to command sent)", reactor.host_ms)
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+# coding=utf-8
+#
+# Copyright (c) 2026 Antonio González
+
+""" lick_records.py
+
+Decode the text records sent by the lick sensor into numpy arrays.
+
+Text from the serial port is passed to `RecordDecoder.feed` as it
+arrives, in chunks of any size; `RecordDecoder.read` returns all the
+complete lines received so far as one 2-D numpy array (one row per
+line), and keeps any incomplete line for later. Lines starting with `#`
+(e.g. sensor health reports) are returned separately by
+`RecordDecoder.comments`, and lines that are not valid records are
+skipped and counted in `RecordDecoder.n_bad`.
+
+The decoding is done by the native `lick` library (see
+common/lick_records.h), which writes the values straight into the
+memory of the returned array, without creating a Python object per
+value. Build it with
+
+    cmake -S host -B host/build
+    cmake --build host/build
+
+The library is looked for in the path given by the LICK_LIBRARY
+environment variable, then in host/build, and then in the system
+library paths.
+
+Example
+-------
+    decoder = RecordDecoder(n_cols=4)
+    decoder.feed(b"0 1200 1 0\\r\\n1 1320 0 2\\r\\n2 14")
+    decoder.read()   # array([[0, 1200, 1, 0], [1, 1320, 0, 2]])
+"""
+
+import ctypes
+import ctypes.util
+import os
+
+import numpy as np
+
+_HERE = os.path.dirname(os.path.abspath(__file__))
+_BUILD_DIR = os.path.join(_HERE, '..', 'build')
+
+
+def _load_library():
+    paths = []
+    if os.environ.get('LICK_LIBRARY'):
+        paths.append(os.environ['LICK_LIBRARY'])
+    paths.append(os.path.join(_BUILD_DIR, 'liblick.so'))
+    paths.append(os.path.join(_BUILD_DIR, 'liblick.dylib'))
+    system = ctypes.util.find_library('lick')
+    if system:
+        paths.append(system)
+    for path in paths:
+        if os.path.exists(path) or path == system:
+            return ctypes.CDLL(path)
+    raise OSError("the lick library was not found; build it with "
+                  "`cmake -S host -B host/build && "
+                  "cmake --build host/build` or set LICK_LIBRARY")
+
+
+_lib = _load_library()
+
+_handle = ctypes.c_void_p
+_lib.lick_records_new.argtypes = [ctypes.c_uint32]
+_lib.lick_records_new.restype = _handle
+_lib.lick_records_free.argtypes = [_handle]
+_lib.lick_records_free.restype = None
+_lib.lick_records_feed.argtypes = [_handle, ctypes.c_char_p,
+                                   ctypes.c_size_t]
+_lib.lick_records_feed.restype = ctypes.c_int
+_lib.lick_records_n_lines.argtypes = [_handle]
+_lib.lick_records_n_lines.restype = ctypes.c_size_t
+_lib.lick_records_read_i64.argtypes = [_handle, ctypes.c_void_p,
+                                       ctypes.c_size_t]
+_lib.lick_records_read_i64.restype = ctypes.c_size_t
+_lib.lick_records_read_f64.argtypes = [_handle, ctypes.c_void_p,
+                                       ctypes.c_size_t]
+_lib.lick_records_read_f64.restype = ctypes.c_size_t
+_lib.lick_records_n_cols.argtypes = [_handle]
+_lib.lick_records_n_cols.restype = ctypes.c_uint32
+_lib.lick_records_n_bad.argtypes = [_handle]
+_lib.lick_records_n_bad.restype = ctypes.c_uint64
+_lib.lick_records_comments_len.argtypes = [_handle]
+_lib.lick_records_comments_len.restype = ctypes.c_size_t
+_lib.lick_records_comments.argtypes = [_handle, ctypes.c_char_p,
+                                       ctypes.c_size_t]
+_lib.lick_records_comments.restype = ctypes.c_size_t
+
+
+class RecordDecoder:
+    """
+    Decoder of text records with `n_cols` values per line (or as many
+    as the first valid line has, if 0). `dtype` is np.int64 or
+    np.float64.
+    """
+    def __init__(self, n_cols=0, dtype=np.int64):
+        self.dtype = np.dtype(dtype)
+        if self.dtype == np.int64:
+            self._read = _lib.lick_records_read_i64
+        elif self.dtype == np.float64:
+            self._read = _lib.lick_records_read_f64
+        else:
+            raise ValueError("dtype must be int64 or float64")
+        self._r = _lib.lick_records_new(n_cols)
+        if not self._r:
+            raise MemoryError()
+
+    def __del__(self):
+        if getattr(self, '_r', None):
+            _lib.lick_records_free(self._r)
+            self._r = None
+
+    @property
+    def n_cols(self):
+        return _lib.lick_records_n_cols(self._r)
+
+    @property
+    def n_bad(self):
+        return _lib.lick_records_n_bad(self._r)
+
+    def feed(self, data):
+        if _lib.lick_records_feed(self._r, data, len(data)) != 0:
+            raise MemoryError()
+
+    def read(self):
+        """
+        Return the complete lines received so far as an array of shape
+        (n_lines, n_cols).
+        """
+        n_cols = self.n_cols
+        n_lines = _lib.lick_records_n_lines(self._r)
+        out = np.empty((n_lines, max(n_cols, 1)), dtype=self.dtype)
+        if n_cols == 0 or n_lines == 0:
+            return out[:0]
+        n = self._read(self._r, out.ctypes.data, n_lines)
+        return out[:n]
+
+    def comments(self):
+        """
+        Return the comment lines found so far, as a list of strings.
+        """
+        size = _lib.lick_records_comments_len(self._r)
+        if size == 0:
+            return []
+        buf = ctypes.create_string_buffer(size)
+        n = _lib.lick_records_comments(self._r, buf, size)
+        return buf.raw[:n].decode(errors='replace').splitlines()
@@ -0,0 +1,382 @@
+#!/usr/bin/env python3
+# coding=utf-8
+#
+# Copyright (c) 2026 Antonio González
+
+""" lick_segments.py
+
+Write a session to disk so that a crash or a power cut loses at most the
+last block, and never leaves a damaged file.
+
+A session is a directory of segments, `<name>-0000.csv`,
+`<name>-0001.csv`, ... Text is written in blocks (one per call to
+`flush`, i.e. one per read of the serial port in the lick events
+readers), each preceded by a line
+
+    # block <sequence number> <length, bytes> <CRC-32, hex>
+
+so that a block that was only partly written can be told apart from a
+complete one. Block lines start with `#`, so segments are still csv
+files with comments that the other tools can read.
+
+A segment is closed when it reaches `max_bytes` or is `max_seconds`
+old, and a new one is started. The session header (date, column names;
+see `set_header`) is written at the start of every segment, in a block
+marked `# header` instead of `# block`, so that each segment can be
+read on its own. Closed segments are compressed with gzip
+(`<name>-0000.csv.gz`) on a background thread, so that writing does not
+wait for them.
+
+When a session directory is opened again (e.g. the reader restarted
+after a crash), the last segment is cut back to its last valid block,
+segments that were closed but not compressed are compressed, and
+writing continues in a new segment.
+
+A writer holds a lock on its directory while it is open, which the
+system releases if the process dies, and `close` leaves a `.closed`
+file in it. A session without one was not closed: `recover_sessions`
+finds those in a directory that are not open in another writer, and
+recovers them as above without writing anything else. The readers do
+this when they start, before starting a new session.
+
+How often data is forced to disk with fsync is set by `fsync`:
+
+    'block'      every block (nothing written is lost)
+    'interval'   at most every `fsync_interval` seconds
+    'segment'    when a segment is closed
+    'none'       never; the operating system writes data when it wants
+
+Until it is on disk, data can be lost in a power cut, but not in a
+crash of the reader alone. See host/bench/bench_segments.py for what
+each option costs.
+
+Example
+-------
+    writer = SegmentWriter('lick_events_2026-10-18')
+    writer.set_header('idx,timestamp,sensorA,sensorB\\n')
+    writer.write('0,0,1,0\\n')
+    writer.flush()              # One block
+    writer.close()
+
+    # When the reader starts again after a crash:
+    recover_sessions('.', 'lick_events_*')
+
+`python3 lick_segments.py <session directory> > session.csv` joins the
+valid blocks of all segments into a single csv file, with the header
+only once.
+"""
+
+import glob
+import gzip
+import os
+import queue
+import re
+import shutil
+import sys
+import threading
+import time
+import zlib
+
+try:
+    import fcntl
+except ImportError:
+    # Not on Windows, where sessions are not locked.
+    fcntl = None
+
+FSYNC_POLICIES = ('block', 'interval', 'segment', 'none')
+BLOCK_LINE = re.compile(rb'# (block|header) (\d+) (\d+) ([0-9a-f]{8})\n')
+LOCK = '.lock'
+CLOSED = '.closed'
+
+
+def _fsync_dir(path):
+    # Make the creation or renaming of files in the directory durable.
+    fd = os.open(path, os.O_RDONLY)
+    try:
+        os.fsync(fd)
+    finally:
+        os.close(fd)
+
+
+def _lock(directory):
+    # Lock a session for the writer that has it open. The lock goes with
+    # the file, so it is also released if the process dies. Raises
+    # BlockingIOError if another writer holds it.
+    fid = open(os.path.join(directory, LOCK), 'a')
+    if fcntl is not None:
+        try:
+            fcntl.flock(fid, fcntl.LOCK_EX | fcntl.LOCK_NB)
+        except OSError:
+            fid.close()
+            raise
+    return fid
+
+
+def read_blocks(data):
+    """
+    Return the valid blocks at the start of `data` (bytes of one
+    segment), as a list of (kind, sequence number, payload), where kind
+    is b'block' or b'header', and the length of the data that they take
+    up. Anything after the first block that is incomplete or fails its
+    checksum is not valid.
+    """
+    blocks = []
+    pos = 0
+    while True:
+        match = BLOCK_LINE.match(data, pos)
+        if match is None:
+            break
+        (kind, seq, length, crc) = match.groups()
+        start = match.end()
+        end = start + int(length)
+        payload = data[start:end]
+        if end > len(data) or zlib.crc32(payload) != int(crc, 16):
+            break
+        blocks.append((kind, int(seq), payload))
+        pos = end
+    return (blocks, pos)
+
+
+def read_segment(path):
+    """Return the valid blocks of a segment (see `read_blocks`)."""
+    opener = gzip.open if path.endswith('.gz') else open
+    with opener(path, 'rb') as fin:
+        return read_blocks(fin.read())[0]
+
+
+def segment_paths(directory):
+    """
+    Return the segments of a session in order, as paths to the plain
+    or compressed file, whichever exists.
+    """
+    paths = {}
+    for path in glob.glob(os.path.join(directory, '*-[0-9][0-9][0-9][0-9]'
+                                       '.csv*')):
+        match = re.search(r'-(\d{4,})\.csv(\.gz)?$', path)
+        if match is None:
+            continue
+        number = int(match.group(1))
+        # A plain file is only left next to its compressed copy if the
+        # copy was not finished.
+        if number not in paths or not match.group(2):
+            paths[number] = path
+    return [paths[n] for n in sorted(paths)]
+
+
+def read_session(directory):
+    """
+    Yield the payload of every valid block of a session, in order, with
+    the session header only once.
+    """
+    have_header = False
+    for path in segment_paths(directory):
+        for (kind, _, payload) in read_segment(path):
+            if kind == b'header':
+                if have_header:
+                    continue
+                have_header = True
+            yield payload
+
+
+def recover_sessions(parent, pattern='*'):
+    """
+    Recover the sessions in `parent` whose names match `pattern` that
+    were not closed (e.g. the reader crashed or the power was cut) and
+    that no other writer has open: cut the last segment back to its last
+    valid block, compress all segments and mark the session as closed.
+    Return a list of (directory, bytes cut) of the sessions recovered.
+    """
+    recovered = []
+    for directory in sorted(glob.glob(os.path.join(parent, pattern))):
+        if (not os.path.isdir(directory) or
+                os.path.exists(os.path.join(directory, CLOSED))):
+            continue
+        if (not segment_paths(directory) and
+                not os.path.exists(os.path.join(directory, LOCK))):
+            # Not a session.
+            continue
+        try:
+            writer = SegmentWriter(directory, fsync='segment')
+        except BlockingIOError:
+            # Still being written.
+            continue
+        writer.close()
+        recovered.append((directory, writer.n_recovered))
+    return recovered
+
+
+class SegmentWriter:
+    """
+    File-like writer of a session into checksummed blocks and segments
+    in `directory` (created if needed). Raises BlockingIOError if the
+    session is open in another writer.
+    """
+    def __init__(self, directory, fsync='block', fsync_interval=1.0,
+                 max_bytes=16 << 20, max_seconds=3600):
+        if fsync not in FSYNC_POLICIES:
+            raise ValueError(f"fsync must be one of {FSYNC_POLICIES}")
+        os.makedirs(directory, exist_ok=True)
+        self._lock = _lock(directory)
+        # The session is open again until it is closed.
+        closed = os.path.join(directory, CLOSED)
+        if os.path.exists(closed):
+            os.remove(closed)
+        self.directory = directory
+        self.name = os.path.basename(os.path.normpath(directory))
+        self.header = b''
+        self.fsync = fsync
+        self.fsync_interval = fsync_interval
+        self.max_bytes = max_bytes
+        self.max_seconds = max_seconds
+        self.seq = 0
+        self.n_recovered = 0        # Bytes cut from a damaged segment
+        self._pending = []
+        self._fid = None
+        self._last_sync = time.monotonic()
+        self._queue = queue.Queue()
+        self._compressor = threading.Thread(target=self._compress_loop,
+                                            daemon=True)
+        self._compressor.start()
+        self._number = self._recover()
+
+    # File-like interface, as used by the readers.
+    def write(self, text):
+        self._pending.append(text)
+
+    def flush(self):
+        """
+        Write what was written since the last flush as one block, and
+        return its length (0 if there was nothing to write).
+        """
+        if not self._pending:
+            return 0
+        payload = ''.join(self._pending).encode()
+        self._pending = []
+        if self._fid is None or self._due():
+            self._rotate()
+        self._write_block(payload)
+        return len(payload)
+
+    @property
+    def compress_queue(self):
+        """Number of closed segments waiting to be compressed."""
+        return self._queue.qsize()
+
+    def set_header(self, text):
+        """
+        Write the session header, after anything written before, and
+        again at the start of every new segment.
+        """
+        self.flush()
+        self.header = text.encode()
+        if self._fid is None:
+            self._rotate()
+        else:
+            self._write_block(self.header, b'header')
+
+    def close(self):
+        """
+        Flush, close the segment, wait until all closed segments have
+        been compressed, and mark the session as closed.
+        """
+        self.flush()
+        self._close_segment()
+        self._queue.put(None)
+        self._compressor.join()
+        open(os.path.join(self.directory, CLOSED), 'w').close()
+        if self.fsync != 'none':
+            _fsync_dir(self.directory)
+        self._lock.close()
+
+    # Segments
+    def _path(self, number):
+        return os.path.join(self.directory,
+                            f'{self.name}-{number:04d}.csv')
+
+    def _due(self):
+        return (self._fid.tell() >= self.max_bytes or
+                time.monotonic() - self._opened >= self.max_seconds)
+
+    def _write_block(self, payload, kind=b'block'):
+        line = b'# %s %d %d %08x\n' % (kind, self.seq, len(payload),
+                                       zlib.crc32(payload))
+        self._fid.write(line + payload)
+        self._fid.flush()
+        self.seq += 1
+        now = time.monotonic()
+        if self.fsync == 'block' or (self.fsync == 'interval' and
+                now - self._last_sync >= self.fsync_interval):
+            os.fsync(self._fid.fileno())
+            self._last_sync = now
+
+    def _rotate(self):
+        self._close_segment()
+        self._fid = open(self._path(self._number), 'xb')
+        self._opened = time.monotonic()
+        self._number += 1
+        if self.fsync != 'none':
+            _fsync_dir(self.directory)
+        if self.header:
+            self._write_block(self.header, b'header')
+
+    def _close_segment(self):
+        if self._fid is None:
+            return
+        if self.fsync != 'none':
+            os.fsync(self._fid.fileno())
+        self._fid.close()
+        self._queue.put(self._fid.name)
+        self._fid = None
+
+    def _recover(self):
+        """
+        Cut the last segment of an existing session back to its last
+        valid block, queue closed segments that are not yet compressed,
+        and return the number of the next segment.
+        """
+        paths = segment_paths(self.directory)
+        for path in glob.glob(os.path.join(self.directory, '*.gz.tmp')):
+            os.remove(path)
+        if not paths:
+            return 0
+        last = paths[-1]
+        if last.endswith('.gz'):
+            blocks = read_segment(last)
+        else:
+            with open(last, 'rb+') as fid:
+                (blocks, valid) = read_blocks(fid.read())
+                self.n_recovered = fid.tell() - valid
+                fid.truncate(valid)
+                os.fsync(fid.fileno())
+        if blocks:
+            self.seq = blocks[-1][1] + 1
+        # Keep the session header for the segments to come.
+        for (kind, _, payload) in blocks:
+            if kind == b'header':
+                self.header = payload
+        for path in paths:
+            if not path.endswith('.gz'):
+                self._queue.put(path)
+        number = re.search(r'-(\d{4,})\.csv', last).group(1)
+        return int(number) + 1
+
+    # Compression, on its own thread. The compressed copy is written to
+    # a temporary file, and replaces the plain one only once complete.
+    def _compress_loop(self):
+        while True:
+            path = self._queue.get()
+            if path is None:
+                return
+            tmp = path + '.gz.tmp'
+            with open(path, 'rb') as fin, gzip.open(tmp, 'wb') as fout:
+                shutil.copyfileobj(fin, fout)
+            with open(tmp, 'rb') as fid:
+                os.fsync(fid.fileno())
+            os.rename(tmp, path + '.gz')
+            _fsync_dir(self.directory)
+            os.remove(path)
+
+
+if __name__ == '__main__':
+    for payload in read_session(sys.argv[1]):
+        sys.stdout.buffer.write(payload)
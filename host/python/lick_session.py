@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+# coding=utf-8
+#
+# Copyright (c) 2026 Antonio González
+
+""" lick_session.py
+
+The session of a lick events reader: what the readers of every variant
+(bottle-*/lick_events_reader.py) do with the lick events once they have
+parsed them.
+
+A session is a directory of csv segments named after the date and time
+at which the reader started, `lick_events_<date>`, written one
+checksummed block per read of the serial port (see lick_segments.py).
+While it is written, counters of what is received are served on
+`METRICS` (see lick_metrics.py) and, with `SQLITE` set, the lick events
+are also inserted into a SQLite database (see lick_sqlite.py). These
+settings are the same for every reader, and are set below.
+
+A reader calls `recover` before it starts, so that sessions left
+unfinished by an earlier run (a crash or a power cut) are recovered,
+then makes one `ReaderSession`. At every read of the serial port it
+gives the session the comments and the lick events that it decoded
+(`write_comments` and `received`), writes the events to `fid` in the
+columns of its variant, and ends with `write_block`. `close` closes the
+session when the reader is stopped.
+"""
+
+from datetime import datetime
+import os
+import time
+
+from lick_metrics import ReaderMetrics, serve
+from lick_segments import SegmentWriter, recover_sessions
+from lick_sqlite import SqliteSink
+
+# Parameters
+PREFIX = "lick_events_"
+# The session is written to a directory of segments, with every read of
+# the serial port forced to disk (see lick_segments.py). FSYNC =
+# 'interval' or 'segment' writes less often to the SD card.
+FSYNC = 'block'
+SEGMENT_BYTES = 16 << 20
+SEGMENT_SECONDS = 3600
+# Live metrics (see lick_metrics.py) are served on this local address,
+# 'host:port' or the path of a Unix socket; None to disable them.
+METRICS = "localhost:9180"
+# Lick events can also be inserted into a local SQLite database, one
+# row per lick, for SQL queries (see lick_sqlite.py); e.g.
+# "lick_events.sqlite". None to disable it.
+SQLITE = None
+
+
+def recover(output_dir):
+    """
+    Recover the sessions in `output_dir` that an earlier run of a reader
+    left unfinished, and print what was done with each.
+    """
+    for (session, n_cut) in recover_sessions(output_dir, PREFIX + '*'):
+        print(f"Recovered {session} ({n_cut} bytes cut)")
+
+
+class ReaderSession:
+    """
+    A new session in `output_dir` of the lick events of `device` (the
+    serial port). `header` is the line of column names of the csv file.
+    Lick events, as decoded by RecordDecoder, have the event count and
+    the timestamp in their first two columns, and the electrode masks of
+    the sensors in the columns `mask_cols` (an index, or a list of
+    indices with one sensor each); `n_electrodes` is the number of
+    electrodes of each sensor.
+    """
+    def __init__(self, output_dir, device, header, mask_cols,
+                 n_electrodes=12):
+        self.header = header
+        self.mask_cols = mask_cols
+        self.idx = -1
+        self.t0 = -1
+        # The output file receives an automatic name based on the date
+        # and time. This avoids having to ask for a file name every time
+        # the programme is run.
+        now = datetime.now()
+        fname = os.path.join(output_dir,
+                             f"{PREFIX}{now:%Y-%m-%d_%H_%M_%S}")
+        self.fid = SegmentWriter(fname, fsync=FSYNC,
+                                 max_bytes=SEGMENT_BYTES,
+                                 max_seconds=SEGMENT_SECONDS)
+        self.metrics = ReaderMetrics(device, self.fid)
+        if METRICS:
+            serve(self.metrics, METRICS)
+        # The database is written on a thread of its own; adding events
+        # to it never waits.
+        self.sqlite = None
+        if SQLITE:
+            self.sqlite = SqliteSink(SQLITE, os.path.basename(fname),
+                                     device=device,
+                                     n_electrodes=n_electrodes)
+
+    def write_comments(self, decoder):
+        """
+        Write the lines starting with '#' (e.g. reports of sensor health)
+        that `decoder` received to the output file, and the screen, as
+        they are. Return how many there were.
+        """
+        comments = decoder.comments()
+        for comment in comments:
+            print(comment)
+            self.fid.write(comment + '\n')
+        return len(comments)
+
+    def received(self, data, events, n_bad, n_comments):
+        """
+        Count what was received at one read of the serial port: the
+        bytes `data`, decoded into the lick `events`, `n_bad` lines that
+        could not be decoded so far and `n_comments` comments. The event
+        count and timestamp of `events` are made relative to the first
+        lick event, in place, and the events are given to the database.
+        """
+        if len(events) > 0:
+            if self.t0 == -1:
+                self.start(events[0, 0], events[0, 1])
+            events[:, 1] -= self.t0
+            events[:, 0] -= self.idx
+        self.metrics.received(data, events, n_bad, n_comments)
+        if self.sqlite and len(events) > 0:
+            self.sqlite.add(events[:, 0], events[:, 1],
+                            events[:, self.mask_cols])
+
+    def start(self, idx, t0):
+        # When the first lick event arrives, write to the output file
+        # the date and time; this is time 0. The event count is used to
+        # check that there is no data lost on the way between the Pico
+        # and the csv file.
+        self.idx = idx
+        self.t0 = t0
+        start = datetime.now()
+        start = f'# {start:%Y-%m-%d %H:%M:%S}\n'
+        # Comments from the firmware (e.g. waveform snippets) refer to
+        # events by their count and time on the Pico; these are those of
+        # event 0. All this is repeated at the start of every segment.
+        self.fid.set_header(start + self.header +
+                            f'# first event {self.idx} {self.t0}\n')
+        if self.sqlite:
+            self.sqlite.set_start(start[2:].strip())
+
+    def write_block(self):
+        """
+        Write what was received as one checksummed block, to minimise
+        data loss in case of a crash (see lick_segments.py).
+        """
+        start = time.perf_counter()
+        if self.fid.flush():
+            self.metrics.wrote(time.perf_counter() - start)
+
+    def close(self):
+        """Close the session and the database."""
+        self.fid.close()
+        if self.sqlite:
+            self.sqlite.close()
@@ -0,0 +1,299 @@
+#!/usr/bin/env python3
+# coding=utf-8
+#
+# Copyright (c) 2026 Antonio González
+
+""" lick_sqlite.py
+
+Write lick events into a local SQLite database, one row per lick, so
+that they can be queried with SQL instead of parsing the csv files of
+every session again.
+
+`SqliteSink` is given the events of every read of the serial port
+(`add`) and returns at once: the events are put in a queue, and a
+thread of its own, which owns the database connection, expands them
+into one row per electrode and inserts them in large transactions (up
+to `batch_rows` rows, or what arrived in `batch_seconds`), with one
+prepared statement. The reader never waits for the database; if the
+database falls more than `max_pending` events behind, new events are
+not queued and are counted in `n_dropped` instead (the csv session on
+disk is still complete). The database is in WAL mode, so that it can be
+queried while it is written.
+
+Tables:
+
+    sessions  id, name, device, started, n_electrodes
+    licks     session, sensor, electrode, t_ms, idx
+
+`t_ms` and `idx` are the timestamp and count of the event, relative to
+the first event of the session, as in the csv files. Licks are stored
+in order of session, sensor, electrode and time (the primary key), so
+that the licks of one electrode are read together, and are also indexed
+by session and time; sessions are indexed by device and start time.
+For example, the licks per electrode of each session of a device:
+
+    SELECT s.name, l.sensor, l.electrode, count(*)
+    FROM sessions s JOIN licks l ON l.session = s.id
+    WHERE s.device = '/dev/ttyACM0'
+    GROUP BY l.session, l.sensor, l.electrode;
+
+See host/bench/bench_sqlite.py for the insert rate and query times.
+
+Example
+-------
+    sink = SqliteSink('licks.sqlite', 'lick_events_2026-10-18',
+                      device='/dev/ttyACM0')
+    sink.set_start('2026-10-18 09:00:00')
+    sink.add(idx, t_ms, masks)      # masks: one column per sensor
+    sink.close()
+
+`python3 lick_sqlite.py licks.sqlite <session directory or csv> ...`
+imports sessions saved by the lick events readers. An import is given
+to the sink in chunks of `batch_rows` events and waits for room in the
+backlog (`add(..., wait=True)`), so no event of a long session is
+dropped.
+"""
+
+import os
+import queue
+import sqlite3
+import sys
+import threading
+import time
+
+import numpy as np
+
+SCHEMA = """
+CREATE TABLE IF NOT EXISTS sessions (
+    id INTEGER PRIMARY KEY,
+    name TEXT NOT NULL,
+    device TEXT,
+    started TEXT,
+    n_electrodes INTEGER NOT NULL);
+CREATE INDEX IF NOT EXISTS sessions_device ON sessions (device, started);
+CREATE TABLE IF NOT EXISTS licks (
+    session INTEGER NOT NULL REFERENCES sessions (id),
+    sensor INTEGER NOT NULL,
+    electrode INTEGER NOT NULL,
+    t_ms INTEGER NOT NULL,
+    idx INTEGER NOT NULL,
+    PRIMARY KEY (session, sensor, electrode, t_ms, idx)) WITHOUT ROWID;
+CREATE INDEX IF NOT EXISTS licks_time ON licks (session, t_ms);
+"""
+INSERT = "INSERT INTO licks VALUES (?, ?, ?, ?, ?)"
+
+
+def connect(path):
+    """
+    Open a database with the lick tables, in WAL mode. Commits are not
+    forced to disk (synchronous=NORMAL): a power cut can lose the last
+    transactions, but not damage the database.
+    """
+    conn = sqlite3.connect(path, isolation_level=None,
+                           check_same_thread=False)
+    conn.execute("PRAGMA journal_mode=WAL")
+    conn.execute("PRAGMA synchronous=NORMAL")
+    conn.executescript(SCHEMA)
+    return conn
+
+
+def expand(session, idx, t_ms, masks, n_electrodes):
+    """
+    Rows of (session, sensor, electrode, t_ms, idx), one per bit set in
+    `masks` (one column per sensor).
+    """
+    masks = np.asarray(masks, dtype=np.int64).reshape(len(idx), -1)
+    bits = (masks[:, :, np.newaxis] >> np.arange(n_electrodes)) & 1
+    (event, sensor, electrode) = np.nonzero(bits)
+    rows = np.column_stack((np.full(len(event), session), sensor,
+                            electrode, np.asarray(t_ms)[event],
+                            np.asarray(idx)[event]))
+    return rows.tolist()
+
+
+class SqliteSink:
+    """
+    Lick events of one session, inserted into the database at `path` on
+    a thread of its own.
+    """
+    def __init__(self, path, name, device=None, n_electrodes=12,
+                 batch_rows=50000, batch_seconds=1.0,
+                 max_pending=1000000):
+        self.n_electrodes = n_electrodes
+        self.batch_rows = batch_rows
+        self.batch_seconds = batch_seconds
+        self.max_pending = max_pending
+        self.n_rows = 0             # Rows inserted
+        self.n_commits = 0
+        self.max_commit_seconds = 0.0
+        self.n_dropped = 0          # Events not queued (backlog full)
+        self.error = None           # What stopped the writer, if any
+        self._pending = 0           # Events queued, not yet inserted
+        self._lock = threading.Lock()
+        self._room = threading.Condition(self._lock)
+        self._queue = queue.SimpleQueue()
+        self._conn = connect(path)
+        cursor = self._conn.execute(
+            "INSERT INTO sessions (name, device, n_electrodes) "
+            "VALUES (?, ?, ?)", (name, device, n_electrodes))
+        self.session = cursor.lastrowid
+        self._writer = threading.Thread(target=self._write_loop,
+                                        daemon=True)
+        self._writer.start()
+
+    def add(self, idx, t_ms, masks, wait=False):
+        """
+        Queue lick events: their count, timestamp and masks (n x
+        n_sensors, or n values for one sensor). Never waits unless
+        `wait` is set, in which case it waits for room in the backlog
+        rather than dropping the events (for imports, in chunks of at
+        most `max_pending` events; not for a reader).
+        """
+        n = len(idx)
+        if n == 0:
+            return
+        with self._lock:
+            if wait:
+                self._room.wait_for(lambda: self.error or
+                                    self._pending + n <= self.max_pending)
+            if self._pending + n > self.max_pending or self.error:
+                self.n_dropped += n
+                return
+            self._pending += n
+        # Copies, as the caller may reuse its arrays.
+        self._queue.put(('events', np.array(idx), np.array(t_ms),
+                         np.array(masks)))
+
+    def set_start(self, started):
+        """ Date and time of the first event, as text. """
+        self._queue.put(('start', started))
+
+    @property
+    def pending(self):
+        """ Events queued and not yet inserted. """
+        return self._pending
+
+    def close(self):
+        """ Insert what is queued, and close the database. """
+        self._queue.put(('close',))
+        self._writer.join()
+        self._conn.close()
+
+    def _commit(self, rows):
+        start = time.perf_counter()
+        self._conn.execute("BEGIN")
+        self._conn.executemany(INSERT, rows)
+        self._conn.execute("COMMIT")
+        self.max_commit_seconds = max(self.max_commit_seconds,
+                                      time.perf_counter() - start)
+        self.n_rows += len(rows)
+        self.n_commits += 1
+
+    def _write_loop(self):
+        rows = []
+        n_events = 0                # Events in `rows`
+        due = None                  # When `rows` have to be committed
+        while True:
+            timeout = None if due is None else max(0, due - time.monotonic())
+            try:
+                (kind, *args) = self._queue.get(timeout=timeout)
+            except queue.Empty:
+                kind = 'due'
+            try:
+                if kind == 'start':
+                    self._conn.execute(
+                        "UPDATE sessions SET started = ? WHERE id = ?",
+                        (args[0], self.session))
+                elif kind == 'events':
+                    rows.extend(expand(self.session, *args,
+                                       self.n_electrodes))
+                    n_events += len(args[0])
+                    if due is None:
+                        due = time.monotonic() + self.batch_seconds
+                if kind in ('due', 'close') or len(rows) >= self.batch_rows:
+                    if rows:
+                        self._commit(rows)
+                    with self._lock:
+                        self._pending -= n_events
+                        self._room.notify_all()
+                    (rows, n_events, due) = ([], 0, None)
+            except sqlite3.Error as exc:
+                # E.g. a full disk. Stop inserting; the reader goes on.
+                self.error = exc
+                print("lick_sqlite:", exc, file=sys.stderr)
+                with self._lock:
+                    self._pending = 0
+                    self._room.notify_all()
+                return
+            if kind == 'close':
+                return
+
+
+def read_csv_session(path):
+    """
+    Text of a session saved by the lick events readers: a session
+    directory (see lick_segments.py) or a csv file.
+    """
+    if os.path.isdir(path):
+        from lick_segments import read_session
+        return b''.join(read_session(path)).decode()
+    with open(path) as fid:
+        return fid.read()
+
+
+def import_session(path, database):
+    """
+    Insert a saved session into the database. Returns the sink, closed,
+    whose `n_rows` are the licks inserted and `n_dropped` the events
+    that were not (after an error), or None if the session has no data.
+    """
+    from lick_records import RecordDecoder
+    text = read_csv_session(path)
+    lines = text.splitlines()
+    started = None
+    columns = None
+    for line in lines:
+        if line.startswith('# ') and started is None:
+            started = line[2:].strip()
+        elif line and not line.startswith('#'):
+            columns = line.strip().split(',')
+            break
+    if columns is None:
+        return None
+    decoder = RecordDecoder(len(columns))
+    decoder.feed(text.encode())
+    data = decoder.read()
+    # One column per sensor ("sensorA", ...), or one with the electrode
+    # number (bottle-x12-usb-out, "electrode").
+    if 'electrode' in columns:
+        masks = 1 << data[:, columns.index('electrode')]
+    else:
+        masks = data[:, [col for (col, name) in enumerate(columns)
+                         if name.startswith('sensor')]]
+    name = os.path.basename(os.path.normpath(path))
+    sink = SqliteSink(database, name)
+    if started is not None:
+        sink.set_start(started)
+    idx = data[:, columns.index('idx')]
+    t_ms = data[:, columns.index('timestamp')]
+    for i in range(0, len(data), sink.batch_rows):
+        sink.add(idx[i:i + sink.batch_rows], t_ms[i:i + sink.batch_rows],
+                 masks[i:i + sink.batch_rows], wait=True)
+    sink.close()
+    return sink
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 3:
+        print("usage: lick_sqlite.py database session ...",
+              file=sys.stderr)
+        sys.exit(1)
+    for path in sys.argv[2:]:
+        sink = import_session(path, sys.argv[1])
+        if sink is None:
+            print(f"{path}: no lick events")
+            continue
+        print(f"{path}: {sink.n_rows} licks inserted, {sink.n_dropped} "
+              "lick events dropped")
+        if sink.error:
+            sys.exit(1)
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+# coding=utf-8
+#
+# Copyright (c) 2026 Antonio González
+
+""" test_session_recovery.py
+
+Check that a session left unfinished by a reader that died in the
+middle of a block is recovered when the reader starts again.
+
+For each lick events reader (bottle-x12-usb-out and bottle-x24-usb-out),
+in a temporary directory and against host/tools/lick_emulate:
+
+1. the reader is started and, once it has written some blocks, killed
+   with SIGKILL, and the start of another block is appended to its open
+   segment, as if it had died while writing it;
+2. the reader is started again. Its new session must be left alone by
+   `recover_sessions`, since it is open, and the first one must have
+   been recovered: cut back to its last valid block, compressed, marked
+   as closed, and with every event line complete;
+3. the reader is stopped with Ctrl+C, which must close its session.
+
+The readers need numpy, pyserial and pyserial-asyncio; the test is
+skipped (exit code 77) without them. It also needs the port of the
+readers' live metrics (localhost:9180) to be free.
+
+Usage: python3 test_session_recovery.py [build_dir]
+
+with the build directory of host/ (default host/build), which has
+lick_emulate and the lick library.
+"""
+
+import glob
+import importlib.util
+import os
+import shutil
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.join(HERE, '..', '..')
+sys.path.append(os.path.join(HERE, '..', 'python'))
+from lick_segments import CLOSED, read_session, recover_sessions, \
+    segment_paths
+
+READERS = ('bottle-x12-usb-out', 'bottle-x24-usb-out')
+PARTIAL = b'# block 999 100 00000000\n123,4'
+SKIP = 77
+
+
+def wait_for(condition, timeout=10):
+    t_end = time.monotonic() + timeout
+    while time.monotonic() < t_end:
+        if condition():
+            return True
+        time.sleep(0.1)
+    return False
+
+
+def sessions(directory):
+    return sorted(glob.glob(os.path.join(directory, 'lick_events_*')))
+
+
+def n_blocks(session):
+    # Valid blocks written so far, whether or not compressed.
+    return sum(1 for _ in read_session(session))
+
+
+def start_reader(variant, tty, directory, env):
+    script = os.path.join(ROOT, variant, 'lick_events_reader.py')
+    return subprocess.Popen([sys.executable, script, tty], cwd=directory,
+                            env=env, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT)
+
+
+def check(condition, message):
+    if not condition:
+        raise AssertionError(message)
+
+
+def test_reader(variant, emulator, directory, env):
+    tty = os.path.join(directory, 'tty')
+    emulate = subprocess.Popen([emulator, '-l', tty, '-d', '60'],
+                               stdout=subprocess.DEVNULL,
+                               stderr=subprocess.DEVNULL)
+    reader = None
+    try:
+        check(wait_for(lambda: os.path.exists(tty)), "no emulator")
+
+        # 1. Kill the reader in the middle of a block.
+        reader = start_reader(variant, tty, directory, env)
+        check(wait_for(lambda: sessions(directory) and
+                       n_blocks(sessions(directory)[0]) >= 3),
+              "the reader wrote nothing")
+        reader.send_signal(signal.SIGKILL)
+        reader.wait()
+        first = sessions(directory)[0]
+        # The last segment is still open.
+        last = segment_paths(first)[-1]
+        check(last.endswith('.csv'), "the last segment was compressed")
+        with open(last, 'ab') as fid:
+            fid.write(PARTIAL)
+        # The clock of the session names is in seconds.
+        time.sleep(1.1)
+
+        # 2. Restart it: the first session is recovered.
+        reader = start_reader(variant, tty, directory, env)
+        check(wait_for(lambda: len(sessions(directory)) == 2 and
+                       n_blocks(sessions(directory)[1]) >= 1),
+              "the restarted reader wrote nothing")
+        second = sessions(directory)[1]
+        check(recover_sessions(directory, 'lick_events_*') == [],
+              "a session in use was recovered")
+        check(os.path.exists(os.path.join(first, CLOSED)),
+              "the first session was not marked as closed")
+        check(all(p.endswith('.gz') for p in segment_paths(first)),
+              "the first session was not compressed")
+        text = b''.join(read_session(first))
+        check(PARTIAL not in text, "the broken block was kept")
+        check(text.endswith(b'\n'), "the last line is incomplete")
+
+        # 3. Stop it with Ctrl+C: the second session is closed.
+        reader.send_signal(signal.SIGINT)
+        output = reader.communicate(timeout=10)[0].decode()
+        check(f"({len(PARTIAL)} bytes cut)" in output,
+              "the reader did not report the recovery")
+        check(os.path.exists(os.path.join(second, CLOSED)),
+              "the second session was not closed")
+    finally:
+        if reader is not None and reader.poll() is None:
+            reader.kill()
+            reader.communicate()
+        emulate.terminate()
+        emulate.wait()
+
+
+if __name__ == '__main__':
+    build = os.path.abspath(sys.argv[1] if len(sys.argv) > 1 else
+                            os.path.join(ROOT, 'host', 'build'))
+    for module in ('numpy', 'serial', 'serial_asyncio'):
+        if importlib.util.find_spec(module) is None:
+            print(f"skipped: no {module}")
+            sys.exit(SKIP)
+    env = dict(os.environ, LICK_LIBRARY=os.path.join(build, 'liblick.so'))
+    emulator = os.path.join(build, 'lick_emulate')
+    failed = 0
+    for variant in READERS:
+        directory = tempfile.mkdtemp()
+        try:
+            test_reader(variant, emulator, directory, env)
+            print(f"{variant}: ok")
+        except AssertionError as error:
+            print(f"{variant}: FAILED, {error}")
+            failed += 1
+        finally:
+            shutil.rmtree(directory)
+    sys.exit(1 if failed else 0)
@@ -0,0 +1,155 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_analyse.c
+
+   Lick microstructure of many sessions: inter-lick intervals, clusters,
+   bouts and preference of every electrode (see
+   common/lick_analysis.h).
+
+   Usage:
+     lick_analyse [-j threads] [-c cluster_gap_ms] [-b bout_gap_ms]
+                  [-m min_licks] [-v] session.csv ...
+
+   Sessions are the csv files saved by lick_events_reader.py, or their
+   long format from events-to-long.py. `-j` is the number of threads
+   (default: the number of cores). The defaults are 500 ms between
+   clusters, 1000 ms between bouts and 1 lick per cluster or bout.
+
+   One csv line is printed for every electrode with licks in every
+   session, in the order the sessions were given. `-v` prints the
+   number of sessions and licks and the time taken to stderr.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lick_analysis.h"
+
+static void usage(void) {
+    fprintf(stderr, "usage: lick_analyse [-j threads] [-c cluster_gap_ms] "
+            "[-b bout_gap_ms] [-m min_licks] [-v] session.csv ...\n");
+}
+
+static void print_metrics(const char *path, unsigned e,
+                          const struct lick_analysis_metrics *m) {
+    printf("%s,%c%u,%llu,%.4f,%lld,%lld,%llu,%.1f,%.1f,"
+           "%llu,%.2f,%.1f,%llu,%.2f,%.1f\n",
+           path, 'A' + e / LICK_ANALYSIS_ELECTRODES_PER_SENSOR,
+           e % LICK_ANALYSIS_ELECTRODES_PER_SENSOR,
+           (unsigned long long)m->n_licks, m->preference,
+           (long long)m->first_ms, (long long)m->last_ms,
+           (unsigned long long)m->n_ilis, m->ili_median_ms,
+           m->ili_mean_ms, (unsigned long long)m->n_clusters,
+           m->cluster_licks, m->cluster_ms,
+           (unsigned long long)m->n_bouts, m->bout_licks, m->bout_ms);
+}
+
+int main(int argc, char *argv[]) {
+    struct lick_analysis_params params = LICK_ANALYSIS_DEFAULT_PARAMS;
+    long n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int verbose = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:c:b:m:v")) != -1) {
+        switch (opt) {
+            case 'j':
+                n_threads = atol(optarg);
+                break;
+            case 'c':
+                params.cluster_gap_ms = (uint32_t)atol(optarg);
+                break;
+            case 'b':
+                params.bout_gap_ms = (uint32_t)atol(optarg);
+                break;
+            case 'm':
+                params.min_licks = (uint32_t)atol(optarg);
+                break;
+            case 'v':
+                verbose = 1;
+                break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+    size_t n_sessions = (size_t)(argc - optind);
+    if (n_sessions == 0 || n_threads < 1) {
+        usage();
+        return 1;
+    }
+
+    struct lick_session *sessions = calloc(n_sessions, sizeof(*sessions));
+    struct lick_analysis_metrics *metrics = malloc(n_sessions *
+        LICK_ANALYSIS_MAX_ELECTRODES * sizeof(*metrics));
+    if (sessions == NULL || metrics == NULL) {
+        fprintf(stderr, "lick_analyse: out of memory\n");
+        return 1;
+    }
+    for (size_t s = 0; s < n_sessions; s++) {
+        sessions[s].path = argv[optind + s];
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int ret = lick_analysis_run(sessions, n_sessions, &params,
+                                (unsigned)n_threads, metrics);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (ret) {
+        fprintf(stderr, "lick_analyse: out of memory\n");
+        return 1;
+    }
+
+    printf("session,electrode,licks,preference,first_ms,last_ms,ilis,"
+           "ili_median_ms,ili_mean_ms,clusters,cluster_licks,cluster_ms,"
+           "bouts,bout_licks,bout_ms\n");
+    int status = 0;
+    size_t n_licks = 0;
+    for (size_t s = 0; s < n_sessions; s++) {
+        const struct lick_session *session = &sessions[s];
+        if (session->error) {
+            fprintf(stderr, "%s: %s\n", session->path,
+                    session->error == EINVAL ? "unknown format" :
+                    strerror(session->error));
+            status = 1;
+            continue;
+        }
+        if (session->n_bad) {
+            fprintf(stderr, "%s: %llu lines skipped\n", session->path,
+                    (unsigned long long)session->n_bad);
+        }
+        for (unsigned e = 0; e < LICK_ANALYSIS_MAX_ELECTRODES; e++) {
+            const struct lick_analysis_metrics *m =
+                &metrics[s * LICK_ANALYSIS_MAX_ELECTRODES + e];
+            if (m->n_licks) {
+                print_metrics(session->path, e, m);
+                n_licks += m->n_licks;
+            }
+        }
+    }
+
+    if (verbose) {
+        double seconds = (double)(end.tv_sec - start.tv_sec) +
+            (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+        fprintf(stderr, "%zu sessions, %zu licks, %ld threads: %.3f s\n",
+                n_sessions, n_licks, n_threads, seconds);
+    }
+    for (size_t s = 0; s < n_sessions; s++) {
+        lick_session_free(&sessions[s]);
+    }
+    free(sessions);
+    free(metrics);
+    return status;
+}
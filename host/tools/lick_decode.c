@@ -0,0 +1,129 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_decode.c
+
+   Decode a stream of compressed raw data blocks (see
+   common/lick_codec.h) into text, one line per sample: the timestamp in
+   microseconds followed by the value of each channel.
+
+   Usage:
+     lick_decode [input] > output.txt
+
+   `input` can be a file saved from the serial port or the serial device
+   itself (e.g. /dev/ttyACM0); standard input is read if omitted.
+   Damaged blocks are skipped and counted; a summary is printed to
+   stderr at the end. Blocks in which a sensor failed (see the flags in
+   common/lick_codec.h) are preceded by a line
+
+     # fault <timestamp> <sensors>
+
+   where <sensors> has bit n set if sensor n failed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "lick_codec.h"
+
+#define BUF_SIZE 65536
+
+int main(int argc, char *argv[]) {
+    FILE *fin = stdin;
+    if (argc > 1) {
+        fin = fopen(argv[1], "rb");
+        if (fin == NULL) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    static uint8_t buf[BUF_SIZE];
+    static uint16_t samples[LICK_CODEC_MAX_CHANNELS *
+                            LICK_CODEC_MAX_SAMPLES];
+    size_t len = 0;
+    size_t n_blocks = 0;
+    size_t n_bad = 0;
+    size_t n_lost = 0;
+    size_t skipped = 0;
+    int have_seq = 0;
+    uint16_t next_seq = 0;
+
+    while (1) {
+        size_t n = fread(buf + len, 1, BUF_SIZE - len, fin);
+        if (n == 0 && len == 0) {
+            break;
+        }
+        len += n;
+
+        size_t pos = 0;
+        while (pos < len) {
+            struct lick_block_info info;
+            size_t consumed;
+            int ret = lick_codec_decode(buf + pos, len - pos, &info,
+                samples, sizeof(samples) / sizeof(samples[0]), &consumed);
+            if (ret == LICK_CODEC_NEED_MORE) {
+                break;
+            }
+            if (ret != LICK_CODEC_OK) {
+                if (ret != LICK_CODEC_BAD_SYNC) {
+                    n_bad++;
+                }
+                // Resynchronise at the next possible block start.
+                size_t next = pos + consumed;
+                next += lick_codec_find_sync(buf + next, len - next);
+                skipped += next - pos;
+                pos = next;
+                continue;
+            }
+            pos += consumed;
+            n_blocks++;
+
+            if (have_seq && info.seq != next_seq) {
+                n_lost += (uint16_t)(info.seq - next_seq);
+            }
+            next_seq = info.seq + 1;
+            have_seq = 1;
+
+            if (info.flags) {
+                printf("# fault %u 0x%02x\n", info.t0_us, info.flags);
+            }
+            for (uint8_t i = 0; i < info.n_samples; i++) {
+                printf("%u", info.t0_us + (uint32_t)i * info.period_us);
+                for (uint8_t ch = 0; ch < info.n_channels; ch++) {
+                    printf(" %u", samples[i * info.n_channels + ch]);
+                }
+                putchar('\n');
+            }
+        }
+
+        memmove(buf, buf + pos, len - pos);
+        len -= pos;
+        if (n == 0) {
+            // End of input with an incomplete block left over.
+            skipped += len;
+            break;
+        }
+        if (len == BUF_SIZE) {
+            // Cannot happen with valid blocks, which are much smaller.
+            skipped += len;
+            len = 0;
+        }
+    }
+
+    fprintf(stderr, "%zu blocks, %zu damaged, %zu lost, %zu bytes skipped\n",
+            n_blocks, n_bad, n_lost, skipped);
+    if (fin != stdin) {
+        fclose(fin);
+    }
+    return 0;
+}
@@ -0,0 +1,799 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_emulate.c
+
+   Lick sensor emulator, to test and benchmark the host tools without a
+   Pico (or a mouse).
+
+   A pseudo-terminal is created and the path of its device printed
+   (e.g. /dev/pts/3); open it instead of the Pico's serial port, e.g.
+   `lick_events_reader.py /dev/pts/3`. The emulator writes to it what
+   the firmware would send:
+
+   * lick events, as text (the default), at a given mean rate over any
+     number of sensors and electrodes, optionally in bouts and with
+     several electrodes starting at once;
+   * raw data (-f raw), as compressed blocks (see common/lick_codec.h)
+     of synthetic filtered and baseline values, with a contact at every
+     lick;
+   * or the lick events of a recorded session (-R), replayed at any
+     speed.
+
+   Faults can be injected: records split into two writes some time
+   apart (partial lines), corrupted bytes, and stalls in the output.
+   The same seed gives the same output.
+
+   Usage:
+     lick_emulate [-r rate] [-s sensors] [-e electrodes] [-m max_at_once]
+                  [-b bout_s:pause_s] [-f text|raw] [-i interval_us]
+                  [-R session.csv] [-x speed] [-p split_prob]
+                  [-c corrupt_prob] [-S stall_ms:every_s] [-d seconds]
+                  [-M] [-w pre:post] [-l link] [-z seed]
+
+   -r   mean lick events per second (default 7). With -f raw, licks
+        make contacts in the synthetic trace at this rate.
+   -s   number of sensors (default 2): up to 8 with lick events, 2
+        with -f raw.
+   -m   up to this many electrodes start a lick in the same event
+        (default 1).
+   -b   lick in bouts of bout_s seconds separated by pause_s seconds.
+   -i   with -f raw or -w, the sampling interval (default 20000 us, as
+        the firmware); raw data blocks have 50 samples.
+   -R   replay the lick events of a file saved by lick_events_reader.py,
+        or of the text sent by the firmware, at -x times its speed
+        (default 1). Only lick events are replayed, not comments.
+   -p   probability that a record is written in two parts, 0.1 to 1
+        ms apart.
+   -c   probability that a record has one byte changed.
+   -S   stop writing for stall_ms, on average every every_s seconds.
+   -d   stop after this many seconds (default: until Ctrl-C, or the end
+        of the replayed file).
+   -M   lick event timestamps are CLOCK_MONOTONIC, in ms (the clock of
+        Python's time.monotonic()), instead of ms since the start, so
+        that a reader on the same computer can measure its latency.
+   -w   with lick events, send a waveform snippet from pre samples
+        before to post samples after every onset, as the firmware with
+        LICK_SNIPPET_PRE and LICK_SNIPPET_POST.
+   -l   also make a symbolic link with this name to the device.
+
+   Like the firmware, the emulator answers `?` with a line that
+   describes it (see firmware/lick_command.h), as variant `emulator`.
+   With lick events, `!` toggles an emulated action pin that is
+   connected to the sync input: its rising edges are printed as
+   `# sync in` lines, so that the latency of a host reacting to lick
+   events can be measured as on the Pico (see lick_react).
+
+   Records are written when they are due; when the reader is slow, the
+   pseudo-terminal fills up and writes block. How late the emulator got
+   is reported on exit, with the number of records and bytes written.
+ */
+
+// posix_openpt, cfmakeraw
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lick_codec.h"
+
+// Lick events can come from more sensors than a Pico has (e.g. to try
+// out the plotter's raster); raw data and replays are as the firmware.
+#define MAX_SENSORS 8
+#define FIRMWARE_MAX_SENSORS 2
+#define MAX_ELECTRODES 12
+#define RAW_BLOCK_LEN 50
+#define RAW_N_CHANNELS (2 * FIRMWARE_MAX_SENSORS * MAX_ELECTRODES)
+#define CONTACT_US 40000
+
+enum format { FORMAT_TEXT, FORMAT_RAW };
+
+struct options {
+    double rate;
+    unsigned n_sensors;
+    unsigned n_electrodes;
+    unsigned max_at_once;
+    double bout_s;
+    double pause_s;
+    enum format format;
+    uint32_t interval_us;
+    const char *replay;
+    double speed;
+    double split_prob;
+    double corrupt_prob;
+    double stall_ms;
+    double stall_every_s;
+    double duration;
+    int monotonic;
+    unsigned snippet_pre;
+    unsigned snippet_post;
+    const char *link;
+    uint32_t seed;
+};
+
+struct stats {
+    size_t n_records;
+    size_t n_bytes;
+    size_t n_split;
+    size_t n_corrupt;
+    size_t n_stalls;
+    size_t n_actions;
+    double max_late_s;
+};
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void sleep_until(double t) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)t;
+    ts.tv_nsec = (long)((t - (double)ts.tv_sec) * 1e9);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) ==
+           EINTR && !stop) {
+    }
+}
+
+/* Small deterministic PRNG, so that runs can be repeated. */
+static uint32_t rng_state = 1;
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double rng_uniform(void) {
+    return (rng() + 0.5) / 4294967296.0;
+}
+
+/* Time to the next event of a Poisson process. */
+static double rng_exp(double rate) {
+    return -log(rng_uniform()) / rate;
+}
+
+/* Lick event generator
+ * Events come at random (Poisson) times, only during bouts if these are
+ * set. Times are in seconds from the start.
+ */
+struct licks {
+    const struct options *opt;
+    double t;
+    uint16_t onset[MAX_SENSORS];
+};
+
+static void licks_next(struct licks *l) {
+    const struct options *opt = l->opt;
+    l->t += rng_exp(opt->rate);
+    if (opt->bout_s > 0) {
+        // Time spent in pauses is skipped.
+        double period = opt->bout_s + opt->pause_s;
+        double phase = fmod(l->t, period);
+        if (phase >= opt->bout_s) {
+            l->t += period - phase;
+        }
+    }
+    for (unsigned i = 0; i < MAX_SENSORS; i++) {
+        l->onset[i] = 0;
+    }
+    unsigned n = 1 + rng() % opt->max_at_once;
+    for (unsigned k = 0; k < n; k++) {
+        unsigned s = rng() % opt->n_sensors;
+        l->onset[s] |= (uint16_t)(1u << (rng() % opt->n_electrodes));
+    }
+}
+
+/* Recorded lick events, for -R */
+struct replay {
+    size_t n;
+    size_t n_cols;
+    long long *values;   // n rows of n_cols: count, time in ms, sensors
+};
+
+/* Read the lick events of a csv file saved by lick_events_reader.py or
+ * of the text sent by the firmware. Returns 0 on success.
+ */
+static int replay_load(struct replay *r, const char *path) {
+    FILE *fin = fopen(path, "r");
+    if (fin == NULL) {
+        perror(path);
+        return 1;
+    }
+    size_t cap = 0;
+    r->n = 0;
+    r->n_cols = 0;
+    r->values = NULL;
+    char line[256];
+    while (fgets(line, sizeof(line), fin)) {
+        long long v[2 + FIRMWARE_MAX_SENSORS];
+        size_t n_cols = 0;
+        char *p = line;
+        while (n_cols < 2 + FIRMWARE_MAX_SENSORS) {
+            char *end;
+            long long x = strtoll(p, &end, 10);
+            if (end == p) {
+                break;
+            }
+            v[n_cols++] = x;
+            p = end;
+            while (*p == ',' || *p == ' ' || *p == '\t') {
+                p++;
+            }
+        }
+        // Comments, the header and broken lines are not lick events.
+        if (n_cols < 3 || (*p != '\n' && *p != '\r' && *p != '\0')) {
+            continue;
+        }
+        if (r->n_cols == 0) {
+            r->n_cols = n_cols;
+        } else if (n_cols != r->n_cols) {
+            continue;
+        }
+        if (r->n == cap) {
+            cap = cap ? 2 * cap : 4096;
+            long long *values = realloc(r->values,
+                                        cap * r->n_cols * sizeof(*values));
+            if (values == NULL) {
+                fprintf(stderr, "%s: out of memory\n", path);
+                fclose(fin);
+                return 1;
+            }
+            r->values = values;
+        }
+        memcpy(r->values + r->n * r->n_cols, v,
+               r->n_cols * sizeof(*v));
+        r->n++;
+    }
+    fclose(fin);
+    if (r->n == 0) {
+        fprintf(stderr, "%s: no lick events\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+/* Output, with fault injection */
+struct output {
+    int fd;
+    const struct options *opt;
+    struct stats *stats;
+    double next_stall;
+    unsigned n_sensors;
+    double t0;
+    int action;
+};
+
+static void write_all(int fd, const uint8_t *buf, size_t len) {
+    while (len > 0 && !stop) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("write");
+            stop = 1;
+            return;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+}
+
+static void output_record(struct output *out, uint8_t *buf, size_t len) {
+    const struct options *opt = out->opt;
+    struct stats *stats = out->stats;
+    if (opt->stall_every_s > 0 && now_s() >= out->next_stall) {
+        sleep_until(now_s() + opt->stall_ms / 1000);
+        out->next_stall = now_s() + rng_exp(1 / opt->stall_every_s);
+        stats->n_stalls++;
+    }
+    if (opt->corrupt_prob > 0 && rng_uniform() < opt->corrupt_prob) {
+        buf[rng() % len] ^= (uint8_t)(1 + rng() % 255);
+        stats->n_corrupt++;
+    }
+    if (opt->split_prob > 0 && len > 1 &&
+            rng_uniform() < opt->split_prob) {
+        size_t half = 1 + rng() % (len - 1);
+        write_all(out->fd, buf, half);
+        sleep_until(now_s() + (1 + rng() % 10) * 1e-4);
+        write_all(out->fd, buf + half, len - half);
+        stats->n_split++;
+    } else {
+        write_all(out->fd, buf, len);
+    }
+    stats->n_records++;
+    stats->n_bytes += len;
+}
+
+/* The line with which the firmware describes itself (see
+ * firmware/lick_command.h).
+ */
+static void describe(struct output *out) {
+    const struct options *opt = out->opt;
+    char buf[256];
+    int len = snprintf(buf, sizeof(buf), "# device lick-sensor "
+        "variant emulator version 0 sensors %u electrodes %u "
+        "interval_us %u", out->n_sensors, opt->n_electrodes,
+        opt->interval_us);
+    if (opt->format == FORMAT_RAW && !opt->replay) {
+        len += snprintf(buf + len, sizeof(buf) - (size_t)len,
+            " format raw channels %u block_len %u transport serial\n",
+            2 * out->n_sensors * opt->n_electrodes, RAW_BLOCK_LEN);
+    } else {
+        len += snprintf(buf + len, sizeof(buf) - (size_t)len,
+                        " format events columns idx,timestamp");
+        for (unsigned i = 0; i < out->n_sensors; i++) {
+            len += snprintf(buf + len, sizeof(buf) - (size_t)len,
+                            ",sensor%c", 'A' + i);
+        }
+        len += snprintf(buf + len, sizeof(buf) - (size_t)len,
+                        " action_pin 0\n");
+    }
+    write_all(out->fd, (const uint8_t *)buf, (size_t)len);
+}
+
+/* The action pin, as if it were connected to the sync input: every
+ * rising edge is printed with its time, on the clock of the lick event
+ * timestamps.
+ */
+static void toggle_action(struct output *out) {
+    out->action = !out->action;
+    if (!out->action) {
+        return;
+    }
+    double t = out->opt->monotonic ? now_s() : now_s() - out->t0;
+    char buf[64];
+    int len = snprintf(buf, sizeof(buf), "# sync in %zu %lld 0\n",
+                       out->stats->n_actions++, (long long)(t * 1e6));
+    write_all(out->fd, (const uint8_t *)buf, (size_t)len);
+}
+
+/* Act on the commands of the firmware that the emulator knows: `?`,
+ * and, with lick events, `!`. Other characters are ignored.
+ */
+static void read_commands(struct output *out) {
+    const int events = out->opt->format == FORMAT_TEXT ||
+        out->opt->replay;
+    uint8_t cmd[64];
+    struct pollfd pfd = {out->fd, POLLIN, 0};
+    while (poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN)) {
+        ssize_t n = read(out->fd, cmd, sizeof(cmd));
+        if (n <= 0) {
+            return;
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            if (cmd[i] == '?') {
+                describe(out);
+            } else if (cmd[i] == '!' && events) {
+                toggle_action(out);
+            }
+        }
+    }
+}
+
+/* Wait until time `t` from the start, and note how late we are.
+ * Commands from the reader are answered in the meantime.
+ */
+static void wait_for(struct output *out, double t0, double t) {
+    double now = now_s();
+    if (now - (t0 + t) > out->stats->max_late_s) {
+        out->stats->max_late_s = now - (t0 + t);
+    }
+    read_commands(out);
+    while (now < t0 + t && !stop) {
+        struct pollfd pfd = {out->fd, POLLIN, 0};
+        double left_ms = (t0 + t - now) * 1000;
+        if (poll(&pfd, 1, left_ms > 1 ? (int)left_ms : 0) > 0) {
+            read_commands(out);
+        } else if (left_ms <= 1) {
+            sleep_until(t0 + t);
+        }
+        now = now_s();
+    }
+}
+
+static size_t format_event(char *buf, size_t size, long long count,
+        long long t_ms, const long long *sensors, size_t n_sensors) {
+    size_t n = (size_t)snprintf(buf, size, "%lld %lld", count, t_ms);
+    for (size_t i = 0; i < n_sensors && n < size; i++) {
+        n += (size_t)snprintf(buf + n, size - n, " %lld", sensors[i]);
+    }
+    if (n + 1 < size) {
+        buf[n++] = '\n';
+    }
+    return n;
+}
+
+static long long monotonic_ms(void) {
+    return (long long)(now_s() * 1000);
+}
+
+/* A waveform snippet (see firmware/lick_snippet.h) of one electrode
+ * for lick event `count`: noise of a count or two, and a contact that
+ * lasts CONTACT_US from the onset.
+ */
+static size_t format_snippet(char *buf, size_t size,
+        const struct options *opt, long long count, unsigned sensor,
+        unsigned electrode) {
+    const unsigned contact = CONTACT_US / opt->interval_us + 1;
+    size_t n = (size_t)snprintf(buf, size, "# snippet %lld %u %u %u %u",
+        count, sensor, electrode, opt->snippet_pre, 600 + rng() % 100);
+    for (unsigned i = 0; i <= opt->snippet_pre + opt->snippet_post &&
+            n < size; i++) {
+        int delta = (int)(rng() % 5) - 2;
+        if (i >= opt->snippet_pre && i < opt->snippet_pre + contact) {
+            delta += 60;
+        }
+        n += (size_t)snprintf(buf + n, size - n, " %d", delta);
+    }
+    if (n + 1 < size) {
+        buf[n++] = '\n';
+    }
+    return n;
+}
+
+static void run_text(struct output *out, double t0) {
+    const struct options *opt = out->opt;
+    struct licks licks = {opt, 0, {0}};
+    char buf[128];
+    char snippet[1024];
+    for (long long count = 0; !stop; count++) {
+        licks_next(&licks);
+        if (opt->duration > 0 && licks.t > opt->duration) {
+            break;
+        }
+        wait_for(out, t0, licks.t);
+        long long sensors[MAX_SENSORS];
+        for (unsigned i = 0; i < opt->n_sensors; i++) {
+            sensors[i] = licks.onset[i];
+        }
+        long long t_ms = opt->monotonic ? monotonic_ms() :
+            (long long)(licks.t * 1000);
+        size_t n = format_event(buf, sizeof(buf), count, t_ms, sensors,
+                                opt->n_sensors);
+        output_record(out, (uint8_t *)buf, n);
+        if (opt->snippet_pre + opt->snippet_post == 0) {
+            continue;
+        }
+        // The firmware sends them snippet_post samples later; here
+        // they follow the event.
+        for (unsigned i = 0; i < opt->n_sensors; i++) {
+            for (unsigned e = 0; e < opt->n_electrodes; e++) {
+                if ((licks.onset[i] >> e) & 1u) {
+                    n = format_snippet(snippet, sizeof(snippet), opt,
+                                       count, i, e);
+                    output_record(out, (uint8_t *)snippet, n);
+                }
+            }
+        }
+    }
+}
+
+static void run_replay(struct output *out, double t0,
+        const struct replay *r) {
+    const struct options *opt = out->opt;
+    long long first_ms = r->values[1];
+    char buf[128];
+    for (size_t i = 0; i < r->n && !stop; i++) {
+        const long long *v = r->values + i * r->n_cols;
+        double t = (double)(v[1] - first_ms) / 1000 / opt->speed;
+        if (opt->duration > 0 && t > opt->duration) {
+            break;
+        }
+        wait_for(out, t0, t);
+        long long t_ms = opt->monotonic ? monotonic_ms() : v[1];
+        size_t n = format_event(buf, sizeof(buf), v[0], t_ms, v + 2,
+                                r->n_cols - 2);
+        output_record(out, (uint8_t *)buf, n);
+    }
+}
+
+/* Raw data: filtered values jitter by a count or two around a slowly
+ * drifting baseline, and drop by ~60 counts during each contact, which
+ * lasts CONTACT_US from every lick onset.
+ */
+static void run_raw(struct output *out, double t0) {
+    const struct options *opt = out->opt;
+    const unsigned n_electrodes = opt->n_sensors * opt->n_electrodes;
+    const unsigned n_channels = 2 * n_electrodes;
+    const uint32_t contact = CONTACT_US / opt->interval_us + 1;
+    static uint16_t samples[RAW_BLOCK_LEN * RAW_N_CHANNELS];
+    static uint8_t block[LICK_CODEC_MAX_BLOCK_SIZE(RAW_N_CHANNELS,
+                                                   RAW_BLOCK_LEN)];
+    uint32_t touching[FIRMWARE_MAX_SENSORS * MAX_ELECTRODES] = {0};
+    double baseline[FIRMWARE_MAX_SENSORS * MAX_ELECTRODES];
+    for (unsigned e = 0; e < n_electrodes; e++) {
+        baseline[e] = 600 + rng() % 100;
+    }
+    struct licks licks = {opt, 0, {0}};
+    licks_next(&licks);
+    uint64_t n_samples = 0;
+
+    for (uint16_t seq = 0; !stop; seq++) {
+        for (unsigned i = 0; i < RAW_BLOCK_LEN; i++, n_samples++) {
+            double t = (double)n_samples * opt->interval_us * 1e-6;
+            while (licks.t <= t) {
+                for (unsigned e = 0; e < n_electrodes; e++) {
+                    unsigned s = e / opt->n_electrodes;
+                    unsigned k = e % opt->n_electrodes;
+                    if ((licks.onset[s] >> k) & 1u) {
+                        touching[e] = contact;
+                    }
+                }
+                licks_next(&licks);
+            }
+            uint16_t *frame = samples + i * n_channels;
+            for (unsigned e = 0; e < n_electrodes; e++) {
+                baseline[e] += ((int)(rng() % 3) - 1) * 0.05;
+                int value = (int)baseline[e] + (int)(rng() % 5) - 2;
+                if (touching[e]) {
+                    value -= 60;
+                    touching[e]--;
+                }
+                frame[e] = (uint16_t)value;
+                frame[n_electrodes + e] = (uint16_t)baseline[e];
+            }
+        }
+        // A block is sent once its last sample has been taken.
+        double t_end = (double)n_samples * opt->interval_us * 1e-6;
+        if (opt->duration > 0 && t_end > opt->duration) {
+            break;
+        }
+        wait_for(out, t0, t_end);
+        uint32_t t0_us = (uint32_t)((n_samples - RAW_BLOCK_LEN) *
+                                    opt->interval_us);
+        size_t n = lick_codec_encode(samples, RAW_BLOCK_LEN,
+            (uint8_t)n_channels, seq, t0_us, (uint16_t)opt->interval_us,
+            0, block, sizeof(block));
+        output_record(out, block, n);
+    }
+}
+
+/* Create the pseudo-terminal. Its other end is kept open, in raw mode,
+ * so that writes do not fail while no reader has it open.
+ */
+static int open_pty(int *slave_fd, char *name, size_t name_size) {
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+        perror("pseudo-terminal");
+        return -1;
+    }
+    const char *path = ptsname(fd);
+    if (path == NULL) {
+        perror("ptsname");
+        close(fd);
+        return -1;
+    }
+    snprintf(name, name_size, "%s", path);
+    *slave_fd = open(name, O_RDWR | O_NOCTTY);
+    if (*slave_fd < 0) {
+        perror(name);
+        close(fd);
+        return -1;
+    }
+    struct termios tio;
+    tcgetattr(*slave_fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(*slave_fd, TCSANOW, &tio);
+    return fd;
+}
+
+static int parse_pair(const char *s, double *a, double *b) {
+    return sscanf(s, "%lf:%lf", a, b) == 2 && *a > 0 && *b >= 0;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: lick_emulate [-r rate] [-s sensors] "
+            "[-e electrodes] [-m max_at_once] [-b bout_s:pause_s]\n"
+            "                    [-f text|raw] [-i interval_us] "
+            "[-R session.csv] [-x speed]\n"
+            "                    [-p split_prob] [-c corrupt_prob] "
+            "[-S stall_ms:every_s]\n"
+            "                    [-d seconds] [-M] [-w pre:post] [-l link] "
+            "[-z seed]\n");
+}
+
+int main(int argc, char *argv[]) {
+    struct options opt = {
+        .rate = 7,
+        .n_sensors = 2,
+        .n_electrodes = 12,
+        .max_at_once = 1,
+        .format = FORMAT_TEXT,
+        .interval_us = 20000,
+        .speed = 1,
+        .seed = 1
+    };
+    int opt_c;
+    while ((opt_c = getopt(argc, argv, "r:s:e:m:b:f:i:R:x:p:c:S:d:Mw:l:z:"))
+           != -1) {
+        switch (opt_c) {
+            case 'r':
+                opt.rate = atof(optarg);
+                break;
+            case 's':
+                opt.n_sensors = (unsigned)atoi(optarg);
+                break;
+            case 'e':
+                opt.n_electrodes = (unsigned)atoi(optarg);
+                break;
+            case 'm':
+                opt.max_at_once = (unsigned)atoi(optarg);
+                break;
+            case 'b':
+                if (!parse_pair(optarg, &opt.bout_s, &opt.pause_s)) {
+                    usage();
+                    return 1;
+                }
+                break;
+            case 'f':
+                if (strcmp(optarg, "text") == 0) {
+                    opt.format = FORMAT_TEXT;
+                } else if (strcmp(optarg, "raw") == 0) {
+                    opt.format = FORMAT_RAW;
+                } else {
+                    usage();
+                    return 1;
+                }
+                break;
+            case 'i':
+                opt.interval_us = (uint32_t)atol(optarg);
+                break;
+            case 'R':
+                opt.replay = optarg;
+                break;
+            case 'x':
+                opt.speed = atof(optarg);
+                break;
+            case 'p':
+                opt.split_prob = atof(optarg);
+                break;
+            case 'c':
+                opt.corrupt_prob = atof(optarg);
+                break;
+            case 'S':
+                if (!parse_pair(optarg, &opt.stall_ms,
+                                &opt.stall_every_s)) {
+                    usage();
+                    return 1;
+                }
+                break;
+            case 'd':
+                opt.duration = atof(optarg);
+                break;
+            case 'M':
+                opt.monotonic = 1;
+                break;
+            case 'w':
+                if (sscanf(optarg, "%u:%u", &opt.snippet_pre,
+                           &opt.snippet_post) != 2 ||
+                        opt.snippet_pre + opt.snippet_post > 255) {
+                    usage();
+                    return 1;
+                }
+                break;
+            case 'l':
+                opt.link = optarg;
+                break;
+            case 'z':
+                opt.seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+    if (opt.rate <= 0 || opt.speed <= 0 || opt.n_sensors < 1 ||
+            opt.n_sensors > MAX_SENSORS ||
+            (opt.format == FORMAT_RAW &&
+             opt.n_sensors > FIRMWARE_MAX_SENSORS) ||
+            opt.n_electrodes < 1 ||
+            opt.n_electrodes > MAX_ELECTRODES || opt.max_at_once < 1 ||
+            opt.interval_us < 1000 || opt.interval_us > 65535) {
+        fprintf(stderr, "lick_emulate: invalid option value\n");
+        return 1;
+    }
+    // Small seeds give small first numbers; spread them out.
+    rng_state = opt.seed * 2654435761u ^ 0x9e3779b9u;
+    if (rng_state == 0) {
+        rng_state = 1;
+    }
+    for (int i = 0; i < 16; i++) {
+        rng();
+    }
+
+    struct replay replay = {0};
+    if (opt.replay && replay_load(&replay, opt.replay) != 0) {
+        return 1;
+    }
+
+    int slave_fd;
+    char name[64];
+    int fd = open_pty(&slave_fd, name, sizeof(name));
+    if (fd < 0) {
+        return 1;
+    }
+    if (opt.link) {
+        unlink(opt.link);
+        if (symlink(name, opt.link) != 0) {
+            perror(opt.link);
+        }
+    }
+    printf("%s\n", name);
+    fflush(stdout);
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    struct stats stats = {0};
+    double t0 = now_s();
+    struct output out = {fd, &opt, &stats, 0,
+        opt.replay ? (unsigned)replay.n_cols - 2 : opt.n_sensors, t0, 0};
+    if (opt.stall_every_s > 0) {
+        out.next_stall = t0 + rng_exp(1 / opt.stall_every_s);
+    }
+    if (opt.replay) {
+        run_replay(&out, t0, &replay);
+    } else if (opt.format == FORMAT_RAW) {
+        run_raw(&out, t0);
+    } else {
+        run_text(&out, t0);
+    }
+    double elapsed = now_s() - t0;
+
+    fprintf(stderr, "%zu records, %zu bytes in %.1f s (%.0f records/s, "
+            "%.3f MB/s); %zu split, %zu corrupted, %zu stalls; "
+            "%zu actions; at most %.1f ms late\n", stats.n_records,
+            stats.n_bytes, elapsed,
+            elapsed > 0 ? stats.n_records / elapsed : 0.0,
+            elapsed > 0 ? stats.n_bytes / elapsed / 1e6 : 0.0,
+            stats.n_split, stats.n_corrupt, stats.n_stalls,
+            stats.n_actions, 1000 * stats.max_late_s);
+
+    // Let the reader take what is left (for up to 1 s) before the
+    // device goes away.
+    double t_close = now_s() + 1;
+    int pending;
+    // Written data takes a moment to show up on the other end.
+    tcdrain(fd);
+    sleep_until(now_s() + 0.05);
+    while (ioctl(slave_fd, FIONREAD, &pending) == 0 && pending > 0 &&
+           now_s() < t_close) {
+        sleep_until(now_s() + 0.01);
+    }
+    if (opt.link) {
+        unlink(opt.link);
+    }
+    free(replay.values);
+    close(slave_fd);
+    close(fd);
+    return 0;
+}
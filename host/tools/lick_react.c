@@ -0,0 +1,382 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_react.c
+
+   React to lick events on chosen electrodes by toggling the action pin
+   of the lick sensor (LICK_ACTION_PIN, see firmware/lick_command.h),
+   and measure how long that takes.
+
+   The serial port is read as soon as anything arrives, rather than in
+   batches as the lick events readers do, and the `!` command is sent
+   back before anything else is done with the data. All lines received
+   are copied to standard output, so that the session can still be
+   saved (e.g. `lick_react -e 1:0 /dev/ttyACM0 > session.txt`).
+
+   With the action pin connected to the sync input (LICK_SYNC_IN_PIN, in
+   stamp mode), the firmware prints the time of every rising edge of the
+   pin as a `# sync in` line. Every second toggle is then matched with
+   its edge, and the latency from the lick event (its timestamp) to the
+   action is measured; a summary is printed to stderr at the end. The
+   timestamps of lick events are in ms, so latencies are over-estimated
+   by up to 1 ms. The time this program takes from reading an event to
+   sending the command is also reported.
+
+   Usage:
+     lick_react [-e sensor:electrode] ... [-n count] [-t seconds] [-q]
+                device
+
+   -e   react to lick events on this electrode (e.g. 1:0 for electrode 0
+        of the second sensor); can be repeated. By default, to all.
+   -n   stop after this many latencies have been measured.
+   -t   stop after this many seconds.
+   -q   do not copy the lines received to standard output.
+ */
+
+// cfmakeraw
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lick_records.h"
+
+#define MAX_SENSORS 2
+#define MAX_COLS (2 + MAX_SENSORS)
+#define MAX_ROWS 256
+// Toggles waiting for their sync edge; must be a power of 2.
+#define PENDING_LEN 64
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+/* Growing array of times, in ms */
+struct times {
+    double *t;
+    size_t n;
+    size_t cap;
+};
+
+static int times_add(struct times *s, double t) {
+    if (s->n == s->cap) {
+        size_t cap = s->cap ? 2 * s->cap : 1024;
+        double *t_new = realloc(s->t, cap * sizeof(*t_new));
+        if (t_new == NULL) {
+            return -1;
+        }
+        s->t = t_new;
+        s->cap = cap;
+    }
+    s->t[s->n++] = t;
+    return 0;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void times_summary(const char *name, struct times *s) {
+    if (s->n == 0) {
+        fprintf(stderr, "%s: none\n", name);
+        return;
+    }
+    qsort(s->t, s->n, sizeof(*s->t), compare_double);
+    fprintf(stderr, "%s: n %zu p50 %.2f p99 %.2f max %.2f ms\n", name,
+            s->n, s->t[s->n / 2], s->t[(s->n * 99) / 100],
+            s->t[s->n - 1]);
+}
+
+struct reactor {
+    int fd;
+    uint16_t subscribed[MAX_SENSORS];
+    int level;                          // Of the action pin
+    int64_t pending_ms[PENDING_LEN];    // Events that raised the pin
+    uint32_t pending_head;
+    uint32_t pending_tail;
+    size_t n_actions;
+    size_t n_unmatched;
+    struct times latency;
+    struct times host;
+};
+
+/* Send the action command if any of the events is on a subscribed
+ * electrode. Returns -1 if the command cannot be sent.
+ */
+static int react(struct reactor *r, const int64_t *rows, size_t n_rows,
+        uint32_t n_cols, double t_read) {
+    for (size_t i = 0; i < n_rows; i++) {
+        const int64_t *row = rows + i * n_cols;
+        int hit = 0;
+        for (uint32_t s = 0; s + 2 < n_cols && s < MAX_SENSORS; s++) {
+            hit |= (row[2 + s] & r->subscribed[s]) != 0;
+        }
+        if (!hit) {
+            continue;
+        }
+        if (write(r->fd, "!", 1) != 1) {
+            perror("write");
+            return -1;
+        }
+        times_add(&r->host, 1000 * (now_s() - t_read));
+        r->n_actions++;
+        r->level = !r->level;
+        if (r->level) {
+            if (r->pending_head - r->pending_tail == PENDING_LEN) {
+                r->pending_tail++;
+                r->n_unmatched++;
+            }
+            r->pending_ms[r->pending_head++ % PENDING_LEN] = row[1];
+        }
+    }
+    return 0;
+}
+
+/* Match `# sync in` lines with the events that raised the pin. */
+static void match_edges(struct reactor *r, char *comments) {
+    for (char *line = strtok(comments, "\n"); line != NULL;
+            line = strtok(NULL, "\n")) {
+        unsigned long count;
+        long long t_us;
+        if (sscanf(line, "# sync in %lu %lld", &count, &t_us) != 2) {
+            continue;
+        }
+        if (r->pending_head == r->pending_tail) {
+            r->n_unmatched++;
+            continue;
+        }
+        int64_t t_ms = r->pending_ms[r->pending_tail++ % PENDING_LEN];
+        times_add(&r->latency, (double)(t_us - t_ms * 1000) / 1000);
+    }
+}
+
+/* Ask the device for the number of values in its lines (see
+ * firmware/lick_command.h). Returns 0 if it does not say within 0.5 s;
+ * the decoder then takes it from the first line.
+ */
+static uint32_t device_columns(int fd) {
+    char buf[1024];
+    size_t len = 0;
+    double t_end = now_s() + 0.5;
+    if (write(fd, "?", 1) != 1) {
+        return 0;
+    }
+    while (now_s() < t_end && !stop) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 50) <= 0) {
+            continue;
+        }
+        if (len == sizeof(buf) - 1) {
+            len = 0;
+        }
+        ssize_t n = read(fd, buf + len, sizeof(buf) - 1 - len);
+        if (n <= 0) {
+            return 0;
+        }
+        len += (size_t)n;
+        buf[len] = '\0';
+        char *line = strstr(buf, "# device ");
+        char *end = line ? strchr(line, '\n') : NULL;
+        if (end == NULL) {
+            continue;
+        }
+        *end = '\0';
+        char *columns = strstr(line, " columns ");
+        if (columns == NULL) {
+            return 0;
+        }
+        uint32_t n_cols = 1;
+        for (char *c = columns + 9; *c && *c != ' '; c++) {
+            n_cols += *c == ',';
+        }
+        return n_cols;
+    }
+    return 0;
+}
+
+static int parse_electrode(const char *s, uint16_t *subscribed) {
+    unsigned sensor, electrode;
+    if (sscanf(s, "%u:%u", &sensor, &electrode) != 2 ||
+            sensor >= MAX_SENSORS || electrode >= 12) {
+        return -1;
+    }
+    subscribed[sensor] |= (uint16_t)(1u << electrode);
+    return 0;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: lick_react [-e sensor:electrode] ... "
+            "[-n count] [-t seconds] [-q] device\n");
+}
+
+int main(int argc, char *argv[]) {
+    struct reactor r = {0};
+    size_t max_latencies = 0;
+    double duration = 0;
+    int quiet = 0;
+    int any = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "e:n:t:qh")) != -1) {
+        switch (opt) {
+            case 'e':
+                if (parse_electrode(optarg, r.subscribed) != 0) {
+                    usage();
+                    return 1;
+                }
+                any = 1;
+                break;
+            case 'n':
+                max_latencies = (size_t)atol(optarg);
+                break;
+            case 't':
+                duration = atof(optarg);
+                break;
+            case 'q':
+                quiet = 1;
+                break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+    if (optind >= argc) {
+        usage();
+        return 1;
+    }
+    if (!any) {
+        for (int s = 0; s < MAX_SENSORS; s++) {
+            r.subscribed[s] = 0x0fff;
+        }
+    }
+
+    const char *path = argv[optind];
+    r.fd = open(path, O_RDWR | O_NOCTTY);
+    if (r.fd < 0) {
+        perror(path);
+        return 1;
+    }
+    // Raw mode: bytes are passed on as soon as they arrive.
+    struct termios tio;
+    if (tcgetattr(r.fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cc[VMIN] = 1;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(r.fd, TCSANOW, &tio);
+    }
+    tcflush(r.fd, TCIFLUSH);
+
+    struct lick_records *records = lick_records_new(device_columns(r.fd));
+    if (records == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    struct sigaction sa = {0};
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    static char buf[4096];
+    static int64_t rows[MAX_ROWS * MAX_COLS];
+    static char comments[LICK_RECORDS_MAX_LINE * 4];
+    int ret = 0;
+    double t_end = duration > 0 ? now_s() + duration : 0;
+    while (!stop && !(t_end && now_s() >= t_end) &&
+           !(max_latencies && r.latency.n >= max_latencies)) {
+        ssize_t n = read(r.fd, buf, sizeof(buf));
+        double t_read = now_s();
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror(path);
+            ret = 1;
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        if (lick_records_feed(records, buf, (size_t)n) != 0) {
+            fprintf(stderr, "out of memory\n");
+            ret = 1;
+            break;
+        }
+        size_t n_rows;
+        while ((n_rows = lick_records_read_i64(records, rows, MAX_ROWS))
+               > 0) {
+            uint32_t n_cols = lick_records_n_cols(records);
+            if (n_cols > MAX_COLS) {
+                fprintf(stderr, "%s: %u values per line; expected lick "
+                        "events\n", path, n_cols);
+                stop = 1;
+                ret = 1;
+                break;
+            }
+            if (react(&r, rows, n_rows, n_cols, t_read) != 0) {
+                stop = 1;
+                ret = 1;
+                break;
+            }
+            // Once the reaction is on its way, the data is passed on.
+            for (size_t i = 0; i < n_rows && !quiet; i++) {
+                for (uint32_t c = 0; c < n_cols; c++) {
+                    printf(c ? " %lld" : "%lld",
+                           (long long)rows[i * n_cols + c]);
+                }
+                printf("\n");
+            }
+        }
+        size_t len = lick_records_comments(records, comments,
+                                           sizeof(comments) - 1);
+        if (len > 0) {
+            if (!quiet) {
+                fwrite(comments, 1, len, stdout);
+            }
+            comments[len] = '\0';
+            match_edges(&r, comments);
+        }
+        if (!quiet) {
+            fflush(stdout);
+        }
+    }
+
+    fprintf(stderr, "%zu actions, %zu edges not matched, %llu bad "
+            "lines\n", r.n_actions, r.n_unmatched,
+            (unsigned long long)lick_records_n_bad(records));
+    times_summary("lick to action", &r.latency);
+    times_summary("host (read to command sent)", &r.host);
+
+    free(r.latency.t);
+    free(r.host.t);
+    lick_records_free(records);
+    close(r.fd);
+    return ret;
+}
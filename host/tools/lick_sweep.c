@@ -0,0 +1,404 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_sweep.c
+
+   Replay lick detection with many settings on recorded raw data, and
+   compare the onsets of each with reference onsets (see
+   common/lick_sweep.h).
+
+   Usage:
+     lick_sweep [-j threads] [-s n_sensors] [-i interval_ms]
+                [-w window_ms] [-p settings.txt] [-o prefix] [-v]
+                trace.txt[:labels.txt] ...
+
+   Each trace is the output of lick_decode, and its labels, if given,
+   the reference onsets, one per line as `<timestamp, us> <electrode>`
+   (e.g. `81234567 A3`), in time order and on the clock of the trace.
+   Onsets of a trace without labels are all counted as false, as in a
+   recording with no touches.
+
+   Settings are read from `settings.txt`, one per line as
+
+     tth rth tdbnc rdbnc [min_ili_ms [min_contact_ms]]
+
+   Without `-p`, every touch threshold from 4 to 39, with release
+   thresholds of 1/4, 1/2 and 3/4 of it and debounce values from 0 to
+   2 (972 settings), is tried. Times are turned into samples with the
+   sampling interval `-i` (default 20 ms), rounding up, as in the
+   firmware; `-w` (default 100 ms) is how far from a reference onset an
+   onset is matched to it. `-j` is the number of threads (default: the
+   number of cores), `-s` the number of sensors the electrodes are
+   split into (default: 1 for up to 12 electrodes, else 2).
+
+   One line is printed for every setting, with the onsets, matched,
+   false and missed onsets, precision, recall, F1 and mean latency over
+   all traces and electrodes. With `-o`, the onsets, F1 and latency of
+   every setting (rows) on every electrode (columns) are also written
+   to <prefix>-onsets.csv, <prefix>-f1.csv and <prefix>-latency.csv.
+   `-v` prints the size of the data and the time taken to stderr.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lick_sweep.h"
+
+#define LINE_SIZE 256
+
+static void usage(void) {
+    fprintf(stderr, "usage: lick_sweep [-j threads] [-s n_sensors] "
+            "[-i interval_ms] [-w window_ms] [-p settings.txt] "
+            "[-o prefix] [-v] trace.txt[:labels.txt] ...\n");
+}
+
+/* Totals of one setting over traces and electrodes. */
+struct totals {
+    uint64_t n_onsets;
+    uint64_t n_matched;
+    uint64_t n_reference;
+    double latency_ms;          // Sum over the matched onsets
+};
+
+static uint32_t to_samples(double ms, double interval_ms) {
+    return ms > 0 ? (uint32_t)((ms + interval_ms - 1e-9) / interval_ms) :
+        0;
+}
+
+/* The default grid of settings. Returns their number. */
+static size_t default_settings(struct lick_sweep_params *p) {
+    size_t n = 0;
+    for (int tth = 4; tth < 40; tth++) {
+        for (int quarters = 1; quarters <= 3; quarters++) {
+            for (int tdbnc = 0; tdbnc <= 2; tdbnc++) {
+                for (int rdbnc = 0; rdbnc <= 2; rdbnc++) {
+                    if (p != NULL) {
+                        p[n] = (struct lick_sweep_params){
+                            (uint8_t)tth, (uint8_t)(tth * quarters / 4),
+                            (uint8_t)tdbnc, (uint8_t)rdbnc, 0, 0};
+                    }
+                    n++;
+                }
+            }
+        }
+    }
+    return n;
+}
+
+/* Read settings from `path`. Returns their number, or 0 on error. */
+static size_t read_settings(const char *path, double interval_ms,
+                            struct lick_sweep_params **params) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return 0;
+    }
+    size_t n = 0;
+    size_t cap = 0;
+    char line[LINE_SIZE];
+    size_t line_no = 0;
+    while (fgets(line, sizeof(line), f)) {
+        line_no++;
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0') {
+            continue;
+        }
+        unsigned tth, rth, tdbnc, rdbnc;
+        double min_ili_ms = 0;
+        double min_contact_ms = 0;
+        int got = sscanf(line, "%u %u %u %u %lf %lf", &tth, &rth, &tdbnc,
+                         &rdbnc, &min_ili_ms, &min_contact_ms);
+        uint32_t min_ili = to_samples(min_ili_ms, interval_ms);
+        uint32_t min_contact = to_samples(min_contact_ms, interval_ms);
+        if (got < 4 || tth > 255 || rth > 255 || tdbnc > 7 ||
+            rdbnc > 7 || min_ili > LICK_SWEEP_MAX_ILI ||
+            min_contact > 255) {
+            fprintf(stderr, "%s:%zu: not a valid setting\n", path,
+                    line_no);
+            fclose(f);
+            free(*params);
+            return 0;
+        }
+        if (n == cap) {
+            cap = cap ? 2 * cap : 1024;
+            struct lick_sweep_params *p = realloc(*params,
+                                                  cap * sizeof(*p));
+            if (p == NULL) {
+                fprintf(stderr, "lick_sweep: out of memory\n");
+                fclose(f);
+                free(*params);
+                return 0;
+            }
+            *params = p;
+        }
+        (*params)[n++] = (struct lick_sweep_params){(uint8_t)tth,
+            (uint8_t)rth, (uint8_t)tdbnc, (uint8_t)rdbnc,
+            (uint16_t)min_ili, (uint8_t)min_contact};
+    }
+    fclose(f);
+    if (n == 0) {
+        fprintf(stderr, "%s: no settings\n", path);
+    }
+    return n;
+}
+
+static void print_setting(FILE *f, const struct lick_sweep_params *p,
+                          double interval_ms) {
+    fprintf(f, "%u,%u,%u,%u,%g,%g", p->tth, p->rth, p->tdbnc, p->rdbnc,
+            p->min_ili * interval_ms,
+            p->min_contact > 1 ? p->min_contact * interval_ms : 0);
+}
+
+static double f1_score(uint64_t n_onsets, uint64_t n_matched,
+                       uint64_t n_reference) {
+    return n_onsets + n_reference ?
+        2.0 * n_matched / (double)(n_onsets + n_reference) : 0;
+}
+
+/* Write one matrix: `what` is 0 for onsets, 1 for F1, 2 for latency. */
+static int write_matrix(const char *prefix, const char *name, int what,
+                        const struct lick_sweep_trace *traces,
+                        size_t n_traces, size_t n_electrodes,
+                        size_t per_sensor,
+                        const struct lick_sweep_params *params,
+                        size_t n_params, double interval_ms,
+                        const struct lick_sweep_result *results) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s-%s.csv", prefix, name);
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "tth,rth,tdbnc,rdbnc,min_ili_ms,min_contact_ms");
+    for (size_t e = 0; e < n_electrodes; e++) {
+        fprintf(f, ",%c%zu", (char)('A' + e / per_sensor),
+                e % per_sensor);
+    }
+    fprintf(f, "\n");
+    for (size_t i = 0; i < n_params; i++) {
+        print_setting(f, &params[i], interval_ms);
+        for (size_t e = 0; e < n_electrodes; e++) {
+            struct totals t = {0};
+            for (size_t s = 0; s < n_traces; s++) {
+                const struct lick_sweep_result *r = &results[
+                    (s * n_params + i) * LICK_SWEEP_MAX_ELECTRODES + e];
+                t.n_onsets += r->n_onsets;
+                t.n_matched += r->n_matched;
+                t.n_reference += r->n_reference;
+                t.latency_ms += r->latency_sum * traces[s].period_ms;
+            }
+            if (what == 0) {
+                fprintf(f, ",%llu", (unsigned long long)t.n_onsets);
+            } else if (what == 1 && t.n_onsets + t.n_reference) {
+                fprintf(f, ",%.4f", f1_score(t.n_onsets, t.n_matched,
+                                             t.n_reference));
+            } else if (t.n_matched) {
+                fprintf(f, ",%.1f", t.latency_ms / t.n_matched);
+            } else {
+                fprintf(f, ",");
+            }
+        }
+        fprintf(f, "\n");
+    }
+    if (fclose(f)) {
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    long n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t n_sensors = 0;
+    double interval_ms = 20;
+    double window_ms = 100;
+    const char *settings = NULL;
+    const char *prefix = NULL;
+    int verbose = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:s:i:w:p:o:v")) != -1) {
+        switch (opt) {
+            case 'j':
+                n_threads = atol(optarg);
+                break;
+            case 's':
+                n_sensors = (size_t)atoi(optarg);
+                break;
+            case 'i':
+                interval_ms = atof(optarg);
+                break;
+            case 'w':
+                window_ms = atof(optarg);
+                break;
+            case 'p':
+                settings = optarg;
+                break;
+            case 'o':
+                prefix = optarg;
+                break;
+            case 'v':
+                verbose = 1;
+                break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+    size_t n_traces = (size_t)(argc - optind);
+    if (n_traces == 0 || n_threads < 1 || interval_ms <= 0 ||
+        n_sensors > 2) {
+        usage();
+        return 1;
+    }
+    uint32_t window = to_samples(window_ms, interval_ms);
+    if (window > LICK_SWEEP_MAX_WINDOW) {
+        fprintf(stderr, "lick_sweep: the window can be at most %u "
+                "samples\n", LICK_SWEEP_MAX_WINDOW);
+        return 1;
+    }
+
+    struct lick_sweep_params *params = NULL;
+    size_t n_params;
+    if (settings) {
+        n_params = read_settings(settings, interval_ms, &params);
+        if (n_params == 0) {
+            return 1;
+        }
+    } else {
+        n_params = default_settings(NULL);
+        params = malloc(n_params * sizeof(*params));
+        if (params != NULL) {
+            default_settings(params);
+        }
+    }
+
+    struct lick_sweep_trace *traces = calloc(n_traces, sizeof(*traces));
+    struct lick_sweep_result *results = malloc(n_traces * n_params *
+        LICK_SWEEP_MAX_ELECTRODES * sizeof(*results));
+    if (params == NULL || traces == NULL || results == NULL) {
+        fprintf(stderr, "lick_sweep: out of memory\n");
+        return 1;
+    }
+    for (size_t s = 0; s < n_traces; s++) {
+        char *arg = argv[optind + s];
+        char *colon = strchr(arg, ':');
+        if (colon) {
+            *colon = '\0';
+            traces[s].labels = colon + 1;
+        }
+        traces[s].path = arg;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int ret = lick_sweep_run(traces, n_traces, n_sensors, params,
+                             n_params, window, (unsigned)n_threads,
+                             results);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (ret) {
+        fprintf(stderr, "lick_sweep: out of memory\n");
+        return 1;
+    }
+
+    int status = 0;
+    size_t n_electrodes = 0;
+    size_t n_samples = 0;
+    for (size_t s = 0; s < n_traces; s++) {
+        const struct lick_sweep_trace *t = &traces[s];
+        if (t->error) {
+            fprintf(stderr, "%s%s%s: %s\n", t->path,
+                    t->labels ? " or " : "", t->labels ? t->labels : "",
+                    t->error == EINVAL ? "no data" : strerror(t->error));
+            status = 1;
+            continue;
+        }
+        if (t->n_bad_labels) {
+            fprintf(stderr, "%s: %zu labels skipped\n", t->labels,
+                    t->n_bad_labels);
+        }
+        if (n_electrodes && t->n_electrodes != n_electrodes) {
+            fprintf(stderr, "%s: %zu electrodes, not %zu as in the "
+                    "others\n", t->path, t->n_electrodes, n_electrodes);
+            status = 1;
+        }
+        if (t->n_electrodes > n_electrodes) {
+            n_electrodes = t->n_electrodes;
+        }
+        n_samples += t->n_samples;
+    }
+    if (n_electrodes == 0) {
+        return 1;
+    }
+    if (n_sensors == 0) {
+        n_sensors = n_electrodes > 12 ? 2 : 1;
+    }
+    size_t per_sensor = (n_electrodes + n_sensors - 1) / n_sensors;
+
+    printf("tth,rth,tdbnc,rdbnc,min_ili_ms,min_contact_ms,onsets,matched,"
+           "false,missed,precision,recall,f1,latency_ms\n");
+    for (size_t i = 0; i < n_params; i++) {
+        struct totals t = {0};
+        for (size_t s = 0; s < n_traces; s++) {
+            for (size_t e = 0; e < LICK_SWEEP_MAX_ELECTRODES; e++) {
+                const struct lick_sweep_result *r = &results[
+                    (s * n_params + i) * LICK_SWEEP_MAX_ELECTRODES + e];
+                t.n_onsets += r->n_onsets;
+                t.n_matched += r->n_matched;
+                t.n_reference += r->n_reference;
+                t.latency_ms += r->latency_sum * traces[s].period_ms;
+            }
+        }
+        print_setting(stdout, &params[i], interval_ms);
+        printf(",%llu,%llu,%llu,%llu,%.4f,%.4f,%.4f,",
+               (unsigned long long)t.n_onsets,
+               (unsigned long long)t.n_matched,
+               (unsigned long long)(t.n_onsets - t.n_matched),
+               (unsigned long long)(t.n_reference - t.n_matched),
+               t.n_onsets ? (double)t.n_matched / t.n_onsets : 0,
+               t.n_reference ? (double)t.n_matched / t.n_reference : 0,
+               f1_score(t.n_onsets, t.n_matched, t.n_reference));
+        if (t.n_matched) {
+            printf("%.1f", t.latency_ms / t.n_matched);
+        }
+        printf("\n");
+    }
+
+    if (prefix) {
+        static const char *names[] = {"onsets", "f1", "latency"};
+        for (int what = 0; what < 3; what++) {
+            if (write_matrix(prefix, names[what], what, traces, n_traces,
+                             n_electrodes, per_sensor, params, n_params,
+                             interval_ms, results)) {
+                status = 1;
+            }
+        }
+    }
+
+    if (verbose) {
+        double seconds = (double)(end.tv_sec - start.tv_sec) +
+            (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+        fprintf(stderr, "%zu traces, %zu samples, %zu electrodes, %zu "
+                "settings, %ld threads: %.3f s\n", n_traces, n_samples,
+                n_electrodes, n_params, n_threads, seconds);
+    }
+    for (size_t s = 0; s < n_traces; s++) {
+        lick_sweep_free(&traces[s]);
+    }
+    free(traces);
+    free(results);
+    free(params);
+    return status;
+}
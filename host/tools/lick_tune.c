@@ -0,0 +1,295 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_tune.c
+
+   Choose the touch and release thresholds of every electrode, and the
+   debounce values, from two recordings of raw data: one with no
+   touches and one with touches on every electrode (see
+   common/lick_tune.h for how).
+
+   Usage:
+     lick_tune [-s n_sensors] [-f false_per_hour] [-d detected]
+               noise.txt touch.txt
+
+   Both files are the output of lick_decode: one line per sample with
+   the timestamp in us, the filtered values of every electrode and then
+   their baseline values. `-s` is the number of sensors the electrodes
+   are split into (default: 1 for up to 12 electrodes, else 2). A
+   setting is acceptable if its expected rate of false onsets is at
+   most `false_per_hour` (default 1) and it detects at least a fraction
+   `detected` (default 1) of the touches.
+
+   The chosen settings are printed as a table and as the lines to add
+   to the variant's lick_variant.h. The same recordings always give the
+   same settings.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lick_tune.h"
+
+#define MAX_ELECTRODES 24
+#define ELECTRODES_PER_SENSOR 12
+#define LINE_SIZE 1024
+
+// Thresholds written for electrodes without touches in the recording;
+// these are the sensor's defaults.
+#define DEFAULT_TTH 15
+#define DEFAULT_RTH 10
+
+/* Delta (baseline - filtered) of each electrode in a recording. */
+struct trace {
+    size_t n_samples;
+    size_t n_electrodes;
+    double period_ms;
+    int16_t *delta[MAX_ELECTRODES];
+};
+
+struct result {
+    int found;
+    struct lick_tune_params p;
+    struct lick_tune_score s;
+};
+
+static void usage(void) {
+    fprintf(stderr, "usage: lick_tune [-s n_sensors] [-f false_per_hour] "
+            "[-d detected] noise.txt touch.txt\n");
+}
+
+static int read_trace(const char *path, struct trace *t) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    memset(t, 0, sizeof(*t));
+    size_t cap = 0;
+    uint32_t t_first = 0;
+    uint32_t t_last = 0;
+    char line[LINE_SIZE];
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long values[1 + 2 * MAX_ELECTRODES];
+        size_t n = 0;
+        char *s = line;
+        char *end;
+        while (n < sizeof(values) / sizeof(values[0])) {
+            unsigned long v = strtoul(s, &end, 10);
+            if (end == s) {
+                break;
+            }
+            values[n++] = v;
+            s = end;
+        }
+        if (n < 3 || n % 2 == 0) {
+            continue;
+        }
+        size_t n_electrodes = (n - 1) / 2;
+        if (t->n_samples == 0) {
+            t->n_electrodes = n_electrodes;
+            t_first = (uint32_t)values[0];
+        } else if (n_electrodes != t->n_electrodes) {
+            continue;
+        }
+        if (t->n_samples == cap) {
+            cap = cap ? 2 * cap : 65536;
+            for (size_t e = 0; e < n_electrodes; e++) {
+                int16_t *d = realloc(t->delta[e], cap * sizeof(*d));
+                if (d == NULL) {
+                    fprintf(stderr, "%s: out of memory\n", path);
+                    fclose(f);
+                    return -1;
+                }
+                t->delta[e] = d;
+            }
+        }
+        for (size_t e = 0; e < n_electrodes; e++) {
+            long filtered = (long)values[1 + e];
+            long baseline = (long)values[1 + n_electrodes + e];
+            t->delta[e][t->n_samples] = (int16_t)(baseline - filtered);
+        }
+        t_last = (uint32_t)values[0];
+        t->n_samples++;
+    }
+    fclose(f);
+    if (t->n_samples < 2) {
+        fprintf(stderr, "%s: no data\n", path);
+        return -1;
+    }
+    // Timestamps wrap around every ~71 min; unsigned arithmetic gives
+    // the right interval provided that the recording is shorter.
+    t->period_ms = (uint32_t)(t_last - t_first) / 1000.0 /
+        (t->n_samples - 1);
+    return 0;
+}
+
+/* Tune every electrode with the given debounce values. Returns the
+ * number of electrodes (out of those with touches) that have an
+ * acceptable setting, and their worst latency in `max_latency`.
+ */
+static size_t tune_all(const struct trace *noise,
+                       const struct trace *touch, uint8_t tdbnc,
+                       uint8_t rdbnc,
+                       const struct lick_tune_criteria *criteria,
+                       struct result *results, double *max_latency) {
+    size_t n_ok = 0;
+    *max_latency = 0;
+    for (size_t e = 0; e < noise->n_electrodes; e++) {
+        struct result *r = &results[e];
+        r->found = lick_tune_electrode(noise->delta[e], noise->n_samples,
+            touch->delta[e], touch->n_samples, touch->period_ms, tdbnc,
+            rdbnc, criteria, &r->p, &r->s);
+        if (r->found == 1) {
+            n_ok++;
+            if (r->s.latency_ms > *max_latency) {
+                *max_latency = r->s.latency_ms;
+            }
+        }
+    }
+    return n_ok;
+}
+
+static void print_array(const char *name, const struct result *results,
+                        size_t n_electrodes, size_t n_sensors, int rth) {
+    size_t per_sensor = n_electrodes / n_sensors;
+    printf("#define %s {", name);
+    for (size_t i = 0; i < n_sensors; i++) {
+        printf("%s{", i ? ", " : "");
+        for (size_t j = 0; j < per_sensor; j++) {
+            const struct result *r = &results[i * per_sensor + j];
+            int v;
+            if (r->found < 0) {
+                v = rth ? DEFAULT_RTH : DEFAULT_TTH;
+            } else {
+                v = rth ? r->p.rth : r->p.tth;
+            }
+            printf("%s%d", j ? ", " : "", v);
+        }
+        printf("}");
+    }
+    printf("}\n");
+}
+
+int main(int argc, char *argv[]) {
+    struct lick_tune_criteria criteria = {1.0, 1.0};
+    size_t n_sensors = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:f:d:")) != -1) {
+        switch (opt) {
+            case 's':
+                n_sensors = (size_t)atoi(optarg);
+                break;
+            case 'f':
+                criteria.max_false_per_hour = atof(optarg);
+                break;
+            case 'd':
+                criteria.min_detected = atof(optarg);
+                break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+    if (argc - optind != 2) {
+        usage();
+        return 1;
+    }
+
+    static struct trace noise, touch;
+    if (read_trace(argv[optind], &noise) ||
+        read_trace(argv[optind + 1], &touch)) {
+        return 1;
+    }
+    if (noise.n_electrodes != touch.n_electrodes) {
+        fprintf(stderr, "the recordings have different numbers of "
+                "electrodes (%zu, %zu)\n", noise.n_electrodes,
+                touch.n_electrodes);
+        return 1;
+    }
+    size_t n_electrodes = noise.n_electrodes;
+    if (n_sensors == 0) {
+        n_sensors = n_electrodes > ELECTRODES_PER_SENSOR ? 2 : 1;
+    }
+    if (n_sensors > 2 || n_electrodes % n_sensors) {
+        fprintf(stderr, "cannot split %zu electrodes into %zu sensors\n",
+                n_electrodes, n_sensors);
+        return 1;
+    }
+    fprintf(stderr, "noise: %zu samples, %.1f min; touch: %zu samples, "
+            "%.1f min; %zu electrodes, %.2f ms per sample\n",
+            noise.n_samples, noise.n_samples * noise.period_ms / 60000,
+            touch.n_samples, touch.n_samples * touch.period_ms / 60000,
+            n_electrodes, touch.period_ms);
+
+    // The debounce values apply to all electrodes, so each pair is
+    // tried on all of them. The best pair is the one with which most
+    // electrodes have an acceptable setting, and then the one with the
+    // lowest worst-case latency.
+    static struct result results[MAX_ELECTRODES];
+    static struct result best[MAX_ELECTRODES];
+    size_t best_ok = 0;
+    double best_latency = 0;
+    uint8_t best_tdbnc = 0;
+    uint8_t best_rdbnc = 0;
+    int have_best = 0;
+    for (uint8_t tdbnc = 0; tdbnc <= LICK_TUNE_MAX_DEBOUNCE; tdbnc++) {
+        for (uint8_t rdbnc = 0; rdbnc <= LICK_TUNE_MAX_DEBOUNCE; rdbnc++) {
+            double latency;
+            size_t n_ok = tune_all(&noise, &touch, tdbnc, rdbnc,
+                                   &criteria, results, &latency);
+            if (!have_best || n_ok > best_ok ||
+                (n_ok == best_ok && latency < best_latency)) {
+                memcpy(best, results, sizeof(best));
+                best_ok = n_ok;
+                best_latency = latency;
+                best_tdbnc = tdbnc;
+                best_rdbnc = rdbnc;
+                have_best = 1;
+            }
+        }
+    }
+
+    size_t per_sensor = n_electrodes / n_sensors;
+    printf("# sensor electrode noise_mean noise_sd tth rth latency_ms "
+           "false_per_hour detected touches\n");
+    for (size_t e = 0; e < n_electrodes; e++) {
+        struct lick_tune_noise stats;
+        lick_tune_noise_stats(noise.delta[e], noise.n_samples, &stats);
+        const struct result *r = &best[e];
+        printf("%zu %zu %.2f %.2f", e / per_sensor, e % per_sensor,
+               stats.mean, stats.sd);
+        if (r->found < 0) {
+            printf(" - - - - 0 0 # no touches\n");
+            continue;
+        }
+        printf(" %u %u %.1f %.3g %zu %zu%s\n", r->p.tth, r->p.rth,
+               r->s.latency_ms, r->s.false_per_hour, r->s.n_detected,
+               r->s.n_touches, r->found ? "" : " # not acceptable");
+    }
+
+    printf("\n// lick_tune %s %s (max %g false onsets/h, %g detected)\n",
+           argv[optind], argv[optind + 1], criteria.max_false_per_hour,
+           criteria.min_detected);
+    printf("#define LICK_SETTING_TDBNC %u\n", best_tdbnc);
+    printf("#define LICK_SETTING_RDBNC %u\n", best_rdbnc);
+    print_array("LICK_ELECTRODE_TTH", best, n_electrodes, n_sensors, 0);
+    print_array("LICK_ELECTRODE_RTH", best, n_electrodes, n_sensors, 1);
+
+    for (size_t e = 0; e < n_electrodes; e++) {
+        free(noise.delta[e]);
+        free(touch.delta[e]);
+    }
+    return 0;
+}
@@ -0,0 +1,265 @@
+/* Copyright (c) 2026 Antonio González
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version. This program is distributed in the
+ * hope that it will be useful, but WITHOUT ANY WARRANTY; without even
+ * the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE. See the GNU General Public License for more details. You
+ * should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* lick_usb_read.c
+
+   Read the raw data blocks that a lick sensor built with
+   LICK_RAW_USB_VENDOR sends on its vendor-class USB interface (see
+   firmware/lick_usb.h), and write them unchanged to a file or to
+   standard output, e.g. to be decoded with lick_decode:
+
+     lick_usb_read | lick_decode > raw.txt
+
+   Several bulk transfers are kept queued with libusb, so that the
+   endpoint is read again as soon as one completes while the data from
+   the previous one is being written out.
+
+   To compare with raw data sent through the serial port (a variant
+   with LICK_SINK_RAW only), `-c /dev/ttyACM0` reads that instead. In
+   both cases, a summary of the throughput and of the CPU time used by
+   this program is printed to stderr at the end.
+
+   Usage:
+     lick_usb_read [-d vid:pid] [-c serial_device] [-t seconds]
+                   [output]
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <libusb.h>
+
+// Same as LICK_USB_VID, LICK_USB_PID in firmware/lick_config.h
+#define DEFAULT_VID 0x2E8A
+#define DEFAULT_PID 0x4C4B
+
+// Vendor-class interface and its bulk IN endpoint (see lick_usb.c)
+#define VENDOR_ITF 2
+#define VENDOR_EP_IN 0x83
+
+#define N_TRANSFERS 4
+#define TRANSFER_SIZE 16384
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+struct reader {
+    FILE *out;
+    size_t n_bytes;
+    size_t n_transfers;
+    int n_active;
+    int error;
+};
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static double cpu_s(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (double)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) +
+        1e-6 * (double)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec);
+}
+
+static void LIBUSB_CALL on_transfer(struct libusb_transfer *t) {
+    struct reader *r = t->user_data;
+    if (t->status == LIBUSB_TRANSFER_COMPLETED ||
+            t->status == LIBUSB_TRANSFER_TIMED_OUT) {
+        if (t->actual_length > 0) {
+            fwrite(t->buffer, 1, (size_t)t->actual_length, r->out);
+            r->n_bytes += (size_t)t->actual_length;
+            r->n_transfers++;
+        }
+        if (!stop && libusb_submit_transfer(t) == 0) {
+            return;
+        }
+    } else if (t->status != LIBUSB_TRANSFER_CANCELLED) {
+        fprintf(stderr, "transfer failed: %s\n",
+                libusb_error_name(t->status));
+        r->error = 1;
+        stop = 1;
+    }
+    r->n_active--;
+}
+
+static int read_usb(struct reader *r, uint16_t vid, uint16_t pid,
+        double duration) {
+    libusb_context *ctx;
+    int ret = libusb_init(&ctx);
+    if (ret != 0) {
+        fprintf(stderr, "libusb: %s\n", libusb_error_name(ret));
+        return 1;
+    }
+    libusb_device_handle *dev = libusb_open_device_with_vid_pid(ctx, vid,
+                                                                 pid);
+    if (dev == NULL) {
+        fprintf(stderr, "no device %04x:%04x\n", vid, pid);
+        libusb_exit(ctx);
+        return 1;
+    }
+    ret = libusb_claim_interface(dev, VENDOR_ITF);
+    if (ret != 0) {
+        fprintf(stderr, "cannot claim interface %d: %s\n", VENDOR_ITF,
+                libusb_error_name(ret));
+        libusb_close(dev);
+        libusb_exit(ctx);
+        return 1;
+    }
+
+    struct libusb_transfer *transfers[N_TRANSFERS] = {0};
+    for (int i = 0; i < N_TRANSFERS; i++) {
+        transfers[i] = libusb_alloc_transfer(0);
+        uint8_t *buf = malloc(TRANSFER_SIZE);
+        if (transfers[i] == NULL || buf == NULL) {
+            free(buf);
+            fprintf(stderr, "out of memory\n");
+            r->error = 1;
+            break;
+        }
+        // With a timeout, a partly filled buffer is still written out
+        // when data is slow to come.
+        libusb_fill_bulk_transfer(transfers[i], dev, VENDOR_EP_IN, buf,
+            TRANSFER_SIZE, on_transfer, r, 500);
+        transfers[i]->flags = LIBUSB_TRANSFER_FREE_BUFFER;
+        if (libusb_submit_transfer(transfers[i]) == 0) {
+            r->n_active++;
+        }
+    }
+
+    double t_end = duration > 0 ? now_s() + duration : 0;
+    while (r->n_active > 0) {
+        if (stop || (t_end && now_s() >= t_end)) {
+            stop = 1;
+            for (int i = 0; i < N_TRANSFERS; i++) {
+                if (transfers[i]) {
+                    libusb_cancel_transfer(transfers[i]);
+                }
+            }
+        }
+        struct timeval tv = {0, 100000};
+        libusb_handle_events_timeout_completed(ctx, &tv, NULL);
+    }
+
+    for (int i = 0; i < N_TRANSFERS; i++) {
+        libusb_free_transfer(transfers[i]);
+    }
+    libusb_release_interface(dev, VENDOR_ITF);
+    libusb_close(dev);
+    libusb_exit(ctx);
+    return r->error;
+}
+
+static int read_serial(struct reader *r, const char *path,
+        double duration) {
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+    static uint8_t buf[TRANSFER_SIZE];
+    double t_end = duration > 0 ? now_s() + duration : 0;
+    while (!stop && !(t_end && now_s() >= t_end)) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror(path);
+            r->error = 1;
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        fwrite(buf, 1, (size_t)n, r->out);
+        r->n_bytes += (size_t)n;
+        r->n_transfers++;
+    }
+    close(fd);
+    return r->error;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: lick_usb_read [-d vid:pid] "
+            "[-c serial_device] [-t seconds] [output]\n");
+}
+
+int main(int argc, char *argv[]) {
+    unsigned vid = DEFAULT_VID;
+    unsigned pid = DEFAULT_PID;
+    const char *serial = NULL;
+    double duration = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "d:c:t:h")) != -1) {
+        switch (opt) {
+            case 'd':
+                if (sscanf(optarg, "%x:%x", &vid, &pid) != 2) {
+                    usage();
+                    return 1;
+                }
+                break;
+            case 'c':
+                serial = optarg;
+                break;
+            case 't':
+                duration = atof(optarg);
+                break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+
+    struct reader r = {stdout, 0, 0, 0, 0};
+    if (optind < argc) {
+        r.out = fopen(argv[optind], "wb");
+        if (r.out == NULL) {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    double t0 = now_s();
+    double cpu0 = cpu_s();
+    int ret = serial ? read_serial(&r, serial, duration) :
+        read_usb(&r, (uint16_t)vid, (uint16_t)pid, duration);
+    double elapsed = now_s() - t0;
+    double cpu = cpu_s() - cpu0;
+
+    fflush(r.out);
+    if (r.out != stdout) {
+        fclose(r.out);
+    }
+    fprintf(stderr, "%s: %zu bytes in %zu reads, %.1f s, %.3f MB/s, "
+            "CPU %.2f s (%.1f%%)\n", serial ? serial : "usb", r.n_bytes,
+            r.n_transfers, elapsed,
+            elapsed > 0 ? r.n_bytes / elapsed / 1e6 : 0.0, cpu,
+            elapsed > 0 ? 100 * cpu / elapsed : 0.0);
+    return ret;
+}
@@ -0,0 +1,48 @@
+#include "hardware/dma.h"
+
+#include "dac_dma.h"
+
+
+void dac_dma_init(spi_inst_t *spi, uint pin_cs, uint pin_mosi,
+                  uint pin_sck, struct dac_dma *dac) {
+    dac->spi = spi;
+    dac->next = 0;
+    dac->n_updates = 0;
+    dac->n_overruns = 0;
+
+    // 16-bit frames, mode 0,0. With CPHA = 0 the SPI hardware raises
+    // chip select between consecutive frames, which is what latches
+    // each value into the DAC.
+    spi_set_format(spi, 16, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+    gpio_set_function(pin_mosi, GPIO_FUNC_SPI);
+    gpio_set_function(pin_sck, GPIO_FUNC_SPI);
+    gpio_set_function(pin_cs, GPIO_FUNC_SPI);
+
+    // DMA from memory to the SPI data register, paced by the SPI TX
+    // FIFO. Nothing is read back from the DAC; the SPI simply discards
+    // received data once its RX FIFO is full.
+    dac->dma_chan = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(dac->dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, spi_get_dreq(spi, true));
+    dma_channel_configure(dac->dma_chan, &c, &spi_get_hw(spi)->dr, NULL,
+                          DAC_N_CHANNELS, false);
+}
+
+
+void dac_dma_put(const uint16_t *values, struct dac_dma *dac) {
+    if (dma_channel_is_busy(dac->dma_chan)) {
+        dac->n_overruns++;
+        return;
+    }
+    uint16_t *buf = dac->buf[dac->next];
+    for (uint8_t i = 0; i < DAC_N_CHANNELS; i++) {
+        buf[i] = dac_word(i, values[i]);
+    }
+    dma_channel_transfer_from_buffer_now(dac->dma_chan, buf,
+                                         DAC_N_CHANNELS);
+    dac->next ^= 1;
+    dac->n_updates++;
+}
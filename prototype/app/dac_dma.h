@@ -0,0 +1,66 @@
+#ifndef DAC_DMA_H
+#define DAC_DMA_H
+
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+
+/*
+MCP48xx DAC driven by SPI and DMA.
+
+Each DAC update is one 16-bit SPI frame per channel:
+
+  bit 15     channel (0 = A, 1 = B; must be 0 in single-channel MCP48x1)
+  bit 14     unused
+  bit 13     gain (0 = 2x, 1 = 1x)
+  bit 12     1 = output enabled
+  bits 11-0  value (12-bit; 8- and 10-bit devices ignore the low bits)
+
+The SPI chip-select pin is driven by the SPI hardware, which raises it
+between frames; the DAC latches the new value at that moment. Frames
+are copied to the SPI from memory by DMA, so setting the outputs only
+takes the CPU as long as it takes to write the frames to a buffer and
+start the transfer.
+
+Two buffers are used in turn: a new update is written into one of them
+while the previous one may still be being sent from the other.
+*/
+
+// Channels per DAC: 1 for MCP4801/4811/4821, 2 for MCP4802/4812/4822.
+#ifndef DAC_N_CHANNELS
+#define DAC_N_CHANNELS 2
+#endif
+
+#define DAC_WORD_CHANNEL_B (1u << 15)
+#define DAC_WORD_GAIN_1X (1u << 13)
+#define DAC_WORD_ACTIVE (1u << 12)
+
+struct dac_dma {
+    spi_inst_t *spi;
+    uint dma_chan;
+    uint16_t buf[2][DAC_N_CHANNELS];
+    uint8_t next;
+    // Number of updates sent, and updates skipped because the previous
+    // one had not been sent yet.
+    uint32_t n_updates;
+    uint32_t n_overruns;
+};
+
+/* Set up the SPI port (which must have been initialised with spi_init)
+ * and its pins for the DAC, and claim a DMA channel. Gain is set to 2x.
+ */
+void dac_dma_init(spi_inst_t *spi, uint pin_cs, uint pin_mosi,
+                  uint pin_sck, struct dac_dma *dac);
+
+/* Build the SPI frame that sets `channel` to `value`, gain 2x. */
+static inline uint16_t dac_word(uint8_t channel, uint16_t value) {
+    return (channel ? DAC_WORD_CHANNEL_B : 0) | DAC_WORD_ACTIVE |
+        (value & 0xfff);
+}
+
+/* Start sending new values for all channels. Returns without waiting
+ * for the transfer to finish. If the previous transfer is still in
+ * progress the update is skipped and counted as an overrun.
+ */
+void dac_dma_put(const uint16_t *values, struct dac_dma *dac);
+
+#endif
@@ -1,22 +1,24 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include "pico/multicore.h"
-#include "pico/sync.h"
+#include "hardware/sync.h"
 #include "hardware/i2c.h"
 #include "hardware/spi.h"
 
 #include "lcd16x2_i2c.h"
-#include "mcp48x1.h"
 #include "mpr121.h"
 
+#include "dac_dma.h"
 #include "settings.h"
 
-/*
-#include "pico/time.h"
-absolute_time_t now;
-absolute_time_t then;
-int16_t tdiff;
-*/
+/* Timing measurements
+ * Set to 1 to print to serial, once per second, the time spent in the
+ * timer callback (mean and max, in us), the longest interval between
+ * the start of two consecutive callbacks (should be 1000 us), the number
+ * of DAC updates sent and skipped, and the number of setting changes
+ * applied.
+ */
+#define MEASURE_TIMING 0
 
 /* LCD defines */
 #define LCD_I2C_PORT i2c0
@@ -27,7 +29,7 @@ int16_t tdiff;
 
 /* DAC defines */
 #define DAC_SPI_PORT spi0
-#define DAC_SPI_BAUD 1 * 1000 * 1000 // 1 MHz
+#define DAC_SPI_BAUD 10 * 1000 * 1000 // 10 MHz. Max is 20 MHz
 #define DAC_SPI_PIN_MOSI 3
 #define DAC_SPI_PIN_CS 5
 #define DAC_SPI_PIN_SCK 6
@@ -37,7 +39,7 @@ int16_t tdiff;
 #define MPR121_I2C_PIN_SDA 26
 #define MPR121_I2C_PIN_SCL 27
 #define MPR121_I2C_ADDRESS 0x5A
-#define MPR121_I2C_FREQ 100000
+#define MPR121_I2C_FREQ 400000
 
 /* Buttons defines */
 #define BTN_UP 17
@@ -56,24 +58,97 @@ const uint LED_PIN = PICO_DEFAULT_LED_PIN;
 
 /* LCD variables */
 #define LCD_VALUE_COL 13
-volatile bool needs_update = false;
 uint8_t curr_setting = 0;
 
-/* Touch sensor variables */
-const uint8_t electrode = 0;
+/* Touch sensor variables
+ * The delta (baseline - filtered) of each of the first N_ANALOG
+ * electrodes is sent to its own DAC channel. Touch status of electrode
+ * 0 is sent to the digital output.
+ */
+#define N_ANALOG DAC_N_CHANNELS
 bool is_touched;
-uint16_t baseline, filtered, delta_out;
-int16_t delta;
-// absolute_time_t now;
+uint16_t baseline[N_ANALOG], filtered[N_ANALOG], delta_out[N_ANALOG];
+
+// MPR121 registers read at every sample: touch status (0x00, 0x01),
+// out-of-range status (0x02, 0x03) and filtered data (from 0x04, two
+// bytes per electrode) in one transaction, then baseline (from 0x1E,
+// upper 8 of 10 bits, one byte per electrode) in a second.
+#define TOUCH_STATUS_REG 0x00
+#define BASELINE_REG 0x1E
+// Sampling interval of the MPR121 itself is set in the AFE
+// configuration 2 register, which can only be written with all
+// electrodes disabled (ECR = 0).
+#define AFE_CONFIG2_REG 0x5D
+#define ECR_REG 0x5E
+// Charge time 0.5 us (as after reset), 4 samples for the second
+// filter, electrode sampling interval 1 ms.
+#define AFE_CONFIG2_1MS 0x20
 
 /* Repeating timer */
-const int32_t sampling_interval_ms = 20;  // 50 Hz
+const int32_t sampling_interval_us = 1000;  // 1 kHz
 bool timer_callback(repeating_timer_t *rt);
 
-static mutex_t mtx;
 struct mpr121_sensor mpr121;
 struct lcd16x2 lcd;
-struct mcp48x1_dac dac;
+struct dac_dma dac;
+
+#if MEASURE_TIMING
+volatile uint32_t irq_us_max = 0;
+volatile uint32_t irq_us_sum = 0;
+volatile uint32_t irq_count = 0;
+volatile uint32_t irq_period_max = 0;
+volatile uint32_t n_messages = 0;
+uint32_t irq_last_start = 0;
+#endif
+
+/* Scale delta for the DAC.
+ *
+ * DAC gain is set to 2x. Thus, its useful range is 0 ~ 3299 (0 ~ 3.3
+ * V). Both baseline and filtered are 10-bit numbers, which means that
+ * delta can be a number between -1023 and +1023.
+ *
+ * To output this delta value to the DAC, which is 12-bit, I add 1650 to
+ * center delta at 1.65 V. This gives an output range for delta of:
+ *   * 1650 + 1023 = 2673 = 2.67 V
+ *   * 1650 - 1023 = 627 = 0.627 V
+ *
+ * Multiplying delta by 1.5 extends the useful output range
+ *   * 1650 + (+1023 * 1.5) = 3185 = 3.19 V
+ *   * 1650 + (-1023 * 1.5) = 116 = 0.12 V
+ *
+ * This is 1650 + 1.5 * delta done in integers, as (3300 + 3 * delta) / 2.
+ * The sum is always positive, so the result is the same as truncating
+ * the floating point value, without floating point maths (which the
+ * RP2040 does in software) in the timer callback.
+ */
+static inline uint16_t delta_to_dac(int16_t delta) {
+    return (uint16_t)((3300 + 3 * (int32_t)delta) / 2);
+}
+
+/* Read touch status of electrode 0, and filtered and baseline values of
+ * the first N_ANALOG electrodes, in two I2C transactions.
+ */
+void read_electrodes(void) {
+    uint8_t buf[4 + 2 * N_ANALOG];
+    uint8_t reg = TOUCH_STATUS_REG;
+    i2c_write_blocking(MPR121_I2C_PORT, MPR121_I2C_ADDRESS, &reg, 1,
+                       true);
+    i2c_read_blocking(MPR121_I2C_PORT, MPR121_I2C_ADDRESS, buf,
+                      sizeof(buf), false);
+    is_touched = buf[0] & 0x1;
+    for (uint8_t i = 0; i < N_ANALOG; i++) {
+        filtered[i] = (buf[4 + 2 * i] | (buf[5 + 2 * i] << 8)) & 0x3ff;
+    }
+
+    reg = BASELINE_REG;
+    i2c_write_blocking(MPR121_I2C_PORT, MPR121_I2C_ADDRESS, &reg, 1,
+                       true);
+    i2c_read_blocking(MPR121_I2C_PORT, MPR121_I2C_ADDRESS, buf, N_ANALOG,
+                      false);
+    for (uint8_t i = 0; i < N_ANALOG; i++) {
+        baseline[i] = buf[i] << 2;
+    }
+}
 
 bool debounce_btn(uint8_t button){
     // From Listing 2 in www.ganssle.com/debouncing-pt2.htm
@@ -89,33 +164,39 @@ void lcd_put_number(uint8_t num, lcd16x2_t *lcd) {
     lcd_put_str(c, lcd);
 }
 
-void update_mpr121(struct setting *settings, uint8_t *idx,
-                   lcd16x2_t *lcd, mpr121_sensor_t *mpr121) {
-    switch (settings[*idx].func) {
+/* Apply a setting-change message (see settings.h) to the sensor.
+ *
+ * This runs in the timer callback, on core 0, which is the only code
+ * that talks to the sensor; the LCD is left entirely to core 1.
+ */
+void apply_setting_message(uint32_t msg, mpr121_sensor_t *mpr121) {
+    switch (message_func(msg)) {
         case FUNC_SET_TH:
-            struct setting tth, rth;
-            tth = get_setting(SETTING_TTH, settings);
-            rth = get_setting(SETTING_RTH, settings);
-            mpr121_set_thresholds(tth.value, rth.value, mpr121);
+            mpr121_set_thresholds(message_value(msg, 0),
+                                  message_value(msg, 1), mpr121);
             break;
         case FUNC_SET_NHD:
-            struct setting nhdr, nhdf, nhdt;
-            nhdr = get_setting(SETTING_NHDR, settings);
-            nhdf = get_setting(SETTING_NHDF, settings);
-            nhdt = get_setting(SETTING_NHDT, settings);
-            mpr121_set_noise_half_delta(nhdr.value, nhdf.value,
-                                        nhdt.value, mpr121);
+            mpr121_set_noise_half_delta(message_value(msg, 0),
+                                        message_value(msg, 1),
+                                        message_value(msg, 2), mpr121);
             break;
         case FUNC_SET_MHD:
-            struct setting mhdr, mhdf;
-            mhdr = get_setting(SETTING_MHDR, settings);
-            mhdf = get_setting(SETTING_MHDF, settings);         
-            mpr121_set_max_half_delta(mhdr.value, mhdf.value, mpr121);
+            mpr121_set_max_half_delta(message_value(msg, 0),
+                                      message_value(msg, 1), mpr121);
+            break;
+        default:
             break;
     }
-    // Update LCD with new value
+}
+
+/* Send the current value of a setting to core 0, and show it. If the
+ * FIFO to core 0 is full (i.e. the buttons are pressed faster than core
+ * 0 applies the changes) this waits; only core 1 is held up.
+ */
+void send_setting(struct setting *settings, uint8_t idx, lcd16x2_t *lcd) {
+    multicore_fifo_push_blocking(settings_message(settings, idx));
     lcd_move_cursor(0, LCD_VALUE_COL, lcd);
-    lcd_put_number(settings[*idx].value, lcd);
+    lcd_put_number(settings[idx].value, lcd);
 }
 
 void lcd_put_setting(struct setting *settings, uint8_t *idx,
@@ -126,7 +207,12 @@ void lcd_put_setting(struct setting *settings, uint8_t *idx,
     lcd_put_number(settings[*idx].value, lcd);
 }
 
-/* Core 1: Handle LCD and buttons */
+/* Core 1: Handle LCD and buttons
+ *
+ * Core 1 owns `settings` and the LCD. Setting changes are sent to core
+ * 0 as messages through the inter-core FIFO, which is hardware and needs
+ * no locks, so core 0 never waits for core 1.
+ */
 void core1_entry() {
     /* Initialise buttons */
     gpio_init(BTN_UP);
@@ -183,17 +269,13 @@ void core1_entry() {
         }
         /* Button right: increase the value of the current setting */
         if (debounce_btn(BTN_RIGHT)) {
-            mutex_enter_blocking(&mtx);
             setting_increase_value(settings, &curr_setting);
-            needs_update = true;
-            mutex_exit(&mtx);
+            send_setting(settings, curr_setting, &lcd);
         }
         /* Button left: decrease the value of the current setting */
         if (debounce_btn(BTN_LEFT)) {
-            mutex_enter_blocking(&mtx);
             setting_decrease_value(settings, &curr_setting);
-            needs_update = true;
-            mutex_exit(&mtx);
+            send_setting(settings, curr_setting, &lcd);
         }
         sleep_ms(20);
     }
@@ -217,10 +299,12 @@ int main() {
     gpio_pull_up(MPR121_I2C_PIN_SDA);
     gpio_pull_up(MPR121_I2C_PIN_SCL);
 
-    /* Initialise the touch sensor. Enable only one touch sensor
-    (electrode 0) */
+    /* Initialise the touch sensor. Enable one electrode per analog
+    output, and have the sensor sample them every 1 ms */
     mpr121_init(MPR121_I2C_PORT, MPR121_I2C_ADDRESS, &mpr121);
-    mpr121_enable_electrodes(1, &mpr121);
+    mpr121_write(ECR_REG, 0, &mpr121);
+    mpr121_write(AFE_CONFIG2_REG, AFE_CONFIG2_1MS, &mpr121);
+    mpr121_enable_electrodes(N_ANALOG, &mpr121);
     settings_init(settings);
     struct setting tth = get_setting(SETTING_TTH, settings);
     struct setting rth = get_setting(SETTING_RTH, settings);
@@ -235,67 +319,88 @@ int main() {
 
     /* Initialise SPI and DAC */
     spi_init(DAC_SPI_PORT, DAC_SPI_BAUD);
-    mcp48x1_init(DAC_SPI_PORT, DAC_SPI_PIN_CS, DAC_SPI_PIN_MOSI,
-                 DAC_SPI_PIN_SCK, MCP48X1_RESOLUTION_12, &dac);
-    mcp48x1_set_gain(MCP48X1_GAIN_2X, &dac);
+    dac_dma_init(DAC_SPI_PORT, DAC_SPI_PIN_CS, DAC_SPI_PIN_MOSI,
+                 DAC_SPI_PIN_SCK, &dac);
 
-    /* Initialise mutex and start core 1 */
-    mutex_init(&mtx);
+    /* Start core 1 */
     multicore_launch_core1(core1_entry);
 
     /* Start repeating timer */
     repeating_timer_t timer;
-    add_repeating_timer_ms(-sampling_interval_ms, timer_callback, NULL,
+    add_repeating_timer_us(-sampling_interval_us, timer_callback, NULL,
                            &timer);
 
+#if MEASURE_TIMING
+    uint32_t last_updates = 0;
+    uint32_t last_overruns = 0;
+#endif
     while(1) {
+#if MEASURE_TIMING
+        sleep_ms(1000);
+        uint32_t save = save_and_disable_interrupts();
+        uint32_t us_max = irq_us_max;
+        uint32_t us_sum = irq_us_sum;
+        uint32_t count = irq_count;
+        uint32_t period_max = irq_period_max;
+        uint32_t messages = n_messages;
+        uint32_t updates = dac.n_updates;
+        uint32_t overruns = dac.n_overruns;
+        irq_us_max = irq_us_sum = irq_count = 0;
+        irq_period_max = n_messages = 0;
+        restore_interrupts(save);
+        if (count) {
+            printf("irq us mean %lu max %lu, period max %lu, "
+                   "dac updates/s %lu, skipped %lu, settings %lu\n",
+                   us_sum / count, us_max, period_max,
+                   updates - last_updates, overruns - last_overruns,
+                   messages);
+        }
+        last_updates = updates;
+        last_overruns = overruns;
+#else
         tight_loop_contents();
+#endif
     }
     return 0;
 }
 
 bool timer_callback(repeating_timer_t *rt) {
-    // now = get_absolute_time();
-    // tdiff = to_ms_since_boot(now) - to_ms_since_boot(then);
-    // then = now;
+#if MEASURE_TIMING
+    uint32_t t_start = time_us_32();
+    uint32_t period = t_start - irq_last_start;
+    if (irq_count && period > irq_period_max) irq_period_max = period;
+    irq_last_start = t_start;
+#endif
 
     // Check if the electrode has been touched, and read the
     // baseline and filtered data values
-    mpr121_is_touched(electrode, &is_touched, &mpr121);
-    mpr121_baseline_value(electrode, &baseline, &mpr121);
-    mpr121_filtered_data(electrode, &filtered, &mpr121);
-    delta = baseline - filtered;
-
-    // DAC gain is set to 2x. Thus, its useful range is 0 ~ 3299 (0 ~
-    // 3.3 V). Both baseline and filtered are 10-bit numbers, which
-    // means that delta can be a number between -1023 and +1023.
-    //
-    // To output this delta value to the DAC, which is 12-bit, I add
-    // 1650 to center delta at 1.65 V. This gives an output range for
-    // delta of:
-    //   * 1650 + 1023 = 2673 = 2.67 V
-    //   * 1650 - 1023 = 627 = 0.627 V
-    //
-    // Multiplying delta by 1.5 extends the useful output range
-    //   * 1650 + (+1023 * 1.5) = 3185 = 3.19 V
-    //   * 1650 + (-1023 * 1.5) = 116 = 0.12 V
-    delta_out = (uint16_t)(1650.0 + (delta * 1.5));
-    
-    // Output: is_touched (digital) and delta (analog) values
+    read_electrodes();
+    for (uint8_t i = 0; i < N_ANALOG; i++) {
+        delta_out[i] = delta_to_dac((int16_t)(baseline[i] - filtered[i]));
+    }
+
+    // Output: is_touched (digital) and delta (analog) values. The DAC
+    // values are sent by DMA in the background.
     gpio_put(TOUCH_OUT_PIN, is_touched);
     gpio_put(LED_PIN, is_touched);
-    mcp48x1_put(delta_out, &dac);
-    
-    // printf("%d %d %d %d %d %d\n", baseline, filtered, delta,     
-    //     settings[0].value, settings[1].value,
-    //     // delta_out , mhdf,
-    //     is_touched);
-
-    // printf("%d\n", tdiff);
-    
-    if (needs_update && mutex_try_enter(&mtx, 0)) {
-        update_mpr121(settings, &curr_setting, &lcd, &mpr121);
-        needs_update = false;
-        mutex_exit(&mtx);
+    dac_dma_put(delta_out, &dac);
+
+    // Apply setting changes from core 1, after this sample has been
+    // output. At most one message is applied per sample, so the time
+    // that this can add to the callback is bounded by the cost of one
+    // MPR121 settings function.
+    if (multicore_fifo_rvalid()) {
+        apply_setting_message(multicore_fifo_pop_blocking(), &mpr121);
+#if MEASURE_TIMING
+        n_messages++;
+#endif
     }
-}
\ No newline at end of file
+
+#if MEASURE_TIMING
+    uint32_t dt = time_us_32() - t_start;
+    if (dt > irq_us_max) irq_us_max = dt;
+    irq_us_sum += dt;
+    irq_count++;
+#endif
+    return true;
+}
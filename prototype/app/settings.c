@@ -108,4 +108,26 @@ void setting_decrease_value(struct setting *settings, uint8_t *idx) {
     } else {
         settings[*idx].value = (uint8_t)val;
     }
-}
\ No newline at end of file
+}
+
+uint32_t settings_message(struct setting *settings, uint8_t idx) {
+    uint32_t msg = (uint32_t)settings[idx].func << 24;
+    switch (settings[idx].func) {
+        case FUNC_SET_TH:
+            msg |= get_setting(SETTING_TTH, settings).value << 16;
+            msg |= get_setting(SETTING_RTH, settings).value << 8;
+            break;
+        case FUNC_SET_NHD:
+            msg |= get_setting(SETTING_NHDR, settings).value << 16;
+            msg |= get_setting(SETTING_NHDF, settings).value << 8;
+            msg |= get_setting(SETTING_NHDT, settings).value;
+            break;
+        case FUNC_SET_MHD:
+            msg |= get_setting(SETTING_MHDR, settings).value << 16;
+            msg |= get_setting(SETTING_MHDF, settings).value << 8;
+            break;
+        default:
+            break;
+    }
+    return msg;
+}
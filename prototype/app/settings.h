@@ -55,4 +55,22 @@ void setting_increase_value(struct setting *settings, uint8_t *idx);
 
 void setting_decrease_value(struct setting *settings, uint8_t *idx);
 
+/* Setting-change messages.
+ *
+ * A message carries the current values of all the settings that are
+ * applied to the MPR121 by the same function as the setting at `idx`,
+ * packed into 32 bits: function in bits 31-24, then up to three values
+ * of 8 bits each, in the order in which the function takes them. It is
+ * a copy, so it stays valid whatever happens to `settings` afterwards.
+ */
+uint32_t settings_message(struct setting *settings, uint8_t idx);
+
+static inline enum mpr121_func_key message_func(uint32_t msg) {
+    return (enum mpr121_func_key)(msg >> 24);
+}
+
+static inline uint8_t message_value(uint32_t msg, uint8_t n) {
+    return (uint8_t)(msg >> (16 - 8 * n));
+}
+
 #endif
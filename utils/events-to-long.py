@@ -11,8 +11,8 @@ electrodes as active.
 This script converts one such file into long format suitable for
 analysis. For example, if the original csv shows the line
 
-    timestamp,sensorA,sensorB
-    0.2,3,1
+    idx,timestamp,sensorA,sensorB
+    0,0.2,3,1
 
 which indicates that at timestamp 0.2 sensor A detected a lick in
 electrodes 0 and 1, and sensor B detected a lick in electrode 1, then
@@ -23,54 +23,62 @@ this script will convert that line into
     0.2,A1
     0.2,B1
 
-which can then be used for further analysis.
-    
+which can then be used for further analysis. Columns other than the
+timestamp and the sensors (e.g. the event count, `idx`) are dropped.
+
 author: Antonio Gonzalez
-last updated: 2026-01-06
+last updated: 2026-10-18
 """
 import os
 import sys
 
 NELE = 12  # Number of electrodes in each touch sensor
 
-fname_in = sys.argv[1]
-
-fname, ext = os.path.splitext(fname_in)
-fname_out = f'{fname}-long{ext}'
 
-if os.path.exists(fname_out):
-    answ = input("Output file exists. Overwrite? [N/y] ")
-    if answ != 'y':
-        print('File will not be overwritten. Exiting.')
-        sys.exit()
-
-header = ''
-counter = 0
-with open(fname_in, 'r') as fin, open(fname_out, 'w') as fout:
+def to_long(fin, fout, n_electrodes=NELE):
+    """
+    Convert the lines of `fin` (a csv file in short format, with
+    comments and a header) to long format, written to `fout`. Also used
+    by host/bench/bench_suite.py to time the conversion.
+    """
+    header = ''
     for line in fin:
         if line.startswith('#'):
             fout.write(line)
         elif header == '':
-            header = line
-            header = header.replace('sensor', '')
-            header = header.strip().split(',')
+            header = line.strip().split(',')
             # fout.write('timestamp,sensorID,electrodeID\n')
             fout.write('timestamp,eleID\n')
-            # First column is timestamp, rest are values from sensors
-            ncols = len(header)
+            # One column is the timestamp; those named "sensor..." are
+            # values from sensors.
+            time_col = header.index('timestamp')
+            sensor_cols = [col for (col, name) in enumerate(header)
+                           if name.startswith('sensor')]
+            header = [name.replace('sensor', '') for name in header]
         else:
             vals = line.strip().split(',')
-            timestamp = int(vals[0])
-            # Iterate over each sensor's data: start from column 1 (column 0 is
-            # timestamp)
-            for col in range(1, ncols):
+            timestamp = int(vals[time_col])
+            # Iterate over each sensor's data
+            for col in sensor_cols:
                 val = int(vals[col])
                 if val > 0:
-                    for ele in range(NELE):
+                    for ele in range(n_electrodes):
                         if (val >> ele) & 0x1:
                             fout.write(f"{timestamp},{header[col]}{ele}\n")
-                    # print(line[0], line[1], ele)
-        # if counter == 9:
-            # break
-        # counter += 1
-print(f'Done: {fname_out}')
+
+
+if __name__ == "__main__":
+    fname_in = sys.argv[1]
+
+    fname, ext = os.path.splitext(fname_in)
+    fname_out = f'{fname}-long{ext}'
+
+    if os.path.exists(fname_out):
+        answ = input("Output file exists. Overwrite? [N/y] ")
+        if answ != 'y':
+            print('File will not be overwritten. Exiting.')
+            sys.exit()
+
+    with open(fname_in, 'r') as fin, open(fname_out, 'w') as fout:
+        to_long(fin, fout)
+    print(f'Done: {fname_out}')
@@ -0,0 +1,104 @@
+"""
+Extract the waveform snippets saved with the lick events, for offline
+classification of licks and artifacts.
+
+A lick sensor built with LICK_SNIPPET_PRE and LICK_SNIPPET_POST sends,
+for every electrode where a lick starts, the values of that electrode
+around the onset, as a line
+
+    # snippet <event count> <sensor> <electrode> <pre> <baseline> <delta> ...
+
+which the lick events readers save to the csv file as a comment (see
+firmware/lick_snippet.h). Each <delta> is the baseline minus the
+filtered value of one sample, from <pre> samples before the onset
+onwards.
+
+This script writes one row per snippet to `<file>-snippets.csv`:
+
+    idx,timestamp,eleID,baseline,peak,contact,pre_sd,n_onsets,d0,d1,...
+
+where `idx` and `timestamp` are those of the lick event in the csv file
+(empty if the event is not there), `peak` is the largest delta from the
+onset on, `contact` is the number of samples from the onset for which
+the delta stays above half the peak, `pre_sd` is the standard deviation
+of the deltas before the onset, `n_onsets` is the number of electrodes
+that started a lick in the same event, and d0, d1, ... are the deltas.
+A tongue contact gives a steep rise, a contact of a few tens of ms and
+a quiet baseline before it; paws and electrical noise tend to touch
+many electrodes at once, or to give long or ragged contacts.
+
+Usage:
+
+    python3 lick-snippets.py lick_events_<date>.csv
+
+author: Antonio Gonzalez
+last updated: 2026-10-18
+"""
+import os
+import statistics
+import sys
+
+fname_in = sys.argv[1]
+
+fname, ext = os.path.splitext(fname_in)
+fname_out = f'{fname}-snippets{ext}'
+
+if os.path.exists(fname_out):
+    answ = input("Output file exists. Overwrite? [N/y] ")
+    if answ != 'y':
+        print('File will not be overwritten. Exiting.')
+        sys.exit()
+
+# Event count of the first event in the file, on the Pico; the readers
+# save lick events with counts relative to it.
+first_count = None
+timestamps = {}
+snippets = []
+dropped = 0
+with open(fname_in, 'r') as fin:
+    for line in fin:
+        fields = line.split()
+        if fields[:3] == ['#', 'first', 'event']:
+            first_count = int(fields[3])
+        elif fields[:3] == ['#', 'snippet', 'dropped']:
+            dropped = int(fields[3])
+        elif fields[:2] == ['#', 'snippet'] and len(fields) > 7:
+            (count, sensor, electrode, pre, baseline) = (
+                int(v) for v in fields[2:7])
+            deltas = [int(v) for v in fields[7:]]
+            snippets.append((count, sensor, electrode, pre, baseline,
+                             deltas))
+        elif not line.startswith('#'):
+            vals = line.strip().split(',')
+            if len(vals) >= 2 and vals[0].lstrip('-').isdigit():
+                timestamps[int(vals[0])] = vals[1]
+
+if first_count is None:
+    print('No "# first event" line; event indices are those of the Pico.')
+    first_count = 0
+
+n_onsets = {}
+for snippet in snippets:
+    n_onsets[snippet[0]] = n_onsets.get(snippet[0], 0) + 1
+
+length = max((len(s[5]) for s in snippets), default=0)
+with open(fname_out, 'w') as fout:
+    fout.write('idx,timestamp,eleID,baseline,peak,contact,pre_sd,'
+               'n_onsets,' + ','.join(f'd{i}' for i in range(length)) +
+               '\n')
+    for (count, sensor, electrode, pre, baseline, deltas) in snippets:
+        idx = count - first_count
+        after = deltas[pre:]
+        peak = max(after) if after else 0
+        contact = 0
+        while contact < len(after) and after[contact] > peak / 2:
+            contact += 1
+        before = deltas[:pre]
+        pre_sd = statistics.stdev(before) if len(before) > 1 else 0
+        fout.write(f'{idx},{timestamps.get(idx, "")},'
+                   f'{chr(ord("A") + sensor)}{electrode},{baseline},'
+                   f'{peak},{contact},{pre_sd:.2f},{n_onsets[count]},' +
+                   ','.join(str(d) for d in deltas) + '\n')
+
+print(f'{len(snippets)} snippets ({dropped} dropped by the firmware)')
+print(f'Done: {fname_out}')
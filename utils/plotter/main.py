@@ -22,9 +22,7 @@ Trigger Release → Delta < Touch Threshold
 python3-pyqtgraph
 python3-pyqt6
 """
-from collections import deque
 from datetime import datetime
-from itertools import count
 import os
 import sys
 import time
@@ -39,11 +37,24 @@ from serial.tools import list_ports
 
 from ui.ui_main import Ui_MainWindow
 
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                             '..', '..', 'host', 'python'))
+from lick_device import describe
+from lick_records import RecordDecoder
+from raster import LickRaster
+
 # GUI parameters
 GUI_REFRESH_RATE = 100  # In milliseconds
 WIN_WIDTH_SAMPLES = 150
 CURVE_WIDTH = 2
 
+# Lick events (devices that describe themselves with `format events` or
+# `format edges`) are shown as a raster of this many seconds, in columns
+# of RASTER_WINDOW_S / RASTER_COLUMNS seconds.
+RASTER_WINDOW_S = 600
+RASTER_COLUMNS = 1200
+RASTER_LABEL_ALL = 24   # Label every electrode up to this many rows
+
 # List of signals as expected to arrive in the serial port from the
 # Pico. Each signal is `panel` (panel index where this signal will be
 # plotted), `name` name of the signal, `colour` for the curve.
@@ -55,7 +66,20 @@ signals = {
     3: [1, "TTH", "red"],
     4: [1, "RTH", "green"],
     5: [1, "Status", "yellow"]}
-        
+
+# Devices that describe themselves (see host/python/lick_device.py) send
+# the names of their signals. These are the ones known by name (e.g.
+# from utils/test-sensor-settings); any others are plotted in the second
+# panel, in these colours.
+signals_by_name = {
+    'baseline': [0, "Baseline", "red"],
+    'filtered': [0, "Signal", "green"],
+    'delta': [1, "Delta", "orange"],
+    'tth': [1, "TTH", "red"],
+    'rth': [1, "RTH", "green"],
+    'status': [1, "Status", "yellow"]}
+other_colours = ("blue", "magenta", "cyan", "black", "orange", "brown")
+
 # Serial parameters
 BAUD_DEFAULT = 115200
 BAUD_RATES = (9600, 19200, 38400, 57600, 115200)
@@ -70,7 +94,11 @@ class Settings:
         self.port = ''
         self.scan_ports()
         self.first_is_x = False
-        if len(self.available_ports) > 0:
+        if len(sys.argv) > 1:
+            # E.g. the device made by host/tools/lick_emulate, which is
+            # not listed among the serial ports.
+            self.port = sys.argv[1]
+        elif len(self.available_ports) > 0:
             self.port = self.available_ports[0].device
 
         # UI settings
@@ -87,6 +115,46 @@ class Settings:
         self.available_ports.sort()
 
 
+class RasterItem(pg.GraphicsObject):
+    """
+    Show a LickRaster, with time in seconds (0 is now) on the x-axis and
+    one row per electrode. The image is shared with the raster, not
+    copied, and drawn in two parts (from the oldest column to the end,
+    then from the start) so that it scrolls without being moved.
+    """
+    def __init__(self, raster):
+        super().__init__()
+        self.raster = raster
+        self.window_s = raster.window_ms / 1000
+        self.qimage = pg.functions.ndarray_to_qimage(
+            raster.image, QtGui.QImage.Format.Format_Indexed8)
+        # From the background colour (no licks) to black.
+        background = pg.mkColor(pg.getConfigOption('background'))
+        self.qimage.setColorTable([
+            QtGui.QColor(*(int(c * (255 - v) / 255)
+                           for c in background.getRgb()[:3])).rgb()
+            for v in range(256)])
+
+    def boundingRect(self):
+        return QtCore.QRectF(-self.window_s, 0, self.window_s,
+                             self.raster.n_rows)
+
+    def paint(self, painter, *args):
+        n_rows = self.raster.n_rows
+        n_columns = self.raster.n_columns
+        column_s = self.window_s / n_columns
+        split = self.raster.oldest
+        n_old = n_columns - split
+        painter.drawImage(
+            QtCore.QRectF(-self.window_s, 0, n_old * column_s, n_rows),
+            self.qimage, QtCore.QRectF(split, 0, n_old, n_rows))
+        if split:
+            painter.drawImage(
+                QtCore.QRectF(-split * column_s, 0, split * column_s,
+                              n_rows),
+                self.qimage, QtCore.QRectF(0, 0, split, n_rows))
+
+
 class MainWindow(QtWidgets.QMainWindow, Ui_MainWindow):
     """
     Data acquisition main window
@@ -98,6 +166,7 @@ class MainWindow(QtWidgets.QMainWindow, Ui_MainWindow):
         self.playButton.setEnabled(True)
         self.stopButton.setEnabled(False)
         self.settings = Settings()
+        self.raster = None
 
         # Create a timer to update the plot at regular intervals
         self.timer = QtCore.QTimer()
@@ -132,40 +201,24 @@ class MainWindow(QtWidgets.QMainWindow, Ui_MainWindow):
             QtWidgets.QMessageBox.critical(self, "Serial error",
                                            exc.strerror)
             return
-        time.sleep(0.1)
 
-        retries = 0
-        self.statusbar.showMessage("Waiting for data...")
-        self.serial.reset_input_buffer()
-        while self.serial.in_waiting < 30:
-            if retries == retry:
-                msg = "No serial data received."
-                self.stop()
-                QtWidgets.QMessageBox.information(self, "Notice", msg)
-                return
-            retries += 1
-            time.sleep(1)
-
-
-        # Read the first line of data. When the wrong baud rate is set
-        # this line will not have an end-of-line character, and that can
-        # be used to alert the user. (I do not know if this will always
-        # work out though.)
-        #
-        # Note that, according to pySerial documentation
-        # (https://pythonhosted.org/pyserial/shortintro.html#readline),
-        # an exception should be raised if readline() does not find an
-        # end-of-line when a timeout is set. However, that does not work
-        # for me: even with a timeout, readline() blocks forever when
-        # the wrong baud rate is set (and thus no eol is found). These
-        # lines seem to do a good job at circumventing that issue.
-        self.serial.timeout = 0
-        line = self.serial.readline(30)
-        if not line.endswith(b'\n'):
-            self.stop()
-            msg = ("The serial stream is not as expected.\n" +
-                   "Perhaps the wrong baud rate was set?")
-            QtWidgets.QMessageBox.critical(self, "Serial error", msg)
+        # A device that describes itself says which signals it sends,
+        # and there is no need to wait for data to check the stream.
+        device = describe(self.serial)
+        self.raster = None
+        if (device is not None and 'columns' in device and
+                device.get('format') in ('events', 'edges')):
+            self.start_raster(device)
+            return
+        if device is not None and 'columns' in device:
+            self.signals = [
+                signals_by_name.get(
+                    name,
+                    [1, name, other_colours[col % len(other_colours)]])
+                for (col, name) in enumerate(device['columns'])]
+        elif self.wait_for_data(retry):
+            self.signals = [signals[n] for n in sorted(signals)]
+        else:
             return
 
         # If the first line was successfully read, this can be used to
@@ -181,17 +234,17 @@ class MainWindow(QtWidgets.QMainWindow, Ui_MainWindow):
         #else:
             #nsignals = len(line)
             #self._x0 = 0
-        # For the purpose of testing the sensor we hardcode 6 signals:
-        # baseline, data, delta, tth, rth, is_touched
-        nsignals = len(signals)
+        # Without a description, for the purpose of testing the sensor
+        # we hardcode 6 signals: baseline, data, delta, tth, rth,
+        # is_touched
+        nsignals = len(self.signals)
         # self._x0 = 0
-        self.data = []
 
-        # The first set of values in data is values of x. The following
-        # sets are each of the signals.
-        # for _ in range(nsignals+1):
-        for _ in range(nsignals):
-            self.data.append(deque([], maxlen=self.settings.width))
+        # Lines are decoded straight into an array, and only the last
+        # `width` samples of each signal are kept (one column per
+        # signal).
+        self.decoder = RecordDecoder(nsignals, dtype=np.float64)
+        self.data = np.empty((0, nsignals))
 
         # Set up plots
         self.setup_plot(nsignals)
@@ -207,6 +260,69 @@ class MainWindow(QtWidgets.QMainWindow, Ui_MainWindow):
         # self.recButton.setEnabled(True)
         # self.settingsButton.setEnabled(False)
 
+    def start_raster(self, device):
+        """
+        Show the licks of a device that sends lick events as a raster,
+        instead of plotting the values of every column.
+        """
+        columns = device['columns']
+        self.raster = LickRaster(device['sensors'], device['electrodes'],
+                                 RASTER_WINDOW_S * 1000, RASTER_COLUMNS)
+        self.time_col = columns.index('timestamp')
+        # The masks of onsets; offsets (edges) and the sampling interval
+        # of each sensor (adaptive sampling) are not shown.
+        self.mask_cols = [col for (col, name) in enumerate(columns)
+                          if name.startswith(('sensor', 'onset'))]
+        self.decoder = RecordDecoder(len(columns), dtype=np.int64)
+        # Device time, in ms, minus host time: the raster keeps scrolling
+        # between events.
+        self.clock_offset = None
+        self.setup_raster()
+        self.serial.timeout = None
+        self.timer.start(self._gui_refresh_rate)
+        self.statusbar.clearMessage()
+        self.playButton.setEnabled(False)
+        self.stopButton.setEnabled(True)
+
+    def wait_for_data(self, retry):
+        """
+        Wait for data from a device that does not describe itself, and
+        check that it looks right. Return True if it does.
+        """
+        retries = 0
+        self.statusbar.showMessage("Waiting for data...")
+        self.serial.reset_input_buffer()
+        while self.serial.in_waiting < 30:
+            if retries == retry:
+                msg = "No serial data received."
+                self.stop()
+                QtWidgets.QMessageBox.information(self, "Notice", msg)
+                return False
+            retries += 1
+            time.sleep(1)
+
+        # Read the first line of data. When the wrong baud rate is set
+        # this line will not have an end-of-line character, and that can
+        # be used to alert the user. (I do not know if this will always
+        # work out though.)
+        #
+        # Note that, according to pySerial documentation
+        # (https://pythonhosted.org/pyserial/shortintro.html#readline),
+        # an exception should be raised if readline() does not find an
+        # end-of-line when a timeout is set. However, that does not work
+        # for me: even with a timeout, readline() blocks forever when
+        # the wrong baud rate is set (and thus no eol is found). These
+        # lines seem to do a good job at circumventing that issue.
+        self.serial.timeout = 0
+        line = self.serial.readline(30)
+        if not line.endswith(b'\n'):
+            self.stop()
+            msg = ("The serial stream is not as expected.\n" +
+                   "Perhaps the wrong baud rate was set?")
+            QtWidgets.QMessageBox.critical(self, "Serial error", msg)
+            return False
+        return True
+
     def stop(self):
         """
         Stop reading serial data.
@@ -235,56 +351,66 @@ class MainWindow(QtWidgets.QMainWindow, Ui_MainWindow):
         This function runs repeatedly under a QTimer. It reads the data
         form the serial port and plots it.
         """
+        if self.raster is not None:
+            self.update_raster()
+            return
         if self.serial.in_waiting > 10:
-            try:
-                this_data = self.serial.readlines(self.serial.in_waiting)
-                for line in this_data:
-                    line = line.decode()
-
-                    # Write data to file if requested.
-                    #if self.recButton.isChecked():
-                        #self._outfile.writelines(line)
-                        #self._outfile.flush()
-
-                    # Push the data values in to the data queues. The
-                    # first data queue is x. This can be time values
-                    # read from the serial input or the index of the
-                    # sample.
-                    #if self.settings.first_is_x:
-                        #for (index, val) in zip(count(), line.split()):
-                            #val = float(val)
-                            #if index == 0:
-                                ## Convert from ms to s, then substract
-                                ## first time value so that sampling
-                                ## always starts at time 0.
-                                #val = (val/1000) - self._x0
-                            #self.data[index].append(val)
-        
-                    # Data: Baseline, filtered data, touch and release
-                    # thresholds, status
-                    #else:
-                    for (index, val) in zip(count(), line.split()):
-                        #if index == 0:
-                            #self.data[0].append(self._x0)
-                            #self._x0 += 1
-                        #self.data[index+1].append(float(val))
-                        val = float(val)
-                        # if index == 5:
-                            # val *= 270
-                            #l = pg.InfiniteLine(pos=float(val), angle=90,
-                                            #pen=None, movable=False)
-                            #self.plots[-1].addItem(l)
-                        self.data[index].append(val)
-                        self.curves[index].setData(y=self.data[index])
-
-                # Plot the data. First data queue is x.
-                #for (index, samples) in zip(count(), self.data[1:-1]):
-                    #self.curves[index].setData(self.data[0], samples)
-
-            except ValueError as error:
-                print(error)
-                self.timer.stop()
-                # sys.exit()
+            self.decoder.feed(self.serial.read(self.serial.in_waiting))
+            new_data = self.decoder.read()
+            if len(new_data) == 0:
+                return
+            width = self.settings.width
+            self.data = np.concatenate((self.data, new_data))[-width:]
+
+            # Write data to file if requested.
+            #if self.recButton.isChecked():
+                #np.savetxt(self._outfile, new_data)
+                #self._outfile.flush()
+
+            # Data: Baseline, filtered data, delta, touch and release
+            # thresholds, status. Each curve is redrawn once per update,
+            # however many samples arrived.
+            for (index, curve) in enumerate(self.curves):
+                curve.setData(y=self.data[:, index])
+
+    def update_raster(self):
+        """
+        Draw the licks that arrived since the last update into the
+        raster, and scroll it to the current time.
+        """
+        now_ms = time.monotonic() * 1000
+        if self.serial.in_waiting:
+            self.decoder.feed(self.serial.read(self.serial.in_waiting))
+            new_data = self.decoder.read()
+            if len(new_data):
+                timestamps = new_data[:, self.time_col]
+                self.raster.add(timestamps, new_data[:, self.mask_cols])
+                self.clock_offset = timestamps[-1] - now_ms
+        if self.clock_offset is not None:
+            self.raster.advance(now_ms + self.clock_offset)
+        self.raster_item.update()
+
+    def setup_raster(self):
+        self.layout = pg.GraphicsLayout()
+        self.graphicsView.setCentralItem(self.layout)
+        plot = self.layout.addPlot(row=0, col=0)
+        self.raster_item = RasterItem(self.raster)
+        plot.addItem(self.raster_item)
+        plot.invertY(True)
+        plot.setXRange(-RASTER_WINDOW_S, 0, padding=0)
+        plot.setYRange(0, self.raster.n_rows, padding=0)
+        plot.setMouseEnabled(x=False, y=False)
+        plot.setLabel('bottom', 'Time (s)')
+
+        # One label per electrode if they fit, or else one per sensor.
+        labels = self.raster.labels()
+        step = (1 if self.raster.n_rows <= RASTER_LABEL_ALL
+                else self.raster.n_electrodes)
+        yaxis = plot.axes['left']['item']
+        yaxis.setTicks([[(row + 0.5, labels[row])
+                         for row in range(0, self.raster.n_rows, step)]])
+        self.plots = [plot]
+        self.curves = []
 
     def setup_plot(self, nsignals):
         # title_fontsize = 10
@@ -332,7 +458,7 @@ class MainWindow(QtWidgets.QMainWindow, Ui_MainWindow):
         for nrow in range(nsignals):
             # Create curves.
             # curve = plot.plot(pen=self.settings.curve_colour)
-            signal = signals[nrow]
+            signal = self.signals[nrow]
             panel, name, colour = signal
             pen = pg.mkPen(colour, width=CURVE_WIDTH)
             plot = self.plots[panel]
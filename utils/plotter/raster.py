@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+# coding=utf-8
+#
+# Copyright (c) 2026 Antonio González
+
+""" raster.py
+
+A raster of the licks on many electrodes: one row per electrode, one
+tick per lick, over a window of time that scrolls as the data arrive.
+
+The raster is kept as an image of `n_columns` columns of `column_ms`
+each, in a numpy array used as a ring buffer. Only the new licks are
+drawn into it (one tick is a pixel, darker when several licks fall in
+it), and only the columns that time has reached are cleared, so the
+cost of an update depends on the number of new licks and not on the
+length of the window. Scrolling does not move the image: the column
+that holds the oldest time (`LickRaster.oldest`) is where it has to be
+split to be shown in order (see `RasterItem` in main.py).
+
+Lick events arrive as lines of `idx timestamp mask mask ...`, one mask
+of onsets per sensor, as sent by the firmware in the `events` format;
+`edges` lines have a mask of onsets and one of offsets per sensor, and
+only the onsets are used. The raster is not tied to Qt, so that it can
+be used (and timed, see host/bench/bench_raster.py) without a display.
+
+Example
+-------
+    raster = LickRaster(n_sensors=8, n_electrodes=12)
+    raster.add(timestamps_ms, masks)   # masks: n x n_sensors
+    raster.image                       # 96 x 1200, uint8
+"""
+
+import numpy as np
+
+# Every lick makes its pixel this much darker, up to 255.
+TICK = 128
+
+
+class LickRaster:
+    """
+    The licks of `n_sensors` x `n_electrodes` electrodes (row
+    `sensor * n_electrodes + electrode`) over the last `window_ms`.
+    """
+    def __init__(self, n_sensors, n_electrodes, window_ms=600000,
+                 n_columns=1200):
+        self.n_sensors = n_sensors
+        self.n_electrodes = n_electrodes
+        self.n_rows = n_sensors * n_electrodes
+        self.n_columns = n_columns
+        self.window_ms = window_ms
+        self.column_ms = window_ms / n_columns
+        self.image = np.zeros((self.n_rows, n_columns), dtype=np.uint8)
+        # Absolute number of the newest column (time // column_ms).
+        self.newest = None
+        self._bits = np.arange(n_electrodes, dtype=np.int64)
+
+    @property
+    def oldest(self):
+        """ Column of the image that holds the oldest time. """
+        if self.newest is None:
+            return 0
+        return (self.newest + 1) % self.n_columns
+
+    def advance(self, now_ms):
+        """
+        Move the window forward to `now_ms`, clearing the columns that
+        it enters. Times earlier than the newest so far are ignored.
+        """
+        column = int(now_ms // self.column_ms)
+        if self.newest is None:
+            self.newest = column
+            return
+        n_new = column - self.newest
+        if n_new <= 0:
+            return
+        if n_new >= self.n_columns:
+            self.image[:] = 0
+        else:
+            cleared = (self.newest + 1 + np.arange(n_new)) % self.n_columns
+            self.image[:, cleared] = 0
+        self.newest = column
+
+    def add(self, timestamps_ms, masks):
+        """
+        Draw the onsets of new events: `timestamps_ms` (n values) and
+        `masks` (n x n_sensors, electrode `e` in bit `e`). The window is
+        moved forward to the last timestamp; events that are already
+        out of the window are dropped.
+        """
+        if len(timestamps_ms) == 0:
+            return
+        self.advance(np.max(timestamps_ms))
+        masks = np.asarray(masks, dtype=np.int64)
+        bits = (masks[:, :, np.newaxis] >> self._bits) & 1
+        (event, sensor, electrode) = np.nonzero(bits)
+        if len(event) == 0:
+            return
+        column = (np.asarray(timestamps_ms)[event] //
+                  self.column_ms).astype(np.int64)
+        keep = column > self.newest - self.n_columns
+        row = sensor[keep] * self.n_electrodes + electrode[keep]
+        pixel = row * self.n_columns + column[keep] % self.n_columns
+        (pixel, count) = np.unique(pixel, return_counts=True)
+        flat = self.image.reshape(-1)
+        flat[pixel] = np.minimum(flat[pixel] + count * TICK, 255)
+
+    def labels(self):
+        """
+        Names of the electrodes (A0, A1, ..., B0, ...), by row.
+        """
+        return [f"{chr(ord('A') + s)}{e}"
+                for s in range(self.n_sensors)
+                for e in range(self.n_electrodes)]
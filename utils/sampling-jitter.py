@@ -0,0 +1,72 @@
+"""
+Compare the jitter of the sampling times of several recordings.
+
+With -DLICK_BENCHMARK=ON the firmware prints, every second, the jitter
+of its sampling times since it started, as a line
+
+    # jitter <timer|core1> interval_us <us> n <samples> missed <n>
+      late_max_us <us> error_max_us <us> hist <16 counts>
+
+(all in one line; see firmware/lick_bench.h), where the histogram
+counts the period errors, the change in lateness from one sample to the
+next, in bins of powers of 2 of us. This script takes the last such line
+of each file (a log of the serial port, or a csv file saved by the lick
+events readers) and prints one row per file, e.g. to compare sampling
+from the repeating timer on core 0 with sampling on core 1
+(LICK_SAMPLING_CORE1) at several rates:
+
+    cat /dev/ttyACM0 > timer_50hz.txt   # for some minutes, and so on
+    python3 sampling-jitter.py timer_50hz.txt core1_50hz.txt ...
+
+Percentiles are the upper edge of the bin they fall in, e.g. `<8` for
+4 to 8 us.
+
+author: Antonio Gonzalez
+last updated: 2026-10-18
+"""
+import sys
+
+N_BINS = 16
+
+
+def last_jitter(path):
+    fields = None
+    with open(path, 'r', errors='replace') as fin:
+        for line in fin:
+            if line.startswith('# jitter '):
+                fields = line.split()
+    if fields is None or len(fields) < 14 + N_BINS:
+        return None
+    values = dict(zip(fields[3:13:2], map(int, fields[4:13:2])))
+    values['mode'] = fields[2]
+    values['hist'] = [int(x) for x in fields[14:14 + N_BINS]]
+    return values
+
+
+def percentile(hist, q):
+    """ Upper edge of the bin of the q-th percentile, as text. """
+    total = sum(hist)
+    count = 0
+    for (k, n) in enumerate(hist):
+        count += n
+        if count >= q * total:
+            if k == len(hist) - 1:
+                return f'>={1 << (k - 1)}'
+            return f'<{1 << k}'
+    return '-'
+
+
+print(f'{"file":<24}{"mode":>6}{"Hz":>6}{"samples":>10}{"missed":>8}'
+      f'{"p50":>8}{"p99":>8}{"p99.9":>8}{"max":>8}{"late max":>9}'
+      '  (period error, us)')
+for path in sys.argv[1:]:
+    j = last_jitter(path)
+    if j is None:
+        print(f'{path:<24}  no jitter report')
+        continue
+    print(f'{path:<24}{j["mode"]:>6}{1e6 / j["interval_us"]:>6.0f}'
+          f'{j["n"]:>10}{j["missed"]:>8}'
+          f'{percentile(j["hist"], 0.5):>8}'
+          f'{percentile(j["hist"], 0.99):>8}'
+          f'{percentile(j["hist"], 0.999):>8}'
+          f'{j["error_max_us"]:>8}{j["late_max_us"]:>9}')
@@ -0,0 +1,70 @@
+"""
+Measure how well lick sensor samples line up with a sync signal.
+
+The firmware can print the time of every pulse on its sync output and of
+every edge on its sync input, as lines
+
+    # sync out <count> <time, us>
+    # sync in <count> <time, us> <phase, us>
+
+which the lick events readers save to the csv file as comments (see
+firmware/README.md). This script summarises them:
+
+* Loopback: with the sync output wired to the sync input, each input
+  edge should arrive right after its output pulse. The delay between
+  them is the error with which the sync input is timestamped.
+* Phase: how far the nearest sample was from each input edge. With a
+  free-running clock this wanders through a whole sampling interval;
+  with LICK_SYNC_LOCK it should stay within a few us once locked.
+
+Usage:
+
+    python3 sync-loopback.py lick_events_<date>.csv
+
+author: Antonio Gonzalez
+last updated: 2026-10-18
+"""
+import statistics
+import sys
+
+
+def summary(name, values, unit='us'):
+    if not values:
+        print(f'{name}: none')
+        return
+    sd = statistics.stdev(values) if len(values) > 1 else 0
+    print(f'{name}: n {len(values)}, mean {statistics.mean(values):.1f}, '
+          f'sd {sd:.1f}, min {min(values)}, max {max(values)} {unit}')
+
+
+out_times = []
+in_times = []
+phases = []
+with open(sys.argv[1], 'r') as fin:
+    for line in fin:
+        fields = line.split()
+        if len(fields) < 5 or fields[:2] != ['#', 'sync']:
+            continue
+        if fields[2] == 'out':
+            out_times.append(int(fields[4]))
+        elif fields[2] == 'in' and len(fields) >= 6:
+            in_times.append(int(fields[4]))
+            phases.append(int(fields[5]))
+
+# Pair every output pulse with the first input edge after it, if it
+# comes before the next pulse.
+delays = []
+j = 0
+for (i, t_out) in enumerate(out_times):
+    t_next = out_times[i + 1] if i + 1 < len(out_times) else None
+    while j < len(in_times) and in_times[j] < t_out:
+        j += 1
+    if j < len(in_times) and (t_next is None or in_times[j] < t_next):
+        delays.append(in_times[j] - t_out)
+
+print(f'{len(out_times)} output pulses, {len(in_times)} input edges')
+summary('Loopback delay (input - output)', delays)
+summary('Phase of input edges', phases)
+# Once locked, the first few edges are the lock being acquired.
+if len(phases) > 20:
+    summary('Phase, after the first 10 edges', phases[10:])
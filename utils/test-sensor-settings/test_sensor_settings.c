@@ -119,6 +119,14 @@ int main() {
         printf("%u %u %d %u %u %u\n", baseline, filtered, delta,
             tth, rth, is_touched * delta);
 
+        // The plotter sends `?` to find out what is being sent (see
+        // firmware/lick_command.h).
+        if (getchar_timeout_us(0) == '?') {
+            printf("# device test-sensor-settings version 0.1 sensors 1 "
+                   "electrodes 1 interval_us 50000 format samples "
+                   "columns baseline,filtered,delta,tth,rth,status\n");
+        }
+
         // Pause.
         sleep_ms(50);
     }